@@ -20,6 +20,10 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #define TDMA_DATA_STORE_H_
 
 #include <string>
+#include <deque>
+#include <vector>
+#include <set>
+#include <tuple>
 
 #include "tdma_common.h"
 
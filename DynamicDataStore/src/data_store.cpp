@@ -676,12 +676,12 @@ to_int_string(T e, typename std::enable_if<std::is_enum<T>::value>::type *_ = 0)
 { return std::to_string( static_cast<int>(e) ); }
 
 
-// BEING CALLED BY ANOTHER THREAD
+// BEING CALLED BY ANOTHER THREAD (w/ the session's parsed content)
 void
 session_callback( int callback_type,
                   int streamer_service_type,
                   unsigned long long time,
-                  const char* data )
+                  const json& j )
 {
     using namespace std;
     using namespace tdma;
@@ -712,28 +712,27 @@ session_callback( int callback_type,
         log_info("STREAMING", "stopped");
         return;
     case StreamingCallbackType::request_response:
-        log_info("STREAMING", "request response", string(data));
+        log_info("STREAMING", "request response", j.dump());
         return;
     case StreamingCallbackType::error:
-        log_error("STREAMING", "error", string(data));
+        log_error("STREAMING", "error", j.dump());
         return;
     case StreamingCallbackType::timeout:
         log_error("STREAMING", "timeout");
         return;
     case StreamingCallbackType::notify:
-        log_error("STREAMING", "notify", (data ? string(data) : "" ) );
+        log_error("STREAMING", "notify", j.dump());
         return;
     case StreamingCallbackType::data:
         break;
     }
 
     auto ssty = static_cast<StreamerServiceType>(streamer_service_type);
-    if( !data ){
+    if( j.is_null() ){
         log_error("STREAMING", "null data, service type", to_string(ssty));
         return;
     }
 
-    json j = json::parse(string(data));
     unsigned long long t;
 
     StreamingData::QueuesGuard lock;
@@ -1331,6 +1330,7 @@ Start( milliseconds listening_timeout )
         session = tdma::StreamingSession::Create(
             *credentials,
             session_callback,
+            "",
             tdma::StreamingSession::DEF_CONNECT_TIMEOUT,
             listening_timeout
             );
@@ -17,8 +17,12 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 
 #include <string>
 #include <chrono>
+#include <mutex>
 
 #include "curl_connect.h"
+#include "rate_limiter.h"
+#include "response_cache.h"
+#include "retry_policy.h"
 #include "tdma_api_get.h"
 
 namespace tdma {
@@ -42,22 +46,54 @@ const int TYPE_ID_GETTER_ORDERS = 16;
 const int TYPE_ID_GETTER_USER_PRINCIPALS = 17;
 const int TYPE_ID_GETTER_INSTRUMENT_INFO = 18;
 
+/* not getters, outside the getter range */
+const int TYPE_ID_OPTION_CHAIN_TABLE = 101;
+const int TYPE_ID_CANDLE_TABLE = 102;
+
 class APIGetterImpl{
-    static std::chrono::milliseconds wait_msec; // DEF_WAIT_MSEC
-    static std::chrono::milliseconds last_get_msec; // 0
-    static std::mutex get_mtx;
+    static TokenBucket throttle; // DEF_WAIT_MSEC, DEF_BURST
+    static TokenBucket endpoint_throttles[3]; // disabled
     static int current_connection_group;
+    static ResponseCache response_cache;
+    static std::mutex retry_policy_mtx;
+    static RetryPolicy retry_policies[3]; // DEF_RETRY_POLICY
+    static LatencyTracker latencies[3];
 
+    /* retries(and hedges) throttled_get_once per the retry policy */
     static std::string
-    throttled_get(APIGetterImpl& getter);
+    throttled_get( APIGetterImpl& getter,
+                   const conn::chunk_cb_ty& on_chunk = conn::chunk_cb_ty() );
 
-    static std::chrono::milliseconds
-    throttled_wait_remaining();
+    static std::string
+    throttled_get_once( APIGetterImpl& getter,
+                        const conn::chunk_cb_ty& on_chunk );
+
+    /* send again on the async loop if no response after 'hedge_after' */
+    static std::string
+    hedged_get( APIGetterImpl& getter, std::chrono::milliseconds hedge_after );
+
+    static TokenBucket&
+    endpoint_throttle(EndpointClass endpoint_class);
 
     api_on_error_cb_ty _on_error_callback;
     std::reference_wrapper<Credentials> _credentials;
     std::unique_ptr<conn::HTTPConnectionInterface> _connection;
+    std::unique_ptr<std::mutex> _connection_mtx;
+    EndpointClass _endpoint_class;
+    std::string _endpoint; // metrics key, e.g 'GET marketdata/{}/quotes'
     int _connection_group_id;
+    bool _coalesce;
+    std::chrono::milliseconds _cache_ttl;
+
+    std::string
+    request_key() const;
+
+    std::string
+    endpoint() const;
+
+    /* copy of the current request for the async loop */
+    std::shared_ptr<conn::HTTPConnection>
+    async_connection() const;
 
 protected:
     APIGetterImpl(Credentials& creds, api_on_error_cb_ty on_error_callback);
@@ -78,12 +114,21 @@ protected:
     void
     set_url(const std::string& url);
 
+    Credentials&
+    get_credentials() const
+    { return _credentials.get(); }
+
+    /* client_id + hash of the refresh token; one per account */
+    static std::string
+    account_key(const Credentials& creds);
+
 public:
     typedef APIGetter ProxyType;
     static const int TYPE_ID_LOW = TYPE_ID_GETTER_QUOTE;
     static const int TYPE_ID_HIGH = TYPE_ID_GETTER_INSTRUMENT_INFO;
 
     static const std::chrono::milliseconds DEF_WAIT_MSEC;
+    static const unsigned int DEF_BURST;
 
     static std::chrono::milliseconds
     get_wait_msec();
@@ -94,6 +139,31 @@ public:
     static std::chrono::milliseconds
     wait_remaining();
 
+    static unsigned int
+    get_burst();
+
+    static void
+    set_burst(unsigned int burst);
+
+    static std::pair<std::chrono::milliseconds, unsigned int>
+    get_endpoint_wait_msec(EndpointClass endpoint_class);
+
+    static void
+    set_endpoint_wait_msec( EndpointClass endpoint_class,
+                            std::chrono::milliseconds msec,
+                            unsigned int burst );
+
+    static std::chrono::milliseconds
+    endpoint_wait_remaining(EndpointClass endpoint_class);
+
+    static const RetryPolicy DEF_RETRY_POLICY;
+
+    static void
+    set_retry_policy(EndpointClass endpoint_class, const RetryPolicy& policy);
+
+    static RetryPolicy
+    get_retry_policy(EndpointClass endpoint_class);
+
     static void
     share_connections(bool share)
     { current_connection_group = (share ? 0 : -1); }
@@ -102,9 +172,68 @@ public:
     is_sharing_connections()
     { return current_connection_group == 0; }
 
+    static void
+    set_max_connections(unsigned int n)
+    { conn::HTTPConnectionPool::set_max_connections(n); }
+
+    static unsigned int
+    get_max_connections()
+    { return conn::HTTPConnectionPool::get_max_connections(); }
+
+    static void
+    set_connection_max_idle(std::chrono::milliseconds msec)
+    { conn::HTTPConnectionPool::set_max_idle(msec); }
+
+    static std::chrono::milliseconds
+    get_connection_max_idle()
+    { return conn::HTTPConnectionPool::get_max_idle(); }
+
+    /* stats for the shared connection group's pool */
+    static conn::ConnectionPoolStats
+    get_connection_pool_stats()
+    { return conn::SharedHTTPConnection::get_pool_stats(0); }
+
+    static void
+    set_cache_enabled(bool enabled)
+    { response_cache.set_enabled(enabled); }
+
+    static bool
+    is_cache_enabled()
+    { return response_cache.is_enabled(); }
+
+    static void
+    set_cache_max_entries(unsigned int n)
+    { response_cache.set_max_entries(n); }
+
+    static unsigned int
+    get_cache_max_entries()
+    { return static_cast<unsigned int>(response_cache.get_max_entries()); }
+
+    /* empty string for memory only */
+    static void
+    set_cache_directory(const std::string& directory);
+
+    static std::string
+    get_cache_directory();
+
+    static void
+    clear_cache()
+    { response_cache.clear(); }
+
     virtual std::string
     get();
 
+    /* callback is called from the async loop thread */
+    virtual void
+    get_async(connect_async_cb_ty callback);
+
+    /* body is passed to 'on_chunk' as it arrives (nothing if no data) */
+    virtual void
+    get_stream(const conn::chunk_cb_ty& on_chunk);
+
+    EndpointClass
+    get_endpoint_class() const;
+
     void
     close();
 
@@ -116,6 +245,29 @@ public:
 
     std::chrono::milliseconds
     get_timeout() const;
+
+    /* share the result of an identical in-flight get (default) */
+    void
+    set_coalesce(bool coalesce)
+    { _coalesce = coalesce; }
+
+    bool
+    is_coalescing() const
+    { return _coalesce; }
+
+    /* how long get() responses are cached (0 disables) */
+    void
+    set_cache_ttl(std::chrono::milliseconds msec)
+    { _cache_ttl = msec; }
+
+    std::chrono::milliseconds
+    get_cache_ttl() const
+    { return _cache_ttl; }
+
+    /* drop the cached response(if any) for the current request */
+    void
+    invalidate_cache()
+    { response_cache.invalidate( request_key() ); }
 };
 
 } /* tdma */
@@ -135,6 +135,44 @@ StreamingSubscriptionImpl
 C_sub_ptr_to_impl(StreamingSubscription_C *psub);
 
 
+class StreamingSessionImpl;
+class StreamFieldHandler;
+
+/*
+ * StreamingResponseParser - runs messages through a session's listener
+ * parser w/o a connection, e.g to benchmark or test it w/ recorded frames;
+ * 'callback' is called for 'data' and 'notify' messages as it would be
+ * from a session. (Responses to requests are unexpected w/o a session.)
+ */
+class StreamingResponseParser{
+    std::unique_ptr<StreamingSessionImpl> _ss;
+
+public:
+    StreamingResponseParser(streaming_cb_ty callback);
+
+    StreamingResponseParser(streaming_json_cb_ty callback);
+
+    /* no callbacks, e.g only field handlers */
+    StreamingResponseParser();
+
+    ~StreamingResponseParser();
+
+    StreamingResponseParser( const StreamingResponseParser& ) = delete;
+
+    StreamingResponseParser&
+    operator=( const StreamingResponseParser& ) = delete;
+
+    // THROWS
+    void
+    parse(const std::string& responses);
+
+    /* see StreamFrameScanner */
+    void
+    set_field_handler( StreamerServiceType service,
+                       StreamFieldHandler *handler );
+};
+
+
 } /* tdma */
 
 
@@ -29,16 +29,94 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include "util.h"
 #include "tdma_common.h"
 #include "curl_connect.h"
+#include "request_scheduler.h"
+#include "metrics.h"
 
 namespace tdma{
 
-const std::string URL_BASE = "https://api.tdameritrade.com/v1/";
-const std::string URL_MARKETDATA = URL_BASE + "marketdata/";
-const std::string URL_ACCOUNTS = URL_BASE + "accounts/";
-const std::string URL_INSTRUMENTS = URL_BASE + "instruments";
+const std::string DEF_URL_BASE = "https://api.tdameritrade.com/v1/";
+
+/*
+ * base of all the REST urls, overridable (e.g to point at tools/mock_server.py)
+ * set_url_base expects 'http://' or 'https://' and adds a trailing '/'
+ */
+std::string
+url_base();
+
+void
+set_url_base(const std::string& url);
+
+inline std::string
+url_marketdata()
+{ return url_base() + "marketdata/"; }
+
+inline std::string
+url_accounts()
+{ return url_base() + "accounts/"; }
+
+inline std::string
+url_instruments()
+{ return url_base() + "instruments"; }
+
+/*
+ * streamer websocket url; empty(default) uses the one from UserPrincipals
+ * set_streamer_url expects 'ws://' or 'wss://'
+ */
+std::string
+streamer_url();
+
+void
+set_streamer_url(const std::string& url);
 
 typedef std::function<void(long, const std::string&)> api_on_error_cb_ty;
 
+/* (internal) ConnectException from a curl error, keeps the curl code */
+class CurlConnectException
+        : public ConnectException{
+    int _curl_code;
+
+public:
+    CurlConnectException( std::string what,
+                          int curl_code,
+                          int lineno,
+                          const std::string& filename )
+        :
+            ConnectException(what, lineno, filename),
+            _curl_code(curl_code)
+        {}
+
+    int
+    curl_code() const noexcept
+    { return _curl_code; }
+};
+
+/* lanes are RequestLane values; gets and executes are admitted through it */
+RequestScheduler&
+request_scheduler();
+
+/* per-endpoint request counters and latencies (see metrics.h) */
+MetricsRegistry&
+metrics();
+
+/* status code of a ConnectException, 0 for anything else(e.g curl errors) */
+long
+status_from_exception(std::exception_ptr e);
+
+/* count a finished request(status 0 if no response) and time its phases */
+void
+record_request_metrics( const std::string& endpoint,
+                        long status,
+                        const conn::HTTPConnectionInterface& connection );
+
+/* record a newly issued access token(and lifetime) for its client_id */
+void
+update_access_token(const Credentials& creds, long long expires_in_sec);
+
+/* the newest access token for 'creds' account (requests don't write it back
+ * to the cred struct) */
+std::string
+current_access_token(const Credentials& creds);
+
 json
 connect_auth( conn::HTTPConnectionInterface& connection, std::string fname);
 
@@ -47,6 +125,24 @@ connect_get( conn::HTTPConnectionInterface& connection,
              Credentials& creds,
              api_on_error_cb_ty on_error_cb );
 
+/* body is passed to 'on_chunk' as it arrives instead of being returned */
+conn::clock_ty::time_point
+connect_get_stream( conn::HTTPConnectionInterface& connection,
+                    Credentials& creds,
+                    api_on_error_cb_ty on_error_cb,
+                    const conn::chunk_cb_ty& on_chunk );
+
+/* data OR exception, called from the async loop thread */
+typedef std::function<void(const std::string&, std::exception_ptr)>
+    connect_async_cb_ty;
+
+void
+connect_get_async( std::shared_ptr<conn::HTTPConnection> connection,
+                   Credentials& creds,
+                   api_on_error_cb_ty on_error_cb,
+                   conn::clock_ty::time_point start_at,
+                   connect_async_cb_ty callback );
+
 std::pair<std::string, conn::clock_ty::time_point>
 connect_execute( conn::HTTPConnectionInterface& connection,
                    Credentials& creds,
@@ -169,6 +265,42 @@ CallImplFromABI(bool allow_throw, RetTy(*func)(Args...), Args2... args)
 }
 
 
+/*
+ * error_from_exception_ptr converts an exception captured on the 'inside' of
+ *                          the library boundary (e.g on the async loop thread)
+ *                          to an error code/msg, setting the error state like
+ *                          CallImplFromABI does.
+ */
+inline std::pair<int, std::string>
+error_from_exception_ptr(std::exception_ptr e)
+{
+    int err = 0;
+    int lineno = 0;
+    std::string msg, filename;
+
+    try{
+        std::rethrow_exception(e);
+    }catch(APIException& e){
+        err = e.error_code();
+        msg = e.what();
+        lineno = e.lineno();
+        filename = e.filename();
+    }catch(conn::CurlException& e){
+        err = TDMA_API_ERROR;
+        msg = e.what();
+    }catch(std::exception& e){
+        err = TDMA_API_STD_EXCEPTION;
+        msg = e.what();
+    }catch(...){
+        err = TDMA_API_UNKNOWN_EXCEPTION;
+        msg = "unknown exception";
+    }
+
+    set_error_state(err, msg, lineno, filename);
+    return std::make_pair(err, msg);
+}
+
+
 /*
  * TDMA_API_THROW should ONLY be used by code that is run by CallImplFromABI
  */
@@ -26,6 +26,11 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <mutex>
 #include <tuple>
 #include <memory>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+#include <atomic>
 
 #include "curl/curl.h"
 
@@ -38,6 +43,22 @@ typedef std::chrono::steady_clock clock_ty;
 static_assert( static_cast<double>(clock_ty::period::num)
                / clock_ty::period::den <= .001, "invalid tick size of clock" );
 
+/*
+ * called with each chunk of a successful(2xx) response body as it arrives,
+ * instead of buffering it; return false to abort the transfer
+ */
+typedef std::function<bool(const char*, size_t)> chunk_cb_ty;
+
+/* phases of a connection's last transfer (from curl_easy_getinfo) */
+struct TransferTimes{
+    std::chrono::microseconds dns; // 0 if the connection was re-used
+    std::chrono::microseconds connect; // ""
+    std::chrono::microseconds tls; // "", or not https
+    std::chrono::microseconds ttfb; // request sent to first byte back
+    std::chrono::microseconds transfer; // first byte to last
+    std::chrono::microseconds total;
+};
+
 class CurlConnection {
     friend std::ostream&
     operator<<(std::ostream& out, const CurlConnection& session);       
@@ -84,6 +105,28 @@ public:
     std::tuple<long, std::string, std::string, clock_ty::time_point>
     execute(bool return_header_data);
 
+    // <status code, body(empty if streamed), header(optional), time>
+    std::tuple<long, std::string, std::string, clock_ty::time_point>
+    execute(bool return_header_data, const chunk_cb_ty& on_chunk);
+
+    // <status code, body, header(optional), time> OR exception
+    typedef std::function<
+        void(std::tuple<long, std::string, std::string, clock_ty::time_point>,
+             std::exception_ptr)
+        > async_callback_ty;
+
+    /*
+     * queue on the async (curl_multi) loop - not before 'start_at' - and
+     * return immediately; callback is called from the loop thread.
+     *
+     * connection must outlive the transfer and shouldn't be used until
+     * the callback is called
+     */
+    void
+    execute_async( bool return_header_data,
+                   async_callback_ty callback,
+                   clock_ty::time_point start_at = clock_ty::time_point() );
+
     void
     close();
 
@@ -113,6 +156,10 @@ public:
     void
     set_keepalive(bool on);
 
+    /* w/ HTTP/2 let 'execute' share a connection on the multi handle */
+    void
+    set_multiplex(bool on);
+
     void
     set_timeout(long timeout);
 
@@ -131,6 +178,16 @@ public:
     bool
     has_headers();
 
+    /*
+     * use a header list owned elsewhere (it must outlive its use) instead
+     * of building one; replaces any added headers
+     */
+    void
+    set_header_list(struct curl_slist *list);
+
+    TransferTimes
+    get_transfer_times() const;
+
     void
     set_fields(const std::vector<std::pair<std::string, std::string>>& fields);
 
@@ -170,9 +227,23 @@ public:
 
     virtual bool has_headers() = 0;
 
+    /*
+     * the 'Authorization' header is kept in its own slot so a refreshed
+     * token only swaps that value; 'add_headers' puts it there too
+     */
+    virtual void set_auth_header(const std::string& value) = 0;
+
+    virtual const std::string& get_auth_header() const = 0;
+
+    /* of the last execute */
+    virtual TransferTimes get_transfer_times() const = 0;
+
     virtual std::tuple<long, std::string, std::string, clock_ty::time_point>
     execute(bool return_header_data) = 0;
 
+    virtual std::tuple<long, std::string, std::string, clock_ty::time_point>
+    execute(bool return_header_data, const chunk_cb_ty& on_chunk) = 0;
+
     virtual void
     set_fields(const std::vector<std::pair<std::string, std::string>>& fields) =0;
 
@@ -185,14 +256,65 @@ public:
 
 
 // defaults to 'gzip' content encoding
+/*
+ * RequestTemplate - immutable url and prebuilt header list
+ *
+ * Built once, when the url or headers change, instead of on every request.
+ * A pooled connection that was last set up from the same template skips
+ * setting the url and rebuilding its header list; the list itself is only
+ * read by libcurl so one can be shared by concurrent transfers.
+ */
+class RequestTemplate{
+    std::string _url;
+    std::vector<std::pair<std::string,std::string>> _headers;
+    std::string _auth;
+    struct curl_slist *_header_list;
+
+public:
+    RequestTemplate( const std::string& url,
+                     const std::vector<std::pair<std::string,std::string>>& headers,
+                     const std::string& auth );
+
+    ~RequestTemplate();
+
+    RequestTemplate( const RequestTemplate& ) = delete;
+
+    RequestTemplate&
+    operator=( const RequestTemplate& ) = delete;
+
+    const std::string&
+    get_url() const
+    { return _url; }
+
+    /* w/o the 'Authorization' header */
+    const std::vector<std::pair<std::string,std::string>>&
+    get_headers() const
+    { return _headers; }
+
+    const std::string&
+    get_auth_header() const
+    { return _auth; }
+
+    struct curl_slist*
+    get_header_list() const
+    { return _header_list; }
+};
+
+
 class HTTPConnection : public CurlConnection, public HTTPConnectionInterface {
     enum class Protocol { http, https, none };
     Protocol _proto;
     HttpMethod _meth;
+    std::vector<std::pair<std::string,std::string>> _headers; // w/o auth
+    std::string _auth;
+    std::shared_ptr<const RequestTemplate> _tmpl; // if set up from one
 
     HttpMethod
     _set_method(HttpMethod meth);
 
+    void
+    _rebuild_headers();
+
 public:
     static const std::string DEFAULT_ENCODING;
 
@@ -237,25 +359,42 @@ public:
     { _meth = _set_method(meth); }
 
     void
-    add_headers(const std::vector<std::pair<std::string,std::string>>& headers)
-    { CurlConnection::add_headers(headers); }
+    add_headers(const std::vector<std::pair<std::string,std::string>>& headers);
 
     std::vector<std::pair<std::string,std::string>>
     get_headers() const
     { return CurlConnection::get_headers(); }
 
     void
-    reset_headers()
-    { CurlConnection::reset_headers(); }
+    reset_headers();
 
     bool
     has_headers()
     { return CurlConnection::has_headers(); }
 
+    void
+    set_auth_header(const std::string& value);
+
+    const std::string&
+    get_auth_header() const
+    { return _tmpl ? _tmpl->get_auth_header() : _auth; }
+
+    TransferTimes
+    get_transfer_times() const
+    { return CurlConnection::get_transfer_times(); }
+
+    /* set url and headers from 'tmpl' unless they already are */
+    void
+    use_template(const std::shared_ptr<const RequestTemplate>& tmpl);
+
     std::tuple<long, std::string, std::string, clock_ty::time_point>
     execute(bool return_header_data)
     { return CurlConnection::execute(return_header_data); }
 
+    std::tuple<long, std::string, std::string, clock_ty::time_point>
+    execute(bool return_header_data, const chunk_cb_ty& on_chunk)
+    { return CurlConnection::execute(return_header_data, on_chunk); }
+
     void
     set_fields(const std::vector<std::pair<std::string, std::string>>& fields)
     { CurlConnection::set_fields(fields); }
@@ -280,18 +419,153 @@ std::string
 pairs_to_fields_str(const std::vector<std::pair<std::string, std::string>>& fields);
 
 
+struct ConnectionPoolStats{
+    size_t in_use;
+    size_t idle;
+    unsigned long long waits;
+    std::chrono::milliseconds wait_time; // total
+};
+
+
+/*
+ * HTTP/2 mode (off by default) - negotiate HTTP/2 over TLS and run
+ * (non-streaming) transfers through the async loop's multi handle so
+ * concurrent requests to the same host are multiplexed as streams on one
+ * connection. Falls back to HTTP/1.1 if libcurl or the server doesn't
+ * support HTTP/2.
+ */
+void
+set_http2(bool on);
+
+bool
+is_http2();
+
+/* if the libcurl we're linked against was built with HTTP/2 */
+bool
+http2_supported();
+
+struct HTTPStats{
+    unsigned long long requests; // completed transfers
+    unsigned long long connections; // new connections they opened
+    unsigned long long http2_requests;
+};
+
+HTTPStats
+get_http_stats();
+
+
+/*
+ * HTTPConnectionPool - bounded pool of warm (keep-alive) HTTPConnections
+ *
+ * checkout re-uses the most recently used idle connection, creates a new
+ * one if there are fewer than 'max_connections', or blocks until one is
+ * checked back in. Idle connections older than 'max_idle' are closed.
+ *
+ * (all the library's requests go to the same host so the max is per host)
+ */
+class HTTPConnectionPool{
+public:
+    static const size_t DEF_MAX_CONNECTIONS;
+    static const std::chrono::milliseconds DEF_MAX_IDLE;
+
+    /* returns the connection to the pool when destroyed */
+    class Handle{
+        HTTPConnectionPool *_pool;
+        std::unique_ptr<HTTPConnection> _conn;
+        bool _reuse;
+
+    public:
+        Handle(HTTPConnectionPool *pool, std::unique_ptr<HTTPConnection> conn)
+            : _pool(pool), _conn(std::move(conn)), _reuse(true)
+            {}
+
+        Handle( Handle&& h )
+            : _pool(h._pool), _conn(std::move(h._conn)), _reuse(h._reuse)
+            {}
+
+        Handle( const Handle& ) = delete;
+
+        Handle&
+        operator=( const Handle& ) = delete;
+
+        ~Handle()
+        { if( _conn ) _pool->_checkin( std::move(_conn), _reuse ); }
+
+        HTTPConnection*
+        operator->()
+        { return _conn.get(); }
+
+        /* don't return to the pool (e.g connection in a bad state) */
+        void
+        discard()
+        { _reuse = false; }
+    };
+
+private:
+    typedef std::pair<std::unique_ptr<HTTPConnection>, clock_ty::time_point>
+        idle_elem_ty;
+
+    static std::atomic<size_t> max_connections;
+    static std::atomic<long long> max_idle_msec;
+
+    HttpMethod _meth;
+    mutable std::mutex _mtx;
+    std::condition_variable _cond;
+    std::vector<idle_elem_ty> _idle; // most recently used at back
+    size_t _in_use;
+    unsigned long long _waits;
+    std::chrono::milliseconds _wait_time;
+
+    /* caller needs to hold _mtx, returns what should be closed */
+    std::vector<std::unique_ptr<HTTPConnection>>
+    _evict_idle();
+
+    void
+    _checkin(std::unique_ptr<HTTPConnection> conn, bool reuse);
+
+public:
+    HTTPConnectionPool(HttpMethod meth);
+
+    HTTPConnectionPool( const HTTPConnectionPool& ) = delete;
+
+    HTTPConnectionPool&
+    operator=( const HTTPConnectionPool& ) = delete;
+
+    Handle
+    checkout();
+
+    ConnectionPoolStats
+    get_stats() const;
+
+    static void
+    set_max_connections(size_t n)
+    { max_connections = (n > 0 ? n : 1); }
+
+    static size_t
+    get_max_connections()
+    { return max_connections; }
+
+    static void
+    set_max_idle(std::chrono::milliseconds msec)
+    { max_idle_msec = msec.count(); }
+
+    static std::chrono::milliseconds
+    get_max_idle()
+    { return std::chrono::milliseconds(max_idle_msec); }
+};
+
+
 class SharedHTTPConnection : public HTTPConnectionInterface {
 
     struct Context{
         size_t nref;
-        std::shared_ptr<HTTPConnection> conn;
-        std::shared_ptr<std::mutex> mtx;
+        std::shared_ptr<HTTPConnectionPool> pool;
 
-        Context(HTTPConnection * pconn)
-            : nref(0), conn(pconn), mtx(new std::mutex())
+        Context(HttpMethod meth)
+            : nref(0), pool(new HTTPConnectionPool(meth))
             {}
 
-        Context() : Context(nullptr) {}
+        Context() : nref(0), pool() {}
     };
 
     static std::unordered_map<int, Context> contexts;
@@ -309,15 +583,22 @@ class SharedHTTPConnection : public HTTPConnectionInterface {
     bool _is_open;
     std::string _url;
     HttpMethod _meth;
-    std::vector<std::pair<std::string,std::string>> _headers;
+    std::vector<std::pair<std::string,std::string>> _headers; // w/o auth
+    std::string _auth;
     std::string _fields;
     long _timeout;
     int _id;
+    std::shared_ptr<const RequestTemplate> _tmpl; // reset on url/header change
+    TransferTimes _times; // from the pooled connection
 
-    Context&
-    _get_context() const;
+    std::shared_ptr<HTTPConnectionPool>
+    _get_pool() const;
 
 public:
+    /* stats for a context group's pool (zeros if no open connections) */
+    static ConnectionPoolStats
+    get_pool_stats(int context_id);
+
     SharedHTTPConnection( const std::string& url,
                           HttpMethod meth,
                           int context_id );
@@ -369,23 +650,46 @@ public:
     { _meth = meth; }
 
     void
-    add_headers(const std::vector<std::pair<std::string,std::string>>& headers)
-    { _headers.insert( _headers.end(), headers.begin(), headers.end() ); }
+    add_headers(const std::vector<std::pair<std::string,std::string>>& headers);
 
     std::vector<std::pair<std::string,std::string>>
-    get_headers() const
-    { return _headers; }
+    get_headers() const;
 
     void
     reset_headers()
-    { _headers.clear(); }
+    {
+        _headers.clear();
+        _auth.clear();
+        _tmpl.reset();
+    }
 
     bool
     has_headers()
-    { return !_headers.empty(); }
+    { return !_headers.empty() || !_auth.empty(); }
+
+    void
+    set_auth_header(const std::string& value)
+    {
+        if( value != _auth ){
+            _auth = value;
+            _tmpl.reset();
+        }
+    }
+
+    const std::string&
+    get_auth_header() const
+    { return _auth; }
+
+    TransferTimes
+    get_transfer_times() const
+    { return _times; }
 
     std::tuple<long, std::string, std::string, clock_ty::time_point>
-    execute(bool return_header_data);
+    execute(bool return_header_data)
+    { return execute(return_header_data, chunk_cb_ty()); }
+
+    std::tuple<long, std::string, std::string, clock_ty::time_point>
+    execute(bool return_header_data, const chunk_cb_ty& on_chunk);
 
     void
     set_fields(const std::vector<std::pair<std::string, std::string>>& fields)
@@ -0,0 +1,478 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef JSON_SCANNER_H
+#define JSON_SCANNER_H
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+#include <utility>
+
+/*
+ * JSONScanner - pull scanner for decoding json of a known shape in place
+ *
+ * For the typed decoders (QuoteRecord etc.) that know what they expect and
+ * want to skip the DOM: strings come back as pointers into the buffer
+ * (escapes left in place, see 'unescape'), numbers are converted w/o
+ * copying and anything not wanted is skipped. Never allocates. Throws
+ * JSONScanError on malformed input; never reads past 'end'.
+ *
+ *   JSONScanner s(data, data + n);
+ *   s.begin_object();
+ *   for( bool first = true; s.next_member(first, k, kn); ){
+ *       if( key is wanted ) s.number(d); else s.skip_value();
+ *   }
+ */
+class JSONScanError
+        : public std::runtime_error {
+public:
+    JSONScanError(const std::string& what, size_t pos)
+        : std::runtime_error(what + " at position " + std::to_string(pos))
+        {}
+};
+
+class JSONScanner{
+    const char *_beg;
+    const char *_p;
+    const char *_end;
+
+    static bool
+    is_digit(char c)
+    { return c >= '0' && c <= '9'; }
+
+    void
+    skip_ws()
+    {
+        while( _p < _end
+               && (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t') )
+            ++_p;
+    }
+
+    void
+    literal(const char *lit, size_t n)
+    {
+        if( static_cast<size_t>(_end - _p) < n || memcmp(_p, lit, n) )
+            fail("invalid literal");
+        _p += n;
+    }
+
+    /* integer mantissa/exponent of the number at _p; returns false if it
+       can't be exact (too many digits), leaving 'b' at its start */
+    bool
+    scan_number( const char*& b,
+                 bool& neg,
+                 unsigned long long& mant,
+                 int& exp10,
+                 bool& is_int )
+    {
+        skip_ws();
+        b = _p;
+        neg = (_p < _end && *_p == '-');
+        if( neg )
+            ++_p;
+
+        mant = 0;
+        exp10 = 0;
+        is_int = true;
+        int ndigits = 0;
+        bool exact = true;
+        const char *d0 = _p;
+        for( ; _p < _end && is_digit(*_p); ++_p ){
+            if( ndigits < 19 ){
+                mant = mant * 10 + (*_p - '0');
+                ndigits += (mant != 0);
+            }else{
+                ++exp10;
+                exact = false;
+            }
+        }
+        if( _p == d0 )
+            fail("invalid number");
+
+        if( _p < _end && *_p == '.' ){
+            is_int = false;
+            const char *f0 = ++_p;
+            for( ; _p < _end && is_digit(*_p); ++_p ){
+                if( ndigits < 19 ){
+                    mant = mant * 10 + (*_p - '0');
+                    ndigits += (mant != 0);
+                    --exp10;
+                }else{
+                    exact = false;
+                }
+            }
+            if( _p == f0 )
+                fail("invalid number");
+        }
+
+        if( _p < _end && (*_p == 'e' || *_p == 'E') ){
+            is_int = false;
+            ++_p;
+            bool eneg = false;
+            if( _p < _end && (*_p == '-' || *_p == '+') )
+                eneg = (*_p++ == '-');
+            const char *e0 = _p;
+            int e = 0;
+            for( ; _p < _end && is_digit(*_p); ++_p ){
+                if( e < 10000 )
+                    e = e * 10 + (*_p - '0');
+            }
+            if( _p == e0 )
+                fail("invalid number");
+            exp10 += eneg ? -e : e;
+        }
+        return exact;
+    }
+
+public:
+    JSONScanner(const char *beg, const char *end)
+        : _beg(beg), _p(beg), _end(end)
+        {}
+
+    size_t
+    position() const
+    { return static_cast<size_t>(_p - _beg); }
+
+    [[noreturn]] void
+    fail(const char *what) const
+    { throw JSONScanError(what, position()); }
+
+    /* next non-whitespace char, '\0' at the end */
+    char
+    peek()
+    {
+        skip_ws();
+        return _p < _end ? *_p : '\0';
+    }
+
+    bool
+    at_end()
+    { return peek() == '\0'; }
+
+    void
+    expect(char c)
+    {
+        if( peek() != c ){
+            char msg[] = "expected 'X'";
+            msg[10] = c;
+            fail(msg);
+        }
+        ++_p;
+    }
+
+    void
+    begin_object()
+    { expect('{'); }
+
+    void
+    begin_array()
+    { expect('['); }
+
+    /* false (and past the '}') when there are no more members */
+    bool
+    next_member(bool& first, const char*& key, size_t& key_len)
+    {
+        if( peek() == '}' ){
+            ++_p;
+            return false;
+        }
+        if( !first )
+            expect(',');
+        first = false;
+        string(key, key_len);
+        expect(':');
+        return true;
+    }
+
+    /* false (and past the ']') when there are no more elements */
+    bool
+    next_element(bool& first)
+    {
+        if( peek() == ']' ){
+            ++_p;
+            return false;
+        }
+        if( !first )
+            expect(',');
+        first = false;
+        return true;
+    }
+
+    /* raw contents, escapes left in place ('escaped' if there are any) */
+    void
+    string(const char*& s, size_t& n, bool *escaped = nullptr)
+    {
+        expect('"');
+        s = _p;
+        while( true ){
+            const char *q = static_cast<const char*>(
+                memchr(_p, '"', static_cast<size_t>(_end - _p)) );
+            if( !q )
+                fail("unterminated string");
+            /* an odd # of backslashes before it escapes the quote */
+            const char *bs = q;
+            while( bs > _p && bs[-1] == '\\' )
+                --bs;
+            _p = q + 1;
+            if( ((q - bs) & 1) == 0 )
+                break;
+        }
+        n = static_cast<size_t>(_p - 1 - s);
+        if( escaped )
+            *escaped = memchr(s, '\\', n) != nullptr;
+    }
+
+    void
+    number(double& d)
+    {
+        const char *b;
+        bool neg, is_int;
+        unsigned long long mant;
+        int exp10;
+        bool exact = scan_number(b, neg, mant, exp10, is_int);
+
+        /* exact if the mantissa and power of 10 are (< 2^53, <= 10^22) */
+        static const double POW10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        if( exact && mant < (1ULL << 53) && exp10 >= -22 && exp10 <= 22 ){
+            d = exp10 < 0 ? static_cast<double>(mant) / POW10[-exp10]
+                          : static_cast<double>(mant) * POW10[exp10];
+        }else{
+            char buf[64];
+            size_t n = static_cast<size_t>(_p - b);
+            if( n >= sizeof(buf) )
+                fail("number too long");
+            memcpy(buf, b, n);
+            buf[n] = '\0';
+            d = strtod(buf, nullptr);
+            return;
+        }
+        if( neg )
+            d = -d;
+    }
+
+    void
+    number(long long& v)
+    {
+        const char *b = _p;
+        bool neg, is_int;
+        unsigned long long mant;
+        int exp10;
+        bool exact = scan_number(b, neg, mant, exp10, is_int);
+        if( is_int && exact && mant <= 9223372036854775807ULL ){
+            v = neg ? -static_cast<long long>(mant)
+                    : static_cast<long long>(mant);
+            return;
+        }
+        _p = b; // re-scan as a double, e.g 1.5e3
+        double d;
+        number(d);
+        v = static_cast<long long>(d);
+    }
+
+    bool
+    boolean()
+    {
+        char c = peek();
+        if( c == 't' ){
+            literal("true", 4);
+            return true;
+        }
+        if( c != 'f' )
+            fail("expected boolean");
+        literal("false", 5);
+        return false;
+    }
+
+    /* consumes a null if it's next */
+    bool
+    null()
+    {
+        if( peek() != 'n' )
+            return false;
+        literal("null", 4);
+        return true;
+    }
+
+    void
+    skip_value()
+    {
+        char c = peek();
+        const char *s;
+        size_t n;
+        switch(c){
+        case '"':
+            string(s, n);
+            return;
+        case 't':
+        case 'f':
+            boolean();
+            return;
+        case 'n':
+            null();
+            return;
+        case '{':
+        case '[':
+            break;
+        default:
+            double d;
+            number(d);
+            return;
+        }
+
+        /* containers: just match brackets, skipping over strings */
+        int depth = 0;
+        do{
+            if( _p >= _end )
+                fail("unterminated object/array");
+            c = *_p;
+            if( c == '"' ){
+                string(s, n);
+                continue;
+            }
+            if( c == '{' || c == '[' )
+                ++depth;
+            else if( c == '}' || c == ']' )
+                --depth;
+            ++_p;
+        }while( depth > 0 );
+    }
+
+    /* unescape raw string contents from string() into 'out' */
+    static void
+    unescape(const char *s, size_t n, std::string& out)
+    {
+        out.clear();
+        const char *end = s + n;
+        while( s < end ){
+            if( *s != '\\' ){
+                out.push_back(*s++);
+                continue;
+            }
+            if( ++s == end )
+                break;
+            switch( *s++ ){
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u':{
+                unsigned long cp = 0;
+                for( int i = 0; i < 4 && s < end; ++i, ++s ){
+                    char h = *s;
+                    cp = cp * 16 + (is_digit(h) ? h - '0'
+                                                : (h | 0x20) - 'a' + 10);
+                }
+                /* surrogate pair */
+                if( cp >= 0xD800 && cp <= 0xDBFF && end - s >= 6
+                    && s[0] == '\\' && s[1] == 'u' )
+                {
+                    unsigned long lo = strtoul(std::string(s + 2, 4).c_str(),
+                                               nullptr, 16);
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    s += 6;
+                }
+                if( cp < 0x80 ){
+                    out.push_back( static_cast<char>(cp) );
+                }else if( cp < 0x800 ){
+                    out.push_back( static_cast<char>(0xC0 | (cp >> 6)) );
+                    out.push_back( static_cast<char>(0x80 | (cp & 0x3F)) );
+                }else if( cp < 0x10000 ){
+                    out.push_back( static_cast<char>(0xE0 | (cp >> 12)) );
+                    out.push_back( static_cast<char>(0x80 | ((cp >> 6) & 0x3F)) );
+                    out.push_back( static_cast<char>(0x80 | (cp & 0x3F)) );
+                }else{
+                    out.push_back( static_cast<char>(0xF0 | (cp >> 18)) );
+                    out.push_back( static_cast<char>(0x80 | ((cp >> 12) & 0x3F)) );
+                    out.push_back( static_cast<char>(0x80 | ((cp >> 6) & 0x3F)) );
+                    out.push_back( static_cast<char>(0x80 | (cp & 0x3F)) );
+                }
+                break;
+            }
+            default: out.push_back(s[-1]); // '"', '\\', '/'
+            }
+        }
+    }
+};
+
+
+/*
+ * KeyMap - fixed (sorted) map of json keys for the scanner's raw key
+ * pointers; lookup by pointer/length w/o building a std::string
+ */
+template<typename V>
+class KeyMap{
+    std::vector<std::pair<std::string, V>> _entries;
+
+    static int
+    compare(const std::string& l, const char *r, size_t rn)
+    {
+        int c = memcmp(l.data(), r, std::min(l.size(), rn));
+        if( c )
+            return c;
+        return (l.size() < rn) ? -1 : (l.size() > rn);
+    }
+
+    void
+    sort()
+    {
+        std::sort( _entries.begin(), _entries.end(),
+                   [](const std::pair<std::string, V>& l,
+                      const std::pair<std::string, V>& r){
+                       return l.first < r.first;
+                   } );
+    }
+
+public:
+    KeyMap(std::initializer_list<std::pair<std::string, V>> entries)
+        : _entries(entries)
+    { sort(); }
+
+    /* e.g from an existing std::map/unordered_map */
+    template<typename Iter>
+    KeyMap(Iter beg, Iter end)
+        : _entries(beg, end)
+    { sort(); }
+
+    /* nullptr if not found */
+    const V*
+    find(const char *key, size_t n) const
+    {
+        size_t lo = 0, hi = _entries.size();
+        while( lo < hi ){
+            size_t mid = (lo + hi) / 2;
+            int c = compare(_entries[mid].first, key, n);
+            if( c == 0 )
+                return &_entries[mid].second;
+            if( c < 0 )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return nullptr;
+    }
+};
+
+#endif /* JSON_SCANNER_H */
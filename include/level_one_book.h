@@ -0,0 +1,298 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef LEVEL_ONE_BOOK_H
+#define LEVEL_ONE_BOOK_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <limits>
+#include <tuple>
+
+#include "stream_frame_scanner.h"
+#include "symbol_table.h"
+
+namespace tdma {
+
+/*
+ * LevelOneBook - latest value of every level one field, per symbol per
+ * service, merged from the streamer's deltas
+ *
+ * A StreamFieldHandler for the listener thread (the ONE writer): each
+ * content item's fields are collected, then committed to the symbol's
+ * record under its sequence counter. Readers on any thread copy a record
+ * out w/ 'snapshot', retrying if a commit overlapped the copy; they never
+ * take a lock or make the writer wait.
+ *
+ * Records are found by (service, symbol id) through a fixed table of
+ * lazily allocated chunks, so readers can look up while the writer adds
+ * symbols. Records live as long as the book.
+ */
+class LevelOneBook
+        : public StreamFieldHandler {
+public:
+    static const int NFIELDS = STREAMING_LEVEL_ONE_MAX_FIELDS;
+
+    static const StreamerServiceType*
+    services()
+    {
+        static const StreamerServiceType s[] = {
+            StreamerServiceType::QUOTE,
+            StreamerServiceType::OPTION,
+            StreamerServiceType::LEVELONE_FUTURES,
+            StreamerServiceType::LEVELONE_FOREX,
+            StreamerServiceType::LEVELONE_FUTURES_OPTIONS
+        };
+        return s;
+    }
+
+    static const int NSERVICES = 5;
+
+private:
+    static const size_t CHUNK_SIZE = 1024;
+    static const size_t MAX_CHUNKS = 1024; // ~1M symbol ids
+
+    struct Record{
+        std::atomic<unsigned int> seq; // odd while a commit is in progress
+        std::atomic<unsigned long long> timestamp;
+        std::atomic<unsigned long long> nupdates;
+        std::atomic<double> fields[NFIELDS];
+        const char *symbol;
+        const unsigned int symbol_id;
+        const int service;
+
+        Record(const char *symbol, unsigned int symbol_id, int service)
+            :
+                seq(0),
+                timestamp(0),
+                nupdates(0),
+                symbol(symbol),
+                symbol_id(symbol_id),
+                service(service)
+            {
+                for( auto& f : fields )
+                    f.store( std::numeric_limits<double>::quiet_NaN(),
+                             std::memory_order_relaxed );
+            }
+    };
+
+    struct Chunk{
+        std::atomic<Record*> records[CHUNK_SIZE];
+
+        Chunk()
+        {
+            for( auto& r : records )
+                r.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    std::atomic<Chunk*> _chunks[NSERVICES][MAX_CHUNKS];
+
+    /* writer (listener thread) only */
+    std::vector<std::unique_ptr<Chunk>> _chunk_storage;
+    std::vector<std::unique_ptr<Record>> _record_storage;
+    std::unordered_map<std::string, Record*> _by_symbol[NSERVICES];
+    std::string _symbol; // reused, no allocation
+    Record *_cur;
+    unsigned long long _cur_ts;
+    uint64_t _changed; // bit per field
+    double _pending[NFIELDS];
+
+    static int
+    service_index(StreamerServiceType service)
+    {
+        for( int i = 0; i < NSERVICES; ++i ){
+            if( services()[i] == service )
+                return i;
+        }
+        return -1;
+    }
+
+    Record*
+    find(int service_index, unsigned int symbol_id) const
+    {
+        size_t c = symbol_id / CHUNK_SIZE;
+        if( c >= MAX_CHUNKS )
+            return nullptr;
+        Chunk *chunk = _chunks[service_index][c].load(std::memory_order_acquire);
+        if( !chunk )
+            return nullptr;
+        return chunk->records[symbol_id % CHUNK_SIZE]
+                   .load(std::memory_order_acquire);
+    }
+
+    /* nullptr if the id table is full */
+    Record*
+    add(int service_index)
+    {
+        const char *sym;
+        unsigned int id;
+        std::tie(sym, id) = SymbolTable::instance().intern(_symbol);
+        size_t c = id / CHUNK_SIZE;
+        if( c >= MAX_CHUNKS )
+            return nullptr;
+
+        std::atomic<Chunk*>& pchunk = _chunks[service_index][c];
+        Chunk *chunk = pchunk.load(std::memory_order_relaxed);
+        if( !chunk ){
+            _chunk_storage.emplace_back( new Chunk );
+            chunk = _chunk_storage.back().get();
+            pchunk.store(chunk, std::memory_order_release);
+        }
+
+        _record_storage.emplace_back(
+            new Record(sym, id, static_cast<int>(services()[service_index])) );
+        Record *r = _record_storage.back().get();
+        chunk->records[id % CHUNK_SIZE].store(r, std::memory_order_release);
+        _by_symbol[service_index].emplace(_symbol, r);
+        return r;
+    }
+
+public:
+    LevelOneBook()
+        : _cur(nullptr), _cur_ts(0), _changed(0)
+    {
+        for( auto& s : _chunks ){
+            for( auto& c : s )
+                c.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    LevelOneBook( const LevelOneBook& ) = delete;
+
+    LevelOneBook&
+    operator=( const LevelOneBook& ) = delete;
+
+    static bool
+    has_service(StreamerServiceType service)
+    { return service_index(service) >= 0; }
+
+    /* WRITER */
+    bool
+    begin_item( StreamerServiceType service,
+                unsigned long long timestamp,
+                const char *key,
+                size_t key_len )
+    {
+        int si = service_index(service);
+        if( si < 0 || !key )
+            return false;
+
+        if( memchr(key, '\\', key_len) )
+            JSONScanner::unescape(key, key_len, _symbol);
+        else
+            _symbol.assign(key, key_len);
+
+        auto iter = _by_symbol[si].find(_symbol);
+        _cur = (iter != _by_symbol[si].end()) ? iter->second : add(si);
+        _cur_ts = timestamp;
+        _changed = 0;
+        return _cur != nullptr;
+    }
+
+    void
+    set_number(int field, double v)
+    {
+        if( field < NFIELDS ){
+            _pending[field] = v;
+            _changed |= (1ULL << field);
+        }
+    }
+
+    void
+    set_integer(int field, long long v)
+    { set_number( field, static_cast<double>(v) ); }
+
+    void
+    set_string(int field, const char *s, size_t n)
+    {
+        if( n == 1 )
+            set_number( field, static_cast<unsigned char>(*s) );
+    }
+
+    void
+    set_boolean(int field, bool v)
+    { set_number( field, v ? 1. : 0. ); }
+
+    /* WRITER - publish the item's fields all at once */
+    void
+    end_item()
+    {
+        Record *r = _cur;
+        unsigned int seq = r->seq.load(std::memory_order_relaxed);
+        r->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint64_t c = _changed;
+        for( int f = 0; c; ++f, c >>= 1 ){
+            if( c & 1 )
+                r->fields[f].store(_pending[f], std::memory_order_relaxed);
+        }
+        r->timestamp.store(_cur_ts, std::memory_order_relaxed);
+        r->nupdates.store( r->nupdates.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed );
+
+        r->seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /* READER (any thread) - false if nothing received for the symbol */
+    bool
+    snapshot( StreamerServiceType service,
+              unsigned int symbol_id,
+              LevelOneRecord *out ) const
+    {
+        int si = service_index(service);
+        if( si < 0 )
+            return false;
+        const Record *r = find(si, symbol_id);
+        if( !r )
+            return false;
+
+        out->symbol = r->symbol;
+        out->symbol_id = r->symbol_id;
+        out->service = r->service;
+        while( true ){
+            unsigned int seq = r->seq.load(std::memory_order_acquire);
+            if( seq & 1 )
+                continue; // mid-commit
+            out->timestamp = r->timestamp.load(std::memory_order_relaxed);
+            out->nupdates = r->nupdates.load(std::memory_order_relaxed);
+            for( int i = 0; i < NFIELDS; ++i )
+                out->fields[i] = r->fields[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if( r->seq.load(std::memory_order_relaxed) == seq )
+                return true;
+        }
+    }
+
+    /* READER - looks the id up in the (locked) SymbolTable first */
+    bool
+    snapshot( StreamerServiceType service,
+              const std::string& symbol,
+              LevelOneRecord *out ) const
+    {
+        unsigned int id = SymbolTable::instance().find(symbol);
+        return id ? snapshot(service, id, out) : false;
+    }
+};
+
+} /* tdma */
+
+#endif /* LEVEL_ONE_BOOK_H */
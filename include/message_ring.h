@@ -0,0 +1,359 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef MESSAGE_RING_H
+#define MESSAGE_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <climits>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif /* __linux__ */
+
+/*
+ * RingWaiter - lets ONE thread sleep until another signals it
+ *
+ * The signaling side only pays for a wakeup (a futex syscall on linux) when
+ * the other side is actually asleep, so a busy consumer draining a batch of
+ * messages costs the producer nothing but an atomic exchange per push.
+ *
+ *   sleeper: seq = prepare(); if( !still_nothing_to_do() ) cancel();
+ *            else wait(seq, timeout);
+ *   signaler: (publish work) notify();
+ */
+class RingWaiter{
+    std::atomic<int> _seq; // the futex word
+    std::atomic<bool> _sleeping;
+#ifndef __linux__
+    std::mutex _mtx;
+    std::condition_variable _cond;
+#endif /* __linux__ */
+
+public:
+    RingWaiter()
+        : _seq(0), _sleeping(false)
+    {}
+
+    RingWaiter( const RingWaiter& ) = delete;
+
+    RingWaiter&
+    operator=( const RingWaiter& ) = delete;
+
+    int
+    prepare()
+    {
+        _sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _seq.load();
+    }
+
+    void
+    cancel()
+    { _sleeping.store(false); }
+
+    /* false if timed out */
+    bool
+    wait(int seq, std::chrono::nanoseconds timeout)
+    {
+        bool signaled = true;
+#ifdef __linux__
+        if( _seq.load() == seq ){
+            struct timespec ts;
+            ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+            syscall( SYS_futex, reinterpret_cast<int*>(&_seq),
+                     FUTEX_WAIT_PRIVATE, seq, &ts, nullptr, 0 );
+            signaled = (_seq.load() != seq);
+        }
+#else
+        std::unique_lock<std::mutex> lock(_mtx);
+        signaled = _cond.wait_for( lock, timeout,
+                                   [this, seq]{ return _seq.load() != seq; } );
+#endif /* __linux__ */
+        _sleeping.store(false);
+        return signaled;
+    }
+
+    void
+    notify()
+    {
+        /* pairs w/ the fence in 'prepare'; only write if someone's asleep */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if( !_sleeping.load(std::memory_order_relaxed)
+            || !_sleeping.exchange(false) )
+        {
+            return;
+        }
+#ifdef __linux__
+        ++_seq;
+        syscall( SYS_futex, reinterpret_cast<int*>(&_seq), FUTEX_WAKE_PRIVATE,
+                 INT_MAX, nullptr, nullptr, 0 );
+#else
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            ++_seq;
+        }
+        _cond.notify_all();
+#endif /* __linux__ */
+    }
+};
+
+
+/*
+ * MessageRing - bounded single-producer/single-consumer queue of messages
+ *
+ * The slots are strings that are reused (assigned into, never freed) so once
+ * they've grown to the size of the messages going through them a push is a
+ * memcpy and two atomic ops, no allocation or lock. The consumer processes
+ * messages in place (front/pop) and only sleeps when the ring is empty.
+ *
+ * When the ring is full the producer either blocks until the consumer frees
+ * a slot or drops the message (and counts it), depending on the policy.
+ * 'interrupt' can be called from any thread: the consumer gets an empty
+ * message once it has consumed everything pushed before the call.
+ */
+class MessageRing{
+public:
+    enum class OverflowPolicy : int {
+        block, // producer waits for a free slot
+        drop // newest message is discarded
+    };
+
+    static const size_t DEF_CAPACITY = 4096;
+
+private:
+    static const size_t CACHE_LINE = 64;
+
+    std::vector<std::string> _slots;
+    const size_t _mask;
+    const OverflowPolicy _policy;
+    std::atomic<bool> _closed; // stop blocking the producer
+
+    /* written by the producer */
+    char _pad0[CACHE_LINE];
+    std::atomic<size_t> _head;
+    std::atomic<unsigned long long> _ndropped;
+    size_t _tail_cache; // last _tail seen, to avoid reading it every push
+    RingWaiter _writable;
+
+    /* written by the consumer */
+    char _pad1[CACHE_LINE];
+    std::atomic<size_t> _tail;
+    size_t _head_cache; // last _head seen
+    bool _at_interrupt; // 'front' returned the interrupt
+    RingWaiter _readable;
+
+    /* written by 'interrupt' */
+    char _pad2[CACHE_LINE];
+    std::atomic<bool> _interrupted;
+    std::atomic<size_t> _interrupt_at;
+
+    static size_t
+    _round_up(size_t n)
+    {
+        size_t p = 1;
+        while( p < n )
+            p <<= 1;
+        return p;
+    }
+
+    bool
+    _full(size_t head)
+    {
+        if( head - _tail_cache < _slots.size() )
+            return false;
+        _tail_cache = _tail.load(std::memory_order_acquire);
+        return head - _tail_cache >= _slots.size();
+    }
+
+    void
+    _publish(size_t head, const char *data, size_t n)
+    {
+        _slots[head & _mask].assign(data, n);
+        _head.store(head + 1, std::memory_order_release);
+        _readable.notify();
+    }
+
+    bool
+    _interrupt_ready(size_t tail) const
+    { return _interrupted.load() && tail == _interrupt_at.load(); }
+
+    static const std::string&
+    _empty()
+    {
+        static const std::string s;
+        return s;
+    }
+
+public:
+    MessageRing( size_t capacity = DEF_CAPACITY,
+                 OverflowPolicy policy = OverflowPolicy::block )
+        :
+            _slots( _round_up(capacity ? capacity : 1) ),
+            _mask( _slots.size() - 1 ),
+            _policy( policy ),
+            _closed( false ),
+            _head( 0 ),
+            _ndropped( 0 ),
+            _tail_cache( 0 ),
+            _tail( 0 ),
+            _head_cache( 0 ),
+            _at_interrupt( false ),
+            _interrupted( false ),
+            _interrupt_at( 0 )
+        {}
+
+    MessageRing( const MessageRing& ) = delete;
+
+    MessageRing&
+    operator=( const MessageRing& ) = delete;
+
+    size_t
+    capacity() const
+    { return _slots.size(); }
+
+    OverflowPolicy
+    policy() const
+    { return _policy; }
+
+    unsigned long long
+    ndropped() const
+    { return _ndropped.load(); }
+
+    size_t
+    size() const
+    { return _head.load() - _tail.load(); }
+
+    /* PRODUCER - false if dropped */
+    bool
+    push(const char *data, size_t n)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        while( _full(head) ){
+            if( _policy == OverflowPolicy::drop || _closed.load() ){
+                ++_ndropped;
+                return false;
+            }
+            int seq = _writable.prepare();
+            if( !_full(head) || _closed.load() ){
+                _writable.cancel();
+                continue;
+            }
+            _writable.wait(seq, std::chrono::milliseconds(100));
+        }
+
+        _publish(head, data, n);
+        return true;
+    }
+
+    /* PRODUCER - false if full (not counted as dropped), never waits */
+    bool
+    try_push(const char *data, size_t n)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if( _full(head) )
+            return false;
+        _publish(head, data, n);
+        return true;
+    }
+
+    /* PRODUCER - count a message the producer discarded on its own */
+    void
+    add_dropped()
+    { ++_ndropped; }
+
+    /* ANY THREAD */
+    void
+    interrupt()
+    {
+        _interrupt_at.store( _head.load() );
+        _interrupted.store(true);
+        _readable.notify();
+    }
+
+    /* ANY THREAD - the producer drops rather than block from now on */
+    void
+    close()
+    {
+        _closed.store(true);
+        _writable.notify();
+    }
+
+    /* CONSUMER - the next message (valid until 'pop') or nullptr if none;
+     * an empty message is an interrupt */
+    const std::string*
+    front()
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        _at_interrupt = _interrupt_ready(tail);
+        if( _at_interrupt )
+            return &_empty();
+        if( tail == _head_cache ){
+            _head_cache = _head.load(std::memory_order_acquire);
+            if( tail == _head_cache )
+                return nullptr;
+        }
+        return &_slots[tail & _mask];
+    }
+
+    /* CONSUMER - release the message returned by 'front' */
+    void
+    pop()
+    {
+        if( _at_interrupt ){
+            _at_interrupt = false;
+            _interrupted.store(false);
+            return;
+        }
+        _tail.store( _tail.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release );
+        _writable.notify();
+    }
+
+    /* CONSUMER - false if nothing (incl. an interrupt) before 'timeout' */
+    bool
+    wait_for(std::chrono::milliseconds timeout)
+    {
+        using namespace std::chrono;
+
+        auto t_end = steady_clock::now() + timeout;
+        while( !front() ){
+            auto t_left = duration_cast<nanoseconds>(t_end - steady_clock::now());
+            if( t_left.count() <= 0 )
+                return false;
+            int seq = _readable.prepare();
+            if( front() ){
+                _readable.cancel();
+                break;
+            }
+            _readable.wait(seq, t_left);
+        }
+        return true;
+    }
+};
+
+#endif /* MESSAGE_RING_H */
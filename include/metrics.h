@@ -0,0 +1,474 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+
+/*
+ * LatencyHistogram - log-linear(HDR-style) histogram of microseconds
+ *
+ * Values under 16 get their own bucket; above that each power of 2 is
+ * split into 8 linear buckets so percentiles are within ~12.5% across
+ * the whole range, in a fixed ~2.5KB.  Not thread-safe.
+ */
+class LatencyHistogram{
+public:
+    static const int SUB_BUCKETS = 8; // per power of 2
+    static const int LINEAR = 16; // values w/ their own bucket
+    static const int MAX_EXP = 40; // ~12.7 days in usec
+    static const int NBUCKETS = LINEAR + (MAX_EXP - 3) * SUB_BUCKETS;
+
+private:
+    unsigned long long _buckets[NBUCKETS];
+    unsigned long long _count;
+    unsigned long long _sum;
+    unsigned long long _min;
+    unsigned long long _max;
+
+    static int
+    _exp(unsigned long long v)
+    {
+        int e = 0;
+        while( v >>= 1 )
+            ++e;
+        return e;
+    }
+
+    static int
+    _index(unsigned long long v)
+    {
+        if( v < LINEAR )
+            return static_cast<int>(v);
+        int e = _exp(v);
+        if( e > MAX_EXP )
+            e = MAX_EXP;
+        int sub = static_cast<int>( (v >> (e - 3)) & (SUB_BUCKETS - 1) );
+        return (std::min)( LINEAR + (e - 4) * SUB_BUCKETS + sub, NBUCKETS - 1 );
+    }
+
+    /* largest value that goes in bucket 'i' */
+    static unsigned long long
+    _upper(int i)
+    {
+        if( i < LINEAR )
+            return static_cast<unsigned long long>(i);
+        int e = 4 + (i - LINEAR) / SUB_BUCKETS;
+        unsigned long long sub = (i - LINEAR) % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << (e - 3)) - 1;
+    }
+
+public:
+    LatencyHistogram()
+    { clear(); }
+
+    void
+    record(unsigned long long usec)
+    {
+        ++_buckets[ _index(usec) ];
+        if( _count == 0 || usec < _min )
+            _min = usec;
+        if( usec > _max )
+            _max = usec;
+        ++_count;
+        _sum += usec;
+    }
+
+    /* 'p' in (0, 100]; the bucket's upper bound (capped at the max) */
+    unsigned long long
+    percentile(double p) const
+    {
+        if( _count == 0 )
+            return 0;
+        unsigned long long rank = static_cast<unsigned long long>(
+            (p / 100.0) * _count + .5
+            );
+        rank = (std::max)( rank, 1ULL );
+        unsigned long long seen = 0;
+        for( int i = 0; i < NBUCKETS; ++i ){
+            seen += _buckets[i];
+            if( seen >= rank )
+                return (std::min)( (std::max)(_upper(i), _min), _max );
+        }
+        return _max;
+    }
+
+    unsigned long long
+    count() const
+    { return _count; }
+
+    unsigned long long
+    sum() const
+    { return _sum; }
+
+    unsigned long long
+    min() const
+    { return _min; }
+
+    unsigned long long
+    max() const
+    { return _max; }
+
+    void
+    clear()
+    {
+        std::fill( _buckets, _buckets + NBUCKETS, 0ULL );
+        _count = _sum = _min = _max = 0;
+    }
+};
+
+
+/*
+ * MetricsRegistry - thread-safe counters and latency histograms for each
+ *                   endpoint, plus a few global counters
+ *
+ * Endpoints are keyed by method and a normalized path (see 'endpoint')
+ * so e.g. every symbol's quote request lands in 'GET marketdata/{}/quotes'.
+ * Snapshots are plain text (prometheus exposition format) or JSON.
+ */
+class MetricsRegistry{
+public:
+    enum class Phase : int {
+        queue_wait, // for a request lane (request_scheduler.h)
+        throttle_wait, // for the token buckets (rate_limiter.h)
+        dns,
+        connect,
+        tls,
+        ttfb, // request sent to first byte back
+        transfer, // first byte to last
+        total, // all of the above
+        NPHASES
+    };
+
+    static const int NPHASES = static_cast<int>(Phase::NPHASES);
+
+    static const char*
+    phase_name(Phase p)
+    {
+        static const char* NAMES[NPHASES] = {
+            "queue_wait", "throttle_wait", "dns", "connect", "tls", "ttfb",
+            "transfer", "total"
+        };
+        int i = static_cast<int>(p);
+        return (i >= 0 && i < NPHASES) ? NAMES[i] : "";
+    }
+
+    /*
+     * '[METHOD] [path]' w/o scheme, host, version, or query; segments that
+     * aren't all lower-case letters(symbols, account ids etc.) become '{}'
+     *
+     *   https://api.tdameritrade.com/v1/marketdata/SPY/quotes?apikey=X
+     *     -> GET marketdata/{}/quotes
+     */
+    static std::string
+    endpoint(const std::string& method, const std::string& url)
+    {
+        size_t beg = url.find("://");
+        beg = (beg == std::string::npos) ? 0 : url.find('/', beg + 3);
+        size_t end = (std::min)( url.find('?'), url.size() );
+
+        std::string path;
+        bool first = true;
+        while( beg < end ){
+            size_t seg_beg = beg + 1;
+            size_t seg_end = (std::min)( url.find('/', seg_beg), end );
+            std::string seg = url.substr(seg_beg, seg_end - seg_beg);
+            beg = seg_end;
+            if( seg.empty() )
+                continue;
+            bool is_version = first && seg.size() > 1 && seg[0] == 'v'
+                && std::all_of( seg.begin() + 1, seg.end(),
+                                [](char c){ return std::isdigit(c & 0xff); } );
+            first = false;
+            if( is_version )
+                continue;
+            bool is_word = std::all_of( seg.begin(), seg.end(),
+                [](char c){ return c >= 'a' && c <= 'z'; } );
+            if( !path.empty() )
+                path += '/';
+            path += is_word ? seg : "{}";
+        }
+        return method + ' ' + path;
+    }
+
+private:
+    struct Endpoint{
+        LatencyHistogram phases[NPHASES];
+        std::map<long, unsigned long long> status_codes;
+        unsigned long long requests;
+        unsigned long long errors; // w/o a response (e.g curl errors)
+        unsigned long long retries;
+        unsigned long long hedges;
+
+        Endpoint()
+            : requests(0), errors(0), retries(0), hedges(0)
+            {}
+    };
+
+    mutable std::mutex _mtx;
+    std::map<std::string, Endpoint> _endpoints;
+    std::atomic<bool> _enabled;
+    std::atomic<unsigned long long> _token_refreshes;
+    std::atomic<unsigned long long> _streaming_drops;
+
+    static std::string
+    _json_escape(const std::string& s)
+    {
+        std::string r;
+        for( char c : s ){
+            if( c == '"' || c == '\\' )
+                r += '\\';
+            r += c;
+        }
+        return r;
+    }
+
+    /* reported for each histogram */
+    static const std::vector<double>&
+    _percentiles()
+    {
+        static const std::vector<double> PCTS = {50, 90, 99, 99.9};
+        return PCTS;
+    }
+
+public:
+    MetricsRegistry()
+        : _enabled(true), _token_refreshes(0), _streaming_drops(0)
+        {}
+
+    MetricsRegistry( const MetricsRegistry& ) = delete;
+
+    MetricsRegistry&
+    operator=( const MetricsRegistry& ) = delete;
+
+    void
+    set_enabled(bool enabled)
+    { _enabled = enabled; }
+
+    bool
+    is_enabled() const
+    { return _enabled; }
+
+    void
+    record_phase( const std::string& endpoint,
+                  Phase phase,
+                  std::chrono::microseconds t )
+    {
+        if( !_enabled )
+            return;
+        long long usec = static_cast<long long>( t.count() );
+        std::lock_guard<std::mutex> _(_mtx);
+        _endpoints[endpoint].phases[ static_cast<int>(phase) ].record(
+            usec > 0 ? usec : 0
+            );
+    }
+
+    /*
+     * a finished request: status 0 if there was no response; 'phases' are
+     * the dns through transfer times (zeros are skipped for dns, connect
+     * and tls since a re-used connection doesn't have them)
+     */
+    void
+    record_request( const std::string& endpoint,
+                    long status,
+                    const std::chrono::microseconds phases[NPHASES] = nullptr )
+    {
+        if( !_enabled )
+            return;
+        std::lock_guard<std::mutex> _(_mtx);
+        Endpoint& e = _endpoints[endpoint];
+        ++e.requests;
+        if( status )
+            ++e.status_codes[status];
+        else
+            ++e.errors;
+        if( !phases || !status )
+            return;
+        for( int i = static_cast<int>(Phase::dns); i <= static_cast<int>(Phase::total); ++i ){
+            bool conn_phase = i <= static_cast<int>(Phase::tls);
+            long long usec = static_cast<long long>( phases[i].count() );
+            if( usec > 0 || !conn_phase )
+                e.phases[i].record( usec > 0 ? usec : 0 );
+        }
+    }
+
+    void
+    count_retry(const std::string& endpoint)
+    {
+        if( !_enabled )
+            return;
+        std::lock_guard<std::mutex> _(_mtx);
+        ++_endpoints[endpoint].retries;
+    }
+
+    void
+    count_hedge(const std::string& endpoint)
+    {
+        if( !_enabled )
+            return;
+        std::lock_guard<std::mutex> _(_mtx);
+        ++_endpoints[endpoint].hedges;
+    }
+
+    void
+    count_token_refresh()
+    {
+        if( _enabled )
+            ++_token_refreshes;
+    }
+
+    /* inbound streaming messages dropped because the session's buffer
+       was full (OverflowPolicyType::drop) or full w/ as many held back
+       (OverflowPolicyType::block) */
+    void
+    count_streaming_drops(unsigned long long n)
+    {
+        if( _enabled )
+            _streaming_drops += n;
+    }
+
+    void
+    reset()
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _endpoints.clear();
+        _token_refreshes = 0;
+        _streaming_drops = 0;
+    }
+
+    /* prometheus text exposition format; each metric family is grouped */
+    std::string
+    to_text() const
+    {
+        std::ostringstream ss;
+        ss << "# TYPE tdma_token_refreshes_total counter\n"
+           << "tdma_token_refreshes_total " << _token_refreshes.load() << '\n'
+           << "# TYPE tdma_streaming_dropped_total counter\n"
+           << "tdma_streaming_dropped_total " << _streaming_drops.load() << '\n';
+
+        std::lock_guard<std::mutex> _(_mtx);
+
+        auto counter = [&]( const char* name,
+                            unsigned long long Endpoint::*field ){
+            ss << "# TYPE " << name << " counter\n";
+            for( auto& p : _endpoints ){
+                ss << name << "{endpoint=\"" << _json_escape(p.first) << "\"} "
+                   << p.second.*field << '\n';
+            }
+        };
+        counter("tdma_requests_total", &Endpoint::requests);
+        counter("tdma_errors_total", &Endpoint::errors);
+        counter("tdma_retries_total", &Endpoint::retries);
+        counter("tdma_hedges_total", &Endpoint::hedges);
+
+        ss << "# TYPE tdma_responses_total counter\n";
+        for( auto& p : _endpoints ){
+            for( auto& sc : p.second.status_codes ){
+                ss << "tdma_responses_total{endpoint=\"" << _json_escape(p.first)
+                   << "\",code=\"" << sc.first << "\"} " << sc.second << '\n';
+            }
+        }
+
+        ss << "# TYPE tdma_latency_usec summary\n";
+        for( auto& p : _endpoints ){
+            for( int i = 0; i < NPHASES; ++i ){
+                const LatencyHistogram& h = p.second.phases[i];
+                if( h.count() == 0 )
+                    continue;
+                std::string lbl = "endpoint=\"" + _json_escape(p.first)
+                    + "\",phase=\"" + phase_name( static_cast<Phase>(i) ) + "\"";
+                for( double pct : _percentiles() ){
+                    ss << "tdma_latency_usec{" << lbl << ",quantile=\""
+                       << (pct / 100.0) << "\"} " << h.percentile(pct) << '\n';
+                }
+                ss << "tdma_latency_usec_sum{" << lbl << "} " << h.sum() << '\n'
+                   << "tdma_latency_usec_count{" << lbl << "} " << h.count()
+                   << '\n';
+            }
+        }
+        return ss.str();
+    }
+
+    /*
+     * {"token_refreshes": n, "streaming_dropped": n,
+     *  "endpoints": {"GET marketdata/{}/quotes":
+     *   {"requests": n, "errors": n, "retries": n, "hedges": n,
+     *    "status_codes": {"200": n}, "latency_usec": {"ttfb": {"count": n,
+     *    "min": n, "max": n, "mean": n, "p50": n, "p90": n, "p99": n,
+     *    "p99.9": n}, ...}}, ...}}
+     */
+    std::string
+    to_json() const
+    {
+        std::ostringstream ss;
+        ss << "{\"token_refreshes\": " << _token_refreshes.load()
+           << ", \"streaming_dropped\": " << _streaming_drops.load()
+           << ", \"endpoints\": {";
+
+        std::lock_guard<std::mutex> _(_mtx);
+        bool first = true;
+        for( auto& p : _endpoints ){
+            const Endpoint& e = p.second;
+            ss << (first ? "" : ", ") << '"' << _json_escape(p.first) << "\": {"
+               << "\"requests\": " << e.requests
+               << ", \"errors\": " << e.errors
+               << ", \"retries\": " << e.retries
+               << ", \"hedges\": " << e.hedges
+               << ", \"status_codes\": {";
+            first = false;
+
+            bool first_sc = true;
+            for( auto& sc : e.status_codes ){
+                ss << (first_sc ? "" : ", ") << '"' << sc.first << "\": "
+                   << sc.second;
+                first_sc = false;
+            }
+
+            ss << "}, \"latency_usec\": {";
+            bool first_ph = true;
+            for( int i = 0; i < NPHASES; ++i ){
+                const LatencyHistogram& h = e.phases[i];
+                if( h.count() == 0 )
+                    continue;
+                ss << (first_ph ? "" : ", ") << '"'
+                   << phase_name( static_cast<Phase>(i) ) << "\": {"
+                   << "\"count\": " << h.count()
+                   << ", \"min\": " << h.min()
+                   << ", \"max\": " << h.max()
+                   << ", \"mean\": " << (h.sum() / h.count());
+                for( double pct : _percentiles() )
+                    ss << ", \"p" << pct << "\": " << h.percentile(pct);
+                ss << '}';
+                first_ph = false;
+            }
+            ss << "}}";
+        }
+        ss << "}}";
+        return ss.str();
+    }
+};
+
+#endif /* METRICS_H */
@@ -0,0 +1,134 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+/*
+ * TokenBucket - thread-safe token bucket
+ *
+ *   refill - time it takes to add one token (0 disables the bucket)
+ *   burst  - max tokens the bucket can hold (min of 1)
+ *
+ * Tracked as a 'theoretical arrival time' so there's no refill timer. Callers
+ * reserve a token and are told how long to wait before using it; the bucket
+ * is only locked while reserving so the wait (and whatever the caller does
+ * with the token) happens outside the lock. This allows multiple callers to
+ * be 'in flight' at once while still respecting the rate.
+ */
+class TokenBucket{
+public:
+    typedef std::chrono::steady_clock clock_ty;
+    typedef std::chrono::milliseconds msec_ty;
+
+private:
+    mutable std::mutex _mtx;
+    msec_ty _refill;
+    unsigned int _burst;
+    clock_ty::time_point _tat;
+
+    msec_ty
+    _wait_remaining(clock_ty::time_point now) const
+    {
+        if( _refill.count() == 0 )
+            return msec_ty(0);
+
+        auto tat = (std::max)(_tat, now);
+        auto w = std::chrono::duration_cast<msec_ty>(
+            tat - (_refill * (_burst - 1)) - now
+            );
+        return (std::max)(w, msec_ty(0));
+    }
+
+public:
+    TokenBucket(msec_ty refill = msec_ty(0), unsigned int burst = 1)
+        :
+            _refill(refill),
+            _burst( (std::max)(burst, 1u) ),
+            _tat( clock_ty::now() )
+        {
+        }
+
+    TokenBucket( const TokenBucket& ) = delete;
+
+    TokenBucket&
+    operator=( const TokenBucket& ) = delete;
+
+    /* take a token, return how long the caller needs to wait to use it */
+    msec_ty
+    reserve()
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        auto now = clock_ty::now();
+        auto w = _wait_remaining(now);
+        if( _refill.count() > 0 )
+            _tat = (std::max)(_tat, now) + _refill;
+        return w;
+    }
+
+    /* take a token, block until it can be used */
+    void
+    acquire()
+    {
+        auto w = reserve();
+        if( w.count() > 0 )
+            std::this_thread::sleep_for(w);
+    }
+
+    /* how long until a token is available (w/o taking it) */
+    msec_ty
+    wait_remaining() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _wait_remaining( clock_ty::now() );
+    }
+
+    void
+    set_refill(msec_ty refill)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _refill = refill;
+    }
+
+    msec_ty
+    get_refill() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _refill;
+    }
+
+    void
+    set_burst(unsigned int burst)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _burst = (std::max)(burst, 1u);
+    }
+
+    unsigned int
+    get_burst() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _burst;
+    }
+};
+
+#endif /* RATE_LIMITER_H */
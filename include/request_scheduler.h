@@ -0,0 +1,314 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef REQUEST_SCHEDULER_H
+#define REQUEST_SCHEDULER_H
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <iostream>
+
+#include "rate_limiter.h"
+
+/*
+ * RequestScheduler - admits requests through prioritized 'lanes'
+ *
+ * Lane 0 has the highest priority. Each lane has its own (optional)
+ * concurrency limit and token bucket. A request is admitted when its lane
+ * is under its concurrency limit, no higher priority lane has requests
+ * waiting and - unless it's in lane 0 - no lane 0 request is in flight;
+ * i.e lane 0 preempts everything, other lanes only go ahead of lower lanes
+ * in the queue. (Requests already in flight are never interrupted.)
+ *
+ * Waiting requests are counted as 'queued' from the time they ask for
+ * admission, including any wait for their lane's token bucket, so they
+ * hold back lower lanes for that long too.
+ *
+ * 'acquire' blocks the caller; 'acquire_async' never does - the request is
+ * queued and its callback is given the ticket, from whichever thread frees
+ * the slot (e.g the async loop), once it's admitted.
+ */
+class RequestScheduler{
+public:
+    typedef std::chrono::steady_clock clock_ty;
+    typedef std::chrono::milliseconds msec_ty;
+
+    static const int NLANES = 3;
+
+    struct Stats{
+        size_t queued;
+        size_t in_flight;
+        unsigned long long requests; // admitted
+        msec_ty wait_time; // total, for admitted requests
+        msec_ty max_wait;
+    };
+
+    /* a slot in a lane, given back when destroyed */
+    class Ticket{
+        RequestScheduler *_scheduler;
+        int _lane;
+
+    public:
+        Ticket(RequestScheduler *scheduler, int lane)
+            : _scheduler(scheduler), _lane(lane)
+            {}
+
+        Ticket( Ticket&& t )
+            : _scheduler(t._scheduler), _lane(t._lane)
+            { t._scheduler = nullptr; }
+
+        Ticket( const Ticket& ) = delete;
+
+        Ticket&
+        operator=( const Ticket& ) = delete;
+
+        ~Ticket()
+        { release(); }
+
+        /* give the slot back early (e.g from an async callback) */
+        void
+        release()
+        {
+            if( _scheduler ){
+                _scheduler->_release(_lane);
+                _scheduler = nullptr;
+            }
+        }
+
+        int
+        get_lane() const
+        { return _lane; }
+    };
+
+    /* admitted: the ticket and when the lane's token bucket allows it to
+     * start; called w/o any lock held and shouldn't block or throw */
+    typedef std::function<void(Ticket&&, clock_ty::time_point)> admit_cb_ty;
+
+private:
+    struct Lane{
+        size_t max_concurrent; // 0 is unlimited
+        size_t queued;
+        size_t in_flight;
+        unsigned long long requests;
+        msec_ty wait_time;
+        msec_ty max_wait;
+
+        Lane()
+            :
+                max_concurrent(0),
+                queued(0),
+                in_flight(0),
+                requests(0),
+                wait_time(0),
+                max_wait(0)
+            {
+            }
+    };
+
+    struct Waiter{
+        admit_cb_ty callback;
+        clock_ty::time_point queued_at;
+        clock_ty::time_point ready_at;
+    };
+
+    mutable std::mutex _mtx;
+    std::condition_variable _cond;
+    Lane _lanes[NLANES];
+    std::deque<Waiter> _waiters[NLANES]; // from 'acquire_async'
+    TokenBucket _throttles[NLANES]; // disabled
+
+    /* caller needs to hold _mtx */
+    bool
+    _can_run(int lane) const
+    {
+        const Lane& l = _lanes[lane];
+        if( l.max_concurrent && l.in_flight >= l.max_concurrent )
+            return false;
+        if( lane > 0 && _lanes[0].in_flight > 0 )
+            return false;
+        for( int i = 0; i < lane; ++i ){
+            if( _lanes[i].queued > 0 )
+                return false;
+        }
+        return true;
+    }
+
+    /* caller needs to hold _mtx; queued -> in flight */
+    void
+    _admit(int lane, clock_ty::time_point queued_at)
+    {
+        Lane& l = _lanes[lane];
+        --l.queued;
+        ++l.in_flight;
+        ++l.requests;
+        auto wt = std::chrono::duration_cast<msec_ty>(
+            clock_ty::now() - queued_at
+            );
+        l.wait_time += wt;
+        l.max_wait = (std::max)(l.max_wait, wt);
+    }
+
+    /* admit the async waiters that can run now, then call them back */
+    void
+    _dispatch()
+    {
+        std::vector<std::pair<Waiter, int>> admitted;
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            for( int lane = 0; lane < NLANES; ++lane ){
+                std::deque<Waiter>& q = _waiters[lane];
+                while( !q.empty() && _can_run(lane) ){
+                    _admit(lane, q.front().queued_at);
+                    admitted.emplace_back( std::move(q.front()), lane );
+                    q.pop_front();
+                }
+            }
+        }
+        if( admitted.empty() )
+            return;
+
+        /* admitting may have unblocked (or blocked) the other lanes */
+        _cond.notify_all();
+        for( auto& a : admitted ){
+            try{
+                a.first.callback( Ticket(this, a.second), a.first.ready_at );
+            }catch(std::exception& e){
+                std::cerr<< "exception in request admission callback: "
+                         << e.what() << std::endl;
+            }catch(...){
+                std::cerr<< "unknown exception in request admission callback"
+                         << std::endl;
+            }
+        }
+    }
+
+    void
+    _release(int lane)
+    {
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            --_lanes[lane].in_flight;
+        }
+        _cond.notify_all();
+        _dispatch();
+    }
+
+    static int
+    _check_lane(int lane)
+    { return (std::min)( (std::max)(lane, 0), NLANES - 1 ); }
+
+public:
+    RequestScheduler() {}
+
+    RequestScheduler( const RequestScheduler& ) = delete;
+
+    RequestScheduler&
+    operator=( const RequestScheduler& ) = delete;
+
+    /* block until admitted to 'lane' */
+    Ticket
+    acquire(int lane)
+    {
+        lane = _check_lane(lane);
+        auto tbeg = clock_ty::now();
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            ++_lanes[lane].queued;
+        }
+
+        msec_ty w = _throttles[lane].reserve();
+        if( w.count() > 0 )
+            std::this_thread::sleep_for(w);
+
+        bool notify_lower = false;
+        {
+            std::unique_lock<std::mutex> lock(_mtx);
+            _cond.wait( lock, [this, lane]{ return _can_run(lane); } );
+
+            _admit(lane, tbeg);
+            /* the last queued request in a lane may unblock lower lanes */
+            notify_lower = (_lanes[lane].queued == 0 && lane < NLANES - 1);
+        }
+        if( notify_lower ){
+            _cond.notify_all();
+            _dispatch();
+        }
+
+        return Ticket(this, lane);
+    }
+
+    /* queue for 'lane' and return; 'callback' gets the ticket when admitted
+     * (possibly before this returns) */
+    void
+    acquire_async(int lane, admit_cb_ty callback)
+    {
+        lane = _check_lane(lane);
+        auto tbeg = clock_ty::now();
+        auto ready_at = tbeg + _throttles[lane].reserve();
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            ++_lanes[lane].queued;
+            _waiters[lane].push_back( {std::move(callback), tbeg, ready_at} );
+        }
+        _dispatch();
+    }
+
+    void
+    set_limits(int lane, size_t max_concurrent, msec_ty wait, unsigned int burst)
+    {
+        lane = _check_lane(lane);
+        _throttles[lane].set_refill(wait);
+        _throttles[lane].set_burst(burst);
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            _lanes[lane].max_concurrent = max_concurrent;
+        }
+        _cond.notify_all();
+        _dispatch();
+    }
+
+    size_t
+    get_max_concurrent(int lane) const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _lanes[ _check_lane(lane) ].max_concurrent;
+    }
+
+    msec_ty
+    get_wait(int lane) const
+    { return _throttles[ _check_lane(lane) ].get_refill(); }
+
+    unsigned int
+    get_burst(int lane) const
+    { return _throttles[ _check_lane(lane) ].get_burst(); }
+
+    Stats
+    get_stats(int lane) const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        const Lane& l = _lanes[ _check_lane(lane) ];
+        return Stats{l.queued, l.in_flight, l.requests, l.wait_time, l.max_wait};
+    }
+};
+
+#endif /* REQUEST_SCHEDULER_H */
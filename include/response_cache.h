@@ -0,0 +1,357 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <list>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <cstdio>
+
+/*
+ * ResponseCacheStore - (optional) backing store for ResponseCache
+ *
+ * Entries that aren't in memory are looked for here and every put is
+ * written through. Stores are best-effort: a failed load is a miss and a
+ * failed store is ignored.
+ */
+class ResponseCacheStore{
+public:
+    typedef std::chrono::system_clock clock_ty;
+
+    virtual
+    ~ResponseCacheStore(){}
+
+    /* stable across processes (unlike std::hash) */
+    static unsigned long long
+    fnv1a(const std::string& s)
+    {
+        unsigned long long h = 14695981039346656037ULL;
+        for( unsigned char c : s ){
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    virtual bool
+    load(const std::string& key, std::string& data,
+         clock_ty::time_point& expires) = 0;
+
+    virtual void
+    store(const std::string& key, const std::string& data,
+          clock_ty::time_point expires) = 0;
+
+    virtual void
+    erase(const std::string& key) = 0;
+};
+
+
+/*
+ * DiskCacheStore - one file per entry in an (existing) directory
+ *
+ *   [key]\n[expiration, msec since epoch]\n[data]
+ *
+ * Files are named by a hash of the key; the key is stored to catch
+ * collisions. Writes go to a temp file that's renamed into place so
+ * other processes never see a partial entry.
+ */
+class DiskCacheStore
+        : public ResponseCacheStore {
+    std::string _directory;
+
+    std::string
+    path(const std::string& key) const
+    {
+        std::ostringstream ss;
+        ss << _directory << '/' << "tdma_" << std::hex << fnv1a(key)
+           << ".cache";
+        return ss.str();
+    }
+
+public:
+    DiskCacheStore(const std::string& directory)
+        : _directory(directory)
+    {
+        while( _directory.size() > 1 &&
+               (_directory.back() == '/' || _directory.back() == '\\') )
+        {
+            _directory.pop_back();
+        }
+    }
+
+    std::string
+    get_directory() const
+    { return _directory; }
+
+    bool
+    load(const std::string& key, std::string& data,
+         clock_ty::time_point& expires)
+    {
+        std::ifstream in( path(key), std::ios::binary );
+        if( !in )
+            return false;
+
+        std::string k;
+        long long ms;
+        if( !std::getline(in, k) || k != key || !(in >> ms) || in.get() != '\n' )
+            return false;
+
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        data = ss.str();
+        expires = clock_ty::time_point( std::chrono::milliseconds(ms) );
+        return true;
+    }
+
+    void
+    store(const std::string& key, const std::string& data,
+          clock_ty::time_point expires)
+    {
+        std::string p = path(key);
+        std::string tmp = p + ".tmp";
+        {
+            std::ofstream out( tmp, std::ios::binary | std::ios::trunc );
+            if( !out )
+                return;
+            out << key << '\n'
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       expires.time_since_epoch() ).count()
+                << '\n' << data;
+            if( !out )
+                return;
+        }
+        std::remove( p.c_str() ); // rename won't replace on windows
+        std::rename( tmp.c_str(), p.c_str() );
+    }
+
+    void
+    erase(const std::string& key)
+    { std::remove( path(key).c_str() ); }
+};
+
+
+/*
+ * ResponseCache - thread-safe, in-memory LRU of responses w/ expirations
+ *
+ * An entry is returned until it expires; the least recently used entry is
+ * dropped when there are more than 'max_entries'. An optional store keeps
+ * entries across processes.
+ */
+class ResponseCache{
+public:
+    typedef ResponseCacheStore::clock_ty clock_ty;
+    typedef std::chrono::milliseconds msec_ty;
+
+    static const size_t DEF_MAX_ENTRIES = 256;
+
+private:
+    struct Entry{
+        std::string data;
+        clock_ty::time_point expires;
+        std::list<std::string>::iterator lru_iter;
+    };
+
+    mutable std::mutex _mtx;
+    std::list<std::string> _lru; // most recently used at the front
+    std::unordered_map<std::string, Entry> _entries;
+    size_t _max_entries;
+    bool _enabled;
+    std::shared_ptr<ResponseCacheStore> _store;
+
+    void
+    _insert(const std::string& key, const std::string& data,
+            clock_ty::time_point expires)
+    {
+        auto eiter = _entries.find(key);
+        if( eiter != _entries.end() ){
+            _lru.erase(eiter->second.lru_iter);
+            _entries.erase(eiter);
+        }
+        _lru.push_front(key);
+        _entries[key] = Entry{data, expires, _lru.begin()};
+        _trim();
+    }
+
+    void
+    _trim()
+    {
+        while( _entries.size() > _max_entries ){
+            _entries.erase(_lru.back());
+            _lru.pop_back();
+        }
+    }
+
+public:
+    ResponseCache()
+        :
+            _max_entries(DEF_MAX_ENTRIES),
+            _enabled(true)
+        {
+        }
+
+    ResponseCache( const ResponseCache& ) = delete;
+
+    ResponseCache&
+    operator=( const ResponseCache& ) = delete;
+
+    bool
+    get(const std::string& key, std::string& data)
+    {
+        auto now = clock_ty::now();
+        std::shared_ptr<ResponseCacheStore> store;
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            if( !_enabled )
+                return false;
+
+            auto eiter = _entries.find(key);
+            if( eiter != _entries.end() ){
+                if( eiter->second.expires > now ){
+                    _lru.splice(_lru.begin(), _lru, eiter->second.lru_iter);
+                    data = eiter->second.data;
+                    return true;
+                }
+                _lru.erase(eiter->second.lru_iter);
+                _entries.erase(eiter);
+            }
+            store = _store;
+        }
+
+        /* (outside the lock, it's file I/O) */
+        clock_ty::time_point expires;
+        if( !store || !store->load(key, data, expires) )
+            return false;
+
+        if( expires <= now ){
+            store->erase(key);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> _(_mtx);
+        _insert(key, data, expires);
+        return true;
+    }
+
+    void
+    put(const std::string& key, const std::string& data, msec_ty ttl)
+    {
+        if( ttl.count() <= 0 )
+            return;
+
+        auto expires = clock_ty::now() + ttl;
+        std::shared_ptr<ResponseCacheStore> store;
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            if( !_enabled )
+                return;
+            _insert(key, data, expires);
+            store = _store;
+        }
+        if( store )
+            store->store(key, data, expires);
+    }
+
+    void
+    invalidate(const std::string& key)
+    {
+        std::shared_ptr<ResponseCacheStore> store;
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            auto eiter = _entries.find(key);
+            if( eiter != _entries.end() ){
+                _lru.erase(eiter->second.lru_iter);
+                _entries.erase(eiter);
+            }
+            store = _store;
+        }
+        if( store )
+            store->erase(key);
+    }
+
+    /* in-memory entries only; store entries expire on their own */
+    void
+    clear()
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _entries.clear();
+        _lru.clear();
+    }
+
+    size_t
+    size() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _entries.size();
+    }
+
+    void
+    set_max_entries(size_t n)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _max_entries = n;
+        _trim();
+    }
+
+    size_t
+    get_max_entries() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _max_entries;
+    }
+
+    void
+    set_enabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _enabled = enabled;
+        if( !enabled ){
+            _entries.clear();
+            _lru.clear();
+        }
+    }
+
+    bool
+    is_enabled() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _enabled;
+    }
+
+    /* nullptr for memory only */
+    void
+    set_store(std::shared_ptr<ResponseCacheStore> store)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _store = store;
+    }
+
+    std::shared_ptr<ResponseCacheStore>
+    get_store() const
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _store;
+    }
+};
+
+#endif /* RESPONSE_CACHE_H */
@@ -0,0 +1,118 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef RETRY_POLICY_H
+#define RETRY_POLICY_H
+
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+/*
+ * LatencyTracker - thread-safe window of the most recent latencies
+ *
+ * Used to decide when a request is 'slow' enough to hedge. Percentiles
+ * are only reported once there are 'min_samples' so a few early requests
+ * don't set the threshold.
+ */
+class LatencyTracker{
+public:
+    typedef std::chrono::milliseconds msec_ty;
+
+    static const size_t WINDOW = 128;
+    static const size_t MIN_SAMPLES = 20;
+
+private:
+    mutable std::mutex _mtx;
+    std::vector<msec_ty> _samples;
+    size_t _next;
+
+public:
+    LatencyTracker()
+        : _next(0)
+    { _samples.reserve(WINDOW); }
+
+    LatencyTracker( const LatencyTracker& ) = delete;
+
+    LatencyTracker&
+    operator=( const LatencyTracker& ) = delete;
+
+    void
+    add(msec_ty latency)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        if( _samples.size() < WINDOW )
+            _samples.push_back(latency);
+        else
+            _samples[_next] = latency;
+        _next = (_next + 1) % WINDOW;
+    }
+
+    /* 0 if not enough samples */
+    msec_ty
+    percentile(unsigned int p) const
+    {
+        std::vector<msec_ty> tmp;
+        {
+            std::lock_guard<std::mutex> _(_mtx);
+            if( _samples.size() < MIN_SAMPLES )
+                return msec_ty(0);
+            tmp = _samples;
+        }
+        size_t i = (std::min)( tmp.size() - 1, (tmp.size() * p) / 100 );
+        std::nth_element(tmp.begin(), tmp.begin() + i, tmp.end());
+        return tmp[i];
+    }
+
+    void
+    clear()
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        _samples.clear();
+        _next = 0;
+    }
+};
+
+
+/*
+ * exponential backoff w/ 'full jitter': a random wait between 0 and
+ * min(max, base * 2^(attempt-1)) so clients that failed together don't
+ * retry together
+ */
+inline std::chrono::milliseconds
+backoff_with_jitter( std::chrono::milliseconds base,
+                     std::chrono::milliseconds max,
+                     unsigned int attempt )
+{
+    typedef std::chrono::milliseconds::rep rep_ty;
+    static thread_local std::minstd_rand rng( std::random_device{}() );
+
+    if( base.count() <= 0 || max.count() <= 0 )
+        return std::chrono::milliseconds(0);
+
+    rep_ty cap = base.count();
+    for( unsigned int i = 1; i < attempt && cap < max.count(); ++i )
+        cap *= 2;
+    cap = (std::min)(cap, max.count());
+
+    std::uniform_int_distribution<rep_ty> dist(0, cap);
+    return std::chrono::milliseconds( dist(rng) );
+}
+
+#endif /* RETRY_POLICY_H */
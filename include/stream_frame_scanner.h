@@ -0,0 +1,401 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef STREAM_FRAME_SCANNER_H
+#define STREAM_FRAME_SCANNER_H
+
+#include <cstdint>
+#include <initializer_list>
+
+#include "_tdma_api.h"
+#include "tdma_api_streaming.h"
+#include "json_scanner.h"
+
+namespace tdma {
+
+/* from a raw (unterminated) name, w/o building a string (streaming.cpp) */
+StreamerServiceType
+streamer_service_from_str(const char *service_name, size_t n);
+
+/*
+ * StreamFieldHandler - typed setters for the content of one (or more)
+ * services' 'data' responses, called by StreamFrameScanner as it walks
+ * the frame
+ *
+ * 'field' is the numeric key of the content item, i.e the value of the
+ * service's field enum (QuotesSubscriptionField etc.). Numbers go to
+ * 'set_integer' if the service's schema has the field as integral (sizes,
+ * volumes, times, days) otherwise 'set_number'; strings are raw (escapes
+ * left in place) and only valid for the call. nulls, nested values and
+ * non-numeric keys other than "key" (e.g "seq", "delayed") are skipped.
+ */
+class StreamFieldHandler{
+public:
+    virtual
+    ~StreamFieldHandler(){}
+
+    /* start of a content item; 'key' is its raw "key" (the symbol for the
+     * by-symbol services) or nullptr if it has none; false to skip it */
+    virtual bool
+    begin_item( StreamerServiceType service,
+                unsigned long long timestamp,
+                const char *key,
+                size_t key_len ) = 0;
+
+    virtual void
+    set_number(int field, double v) {}
+
+    virtual void
+    set_integer(int field, long long v) {}
+
+    virtual void
+    set_string(int field, const char *s, size_t n) {}
+
+    virtual void
+    set_boolean(int field, bool v) {}
+
+    virtual void
+    end_item() {}
+};
+
+
+/*
+ * StreamFrameScanner - decodes streamer 'data' frames in place
+ *
+ *   {"data":[{"service":..,"timestamp":..,"command":..,
+ *             "content":[{"key":..,"1":..,"2":..},..]},..]}
+ *
+ * One pass over the frame w/ a JSONScanner: no DOM, no strings, nothing
+ * allocated. The service name is matched against a sorted table, field keys
+ * are converted to ints and each value is handed straight to the handler
+ * registered for the service; responses for services w/o one are skipped
+ * (brackets matched, nothing converted).
+ *
+ * Not thread safe; handlers must outlive the scanner (or be unset).
+ */
+class StreamFrameScanner{
+    static const int NSERVICES =
+        static_cast<int>(StreamerServiceType::UNKNOWN) + 1;
+
+    StreamFieldHandler *_handlers[NSERVICES];
+    uint64_t _integer_fields[NSERVICES]; // bit per field id < 64
+    int _nhandlers;
+
+    template<typename F>
+    static uint64_t
+    field_bits(std::initializer_list<F> fields)
+    {
+        uint64_t bits = 0;
+        for( F f : fields )
+            bits |= (1ULL << static_cast<int>(f));
+        return bits;
+    }
+
+    void
+    set_integer_fields(StreamerServiceType service, uint64_t bits)
+    { _integer_fields[static_cast<int>(service)] = bits; }
+
+    void
+    init_schema()
+    {
+        using S = StreamerServiceType;
+        {
+            using F = QuotesSubscriptionField;
+            set_integer_fields( S::QUOTE, field_bits<F>({
+                F::bid_size, F::ask_size, F::total_volume, F::last_size,
+                F::trade_time, F::quote_time, F::island_volume,
+                F::quote_day, F::trade_day, F::digits, F::island_bid_size,
+                F::island_ask_size, F::regular_market_last_size,
+                F::regular_market_trade_time, F::regular_market_trade_day,
+                F::quote_time_as_long, F::trade_time_as_long,
+                F::regular_market_trade_time_as_long
+            }) );
+        }
+        {
+            using F = OptionsSubscriptionField;
+            set_integer_fields( S::OPTION, field_bits<F>({
+                F::total_volume, F::open_interest, F::quote_time,
+                F::trade_time, F::quote_day, F::trade_day,
+                F::expiration_year, F::digits, F::bid_size, F::ask_size,
+                F::last_size, F::expiration_month, F::expiration_day,
+                F::days_to_expiration
+            }) );
+        }
+        {
+            using F = LevelOneFuturesSubscriptionField;
+            set_integer_fields( S::LEVELONE_FUTURES, field_bits<F>({
+                F::bid_size, F::ask_size, F::total_volume, F::last_size,
+                F::quote_time, F::trade_time, F::open_interest,
+                F::future_expiration_date
+            }) );
+        }
+        {
+            using F = LevelOneFuturesOptionsSubscriptionField;
+            set_integer_fields( S::LEVELONE_FUTURES_OPTIONS, field_bits<F>({
+                F::bid_size, F::ask_size, F::total_volume, F::last_size,
+                F::quote_time, F::trade_time, F::open_interest,
+                F::future_expiration_date
+            }) );
+        }
+        {
+            using F = LevelOneForexSubscriptionField;
+            set_integer_fields( S::LEVELONE_FOREX, field_bits<F>({
+                F::bid_size, F::ask_size, F::total_volume, F::last_size,
+                F::quote_time, F::trade_time, F::digits
+            }) );
+        }
+        {
+            using F = NewsHeadlineSubscriptionField;
+            set_integer_fields( S::NEWS_HEADLINE, field_bits<F>({
+                F::error_code, F::story_datetime, F::count_for_keyword
+            }) );
+        }
+        {
+            using F = ChartEquitySubscriptionField;
+            set_integer_fields( S::CHART_EQUITY, field_bits<F>({
+                F::sequence, F::chart_time, F::chart_day
+            }) );
+        }
+        {
+            using F = ChartSubscriptionField;
+            uint64_t bits = field_bits<F>({F::chart_time});
+            set_integer_fields(S::CHART_FOREX, bits);
+            set_integer_fields(S::CHART_FUTURES, bits);
+            set_integer_fields(S::CHART_OPTIONS, bits);
+        }
+        {
+            using F = TimesaleSubscriptionField;
+            uint64_t bits = field_bits<F>({
+                F::trade_time, F::last_size, F::last_sequence
+            });
+            set_integer_fields(S::TIMESALE_EQUITY, bits);
+            set_integer_fields(S::TIMESALE_FOREX, bits);
+            set_integer_fields(S::TIMESALE_FUTURES, bits);
+            set_integer_fields(S::TIMESALE_OPTIONS, bits);
+        }
+        /* ACTIVES_*, ACCT_ACTIVITY etc. are all strings */
+    }
+
+    static bool
+    is_key(const char *k, size_t kn, const char *lit, size_t n)
+    { return kn == n && !memcmp(k, lit, n); }
+
+    /* -1 if not a field id */
+    static int
+    field_id(const char *k, size_t kn)
+    {
+        if( kn == 0 || kn > 4 )
+            return -1;
+        int id = 0;
+        for( size_t i = 0; i < kn; ++i ){
+            if( k[i] < '0' || k[i] > '9' )
+                return -1;
+            id = id * 10 + (k[i] - '0');
+        }
+        return id;
+    }
+
+    void
+    scan_item( JSONScanner& s,
+               StreamFieldHandler *h,
+               StreamerServiceType service,
+               unsigned long long timestamp,
+               uint64_t integer_fields ) const
+    {
+        const char *k;
+        size_t kn;
+
+        /* "key" usually leads but not always (e.g after "seq"); look ahead
+         * for it on a copy so every field arrives after 'begin_item' */
+        const char *key = nullptr;
+        size_t key_len = 0;
+        JSONScanner look = s;
+        look.begin_object();
+        for( bool first = true; look.next_member(first, k, kn); ){
+            if( is_key(k, kn, "key", 3) ){
+                if( look.peek() == '"' )
+                    look.string(key, key_len);
+                break;
+            }
+            look.skip_value();
+        }
+
+        if( !h->begin_item(service, timestamp, key, key_len) ){
+            s.skip_value();
+            return;
+        }
+
+        s.begin_object();
+        for( bool first = true; s.next_member(first, k, kn); ){
+            int field = field_id(k, kn);
+            if( field < 0 ){
+                s.skip_value();
+                continue;
+            }
+            switch( s.peek() ){
+            case '"':{
+                const char *v;
+                size_t vn;
+                s.string(v, vn);
+                h->set_string(field, v, vn);
+                break;
+            }
+            case 't':
+            case 'f':
+                h->set_boolean(field, s.boolean());
+                break;
+            case 'n':
+                s.null();
+                break;
+            case '{':
+            case '[':
+                s.skip_value();
+                break;
+            default:
+                if( field < 64 && ((integer_fields >> field) & 1) ){
+                    long long v;
+                    s.number(v);
+                    h->set_integer(field, v);
+                }else{
+                    double v;
+                    s.number(v);
+                    h->set_number(field, v);
+                }
+            }
+        }
+        h->end_item();
+    }
+
+    void
+    scan_response(JSONScanner& s) const
+    {
+        const char *k;
+        size_t kn;
+
+        /* service/timestamp lead; find them first in case they don't */
+        StreamerServiceType service = StreamerServiceType::UNKNOWN;
+        long long timestamp = 0;
+        int nfound = 0;
+        JSONScanner look = s;
+        look.begin_object();
+        for( bool first = true;
+             nfound < 2 && look.next_member(first, k, kn); )
+        {
+            if( is_key(k, kn, "service", 7) ){
+                const char *v;
+                size_t vn;
+                look.string(v, vn);
+                service = streamer_service_from_str(v, vn);
+                ++nfound;
+            }else if( is_key(k, kn, "timestamp", 9) ){
+                look.number(timestamp);
+                ++nfound;
+            }else{
+                look.skip_value();
+            }
+        }
+
+        StreamFieldHandler *h = _handlers[static_cast<int>(service)];
+        if( !h ){
+            s.skip_value();
+            return;
+        }
+
+        uint64_t integer_fields = _integer_fields[static_cast<int>(service)];
+        s.begin_object();
+        for( bool first = true; s.next_member(first, k, kn); ){
+            if( !is_key(k, kn, "content", 7) ){
+                s.skip_value();
+                continue;
+            }
+            s.begin_array();
+            for( bool first_item = true; s.next_element(first_item); ){
+                scan_item( s, h, service,
+                           static_cast<unsigned long long>(timestamp),
+                           integer_fields );
+            }
+        }
+    }
+
+public:
+    StreamFrameScanner()
+        : _nhandlers(0)
+    {
+        for( int i = 0; i < NSERVICES; ++i ){
+            _handlers[i] = nullptr;
+            _integer_fields[i] = 0;
+        }
+        init_schema();
+    }
+
+    /* nullptr to unset; UNKNOWN/NONE are never dispatched */
+    void
+    set_handler(StreamerServiceType service, StreamFieldHandler *handler)
+    {
+        int i = static_cast<int>(service);
+        if( i <= static_cast<int>(StreamerServiceType::NONE)
+            || i >= static_cast<int>(StreamerServiceType::UNKNOWN) )
+        {
+            TDMA_API_THROW(ValueException, "invalid service for handler");
+        }
+        _nhandlers += (handler != nullptr) - (_handlers[i] != nullptr);
+        _handlers[i] = handler;
+    }
+
+    StreamFieldHandler*
+    get_handler(StreamerServiceType service) const
+    {
+        int i = static_cast<int>(service);
+        return (i >= 0 && i < NSERVICES) ? _handlers[i] : nullptr;
+    }
+
+    bool
+    has_handlers() const
+    { return _nhandlers > 0; }
+
+    /* is 'field' of 'service' decoded as an integer */
+    bool
+    is_integer_field(StreamerServiceType service, int field) const
+    {
+        int i = static_cast<int>(service);
+        return i >= 0 && i < NSERVICES && field >= 0 && field < 64
+            && ((_integer_fields[i] >> field) & 1);
+    }
+
+    /* false if 'frame' isn't a 'data' frame (nothing is dispatched);
+     * THROWS JSONScanError if it's malformed */
+    bool
+    scan(const char *frame, size_t n) const
+    {
+        JSONScanner s(frame, frame + n);
+        const char *k;
+        size_t kn;
+        s.begin_object();
+        bool first = true;
+        if( !s.next_member(first, k, kn) || !is_key(k, kn, "data", 4) )
+            return false;
+
+        s.begin_array();
+        for( bool first_resp = true; s.next_element(first_resp); )
+            scan_response(s);
+        return true;
+    }
+};
+
+} /* tdma */
+
+#endif /* STREAM_FRAME_SCANNER_H */
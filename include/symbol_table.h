@@ -0,0 +1,90 @@
+/*
+Copyright (C) 2018 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <mutex>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+/*
+ * SymbolTable - process-wide interned symbol strings
+ *
+ * Each distinct symbol is stored once and never freed so the returned
+ * 'const char*' can be handed across the ABI (e.g in QuoteRecord) and stays
+ * valid for the life of the library. Ids are dense, starting at 1 (0 is
+ * 'no symbol'). Only a lookup once a symbol has been seen; no allocation.
+ */
+class SymbolTable{
+    std::mutex _mtx;
+    std::deque<std::string> _symbols; // stable addresses, index is id - 1
+    std::unordered_map<std::string, unsigned int> _ids;
+
+    SymbolTable() {}
+
+public:
+    static SymbolTable&
+    instance()
+    {
+        static SymbolTable table;
+        return table;
+    }
+
+    std::pair<const char*, unsigned int>
+    intern(const std::string& symbol)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        auto iter = _ids.find(symbol);
+        if( iter != _ids.end() )
+            return {_symbols[iter->second - 1].c_str(), iter->second};
+
+        _symbols.push_back(symbol);
+        unsigned int id = static_cast<unsigned int>(_symbols.size());
+        _ids.emplace(symbol, id);
+        return {_symbols.back().c_str(), id};
+    }
+
+    /* 0 if 'symbol' hasn't been interned (doesn't intern it) */
+    unsigned int
+    find(const std::string& symbol)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        auto iter = _ids.find(symbol);
+        return (iter != _ids.end()) ? iter->second : 0;
+    }
+
+    /* nullptr if 'id' hasn't been assigned */
+    const char*
+    symbol(unsigned int id)
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return (id && id <= _symbols.size()) ? _symbols[id - 1].c_str()
+                                             : nullptr;
+    }
+
+    size_t
+    size()
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _symbols.size();
+    }
+};
+
+#endif /* SYMBOL_TABLE_H */
@@ -25,6 +25,12 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <set>
 #include <unordered_map>
 #include <iostream>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
 
 #endif /* __cplusplus */
 
@@ -169,6 +175,51 @@ DECL_C_CPP_TDMA_ENUM(OrderStatusType, 0, 15,
     BUILD_C_CPP_TDMA_ENUM_NAME(OrderStatusType, ALL)
 );
 
+DECL_C_CPP_TDMA_ENUM(EndpointClass, 0, 2,
+    BUILD_C_CPP_TDMA_ENUM_NAME(EndpointClass, marketdata),
+    BUILD_C_CPP_TDMA_ENUM_NAME(EndpointClass, accounts),
+    BUILD_C_CPP_TDMA_ENUM_NAME(EndpointClass, instruments)
+);
+
+DECL_C_CPP_TDMA_ENUM(QuoteAssetType, 0, 8,
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, NONE), // not in the quote
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, EQUITY),
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, ETF),
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, OPTION),
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, INDEX),
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, MUTUAL_FUND),
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, FUTURE),
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, FUTURE_OPTION),
+    BUILD_C_CPP_TDMA_ENUM_NAME(QuoteAssetType, FOREX)
+);
+
+/* columns of an OptionChainTable, all doubles (see README_GET.md) */
+DECL_C_CPP_TDMA_ENUM(OptionChainColumn, 0, 22,
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, strike),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, expiration), // msec since epoch
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, days_to_exp),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, put_call), // 0 call, 1 put
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, bid),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, ask),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, last),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, mark),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, bid_size),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, ask_size),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, total_volume),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, open_interest),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, volatility),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, delta),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, gamma),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, theta),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, vega),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, rho),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, theoretical_value),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, time_value),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, multiplier),
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, in_the_money), // 0 or 1
+    BUILD_C_CPP_TDMA_ENUM_NAME(OptionChainColumn, quote_time) // msec since epoch
+);
+
 typedef union {
     unsigned int n_atm;
     double single;
@@ -178,6 +229,64 @@ typedef union {
     OptionRangeType range;
 } OptionStrikesValue;
 
+#define TDMA_API_RETRY_MAX_CODES 8
+
+/* how gets of an EndpointClass are retried/hedged(see README_GET.md) */
+typedef struct{
+    unsigned int max_attempts; /* 1 disables retries */
+    unsigned long long backoff_msec; /* base of the exponential backoff */
+    unsigned long long max_backoff_msec;
+    int status_codes[TDMA_API_RETRY_MAX_CODES]; /* retryable, 0 ends */
+    int curl_codes[TDMA_API_RETRY_MAX_CODES]; /* retryable, 0 ends */
+    unsigned int hedge_percentile; /* 0 disables hedging, or 50 - 99 */
+} RetryPolicy;
+
+/*
+ * a quote decoded directly from the response(no json), fields not in the
+ * quote are 0 (see README_GET.md for which asset types have which fields)
+ */
+typedef struct{
+    const char *symbol; /* interned, valid for the life of the library */
+    unsigned int symbol_id; /* same id for the same symbol, starts at 1 */
+    int asset_type; /* QuoteAssetType */
+    double bid_price;
+    double ask_price;
+    double last_price;
+    double open_price;
+    double high_price;
+    double low_price;
+    double close_price;
+    double net_change;
+    double mark;
+    double volatility;
+    double high_52wk; /* EQUITY, ETF, INDEX, MUTUAL_FUND */
+    double low_52wk;
+    double pe_ratio; /* EQUITY, ETF */
+    double div_yield;
+    double strike_price; /* OPTION */
+    double underlying_price;
+    double delta;
+    double gamma;
+    double theta;
+    double vega;
+    double rho;
+    double multiplier; /* OPTION, FUTURE */
+    long long bid_size;
+    long long ask_size;
+    long long last_size;
+    long long total_volume;
+    long long open_interest; /* OPTION, FUTURE */
+    long long quote_time; /* msec since epoch */
+    long long trade_time;
+} QuoteRecord;
+
+/* OptionChainTable rows w/ min <= 'column' <= max; NaNs never match */
+typedef struct{
+    int column; /* OptionChainColumn */
+    double min;
+    double max;
+} OptionChainFilter;
+
 #define THROW_VALUE_EXCEPTION(m) throw ValueException(m, __LINE__, __FILE__)
 
 #ifdef __cplusplus
@@ -302,6 +411,12 @@ DECL_CGETTER_STRUCT(InstrumentInfoGetter_C);
 DECL_CGETTER_STRUCT(OrderGetter_C);
 DECL_CGETTER_STRUCT(OrdersGetter_C);
 
+/* not a getter: decoded option chain, see OptionChainGetter_GetTable */
+DECL_CGETTER_STRUCT(OptionChainTable_C);
+
+/* not a getter: decoded price history, see HistoricalGetterBase_GetCandles */
+DECL_CGETTER_STRUCT(CandleTable_C);
+
 #undef DECL_CGETTER_STRUCT
 
 
@@ -311,12 +426,59 @@ APIGetter_Get_ABI( Getter_C *pgetter,
                    size_t *n,
                    int allow_exceptions );
 
+/*
+ * called from the async loop thread when the request is complete:
+ *   (error code, data or error message, size of buffer w/ null, ctx)
+ *
+ * buffer is owned by the library and only valid during the call
+ */
+typedef void(*getter_async_cb_ty)(int, const char*, size_t, void*);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetAsync_ABI( Getter_C *pgetter,
+                        getter_async_cb_ty callback,
+                        void *ctx,
+                        int allow_exceptions );
+
+/*
+ * called (in the calling thread) with each chunk of the response body as
+ * it arrives: (chunk, size of chunk - NOT null terminated, ctx)
+ *
+ * return non-zero to continue, 0 to stop the transfer (Get returns an error)
+ */
+typedef int(*getter_chunk_cb_ty)(const char*, size_t, void*);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetStream_ABI( Getter_C *pgetter,
+                         getter_chunk_cb_ty callback,
+                         void *ctx,
+                         int allow_exceptions );
+
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_Close_ABI(Getter_C *pgetter, int allow_exceptions);
 
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_IsClosed_ABI(Getter_C *pgetter, int*b, int allow_exceptions);
 
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetCoalesce_ABI(Getter_C *pgetter, int coalesce, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_IsCoalescing_ABI(Getter_C *pgetter, int *b, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetCacheTTL_ABI( Getter_C *pgetter,
+                           unsigned long long msec,
+                           int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetCacheTTL_ABI( Getter_C *pgetter,
+                           unsigned long long *msec,
+                           int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_InvalidateCache_ABI(Getter_C *pgetter, int allow_exceptions);
+
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_SetTimeout_ABI(Getter_C *pgetter, unsigned long long msec, int allow_exceptions);
 
@@ -335,12 +497,90 @@ APIGetter_GetDefWaitMSec_ABI(unsigned long long *msec, int allow_exceptions);
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_WaitRemaining_ABI(unsigned long long *msec, int allow_exceptions);
 
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetBurst_ABI(unsigned int burst, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetBurst_ABI(unsigned int *burst, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetEndpointWaitMSec_ABI( int endpoint_class,
+                                   unsigned long long msec,
+                                   unsigned int burst,
+                                   int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetEndpointWaitMSec_ABI( int endpoint_class,
+                                   unsigned long long *msec,
+                                   unsigned int *burst,
+                                   int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_EndpointWaitRemaining_ABI( int endpoint_class,
+                                     unsigned long long *msec,
+                                     int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetRetryPolicy_ABI( int endpoint_class,
+                              const RetryPolicy *policy,
+                              int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetRetryPolicy_ABI( int endpoint_class,
+                              RetryPolicy *policy,
+                              int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetDefRetryPolicy_ABI(RetryPolicy *policy, int allow_exceptions);
+
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_ShareConnections_ABI(int b, int allow_exceptions);
 
 EXTERN_C_SPEC_ DLL_SPEC_ int
 APIGetter_IsSharingConnections_ABI(int *b, int allow_exceptions);
 
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetMaxConnections_ABI(unsigned int n, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetMaxConnections_ABI(unsigned int *n, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetConnectionMaxIdleMSec_ABI( unsigned long long msec,
+                                        int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetConnectionMaxIdleMSec_ABI( unsigned long long *msec,
+                                        int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetConnectionPoolStats_ABI( unsigned int *in_use,
+                                      unsigned int *idle,
+                                      unsigned long long *waits,
+                                      unsigned long long *wait_msec,
+                                      int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetCacheEnabled_ABI(int enabled, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_IsCacheEnabled_ABI(int *b, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetCacheMaxEntries_ABI(unsigned int n, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetCacheMaxEntries_ABI(unsigned int *n, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_SetCacheDirectory_ABI(const char *directory, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_GetCacheDirectory_ABI(char **buf, size_t *n, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+APIGetter_ClearCache_ABI(int allow_exceptions);
+
 /* QuoteGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 QuoteGetter_Create_ABI( struct Credentials *pcreds,
@@ -362,6 +602,19 @@ QuoteGetter_SetSymbol_ABI( QuoteGetter_C *pgetter,
                            const char *symbol,
                            int allow_exceptions );
 
+EXTERN_C_SPEC_ DLL_SPEC_ int
+QuoteGetter_SetBatchWindowMSec_ABI( unsigned long long msec,
+                                    int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+QuoteGetter_GetBatchWindowMSec_ABI( unsigned long long *msec,
+                                    int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+QuoteGetter_GetRecord_ABI( QuoteGetter_C *pgetter,
+                           QuoteRecord *record,
+                           int allow_exceptions );
+
 /* QuotesGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 QuotesGetter_Create_ABI( struct Credentials *pcreds,
@@ -407,6 +660,21 @@ QuotesGetter_RemoveSymbols_ABI( QuotesGetter_C *pgetter,
                                 size_t nymbols,
                                 int allow_exceptions );
 
+/* 'n' is the size of 'records' in, the # of records written out */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+QuotesGetter_GetRecords_ABI( QuotesGetter_C *pgetter,
+                             QuoteRecord *records,
+                             size_t *n,
+                             int allow_exceptions );
+
+/* decode the raw json of a quote(s) get, e.g from get_async */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+DecodeQuoteRecords_ABI( const char *data,
+                        size_t data_len,
+                        QuoteRecord *records,
+                        size_t *n,
+                        int allow_exceptions );
+
 /* MarketHoursGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 MarketHoursGetter_Create_ABI( struct Credentials *pcreds,
@@ -521,6 +789,11 @@ HistoricalGetterBase_SetFrequency_ABI( Getter_C *pgetter,
                                        unsigned int frequency,
                                        int allow_exceptions );
 
+EXTERN_C_SPEC_ DLL_SPEC_ int
+HistoricalGetterBase_GetCandles_ABI( Getter_C *pgetter,
+                                     CandleTable_C *ptable,
+                                     int allow_exceptions );
+
 /* HistoricalPeriodGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 HistoricalPeriodGetter_Create_ABI(
@@ -607,6 +880,56 @@ HistoricalRangeGetter_SetStartMSecSinceEpoch_ABI(
     unsigned long long start_msec,
     int allow_exceptions );
 
+/* the range in 'chunk_msec' requests (0 for the default) sent concurrently,
+   merged and de-duplicated by datetime */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+HistoricalRangeGetter_Backfill_ABI( HistoricalRangeGetter_C *pgetter,
+                                    unsigned long long chunk_msec,
+                                    CandleTable_C *ptable,
+                                    int allow_exceptions );
+
+/*
+ * CandleTable
+ *
+ * rows are ordered by datetime(msec since epoch), one row per datetime;
+ * pointers returned point into the table and are valid until it's destroyed
+ */
+
+/* decode the raw json of a historical get, e.g from get_async */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+CandleTable_Create_ABI( const char *data,
+                        size_t data_len,
+                        CandleTable_C *ptable,
+                        int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+CandleTable_Destroy_ABI( CandleTable_C *ptable, int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+CandleTable_GetSize_ABI( CandleTable_C *ptable,
+                         size_t *n,
+                         int allow_exceptions );
+
+/* any of the column args can be NULL */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+CandleTable_GetColumns_ABI( CandleTable_C *ptable,
+                            const double **open,
+                            const double **high,
+                            const double **low,
+                            const double **close,
+                            const long long **volume,
+                            const long long **datetime,
+                            int allow_exceptions );
+
+/* rows [begin, end) w/ start <= datetime <= end_msec */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+CandleTable_Find_ABI( CandleTable_C *ptable,
+                      long long start_msec,
+                      long long end_msec,
+                      size_t *begin,
+                      size_t *end,
+                      int allow_exceptions );
+
 
 /* OptionChainGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
@@ -712,6 +1035,12 @@ OptionChainGetter_SetOptionType_ABI( OptionChainGetter_C *pgetter,
                                      int option_type,
                                      int allow_exceptions );
 
+/* get() decoded directly into a new OptionChainTable, w/o the json */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainGetter_GetTable_ABI( OptionChainGetter_C *pgetter,
+                                OptionChainTable_C *ptable,
+                                int allow_exceptions );
+
 /* OptionChainStrategyGetter */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 OptionChainStrategyGetter_Create_ABI( struct Credentials *pcreds,
@@ -832,6 +1161,74 @@ OptionChainAnalyticalGetter_SetDaysToExp_ABI(
     int allow_exceptions
     );
 
+/*
+ * OptionChainTable
+ *
+ * rows are ordered by expiration, strike, then call before put; pointers
+ * returned point into the table and are valid until it's destroyed
+ */
+
+/* decode the raw json of an option chain get, e.g from get_async */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_Create_ABI( const char *data,
+                             size_t data_len,
+                             OptionChainTable_C *ptable,
+                             int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_Destroy_ABI( OptionChainTable_C *ptable,
+                              int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_GetSize_ABI( OptionChainTable_C *ptable,
+                              size_t *n,
+                              int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_GetColumn_ABI( OptionChainTable_C *ptable,
+                                int column,
+                                const double **data,
+                                int allow_exceptions );
+
+/* interned, valid for the life of the library */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_GetSymbols_ABI( OptionChainTable_C *ptable,
+                                 const char * const **symbols,
+                                 int allow_exceptions );
+
+/* rows ordered by strike, expiration, then call before put */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_GetStrikeIndex_ABI( OptionChainTable_C *ptable,
+                                     const size_t **index,
+                                     int allow_exceptions );
+
+/* rows [begin, end) w/ min <= expiration <= max */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_FindExpirations_ABI( OptionChainTable_C *ptable,
+                                      double min,
+                                      double max,
+                                      size_t *begin,
+                                      size_t *end,
+                                      int allow_exceptions );
+
+/* strike index [begin, end) w/ min <= strike <= max */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_FindStrikes_ABI( OptionChainTable_C *ptable,
+                                  double min,
+                                  double max,
+                                  size_t *begin,
+                                  size_t *end,
+                                  int allow_exceptions );
+
+/* rows matching all filters; 'n' is the size of 'rows' in, the # of rows out */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+OptionChainTable_Filter_ABI( OptionChainTable_C *ptable,
+                             const OptionChainFilter *filters,
+                             size_t nfilters,
+                             size_t *rows,
+                             size_t *n,
+                             int allow_exceptions );
+
 /* AccountGetterBase */
 EXTERN_C_SPEC_ DLL_SPEC_ int
 AccountGetterBase_GetAccountId_ABI( Getter_C *pgetter,
@@ -1202,6 +1599,14 @@ static inline int
 APIGetter_Get(Getter_C *pgetter, char** buf, size_t *n)
 { return APIGetter_Get_ABI(pgetter, buf, n, 0); }
 
+static inline int
+APIGetter_GetAsync(Getter_C *pgetter, getter_async_cb_ty callback, void *ctx)
+{ return APIGetter_GetAsync_ABI(pgetter, callback, ctx, 0); }
+
+static inline int
+APIGetter_GetStream(Getter_C *pgetter, getter_chunk_cb_ty callback, void *ctx)
+{ return APIGetter_GetStream_ABI(pgetter, callback, ctx, 0); }
+
 static inline int
 APIGetter_Close(Getter_C *pgetter)
 { return APIGetter_Close_ABI(pgetter, 0); }
@@ -1210,6 +1615,26 @@ static inline int
 APIGetter_IsClosed(Getter_C *pgetter, int *b)
 { return APIGetter_IsClosed_ABI(pgetter,b, 0); }
 
+static inline int
+APIGetter_SetCoalesce(Getter_C *pgetter, int coalesce)
+{ return APIGetter_SetCoalesce_ABI(pgetter, coalesce, 0); }
+
+static inline int
+APIGetter_IsCoalescing(Getter_C *pgetter, int *b)
+{ return APIGetter_IsCoalescing_ABI(pgetter, b, 0); }
+
+static inline int
+APIGetter_SetCacheTTL(Getter_C *pgetter, unsigned long long msec)
+{ return APIGetter_SetCacheTTL_ABI(pgetter, msec, 0); }
+
+static inline int
+APIGetter_GetCacheTTL(Getter_C *pgetter, unsigned long long *msec)
+{ return APIGetter_GetCacheTTL_ABI(pgetter, msec, 0); }
+
+static inline int
+APIGetter_InvalidateCache(Getter_C *pgetter)
+{ return APIGetter_InvalidateCache_ABI(pgetter, 0); }
+
 static inline int
 APIGetter_SetTimeout(Getter_C *pgetter, unsigned long long msec)
 { return APIGetter_SetTimeout_ABI(pgetter, msec, 0): }
@@ -1234,6 +1659,44 @@ static inline int
 APIGetter_WaitRemaining(unsigned long long *msec)
 { return APIGetter_WaitRemaining_ABI(msec, 0); }
 
+static inline int
+APIGetter_SetBurst(unsigned int burst)
+{ return APIGetter_SetBurst_ABI(burst, 0); }
+
+static inline int
+APIGetter_GetBurst(unsigned int *burst)
+{ return APIGetter_GetBurst_ABI(burst, 0); }
+
+static inline int
+APIGetter_SetEndpointWaitMSec( EndpointClass endpoint_class,
+                               unsigned long long msec,
+                               unsigned int burst )
+{ return APIGetter_SetEndpointWaitMSec_ABI(endpoint_class, msec, burst, 0); }
+
+static inline int
+APIGetter_GetEndpointWaitMSec( EndpointClass endpoint_class,
+                               unsigned long long *msec,
+                               unsigned int *burst )
+{ return APIGetter_GetEndpointWaitMSec_ABI(endpoint_class, msec, burst, 0); }
+
+static inline int
+APIGetter_EndpointWaitRemaining( EndpointClass endpoint_class,
+                                 unsigned long long *msec )
+{ return APIGetter_EndpointWaitRemaining_ABI(endpoint_class, msec, 0); }
+
+static inline int
+APIGetter_SetRetryPolicy( EndpointClass endpoint_class,
+                          const RetryPolicy *policy )
+{ return APIGetter_SetRetryPolicy_ABI(endpoint_class, policy, 0); }
+
+static inline int
+APIGetter_GetRetryPolicy( EndpointClass endpoint_class, RetryPolicy *policy )
+{ return APIGetter_GetRetryPolicy_ABI(endpoint_class, policy, 0); }
+
+static inline int
+APIGetter_GetDefRetryPolicy(RetryPolicy *policy)
+{ return APIGetter_GetDefRetryPolicy_ABI(policy, 0); }
+
 static inline int
 APIGetter_ShareConnections(int share)
 { return APIGetter_ShareConnections_ABI(share, 0); }
@@ -1242,19 +1705,103 @@ static inline int
 APIGetter_IsSharingConnections(int *share)
 { return APIGetter_IsSharingConnections(share, 0); }
 
-/* declare derived versions of Get, Close, IsClosed for each getter*/
+static inline int
+APIGetter_SetMaxConnections(unsigned int n)
+{ return APIGetter_SetMaxConnections_ABI(n, 0); }
+
+static inline int
+APIGetter_GetMaxConnections(unsigned int *n)
+{ return APIGetter_GetMaxConnections_ABI(n, 0); }
+
+static inline int
+APIGetter_SetConnectionMaxIdleMSec(unsigned long long msec)
+{ return APIGetter_SetConnectionMaxIdleMSec_ABI(msec, 0); }
+
+static inline int
+APIGetter_GetConnectionMaxIdleMSec(unsigned long long *msec)
+{ return APIGetter_GetConnectionMaxIdleMSec_ABI(msec, 0); }
+
+static inline int
+APIGetter_GetConnectionPoolStats( unsigned int *in_use,
+                                  unsigned int *idle,
+                                  unsigned long long *waits,
+                                  unsigned long long *wait_msec )
+{
+    return APIGetter_GetConnectionPoolStats_ABI(in_use, idle, waits,
+                                                wait_msec, 0);
+}
+
+static inline int
+APIGetter_SetCacheEnabled(int enabled)
+{ return APIGetter_SetCacheEnabled_ABI(enabled, 0); }
+
+static inline int
+APIGetter_IsCacheEnabled(int *b)
+{ return APIGetter_IsCacheEnabled_ABI(b, 0); }
+
+static inline int
+APIGetter_SetCacheMaxEntries(unsigned int n)
+{ return APIGetter_SetCacheMaxEntries_ABI(n, 0); }
+
+static inline int
+APIGetter_GetCacheMaxEntries(unsigned int *n)
+{ return APIGetter_GetCacheMaxEntries_ABI(n, 0); }
+
+static inline int
+APIGetter_SetCacheDirectory(const char *directory)
+{ return APIGetter_SetCacheDirectory_ABI(directory, 0); }
+
+static inline int
+APIGetter_GetCacheDirectory(char **buf, size_t *n)
+{ return APIGetter_GetCacheDirectory_ABI(buf, n, 0); }
+
+static inline int
+APIGetter_ClearCache(void)
+{ return APIGetter_ClearCache_ABI(0); }
+
+/* declare derived versions of Get, GetAsync, GetStream, Close, IsClosed,
+   SetCoalesce, IsCoalescing, SetCacheTTL, GetCacheTTL, InvalidateCache
+   for each getter */
 #define DECL_WRAPPED_API_GETTER_BASE_FUNCS(name) \
 static inline int \
 name##_Get(name##_C *pgetter, char** buf, size_t *n) \
 { return APIGetter_Get_ABI( (Getter_C*)pgetter, buf, n, 0); } \
 \
 static inline int \
+name##_GetAsync(name##_C *pgetter, getter_async_cb_ty callback, void *ctx) \
+{ return APIGetter_GetAsync_ABI( (Getter_C*)pgetter, callback, ctx, 0); } \
+\
+static inline int \
+name##_GetStream(name##_C *pgetter, getter_chunk_cb_ty callback, void *ctx) \
+{ return APIGetter_GetStream_ABI( (Getter_C*)pgetter, callback, ctx, 0); } \
+\
+static inline int \
 name##_Close(name##_C *pgetter) \
 { return APIGetter_Close_ABI( (Getter_C*)pgetter, 0); } \
 \
 static inline int \
 name##_IsClosed(name##_C *pgetter, int *b) \
-{ return APIGetter_IsClosed_ABI( (Getter_C*)pgetter, b, 0); }
+{ return APIGetter_IsClosed_ABI( (Getter_C*)pgetter, b, 0); } \
+\
+static inline int \
+name##_SetCoalesce(name##_C *pgetter, int coalesce) \
+{ return APIGetter_SetCoalesce_ABI( (Getter_C*)pgetter, coalesce, 0); } \
+\
+static inline int \
+name##_IsCoalescing(name##_C *pgetter, int *b) \
+{ return APIGetter_IsCoalescing_ABI( (Getter_C*)pgetter, b, 0); } \
+\
+static inline int \
+name##_SetCacheTTL(name##_C *pgetter, unsigned long long msec) \
+{ return APIGetter_SetCacheTTL_ABI( (Getter_C*)pgetter, msec, 0); } \
+\
+static inline int \
+name##_GetCacheTTL(name##_C *pgetter, unsigned long long *msec) \
+{ return APIGetter_GetCacheTTL_ABI( (Getter_C*)pgetter, msec, 0); } \
+\
+static inline int \
+name##_InvalidateCache(name##_C *pgetter) \
+{ return APIGetter_InvalidateCache_ABI( (Getter_C*)pgetter, 0); }
 
 
 /* C convenience function BODY */
@@ -1288,6 +1835,18 @@ static inline int
 QuoteGetter_SetSymbol(QuoteGetter_C *pgetter, const char *symbol)
 { return QuoteGetter_SetSymbol_ABI(pgetter, symbol, 0); }
 
+static inline int
+QuoteGetter_SetBatchWindowMSec(unsigned long long msec)
+{ return QuoteGetter_SetBatchWindowMSec_ABI(msec, 0); }
+
+static inline int
+QuoteGetter_GetBatchWindowMSec(unsigned long long *msec)
+{ return QuoteGetter_GetBatchWindowMSec_ABI(msec, 0); }
+
+static inline int
+QuoteGetter_GetRecord(QuoteGetter_C *pgetter, QuoteRecord *record)
+{ return QuoteGetter_GetRecord_ABI(pgetter, record, 0); }
+
 static inline int
 GetQuote(struct Credentials *pcreds, const char* symbol, char **buf, size_t *n)
 { CONVENIENCE_GET_FUNC_BODY(Quote, symbol); }
@@ -1337,6 +1896,19 @@ QuotesGetter_RemoveSymbols( QuotesGetter_C *pgetter,
                             size_t nsymbols )
 { return QuotesGetter_RemoveSymbols_ABI(pgetter, symbols, nsymbols, 0); }
 
+static inline int
+QuotesGetter_GetRecords( QuotesGetter_C *pgetter,
+                         QuoteRecord *records,
+                         size_t *n )
+{ return QuotesGetter_GetRecords_ABI(pgetter, records, n, 0); }
+
+static inline int
+DecodeQuoteRecords( const char *data,
+                    size_t data_len,
+                    QuoteRecord *records,
+                    size_t *n )
+{ return DecodeQuoteRecords_ABI(data, data_len, records, n, 0); }
+
 static inline int
 GetQuotes( struct Credentials *pcreds,
            const char** symbols,
@@ -1538,6 +2110,11 @@ HistoricalPeriodGetter_GetMSecSinceEpoch( HistoricalPeriodGetter_C *pgetter,
 { return HistoricalPeriodGetter_GetMSecSinceEpoch_ABI( pgetter,
                                                        msec_since_epoch, 0 ); }
 
+static inline int
+HistoricalPeriodGetter_GetCandles( HistoricalPeriodGetter_C *pgetter,
+                                   CandleTable_C *ptable )
+{ return HistoricalGetterBase_GetCandles_ABI( (Getter_C*)pgetter, ptable, 0); }
+
 static inline int
 GetHistoricalPeriod( struct Credentials *pcreds,
                      const char* symbol,
@@ -1644,6 +2221,17 @@ HistoricalRangeGetter_SetFrequency( HistoricalRangeGetter_C *pgetter,
                                                 (int)frequency_type,
                                                 frequency, 0); }
 
+static inline int
+HistoricalRangeGetter_GetCandles( HistoricalRangeGetter_C *pgetter,
+                                  CandleTable_C *ptable )
+{ return HistoricalGetterBase_GetCandles_ABI( (Getter_C*)pgetter, ptable, 0); }
+
+static inline int
+HistoricalRangeGetter_Backfill( HistoricalRangeGetter_C *pgetter,
+                                unsigned long long chunk_msec,
+                                CandleTable_C *ptable )
+{ return HistoricalRangeGetter_Backfill_ABI(pgetter, chunk_msec, ptable, 0); }
+
 static inline int
 GetHistoricalRange( struct Credentials *pcreds,
                     const char* symbol,
@@ -1658,15 +2246,47 @@ GetHistoricalRange( struct Credentials *pcreds,
                             start_msec_since_epoch, end_msec_since_epoch,
                             extended_hours); }
 
+/* CandleTable */
+static inline int
+CandleTable_Create( const char *data, size_t data_len, CandleTable_C *ptable )
+{ return CandleTable_Create_ABI(data, data_len, ptable, 0); }
 
-/* OptionChainGetter */
 static inline int
-OptionChainGetter_Create( struct Credentials *pcreds,
-                          const char* symbol,
-                          OptionStrikesType strikes_type,
-                          OptionStrikesValue strikes_value,
-                          OptionContractType contract_type,
-                          int include_quotes,
+CandleTable_Destroy( CandleTable_C *ptable )
+{ return CandleTable_Destroy_ABI(ptable, 0); }
+
+static inline int
+CandleTable_GetSize( CandleTable_C *ptable, size_t *n )
+{ return CandleTable_GetSize_ABI(ptable, n, 0); }
+
+static inline int
+CandleTable_GetColumns( CandleTable_C *ptable,
+                        const double **open,
+                        const double **high,
+                        const double **low,
+                        const double **close,
+                        const long long **volume,
+                        const long long **datetime )
+{ return CandleTable_GetColumns_ABI(ptable, open, high, low, close, volume,
+                                    datetime, 0); }
+
+static inline int
+CandleTable_Find( CandleTable_C *ptable,
+                  long long start_msec,
+                  long long end_msec,
+                  size_t *begin,
+                  size_t *end )
+{ return CandleTable_Find_ABI(ptable, start_msec, end_msec, begin, end, 0); }
+
+
+/* OptionChainGetter */
+static inline int
+OptionChainGetter_Create( struct Credentials *pcreds,
+                          const char* symbol,
+                          OptionStrikesType strikes_type,
+                          OptionStrikesValue strikes_value,
+                          OptionContractType contract_type,
+                          int include_quotes,
                           const char* from_date,
                           const char* to_date,
                           OptionExpMonth exp_month,
@@ -1770,7 +2390,12 @@ name##_GetOptionType(name##_C *pgetter, OptionType *option_type) \
 static inline int \
 name##_SetOptionType(name##_C *pgetter, OptionType option_type) \
 { return OptionChainGetter_SetOptionType_ABI( (OptionChainGetter_C*)pgetter, \
-                                               (int)option_type, 0); }
+                                               (int)option_type, 0); } \
+\
+static inline int \
+name##_GetTable(name##_C *pgetter, OptionChainTable_C *ptable) \
+{ return OptionChainGetter_GetTable_ABI( (OptionChainGetter_C*)pgetter, \
+                                         ptable, 0); }
 
 DECL_WRAPPED_API_GETTER_BASE_FUNCS(OptionChainGetter)
 DECL_WRAPPED_OPTION_GETTER_BASE_FUNCS(OptionChainGetter)
@@ -1992,6 +2617,61 @@ GetOptionChainAnalytical( struct Credentials *pcreds,
                             include_quotes, from_date, to_date, exp_month,
                             option_type); }
 
+/* OptionChainTable */
+static inline int
+OptionChainTable_Create( const char *data,
+                         size_t data_len,
+                         OptionChainTable_C *ptable )
+{ return OptionChainTable_Create_ABI(data, data_len, ptable, 0); }
+
+static inline int
+OptionChainTable_Destroy( OptionChainTable_C *ptable )
+{ return OptionChainTable_Destroy_ABI(ptable, 0); }
+
+static inline int
+OptionChainTable_GetSize( OptionChainTable_C *ptable, size_t *n )
+{ return OptionChainTable_GetSize_ABI(ptable, n, 0); }
+
+static inline int
+OptionChainTable_GetColumn( OptionChainTable_C *ptable,
+                            OptionChainColumn column,
+                            const double **data )
+{ return OptionChainTable_GetColumn_ABI(ptable, (int)column, data, 0); }
+
+static inline int
+OptionChainTable_GetSymbols( OptionChainTable_C *ptable,
+                             const char * const **symbols )
+{ return OptionChainTable_GetSymbols_ABI(ptable, symbols, 0); }
+
+static inline int
+OptionChainTable_GetStrikeIndex( OptionChainTable_C *ptable,
+                                 const size_t **index )
+{ return OptionChainTable_GetStrikeIndex_ABI(ptable, index, 0); }
+
+static inline int
+OptionChainTable_FindExpirations( OptionChainTable_C *ptable,
+                                  double min,
+                                  double max,
+                                  size_t *begin,
+                                  size_t *end )
+{ return OptionChainTable_FindExpirations_ABI(ptable, min, max, begin, end, 0); }
+
+static inline int
+OptionChainTable_FindStrikes( OptionChainTable_C *ptable,
+                              double min,
+                              double max,
+                              size_t *begin,
+                              size_t *end )
+{ return OptionChainTable_FindStrikes_ABI(ptable, min, max, begin, end, 0); }
+
+static inline int
+OptionChainTable_Filter( OptionChainTable_C *ptable,
+                         const OptionChainFilter *filters,
+                         size_t nfilters,
+                         size_t *rows,
+                         size_t *n )
+{ return OptionChainTable_Filter_ABI(ptable, filters, nfilters, rows, n, 0); }
+
 
 /* AccountGetterBase */
 #define DECL_WRAPPED_ACCOUNT_GETTER_BASE_FUNCS(name) \
@@ -2502,6 +3182,126 @@ GetOrders( struct Credentials *pcreds,
 
 namespace tdma{
 
+struct ConnectionPoolStats{
+    unsigned int in_use;
+    unsigned int idle;
+    unsigned long long waits;
+    std::chrono::milliseconds wait_time;
+};
+
+/*
+ * feeds response chunks (from the transfer) to a SAX parse running in its
+ * own thread so parsing overlaps the network transfer; the parse thread is
+ * started on the first chunk
+ */
+class _ChunkSAXParser
+        : private std::streambuf {
+    json::json_sax_t& _sax;
+    std::mutex _mtx;
+    std::condition_variable _cond;
+    std::deque<std::string> _chunks;
+    std::string _cur;
+    bool _done;
+    bool _stopped;
+    bool _result;
+    std::exception_ptr _exc;
+    std::thread _thread;
+
+    int_type
+    underflow()
+    {
+        std::unique_lock<std::mutex> lock(_mtx);
+        _cond.wait( lock, [this]{ return !_chunks.empty() || _done; } );
+        if( _chunks.empty() )
+            return traits_type::eof();
+        _cur = std::move( _chunks.front() );
+        _chunks.pop_front();
+        setg( &_cur[0], &_cur[0], &_cur[0] + _cur.size() );
+        return traits_type::to_int_type(_cur[0]);
+    }
+
+    void
+    _run()
+    {
+        bool r = false;
+        std::exception_ptr e;
+        try{
+            std::istream in(this);
+            r = json::sax_parse(in, &_sax);
+        }catch(...){
+            e = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(_mtx);
+        _result = r;
+        _exc = e;
+        _stopped = !r; // tell the transfer to stop
+        _chunks.clear();
+    }
+
+public:
+    explicit _ChunkSAXParser(json::json_sax_t& sax)
+        :
+            _sax(sax),
+            _done(false),
+            _stopped(false),
+            _result(true)
+        {
+        }
+
+    ~_ChunkSAXParser()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _done = true;
+        }
+        _cond.notify_one();
+        if( _thread.joinable() )
+            _thread.join();
+    }
+
+    static int
+    on_chunk(const char* buf, size_t n, void* ctx)
+    {
+        _ChunkSAXParser *p = reinterpret_cast<_ChunkSAXParser*>(ctx);
+        {
+            std::lock_guard<std::mutex> lock(p->_mtx);
+            if( p->_stopped )
+                return 0;
+            p->_chunks.emplace_back(buf, n);
+            if( !p->_thread.joinable() )
+                p->_thread = std::thread( &_ChunkSAXParser::_run, p );
+        }
+        p->_cond.notify_one();
+        return 1;
+    }
+
+    /* did the parse stop the transfer */
+    bool
+    stopped()
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _stopped;
+    }
+
+    /* no more data; wait for the parse - rethrows its exception */
+    bool
+    finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _done = true;
+        }
+        _cond.notify_one();
+        if( !_thread.joinable() )
+            return true; // no data
+        _thread.join();
+        if( _exc )
+            std::rethrow_exception(_exc);
+        return _result;
+    }
+};
+
+
 class APIGetter{
 public:
     typedef Getter_C CType;
@@ -2515,6 +3315,29 @@ protected:
     cgetter() const
     { return reinterpret_cast<CTy*>( const_cast<CType*>(_cgetter.get()) ); }
 
+    static void
+    _async_trampoline(int err, const char* buf, size_t n, void* ctx)
+    {
+        std::unique_ptr<async_callback_ty> pcb(
+            reinterpret_cast<async_callback_ty*>(ctx)
+            );
+        json j;
+        std::exception_ptr e;
+        try{
+            error_to_exc(err, std::string(buf ? buf : ""), 0, "");
+            if( n > 1 )
+                j = json::parse(buf, buf + n - 1);
+        }catch(...){
+            e = std::current_exception();
+        }
+        try{
+            (*pcb)( std::move(j), e );
+        }catch(std::exception& exc){
+            std::cerr<< "exception in get_async callback: " << exc.what()
+                     << std::endl;
+        }
+    }
+
     template<typename CTy, typename F, typename F2, typename... Args>
     APIGetter(
             CTy _,
@@ -2587,6 +3410,71 @@ public:
         return std::chrono::milliseconds(w);
     }
 
+    static void
+    set_burst(unsigned int burst)
+    { call_abi( APIGetter_SetBurst_ABI, burst ); }
+
+    static unsigned int
+    get_burst()
+    {
+        unsigned int b;
+        call_abi( APIGetter_GetBurst_ABI, &b );
+        return b;
+    }
+
+    static void
+    set_endpoint_wait_msec( EndpointClass endpoint_class,
+                            std::chrono::milliseconds msec,
+                            unsigned int burst = 1 )
+    {
+        call_abi( APIGetter_SetEndpointWaitMSec_ABI,
+                  static_cast<int>(endpoint_class),
+                  static_cast<unsigned long long>(msec.count()), burst );
+    }
+
+    static std::pair<std::chrono::milliseconds, unsigned int>
+    get_endpoint_wait_msec(EndpointClass endpoint_class)
+    {
+        unsigned long long w;
+        unsigned int b;
+        call_abi( APIGetter_GetEndpointWaitMSec_ABI,
+                  static_cast<int>(endpoint_class), &w, &b );
+        return std::make_pair(std::chrono::milliseconds(w), b);
+    }
+
+    static std::chrono::milliseconds
+    endpoint_wait_remaining(EndpointClass endpoint_class)
+    {
+        unsigned long long w;
+        call_abi( APIGetter_EndpointWaitRemaining_ABI,
+                  static_cast<int>(endpoint_class), &w );
+        return std::chrono::milliseconds(w);
+    }
+
+    static void
+    set_retry_policy(EndpointClass endpoint_class, const RetryPolicy& policy)
+    {
+        call_abi( APIGetter_SetRetryPolicy_ABI,
+                  static_cast<int>(endpoint_class), &policy );
+    }
+
+    static RetryPolicy
+    get_retry_policy(EndpointClass endpoint_class)
+    {
+        RetryPolicy policy;
+        call_abi( APIGetter_GetRetryPolicy_ABI,
+                  static_cast<int>(endpoint_class), &policy );
+        return policy;
+    }
+
+    static RetryPolicy
+    get_def_retry_policy()
+    {
+        RetryPolicy policy;
+        call_abi( APIGetter_GetDefRetryPolicy_ABI, &policy );
+        return policy;
+    }
+
     static void
     share_connections(bool share)
     {
@@ -2601,18 +3489,158 @@ public:
         return static_cast<bool>(b);
     }
 
+    static void
+    set_max_connections(unsigned int n)
+    { call_abi( APIGetter_SetMaxConnections_ABI, n ); }
+
+    static unsigned int
+    get_max_connections()
+    {
+        unsigned int n;
+        call_abi( APIGetter_GetMaxConnections_ABI, &n );
+        return n;
+    }
+
+    static void
+    set_connection_max_idle(std::chrono::milliseconds msec)
+    {
+        call_abi( APIGetter_SetConnectionMaxIdleMSec_ABI,
+                  static_cast<unsigned long long>(msec.count()) );
+    }
+
+    static std::chrono::milliseconds
+    get_connection_max_idle()
+    {
+        unsigned long long msec;
+        call_abi( APIGetter_GetConnectionMaxIdleMSec_ABI, &msec );
+        return std::chrono::milliseconds(msec);
+    }
+
+    static ConnectionPoolStats
+    get_connection_pool_stats()
+    {
+        ConnectionPoolStats stats;
+        unsigned long long w;
+        call_abi( APIGetter_GetConnectionPoolStats_ABI, &stats.in_use,
+                  &stats.idle, &stats.waits, &w );
+        stats.wait_time = std::chrono::milliseconds(w);
+        return stats;
+    }
+
+    static void
+    set_cache_enabled(bool enabled)
+    { call_abi( APIGetter_SetCacheEnabled_ABI, static_cast<int>(enabled) ); }
+
+    static bool
+    is_cache_enabled()
+    {
+        int b;
+        call_abi( APIGetter_IsCacheEnabled_ABI, &b );
+        return static_cast<bool>(b);
+    }
+
+    static void
+    set_cache_max_entries(unsigned int n)
+    { call_abi( APIGetter_SetCacheMaxEntries_ABI, n ); }
+
+    static unsigned int
+    get_cache_max_entries()
+    {
+        unsigned int n;
+        call_abi( APIGetter_GetCacheMaxEntries_ABI, &n );
+        return n;
+    }
+
+    /* (existing) directory to also store cached responses in, "" for none */
+    static void
+    set_cache_directory(const std::string& directory)
+    { call_abi( APIGetter_SetCacheDirectory_ABI, directory.c_str() ); }
+
+    static std::string
+    get_cache_directory()
+    {
+        return str_from_abi_vargs( APIGetter_GetCacheDirectory_ABI,
+                                   ALLOW_EXCEPTIONS );
+    }
+
+    static void
+    clear_cache()
+    { call_abi( APIGetter_ClearCache_ABI ); }
+
     json
     get() const
     {
         char *buf;
         size_t n;
         call_abi( APIGetter_Get_ABI, _cgetter.get(), &buf, &n );
-        json j = (n > 1) ? json::parse(std::string(buf)) : json();
+        /* parse in place, don't copy into a string first */
+        json j;
+        try{
+            if( n > 1 )
+                j = json::parse(buf, buf + n - 1);
+        }catch(...){
+            free(buf);
+            throw;
+        }
         if(buf)
             free(buf);
         return j;
     }
 
+    typedef std::function<void(json, std::exception_ptr)> async_callback_ty;
+
+    /* callback is called from the async loop thread w/ data OR exception */
+    void
+    get_async(async_callback_ty callback) const
+    {
+        std::unique_ptr<async_callback_ty> pcb(
+            new async_callback_ty(callback)
+            );
+        call_abi( APIGetter_GetAsync_ABI, _cgetter.get(),
+                  &APIGetter::_async_trampoline,
+                  reinterpret_cast<void*>(pcb.get()) );
+        pcb.release(); // trampoline takes ownership
+    }
+
+    typedef json::json_sax_t sax_handler_ty;
+
+    /*
+     * parse the response into 'sax' as it arrives instead of building a
+     * json object; returns false if the handler stopped the parse. Nothing
+     * is passed to the handler if there's no data.
+     *
+     * the handler is called from another thread (but not concurrently)
+     */
+    bool
+    get(sax_handler_ty& sax) const
+    {
+        _ChunkSAXParser parser(sax);
+        try{
+            call_abi( APIGetter_GetStream_ABI, _cgetter.get(),
+                      &_ChunkSAXParser::on_chunk,
+                      reinterpret_cast<void*>(&parser) );
+        }catch(...){
+            /* if the parse stopped the transfer report the parse result */
+            if( !parser.stopped() )
+                throw;
+        }
+        return parser.finish();
+    }
+
+    std::future<json>
+    get_async() const
+    {
+        std::shared_ptr<std::promise<json>> p( new std::promise<json> );
+        std::future<json> f = p->get_future();
+        get_async( [p](json j, std::exception_ptr e){
+            if( e )
+                p->set_exception(e);
+            else
+                p->set_value( std::move(j) );
+        } );
+        return f;
+    }
+
     void
     close()
     { call_abi(APIGetter_Close_ABI, _cgetter.get() ); }
@@ -2625,6 +3653,42 @@ public:
         return static_cast<bool>(b);
     }
 
+    /* share the response of an identical in-flight get (default: true) */
+    void
+    set_coalesce(bool coalesce)
+    {
+        call_abi( APIGetter_SetCoalesce_ABI, _cgetter.get(),
+                  static_cast<int>(coalesce) );
+    }
+
+    bool
+    is_coalescing() const
+    {
+        int b;
+        call_abi( APIGetter_IsCoalescing_ABI, _cgetter.get(), &b );
+        return static_cast<bool>(b);
+    }
+
+    /* how long responses from get() are cached (0 disables) */
+    void
+    set_cache_ttl(std::chrono::milliseconds msec)
+    {
+        call_abi( APIGetter_SetCacheTTL_ABI, _cgetter.get(),
+                  static_cast<unsigned long long>(msec.count()) );
+    }
+
+    std::chrono::milliseconds
+    get_cache_ttl() const
+    {
+        unsigned long long t;
+        call_abi( APIGetter_GetCacheTTL_ABI, _cgetter.get(), &t );
+        return std::chrono::milliseconds(t);
+    }
+
+    void
+    invalidate_cache()
+    { call_abi( APIGetter_InvalidateCache_ABI, _cgetter.get() ); }
+
     void
     set_timeout(std::chrono::milliseconds timeout)
     {
@@ -2667,6 +3731,32 @@ public:
     {
         call_abi( QuoteGetter_SetSymbol_ABI, cgetter<CType>(), symbol.c_str() );
     }
+
+    /* batch get() calls made within 'msec' of each other into one request
+       for all their symbols; 0 (default) disables, max 1000 */
+    static void
+    set_batch_window(std::chrono::milliseconds msec)
+    {
+        call_abi( QuoteGetter_SetBatchWindowMSec_ABI,
+                  static_cast<unsigned long long>(msec.count()) );
+    }
+
+    static std::chrono::milliseconds
+    get_batch_window()
+    {
+        unsigned long long w;
+        call_abi( QuoteGetter_GetBatchWindowMSec_ABI, &w );
+        return std::chrono::milliseconds(w);
+    }
+
+    /* get() decoded directly into a QuoteRecord, w/o the json */
+    QuoteRecord
+    get_record() const
+    {
+        QuoteRecord r;
+        call_abi( QuoteGetter_GetRecord_ABI, cgetter<CType>(), &r );
+        return r;
+    }
 };
 
 
@@ -2730,8 +3820,36 @@ public:
     void
     remove_symbols(const std::set<std::string>& symbols)
     { _str_set_to_abi(QuotesGetter_RemoveSymbols_ABI, symbols); }
+
+    /* get() decoded directly into QuoteRecords, w/o the json; returns
+       the # written to 'records' (throws ValueException if > 'n') */
+    size_t
+    get_records(QuoteRecord *records, size_t n) const
+    {
+        call_abi( QuotesGetter_GetRecords_ABI, cgetter<CType>(), records, &n );
+        return n;
+    }
+
+    std::vector<QuoteRecord>
+    get_records() const
+    {
+        std::vector<QuoteRecord> r( get_symbols().size() );
+        r.resize( get_records(r.data(), r.size()) );
+        return r;
+    }
 };
 
+/* decode the raw json of a quote(s) get, e.g from get_async */
+inline std::vector<QuoteRecord>
+DecodeQuoteRecords(const std::string& data)
+{
+    size_t n = 0;
+    call_abi( DecodeQuoteRecords_ABI, data.c_str(), data.size(), nullptr, &n );
+    std::vector<QuoteRecord> r(n);
+    call_abi( DecodeQuoteRecords_ABI, data.c_str(), data.size(), r.data(), &n );
+    return r;
+}
+
 
 
 // note we only implement the single MarketType version
@@ -2851,6 +3969,123 @@ public:
 };
 
 
+/*
+ * CandleTable - price history decoded into contiguous OHLCV columns w/ a
+ * row for each candle, ordered by datetime. Pointers point into the table.
+ */
+class CandleTable{
+public:
+    typedef CandleTable_C CType;
+
+private:
+    std::unique_ptr<Getter_C, CProxyDestroyer<Getter_C>> _ctable;
+
+    CandleTable()
+        :
+            _ctable( new Getter_C{0,0},
+                     CProxyDestroyer<Getter_C>(CandleTable_Destroy_ABI) )
+        {
+        }
+
+    const double*
+    price_column(int i) const
+    {
+        const double *c[4] = {nullptr, nullptr, nullptr, nullptr};
+        call_abi( CandleTable_GetColumns_ABI, get_cproxy(), &c[0], &c[1],
+                  &c[2], &c[3], nullptr, nullptr );
+        return c[i];
+    }
+
+public:
+    /* decode the raw json of a historical get, e.g from get_async */
+    explicit
+    CandleTable(const std::string& data)
+        : CandleTable()
+        {
+            call_abi( CandleTable_Create_ABI, data.c_str(), data.size(),
+                      get_cproxy() );
+        }
+
+    /* take ownership of a table from the C/ABI layer */
+    explicit
+    CandleTable(CType&& ctable)
+        : CandleTable()
+        {
+            _ctable->obj = ctable.obj;
+            _ctable->type_id = ctable.type_id;
+            ctable.obj = nullptr;
+            ctable.type_id = 0;
+        }
+
+    CandleTable( CandleTable&& ) = default;
+
+    CandleTable&
+    operator=( CandleTable&& ) = default;
+
+    CandleTable( const CandleTable& ) = delete;
+
+    CandleTable&
+    operator=( const CandleTable& ) = delete;
+
+    size_t
+    size() const
+    {
+        size_t n;
+        call_abi( CandleTable_GetSize_ABI, get_cproxy(), &n );
+        return n;
+    }
+
+    const double*
+    open() const
+    { return price_column(0); }
+
+    const double*
+    high() const
+    { return price_column(1); }
+
+    const double*
+    low() const
+    { return price_column(2); }
+
+    const double*
+    close() const
+    { return price_column(3); }
+
+    const long long*
+    volume() const
+    {
+        const long long *v;
+        call_abi( CandleTable_GetColumns_ABI, get_cproxy(), nullptr, nullptr,
+                  nullptr, nullptr, &v, nullptr );
+        return v;
+    }
+
+    /* msec since epoch */
+    const long long*
+    datetime() const
+    {
+        const long long *dt;
+        call_abi( CandleTable_GetColumns_ABI, get_cproxy(), nullptr, nullptr,
+                  nullptr, nullptr, nullptr, &dt );
+        return dt;
+    }
+
+    /* rows [first, second) w/ start_msec <= datetime <= end_msec */
+    std::pair<size_t, size_t>
+    find(long long start_msec, long long end_msec) const
+    {
+        std::pair<size_t, size_t> r;
+        call_abi( CandleTable_Find_ABI, get_cproxy(), start_msec, end_msec,
+                  &r.first, &r.second );
+        return r;
+    }
+
+    CType*
+    get_cproxy() const
+    { return reinterpret_cast<CType*>( const_cast<Getter_C*>(_ctable.get()) ); }
+};
+
+
 class HistoricalGetterBase
         : public APIGetter {
 protected:
@@ -2922,6 +4157,15 @@ public:
                   static_cast<int>(extended_hours) );
     }
 
+    /* get() decoded directly into a CandleTable, w/o the json */
+    CandleTable
+    get_candles() const
+    {
+        CandleTable_C t{0,0};
+        call_abi( HistoricalGetterBase_GetCandles_ABI, cgetter<>(), &t );
+        return CandleTable( std::move(t) );
+    }
+
 
 };
 
@@ -3053,6 +4297,17 @@ public:
         call_abi( HistoricalRangeGetter_SetStartMSecSinceEpoch_ABI,
                   cgetter<CType>(), start_msec_since_epoch );
     }
+
+    /* the range in 'chunk_msec' requests (0 for the default) sent
+       concurrently, merged and de-duplicated by datetime */
+    CandleTable
+    backfill(unsigned long long chunk_msec = 0) const
+    {
+        CandleTable_C t{0,0};
+        call_abi( HistoricalRangeGetter_Backfill_ABI, cgetter<CType>(),
+                  chunk_msec, &t );
+        return CandleTable( std::move(t) );
+    }
 };
 
 
@@ -3258,6 +4513,128 @@ operator<<(std::ostream& out, const OptionStrategy& strategy)
 }
 
 
+/*
+ * OptionChainTable - option chain decoded into contiguous columns (of
+ * doubles) w/ a row for each contract; rows are ordered by expiration,
+ * strike, then call before put. Pointers point into the table.
+ */
+class OptionChainTable{
+public:
+    typedef OptionChainTable_C CType;
+
+private:
+    std::unique_ptr<Getter_C, CProxyDestroyer<Getter_C>> _ctable;
+
+    OptionChainTable()
+        :
+            _ctable( new Getter_C{0,0},
+                     CProxyDestroyer<Getter_C>(OptionChainTable_Destroy_ABI) )
+        {
+        }
+
+public:
+    /* decode the raw json of an option chain get, e.g from get_async */
+    explicit
+    OptionChainTable(const std::string& data)
+        : OptionChainTable()
+        {
+            call_abi( OptionChainTable_Create_ABI, data.c_str(), data.size(),
+                      get_cproxy() );
+        }
+
+    /* take ownership of a table from the C/ABI layer */
+    explicit
+    OptionChainTable(CType&& ctable)
+        : OptionChainTable()
+        {
+            _ctable->obj = ctable.obj;
+            _ctable->type_id = ctable.type_id;
+            ctable.obj = nullptr;
+            ctable.type_id = 0;
+        }
+
+    OptionChainTable( OptionChainTable&& ) = default;
+
+    OptionChainTable&
+    operator=( OptionChainTable&& ) = default;
+
+    OptionChainTable( const OptionChainTable& ) = delete;
+
+    OptionChainTable&
+    operator=( const OptionChainTable& ) = delete;
+
+    size_t
+    size() const
+    {
+        size_t n;
+        call_abi( OptionChainTable_GetSize_ABI, get_cproxy(), &n );
+        return n;
+    }
+
+    const double*
+    column(OptionChainColumn column) const
+    {
+        const double *c;
+        call_abi( OptionChainTable_GetColumn_ABI, get_cproxy(),
+                  static_cast<int>(column), &c );
+        return c;
+    }
+
+    const char * const *
+    symbols() const
+    {
+        const char * const *s;
+        call_abi( OptionChainTable_GetSymbols_ABI, get_cproxy(), &s );
+        return s;
+    }
+
+    /* rows ordered by strike, expiration, then call before put */
+    const size_t*
+    strike_index() const
+    {
+        const size_t *i;
+        call_abi( OptionChainTable_GetStrikeIndex_ABI, get_cproxy(), &i );
+        return i;
+    }
+
+    /* rows [first, second) w/ min <= expiration <= max */
+    std::pair<size_t, size_t>
+    find_expirations(double min, double max) const
+    {
+        std::pair<size_t, size_t> r;
+        call_abi( OptionChainTable_FindExpirations_ABI, get_cproxy(), min, max,
+                  &r.first, &r.second );
+        return r;
+    }
+
+    /* strike_index() [first, second) w/ min <= strike <= max */
+    std::pair<size_t, size_t>
+    find_strikes(double min, double max) const
+    {
+        std::pair<size_t, size_t> r;
+        call_abi( OptionChainTable_FindStrikes_ABI, get_cproxy(), min, max,
+                  &r.first, &r.second );
+        return r;
+    }
+
+    /* rows matching all filters */
+    std::vector<size_t>
+    filter(const std::vector<OptionChainFilter>& filters) const
+    {
+        std::vector<size_t> rows( size() );
+        size_t n = rows.size();
+        call_abi( OptionChainTable_Filter_ABI, get_cproxy(), filters.data(),
+                  filters.size(), rows.data(), &n );
+        rows.resize(n);
+        return rows;
+    }
+
+    CType*
+    get_cproxy() const
+    { return reinterpret_cast<CType*>( const_cast<Getter_C*>(_ctable.get()) ); }
+};
+
+
 class OptionChainGetter
         : public APIGetter {
 protected:
@@ -3416,6 +4793,15 @@ public:
         call_abi( OptionChainGetter_SetOptionType_ABI, cgetter<CType>(),
                   static_cast<int>(option_type) );
     }
+
+    /* get() decoded directly into an OptionChainTable, w/o the json */
+    OptionChainTable
+    get_table() const
+    {
+        OptionChainTable_C t{0,0};
+        call_abi( OptionChainGetter_GetTable_ABI, cgetter<CType>(), &t );
+        return OptionChainTable( std::move(t) );
+    }
 };
 
 
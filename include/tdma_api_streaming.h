@@ -88,6 +88,14 @@ DECL_C_CPP_TDMA_ENUM(QOSType, 0, 5,
     BUILD_C_CPP_TDMA_ENUM_NAME(QOSType, delayed)    /* 5000 ms */
     );
 
+/* what the session does w/ messages when its inbound buffer is full */
+DECL_C_CPP_TDMA_ENUM(OverflowPolicyType, 0, 1,
+    /* DEFAULT - hold back up to 'capacity' more, then drop */
+    BUILD_C_CPP_TDMA_ENUM_NAME(OverflowPolicyType, block),
+    /* drop new messages right away */
+    BUILD_C_CPP_TDMA_ENUM_NAME(OverflowPolicyType, drop)
+    );
+
 DECL_C_CPP_TDMA_ENUM(CommandType, 0, 3,
     BUILD_C_CPP_TDMA_ENUM_NAME(CommandType, SUBS),
     BUILD_C_CPP_TDMA_ENUM_NAME(CommandType, UNSUBS),
@@ -2032,6 +2040,26 @@ public:
 #define STREAMING_DEF_LISTENING_TIMEOUT 30000
 #define STREAMING_DEF_SUBSCRIBE_TIMEOUT 1500
 #define STREAMING_MAX_SUBSCRIPTIONS 50
+#define STREAMING_DEF_INBOUND_CAPACITY 4096
+#define STREAMING_LEVEL_ONE_MAX_FIELDS 53 /* QuotesSubscriptionField */
+
+/*
+ * the latest value of each field of a symbol on a level one service (QUOTE,
+ * OPTION, LEVELONE_FUTURES, LEVELONE_FOREX, LEVELONE_FUTURES_OPTIONS), from
+ * the session's LevelOneBook; 'fields' is indexed by the service's field
+ * enum (e.g QuotesSubscriptionField_bid_price). Sizes, times etc. are
+ * converted to double, booleans to 0/1 and one-char strings (exchange ids,
+ * ticks) to the char's code; fields not received yet (or other strings) are
+ * NaN (see README_STREAMING.md)
+ */
+typedef struct{
+    const char *symbol; /* interned, valid for the life of the library */
+    unsigned int symbol_id; /* same id for the same symbol, starts at 1 */
+    int service; /* StreamerServiceType */
+    unsigned long long timestamp; /* of the last update, msec since epoch */
+    unsigned long long nupdates;
+    double fields[STREAMING_LEVEL_ONE_MAX_FIELDS];
+} LevelOneRecord;
 
 
 typedef void(*streaming_cb_ty)(int, int, unsigned long long, const char*);
@@ -2046,6 +2074,25 @@ StreamingSession_Create_ABI( struct Credentials *pcreds,
                              StreamingSession_C *psession,
                              int allow_exceptions );
 
+#ifdef __cplusplus
+/*
+ * C++ only: the callback receives the already-parsed message content rather
+ * than a string that has to be parsed again; 'json' is only valid for the
+ * duration of the call. (Requires the json.hpp the library was built with.)
+ */
+typedef void(*streaming_json_cb_ty)(int, int, unsigned long long, const json&);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_CreateJson_ABI( struct Credentials *pcreds,
+                                 streaming_json_cb_ty callback,
+                                 const char* account_id,
+                                 unsigned long connect_timeout,
+                                 unsigned long listening_timeout,
+                                 unsigned long subscribe_timeout,
+                                 StreamingSession_C *psession,
+                                 int allow_exceptions );
+#endif /* __cplusplus */
+
 EXTERN_C_SPEC_ DLL_SPEC_ int
 StreamingSession_Destroy_ABI( StreamingSession_C *psession,
                               int allow_exceptions );
@@ -2086,6 +2133,48 @@ StreamingSession_GetQOS_ABI( StreamingSession_C *psession,
                              int *qos,
                              int allow_exceptions );
 
+/* takes effect the next time the session is started */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetInboundBuffer_ABI( StreamingSession_C *psession,
+                                       size_t capacity,
+                                       int overflow_policy,
+                                       int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetInboundBuffer_ABI( StreamingSession_C *psession,
+                                       size_t *capacity,
+                                       int *overflow_policy,
+                                       int allow_exceptions );
+
+/* can't be changed while the session is active */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_SetLevelOneBookEnabled_ABI( StreamingSession_C *psession,
+                                             int enabled,
+                                             int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_IsLevelOneBookEnabled_ABI( StreamingSession_C *psession,
+                                            int *enabled,
+                                            int allow_exceptions );
+
+/* 'found' is 0 if nothing has been received for 'symbol' on 'service' */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetLevelOneRecord_ABI( StreamingSession_C *psession,
+                                        int service,
+                                        const char *symbol,
+                                        LevelOneRecord *record,
+                                        int *found,
+                                        int allow_exceptions );
+
+/* by LevelOneRecord.symbol_id; no symbol lookup, never blocks */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+StreamingSession_GetLevelOneRecordById_ABI( StreamingSession_C *psession,
+                                            int service,
+                                            unsigned int symbol_id,
+                                            LevelOneRecord *record,
+                                            int *found,
+                                            int allow_exceptions );
+
 #ifndef __cplusplus
 
 /* C Interface */
@@ -2153,6 +2242,57 @@ static inline int
 StreamingSession_GetQOS( StreamingSession_C *psession, QOSType *qos)
 { return StreamingSession_GetQOS_ABI(psession, (int*)qos, 0); }
 
+static inline int
+StreamingSession_SetInboundBuffer( StreamingSession_C *psession,
+                                   size_t capacity,
+                                   OverflowPolicyType overflow_policy )
+{
+    return StreamingSession_SetInboundBuffer_ABI(psession, capacity,
+                                                 (int)overflow_policy, 0);
+}
+
+static inline int
+StreamingSession_GetInboundBuffer( StreamingSession_C *psession,
+                                   size_t *capacity,
+                                   OverflowPolicyType *overflow_policy )
+{
+    return StreamingSession_GetInboundBuffer_ABI(psession, capacity,
+                                                 (int*)overflow_policy, 0);
+}
+
+static inline int
+StreamingSession_SetLevelOneBookEnabled( StreamingSession_C *psession,
+                                         int enabled )
+{ return StreamingSession_SetLevelOneBookEnabled_ABI(psession, enabled, 0); }
+
+static inline int
+StreamingSession_IsLevelOneBookEnabled( StreamingSession_C *psession,
+                                        int *enabled )
+{ return StreamingSession_IsLevelOneBookEnabled_ABI(psession, enabled, 0); }
+
+static inline int
+StreamingSession_GetLevelOneRecord( StreamingSession_C *psession,
+                                    StreamerServiceType service,
+                                    const char *symbol,
+                                    LevelOneRecord *record,
+                                    int *found )
+{
+    return StreamingSession_GetLevelOneRecord_ABI(psession, (int)service,
+                                                  symbol, record, found, 0);
+}
+
+static inline int
+StreamingSession_GetLevelOneRecordById( StreamingSession_C *psession,
+                                        StreamerServiceType service,
+                                        unsigned int symbol_id,
+                                        LevelOneRecord *record,
+                                        int *found )
+{
+    return StreamingSession_GetLevelOneRecordById_ABI(psession, (int)service,
+                                                      symbol_id, record,
+                                                      found, 0);
+}
+
 #else
 
 /* C++ Interface */
@@ -2213,20 +2353,22 @@ private:
         return cpp_results;
     }
 
-public:
+    template<typename CallbackTy>
     static std::shared_ptr<StreamingSession>
-    Create( Credentials& creds,
-             streaming_cb_ty callback,
-             std::string account_id = "",
-             std::chrono::milliseconds connect_timeout=DEF_CONNECT_TIMEOUT,
-             std::chrono::milliseconds listening_timeout=DEF_LISTENING_TIMEOUT,
-             std::chrono::milliseconds subscribe_timeout=DEF_SUBSCRIBE_TIMEOUT
-             )
+    _create( int(*abicall)(Credentials*, CallbackTy, const char*,
+                           unsigned long, unsigned long, unsigned long,
+                           CType*, int),
+             Credentials& creds,
+             CallbackTy callback,
+             const std::string& account_id,
+             std::chrono::milliseconds connect_timeout,
+             std::chrono::milliseconds listening_timeout,
+             std::chrono::milliseconds subscribe_timeout )
     {
         StreamingSession *ss = nullptr;
         try{
             ss = new StreamingSession;
-            call_abi( StreamingSession_Create_ABI, &creds, callback,
+            call_abi( abicall, &creds, callback,
                       account_id.c_str(), connect_timeout.count(),
                       listening_timeout.count(), subscribe_timeout.count(),
                       ss->_obj.get() );
@@ -2237,6 +2379,36 @@ public:
         return std::shared_ptr<StreamingSession>(ss);
     }
 
+public:
+    static std::shared_ptr<StreamingSession>
+    Create( Credentials& creds,
+             streaming_cb_ty callback,
+             std::string account_id = "",
+             std::chrono::milliseconds connect_timeout=DEF_CONNECT_TIMEOUT,
+             std::chrono::milliseconds listening_timeout=DEF_LISTENING_TIMEOUT,
+             std::chrono::milliseconds subscribe_timeout=DEF_SUBSCRIBE_TIMEOUT
+             )
+    {
+        return _create( StreamingSession_Create_ABI, creds, callback,
+                        account_id, connect_timeout, listening_timeout,
+                        subscribe_timeout );
+    }
+
+    /* callback gets the parsed content directly (no dump/re-parse) */
+    static std::shared_ptr<StreamingSession>
+    Create( Credentials& creds,
+             streaming_json_cb_ty callback,
+             std::string account_id = "",
+             std::chrono::milliseconds connect_timeout=DEF_CONNECT_TIMEOUT,
+             std::chrono::milliseconds listening_timeout=DEF_LISTENING_TIMEOUT,
+             std::chrono::milliseconds subscribe_timeout=DEF_SUBSCRIBE_TIMEOUT
+             )
+    {
+        return _create( StreamingSession_CreateJson_ABI, creds, callback,
+                        account_id, connect_timeout, listening_timeout,
+                        subscribe_timeout );
+    }
+
     StreamingSession( const StreamingSession& ) = delete;
 
     StreamingSession&
@@ -2291,8 +2463,76 @@ public:
                   static_cast<int>(qos), &result );
         return static_cast<bool>(result);
     }
+
+    /* takes effect the next time the session is started */
+    void
+    set_inbound_buffer( size_t capacity,
+                        OverflowPolicyType overflow_policy
+                            = OverflowPolicyType::block )
+    {
+        call_abi( StreamingSession_SetInboundBuffer_ABI, _obj.get(), capacity,
+                  static_cast<int>(overflow_policy) );
+    }
+
+    std::pair<size_t, OverflowPolicyType>
+    get_inbound_buffer() const
+    {
+        size_t capacity;
+        int policy;
+        call_abi( StreamingSession_GetInboundBuffer_ABI, _obj.get(),
+                  &capacity, &policy );
+        return {capacity, static_cast<OverflowPolicyType>(policy)};
+    }
+
+    /* keep the latest level one fields per symbol (see LevelOneRecord);
+     * can't be changed while the session is active */
+    void
+    set_level_one_book_enabled(bool enabled)
+    {
+        call_abi( StreamingSession_SetLevelOneBookEnabled_ABI, _obj.get(),
+                  static_cast<int>(enabled) );
+    }
+
+    bool
+    is_level_one_book_enabled() const
+    {
+        int enabled;
+        call_abi( StreamingSession_IsLevelOneBookEnabled_ABI, _obj.get(),
+                  &enabled );
+        return static_cast<bool>(enabled);
+    }
+
+    /* false if nothing has been received for 'symbol' on 'service' */
+    bool
+    get_level_one_record( StreamerServiceType service,
+                          const std::string& symbol,
+                          LevelOneRecord& record ) const
+    {
+        int found;
+        call_abi( StreamingSession_GetLevelOneRecord_ABI, _obj.get(),
+                  static_cast<int>(service), symbol.c_str(), &record, &found );
+        return static_cast<bool>(found);
+    }
+
+    /* by LevelOneRecord.symbol_id; no symbol lookup, never blocks */
+    bool
+    get_level_one_record( StreamerServiceType service,
+                          unsigned int symbol_id,
+                          LevelOneRecord& record ) const
+    {
+        int found;
+        call_abi( StreamingSession_GetLevelOneRecordById_ABI, _obj.get(),
+                  static_cast<int>(service), symbol_id, &record, &found );
+        return static_cast<bool>(found);
+    }
 };
 
+/* e.g level_one_field(r, QuotesSubscriptionField::bid_price) */
+template<typename FieldType>
+inline double
+level_one_field(const LevelOneRecord& record, FieldType field)
+{ return record.fields[static_cast<int>(field)]; }
+
 } /* tdma */
 
 
@@ -398,6 +398,12 @@ namespace tdma{
 static void
 error_to_exc(int code);
 
+static void
+error_to_exc( int code,
+              std::string msg,
+              int lineno,
+              const std::string& fname );
+
 template<typename... Args1, typename... Args2>
 inline void
 call_abi( int(*abicall)(Args1...), Args2... args)
@@ -410,6 +416,176 @@ call_abi( int(*abicall)(Args1...), Args2... args)
 #endif /* __cplusplus */
 
 
+/*
+ * REQUEST LANES - gets and executes are admitted through prioritized lanes
+ * so orders don't wait behind data requests (see README.md)
+ */
+DECL_C_CPP_TDMA_ENUM(RequestLane, 0, 2,
+    BUILD_C_CPP_TDMA_ENUM_NAME(RequestLane, execution),
+    BUILD_C_CPP_TDMA_ENUM_NAME(RequestLane, account),
+    BUILD_C_CPP_TDMA_ENUM_NAME(RequestLane, marketdata)
+);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+SetRequestLaneLimits_ABI( int lane,
+                          unsigned int max_concurrent,
+                          unsigned long long wait_msec,
+                          unsigned int burst,
+                          int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+GetRequestLaneLimits_ABI( int lane,
+                          unsigned int *max_concurrent,
+                          unsigned long long *wait_msec,
+                          unsigned int *burst,
+                          int allow_exceptions );
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+GetRequestLaneStats_ABI( int lane,
+                         unsigned int *queued,
+                         unsigned int *in_flight,
+                         unsigned long long *requests,
+                         unsigned long long *wait_msec,
+                         unsigned long long *max_wait_msec,
+                         int allow_exceptions );
+
+/*
+ * HTTP/2 - multiplex concurrent requests on one connection, falls back to
+ * HTTP/1.1 (see README.md)
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+SetHTTP2Enabled_ABI(int enabled, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+IsHTTP2Enabled_ABI(int *enabled, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+IsHTTP2Supported_ABI(int *supported, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+GetHTTPStats_ABI( unsigned long long *requests,
+                  unsigned long long *connections,
+                  unsigned long long *http2_requests,
+                  int allow_exceptions );
+
+/*
+ * Metrics - per-endpoint request counters and latency histograms, as
+ * (prometheus) text or JSON snapshots (see README.md)
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Metrics_SetEnabled_ABI(int enabled, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Metrics_IsEnabled_ABI(int *enabled, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Metrics_Reset_ABI(int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Metrics_GetText_ABI(char **buf, size_t *n, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+Metrics_GetJSON_ABI(char **buf, size_t *n, int allow_exceptions);
+
+/*
+ * Base URLs - point the library at another server(e.g tools/mock_server.py)
+ * an empty streamer url uses the one from UserPrincipals (see README.md)
+ */
+EXTERN_C_SPEC_ DLL_SPEC_ int
+SetAPIBaseURL_ABI(const char *url, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+GetAPIBaseURL_ABI(char **buf, size_t *n, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+SetStreamerURL_ABI(const char *url, int allow_exceptions);
+
+EXTERN_C_SPEC_ DLL_SPEC_ int
+GetStreamerURL_ABI(char **buf, size_t *n, int allow_exceptions);
+
+#ifndef __cplusplus
+
+static inline int
+SetRequestLaneLimits( RequestLane lane,
+                      unsigned int max_concurrent,
+                      unsigned long long wait_msec,
+                      unsigned int burst )
+{ return SetRequestLaneLimits_ABI(lane, max_concurrent, wait_msec, burst, 0); }
+
+static inline int
+GetRequestLaneLimits( RequestLane lane,
+                      unsigned int *max_concurrent,
+                      unsigned long long *wait_msec,
+                      unsigned int *burst )
+{ return GetRequestLaneLimits_ABI(lane, max_concurrent, wait_msec, burst, 0); }
+
+static inline int
+GetRequestLaneStats( RequestLane lane,
+                     unsigned int *queued,
+                     unsigned int *in_flight,
+                     unsigned long long *requests,
+                     unsigned long long *wait_msec,
+                     unsigned long long *max_wait_msec )
+{ return GetRequestLaneStats_ABI(lane, queued, in_flight, requests, wait_msec,
+                                 max_wait_msec, 0); }
+
+static inline int
+SetHTTP2Enabled(int enabled)
+{ return SetHTTP2Enabled_ABI(enabled, 0); }
+
+static inline int
+IsHTTP2Enabled(int *enabled)
+{ return IsHTTP2Enabled_ABI(enabled, 0); }
+
+static inline int
+IsHTTP2Supported(int *supported)
+{ return IsHTTP2Supported_ABI(supported, 0); }
+
+static inline int
+GetHTTPStats( unsigned long long *requests,
+              unsigned long long *connections,
+              unsigned long long *http2_requests )
+{ return GetHTTPStats_ABI(requests, connections, http2_requests, 0); }
+
+static inline int
+Metrics_SetEnabled(int enabled)
+{ return Metrics_SetEnabled_ABI(enabled, 0); }
+
+static inline int
+Metrics_IsEnabled(int *enabled)
+{ return Metrics_IsEnabled_ABI(enabled, 0); }
+
+static inline int
+Metrics_Reset()
+{ return Metrics_Reset_ABI(0); }
+
+static inline int
+Metrics_GetText(char **buf, size_t *n)
+{ return Metrics_GetText_ABI(buf, n, 0); }
+
+static inline int
+Metrics_GetJSON(char **buf, size_t *n)
+{ return Metrics_GetJSON_ABI(buf, n, 0); }
+
+static inline int
+SetAPIBaseURL(const char *url)
+{ return SetAPIBaseURL_ABI(url, 0); }
+
+static inline int
+GetAPIBaseURL(char **buf, size_t *n)
+{ return GetAPIBaseURL_ABI(buf, n, 0); }
+
+static inline int
+SetStreamerURL(const char *url)
+{ return SetStreamerURL_ABI(url, 0); }
+
+static inline int
+GetStreamerURL(char **buf, size_t *n)
+{ return GetStreamerURL_ABI(buf, n, 0); }
+
+#endif /* __cplusplus */
+
+
 /*
  * if C, client has to call CloseCredentials and CopyCredentials directly
  * a) when done and b) before passing an active instance to LoadCredentials
@@ -495,6 +671,7 @@ public:
 #include <string>
 #include "util.h"
 #include <functional>
+#include <chrono>
 
 namespace tdma{
 
@@ -673,6 +850,128 @@ inline void
 CheckOptionSymbol(const std::string& symbol)
 { call_abi( CheckOptionSymbol_ABI, symbol.c_str() ); }
 
+struct RequestLaneLimits{
+    unsigned int max_concurrent; // 0 is unlimited
+    std::chrono::milliseconds wait_msec; // 0 disables
+    unsigned int burst;
+};
+
+struct RequestLaneStats{
+    unsigned int queued;
+    unsigned int in_flight;
+    unsigned long long requests;
+    std::chrono::milliseconds wait_msec; // total
+    std::chrono::milliseconds max_wait_msec;
+};
+
+inline void
+SetRequestLaneLimits( RequestLane lane,
+                      unsigned int max_concurrent,
+                      std::chrono::milliseconds wait_msec
+                          = std::chrono::milliseconds(0),
+                      unsigned int burst = 1 )
+{
+    call_abi( SetRequestLaneLimits_ABI, static_cast<int>(lane),
+              max_concurrent,
+              static_cast<unsigned long long>(wait_msec.count()), burst );
+}
+
+inline RequestLaneLimits
+GetRequestLaneLimits(RequestLane lane)
+{
+    unsigned int mc, b;
+    unsigned long long w;
+    call_abi( GetRequestLaneLimits_ABI, static_cast<int>(lane), &mc, &w, &b );
+    return {mc, std::chrono::milliseconds(w), b};
+}
+
+inline RequestLaneStats
+GetRequestLaneStats(RequestLane lane)
+{
+    unsigned int q, f;
+    unsigned long long r, w, mw;
+    call_abi( GetRequestLaneStats_ABI, static_cast<int>(lane), &q, &f, &r, &w,
+              &mw );
+    return {q, f, r, std::chrono::milliseconds(w), std::chrono::milliseconds(mw)};
+}
+
+inline void
+SetHTTP2Enabled(bool enabled)
+{ call_abi( SetHTTP2Enabled_ABI, static_cast<int>(enabled) ); }
+
+inline bool
+IsHTTP2Enabled()
+{
+    int b;
+    call_abi( IsHTTP2Enabled_ABI, &b );
+    return static_cast<bool>(b);
+}
+
+inline bool
+IsHTTP2Supported()
+{
+    int b;
+    call_abi( IsHTTP2Supported_ABI, &b );
+    return static_cast<bool>(b);
+}
+
+struct HTTPStats{
+    unsigned long long requests;
+    unsigned long long connections; // new connections opened
+    unsigned long long http2_requests;
+};
+
+inline HTTPStats
+GetHTTPStats()
+{
+    HTTPStats stats;
+    call_abi( GetHTTPStats_ABI, &stats.requests, &stats.connections,
+              &stats.http2_requests );
+    return stats;
+}
+
+inline void
+SetMetricsEnabled(bool enabled)
+{ call_abi( Metrics_SetEnabled_ABI, static_cast<int>(enabled) ); }
+
+inline bool
+IsMetricsEnabled()
+{
+    int b;
+    call_abi( Metrics_IsEnabled_ABI, &b );
+    return static_cast<bool>(b);
+}
+
+inline void
+ResetMetrics()
+{ call_abi( Metrics_Reset_ABI ); }
+
+/* prometheus text exposition format */
+inline std::string
+GetMetricsText()
+{ return str_from_abi_vargs(Metrics_GetText_ABI, ALLOW_EXCEPTIONS); }
+
+inline json
+GetMetricsJSON()
+{ return json::parse( str_from_abi_vargs(Metrics_GetJSON_ABI, ALLOW_EXCEPTIONS) ); }
+
+inline void
+SetAPIBaseURL(const std::string& url)
+{ call_abi( SetAPIBaseURL_ABI, url.c_str() ); }
+
+inline std::string
+GetAPIBaseURL()
+{ return str_from_abi_vargs(GetAPIBaseURL_ABI, ALLOW_EXCEPTIONS); }
+
+/* empty to use the url from UserPrincipals */
+inline void
+SetStreamerURL(const std::string& url)
+{ call_abi( SetStreamerURL_ABI, url.c_str() ); }
+
+inline std::string
+GetStreamerURL()
+{ return str_from_abi_vargs(GetStreamerURL_ABI, ALLOW_EXCEPTIONS); }
+
 
 class APIException
         : public std::exception{
@@ -794,23 +1093,34 @@ public:
 
 class ConnectException
         : public APIException{
+    int _status_code;
+
 public:
     static const int ERROR_CODE = TDMA_API_CONNECT_ERROR;
 
     ConnectException( std::string what,
                       int lineno,
                       const std::string& filename )
-        : APIException(what, lineno, filename)
+        :
+            APIException(what, lineno, filename),
+            _status_code(0)
         {}
 
     ConnectException( std::string what,
                       int status_code,
                       int lineno,
                       const std::string& filename )
-        : APIException( what + "(response code =" + std::to_string(status_code)
-                        + ')', lineno, filename)
+        :
+            APIException( what + "(response code =" + std::to_string(status_code)
+                          + ')', lineno, filename),
+            _status_code(status_code)
         {}
 
+    /* HTTP response code, 0 if none(e.g a connection error) */
+    int
+    status_code() const noexcept
+    { return _status_code; }
+
     virtual const char*
     name() const noexcept
     { return "ConnectException"; }
@@ -943,28 +1253,14 @@ public:
 
 
 static void
-error_to_exc(int code)
+error_to_exc( int code,
+              std::string msg,
+              int lineno,
+              const std::string& fname )
 {
     if( code == 0 )
         return;
 
-    char *bufs[] = {nullptr, nullptr};
-    int lineno, c;
-    size_t n;
-
-    int err = LastErrorState_ABI(&c, &bufs[0], &n, &lineno, &bufs[1], &n, 0);
-    if( err ) {
-        throw std::runtime_error("failed to get last error state("
-                                 + std::to_string(err) + ")");
-    }
-    assert(bufs[0]);
-    assert(bufs[1]);
-    assert(code == c);
-    std::string msg(bufs[0]);
-    std::string fname(bufs[1]);
-    FreeBuffer_ABI(bufs[0], 0);
-    FreeBuffer_ABI(bufs[1], 0);
-
     // move original exc info -> what
     std::stringstream ss;
     ss << msg << " [error code: " << code << ", file: " << fname
@@ -993,6 +1289,33 @@ error_to_exc(int code)
 }
 
 
+static void
+error_to_exc(int code)
+{
+    if( code == 0 )
+        return;
+
+    char *bufs[] = {nullptr, nullptr};
+    int lineno, c;
+    size_t n;
+
+    int err = LastErrorState_ABI(&c, &bufs[0], &n, &lineno, &bufs[1], &n, 0);
+    if( err ) {
+        throw std::runtime_error("failed to get last error state("
+                                 + std::to_string(err) + ")");
+    }
+    assert(bufs[0]);
+    assert(bufs[1]);
+    assert(code == c);
+    std::string msg(bufs[0]);
+    std::string fname(bufs[1]);
+    FreeBuffer_ABI(bufs[0], 0);
+    FreeBuffer_ABI(bufs[1], 0);
+
+    error_to_exc(code, msg, lineno, fname);
+}
+
+
 template<typename FromTy, typename ToTy>
 ToTy*
 set_to_new_array( const std::set<FromTy>& from, ToTy(*trans)(const FromTy&) )
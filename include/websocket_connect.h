@@ -19,6 +19,9 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #define WEBSOCKET_CONNECT_H
 
 #include <queue>
+#include <deque>
+#include <vector>
+#include <memory>
 #include <functional>
 #include <mutex>
 #include <thread>
@@ -28,17 +31,92 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include "_common.h"
 #include "../include/util.h"
 #include "threadsafe_queue.h"
+#include "message_ring.h"
 
 #include "../uWebSockets/uWS.h"
 
 namespace conn{
 
+class WebSocketClient;
+
+/*
+ * WebSocketEventLoop - the uWS::Hub, and the ONE thread running it, shared
+ * by every WebSocketClient in the process
+ *
+ * uWS isn't thread safe so everything that touches the hub or a socket is
+ * posted to the loop thread as a task; the callbacks find their client
+ * through the socket's user data. The loop is started by the first
+ * 'acquire' and stopped when the last client releases it.
+ *
+ * The loop thread never waits on a client: a message that doesn't fit in a
+ * client's (full) in ring is held back and moved in by a timer as the
+ * client's consumer frees slots. One slow consumer can't stall the others.
+ */
+class WebSocketEventLoop{
+    static const int DRAIN_INTERVAL_MSEC = 1;
+
+    uWS::Hub _hub;
+    uS::Async *_wakeup;
+    uS::Timer *_drain_timer;
+    std::thread _thread;
+    std::mutex _tasks_mtx;
+    std::vector<std::function<void()>> _tasks;
+    std::vector<std::function<void()>> _running; // loop thread only
+    std::vector<WebSocketClient*> _held_back; // loop thread only
+
+    static void
+    on_wakeup(uS::Async *a);
+
+    static void
+    on_drain(uS::Timer *t);
+
+    void
+    _run_tasks();
+
+public:
+    WebSocketEventLoop();
+
+    WebSocketEventLoop( const WebSocketEventLoop& ) = delete;
+
+    WebSocketEventLoop&
+    operator=( const WebSocketEventLoop& ) = delete;
+
+    ~WebSocketEventLoop();
+
+    /* the running loop, started if need be */
+    static std::shared_ptr<WebSocketEventLoop>
+    acquire();
+
+    /* run 'task' on the loop thread, after those already posted */
+    void
+    post(std::function<void()> task);
+
+    /* LOOP THREAD only */
+    uWS::Hub&
+    hub()
+    { return _hub; }
+
+    bool
+    in_loop_thread() const
+    { return std::this_thread::get_id() == _thread.get_id(); }
+
+    /* LOOP THREAD - drain 'client's held back messages until it's empty */
+    void
+    hold_back(WebSocketClient *client);
+
+    /* LOOP THREAD - stop draining 'client' */
+    void
+    release(WebSocketClient *client);
+};
+
+
 class WebSocketClient{
+    friend class WebSocketEventLoop;
+
     typedef uWS::WebSocket<uWS::CLIENT> uws_client_ty;
 
+    /* on the loop thread; the client is the socket's user data */
     struct Callbacks{
-        static WebSocketClient *wsc;
-
         static void
         on_connect(uws_client_ty *ws, uWS::HttpRequest r);
 
@@ -50,22 +128,18 @@ class WebSocketClient{
 
         static void
         on_message(uws_client_ty *ws, char *msg, size_t msg_len, uWS::OpCode op);
-
-        static void
-        on_signal(uS::Async *a);
     };
 
-    uWS::Hub _hub;
+    std::shared_ptr<WebSocketEventLoop> _loop;
     std::string _url;
-    uS::Async *_signal;
-    std::thread _thread;
-    ThreadSafeQueue<std::string> _in_queue; // in from server
+    MessageRing _in_ring; // in from server (loop thread -> listener)
+    std::deque<std::string> _held_back; // loop thread only, '_in_ring' full
     ThreadSafeQueue<std::string> _out_queue; // out to server
     std::condition_variable _init_cond;
-    bool _init_flag;
+    bool _init_flag; // connected, or failed to
+    bool _done_flag; // socket gone, the loop won't call back again
     std::mutex _init_mtx;
     uws_client_ty *_ws; // sync issues with is_connected() ?
-    Callbacks _callbacks;
 
     enum class CloseType {
         none,
@@ -74,28 +148,34 @@ class WebSocketClient{
     };
     volatile CloseType _closing_state;
 
-    struct SocketThreadTarget{
-        WebSocketClient *_wsc;
-        std::chrono::milliseconds _timeout;
-
-        void
-        operator()(){
-            util::debug_out("WebSocket", "SocketThreadTarget IN", _wsc,
-                            std::cout);
-            _wsc->_hub.connect(_wsc->_url, nullptr, {}, _timeout.count());
-            _wsc->_hub.run();
-            util::debug_out("WebSocket", "SocketThreadTarget OUT", _wsc,
-                            std::cout);
-        }
-
-        SocketThreadTarget(WebSocketClient *wsc,
-                             std::chrono::milliseconds timeout)
-            : _wsc(wsc), _timeout(timeout)
-        {}
-    };
+    /* LOOP THREAD - send what's queued, close if asked to */
+    void
+    _flush();
+
+    /* LOOP THREAD - into the in ring, or held back if it's full (block) */
+    void
+    _push_message(const char *msg, size_t msg_len);
+
+    /* LOOP THREAD - move held back messages into the in ring; true if none
+     * are left */
+    bool
+    _drain_held_back();
+
+    void
+    _set_flags(bool init, bool done);
+
+    /* wait for the loop to run everything posted before the call */
+    void
+    _sync_with_loop();
+
+    bool
+    _pop_message(std::string& msg);
 
 public:
-    WebSocketClient(std::string url);
+    WebSocketClient( std::string url,
+                     size_t in_capacity = MessageRing::DEF_CAPACITY,
+                     MessageRing::OverflowPolicy in_overflow_policy =
+                         MessageRing::OverflowPolicy::block );
 
     WebSocketClient( const WebSocketClient& ) = delete;
 
@@ -117,13 +197,36 @@ public:
     void
     send(std::string msg);
 
+    /* signal the consumer w/ an empty message after those already in */
     void
     push_empty_message()
-    { _in_queue.push(""); }
+    { _in_ring.interrupt(); }
 
     size_t
     nready()
-    { return _in_queue.size(); }
+    { return _in_ring.size(); }
+
+    /* messages dropped because the in ring was full (drop policy), or full
+     * with as many held back (block policy) */
+    unsigned long long
+    ndropped() const
+    { return _in_ring.ndropped(); }
+
+    /*
+     * zero-copy consumption: wait until at least one message is ready, then
+     * handle each in place; the message is valid until 'pop_message'
+     */
+    bool
+    wait_for_messages(std::chrono::milliseconds timeout)
+    { return _in_ring.wait_for(timeout); }
+
+    const std::string*
+    peek_message()
+    { return _in_ring.front(); }
+
+    void
+    pop_message()
+    { _in_ring.pop(); }
 
     std::string
     recv();
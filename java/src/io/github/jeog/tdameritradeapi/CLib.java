@@ -35,6 +35,10 @@ import com.sun.jna.ptr.PointerByReference;
 import io.github.jeog.tdameritradeapi.Auth.Credentials;
 import io.github.jeog.tdameritradeapi.TDAmeritradeAPI.CLibException;
 import io.github.jeog.tdameritradeapi.stream.StreamingSession;
+import io.github.jeog.tdameritradeapi.stream.LevelOneRecord;
+import io.github.jeog.tdameritradeapi.get.APIGetter;
+import io.github.jeog.tdameritradeapi.get.OptionChainTable;
+import io.github.jeog.tdameritradeapi.get.QuoteRecord;
 
 import com.sun.jna.Pointer;
 
@@ -409,6 +413,20 @@ public interface CLib extends Library {
         }       
     }
     
+    public static class _CandleTable_C extends _CProxy2 {
+        protected int
+        destroyNative() throws  CLibException {
+            return TDAmeritradeAPI.getCLib().CandleTable_Destroy_ABI(this, 0);
+        }
+    }
+    
+    public static class _OptionChainTable_C extends _CProxy2 {
+        protected int
+        destroyNative() throws  CLibException {
+            return TDAmeritradeAPI.getCLib().OptionChainTable_Destroy_ABI(this, 0);
+        }
+    }
+    
     public static class _AccountInfoGetter_C extends _Getter_C {
         protected int
         destroyNative() throws  CLibException {
@@ -595,6 +613,7 @@ public interface CLib extends Library {
     int StreamingCallbackType_to_string_ABI( int service, PointerByReference buffer, size_t[] n, int exc);
     int CommandType_to_string_ABI( int service, PointerByReference buffer, size_t[] n, int exc);
     int QOSType_to_string_ABI( int service, PointerByReference buffer, size_t[] n, int exc); 
+    int OverflowPolicyType_to_string_ABI( int policy, PointerByReference buffer, size_t[] n, int exc);
     int QuotesSubscriptionField_to_string_ABI( int service, PointerByReference buffer, size_t[] n, int exc);
     int OptionsSubscriptionField_to_string_ABI( int service, PointerByReference buffer, size_t[] n, int exc); 
     int ChartEquitySubscriptionField_to_string_ABI( int service, PointerByReference buffer, size_t[] n, int exc );
@@ -621,6 +640,10 @@ public interface CLib extends Library {
     int MoversIndex_to_string_ABI( int moversIndex, PointerByReference buffer, size_t[] n, int exc );
     int MoversDirectionType_to_string_ABI( int moversDirectionType, PointerByReference buffer, size_t[] n, int exc );
     int MoversChangeType_to_string_ABI( int moversChangeType, PointerByReference buffer, size_t[] n, int exc );
+    int EndpointClass_to_string_ABI( int endpointClass, PointerByReference buffer, size_t[] n, int exc );
+    int RequestLane_to_string_ABI( int requestLane, PointerByReference buffer, size_t[] n, int exc );
+    int QuoteAssetType_to_string_ABI( int quoteAssetType, PointerByReference buffer, size_t[] n, int exc );
+    int OptionChainColumn_to_string_ABI( int optionChainColumn, PointerByReference buffer, size_t[] n, int exc );
     
     /* AUTH */
     int LoadCredentials_ABI( String path, String password, Credentials._Credentials pCredentials, int exc );    
@@ -639,6 +662,23 @@ public interface CLib extends Library {
     int BuildOptionSymbol_ABI( String underlying, int month, int day, int year, int is_call, 
             double strike, PointerByReference buffer, size_t[] n, int exc);    
     int CheckOptionSymbol_ABI( String symbol, int exc );
+    int SetRequestLaneLimits_ABI( int lane, int maxConcurrent, long waitMSec, int burst, int exc );
+    int GetRequestLaneLimits_ABI( int lane, int[] maxConcurrent, long[] waitMSec, int[] burst, int exc );
+    int GetRequestLaneStats_ABI( int lane, int[] queued, int[] inFlight, long[] requests, 
+            long[] waitMSec, long[] maxWaitMSec, int exc );
+    int SetHTTP2Enabled_ABI( int enabled, int exc );
+    int IsHTTP2Enabled_ABI( int[] enabled, int exc );
+    int IsHTTP2Supported_ABI( int[] supported, int exc );
+    int GetHTTPStats_ABI( long[] requests, long[] connections, long[] http2Requests, int exc );
+    int Metrics_SetEnabled_ABI( int enabled, int exc );
+    int Metrics_IsEnabled_ABI( int[] enabled, int exc );
+    int Metrics_Reset_ABI( int exc );
+    int Metrics_GetText_ABI( PointerByReference buffer, size_t[] n, int exc );
+    int Metrics_GetJSON_ABI( PointerByReference buffer, size_t[] n, int exc );
+    int SetAPIBaseURL_ABI( String url, int exc );
+    int GetAPIBaseURL_ABI( PointerByReference buffer, size_t[] n, int exc );
+    int SetStreamerURL_ABI( String url, int exc );
+    int GetStreamerURL_ABI( PointerByReference buffer, size_t[] n, int exc );
 
     
     /*
@@ -654,16 +694,46 @@ public interface CLib extends Library {
     
     /* GETTERS (BASE) */
     int APIGetter_Get_ABI( _Getter_C pGetter, PointerByReference buffer, size_t[] n, int exc );    
+    int APIGetter_GetAsync_ABI( _Getter_C pGetter, APIGetter._AsyncCallbackWrapper callback, 
+            Pointer ctx, int exc );
+    int APIGetter_GetStream_ABI( _Getter_C pGetter, APIGetter._ChunkCallbackWrapper callback, 
+            Pointer ctx, int exc );
     int APIGetter_Close_ABI( _Getter_C pGetter, int exc );    
     int APIGetter_IsClosed_ABI( _Getter_C pGetter, int[] b, int exc );
+    int APIGetter_SetCoalesce_ABI( _Getter_C pGetter, int coalesce, int exc );
+    int APIGetter_IsCoalescing_ABI( _Getter_C pGetter, int[] b, int exc );
+    int APIGetter_SetCacheTTL_ABI( _Getter_C pGetter, long msec, int exc );
+    int APIGetter_GetCacheTTL_ABI( _Getter_C pGetter, long[] msec, int exc );
+    int APIGetter_InvalidateCache_ABI( _Getter_C pGetter, int exc );
     int APIGetter_SetTimeout_ABI( _Getter_C pGetter, long msec, int exc );
     int APIGetter_GetTimeout_ABI( _Getter_C pGetter, long[] msec, int exc );
     int APIGetter_SetWaitMSec_ABI( long msec, int exc );
     int APIGetter_GetWaitMSec_ABI( long[] msec, int exc );
     int APIGetter_GetDefWaitMSec_ABI( long[] msec, int exc );
     int APIGetter_WaitRemaining_ABI( long[] msec, int exc );
+    int APIGetter_SetBurst_ABI( int burst, int exc );
+    int APIGetter_GetBurst_ABI( int[] burst, int exc );
+    int APIGetter_SetEndpointWaitMSec_ABI( int endpointClass, long msec, int burst, int exc );
+    int APIGetter_GetEndpointWaitMSec_ABI( int endpointClass, long[] msec, int[] burst, int exc );
+    int APIGetter_EndpointWaitRemaining_ABI( int endpointClass, long[] msec, int exc );
     int APIGetter_ShareConnections_ABI( int b, int exc );
     int APIGetter_IsSharingConnections_ABI( int[] b, int exc);
+    int APIGetter_SetRetryPolicy_ABI( int endpointClass, APIGetter.RetryPolicy policy, int exc );
+    int APIGetter_GetRetryPolicy_ABI( int endpointClass, APIGetter.RetryPolicy policy, int exc );
+    int APIGetter_GetDefRetryPolicy_ABI( APIGetter.RetryPolicy policy, int exc );
+    int APIGetter_SetMaxConnections_ABI( int n, int exc );
+    int APIGetter_GetMaxConnections_ABI( int[] n, int exc );
+    int APIGetter_SetConnectionMaxIdleMSec_ABI( long msec, int exc );
+    int APIGetter_GetConnectionMaxIdleMSec_ABI( long[] msec, int exc );
+    int APIGetter_GetConnectionPoolStats_ABI( int[] inUse, int[] idle, long[] waits, 
+            long[] waitMSec, int exc );
+    int APIGetter_SetCacheEnabled_ABI( int enabled, int exc );
+    int APIGetter_IsCacheEnabled_ABI( int[] b, int exc );
+    int APIGetter_SetCacheMaxEntries_ABI( int n, int exc );
+    int APIGetter_GetCacheMaxEntries_ABI( int[] n, int exc );
+    int APIGetter_SetCacheDirectory_ABI( String directory, int exc );
+    int APIGetter_GetCacheDirectory_ABI( PointerByReference buffer, size_t[] n, int exc );
+    int APIGetter_ClearCache_ABI( int exc );
     
     /* QUOTE GETTER */
     int QuoteGetter_Create_ABI( Credentials._Credentials pCredentials, String symbol, 
@@ -671,6 +741,9 @@ public interface CLib extends Library {
     int QuoteGetter_Destroy_ABI( _QuoteGetter_C pGetter, int exc );    
     int QuoteGetter_GetSymbol_ABI(_QuoteGetter_C pGetter, PointerByReference buffer, size_t[] n, int exc );    
     int QuoteGetter_SetSymbol_ABI(_QuoteGetter_C pGetter, String symbol, int exc );
+    int QuoteGetter_SetBatchWindowMSec_ABI( long msec, int exc );
+    int QuoteGetter_GetBatchWindowMSec_ABI( long[] msec, int exc );
+    int QuoteGetter_GetRecord_ABI( _QuoteGetter_C pGetter, QuoteRecord record, int exc );
         
     /* QUOTES GETTERS*/
     int QuotesGetter_Create_ABI( Credentials._Credentials pCredentials, String[] symbols, size_t n, 
@@ -682,6 +755,8 @@ public interface CLib extends Library {
     int QuotesGetter_RemoveSymbol_ABI(_QuotesGetter_C pGetter, String symbol, int exc );
     int QuotesGetter_AddSymbols_ABI(_QuotesGetter_C pGetter, String[] symbols, size_t n, int exc ); 
     int QuotesGetter_RemoveSymbols_ABI(_QuotesGetter_C pGetter, String[] symbols, size_t n, int exc );
+    int QuotesGetter_GetRecords_ABI( _QuotesGetter_C pGetter, QuoteRecord records, size_t[] n, int exc );
+    int DecodeQuoteRecords_ABI( byte[] data, size_t dataLen, QuoteRecord records, size_t[] n, int exc );
     
     /* MARKET HOURS GETTER */
     int MarketHoursGetter_Create_ABI( Credentials._Credentials pCredentials, int marketType, String date,
@@ -713,6 +788,7 @@ public interface CLib extends Library {
     int HistoricalGetterBase_SetFrequency_ABI(  _Getter_C pGetter, int frequencyType, int frequency, int exc );
     int HistoricalGetterBase_IsExtendedHours_ABI(  _Getter_C pGetter, int[] b, int exc );
     int HistoricalGetterBase_SetExtendedHours_ABI(  _Getter_C pGetter, int b, int exc);
+    int HistoricalGetterBase_GetCandles_ABI( _Getter_C pGetter, _CandleTable_C pTable, int exc );
     
     /* HISTORICAL PERIOD GETTER */
     int HistoricalPeriodGetter_Create_ABI( Credentials._Credentials pCredentials, String symbol, 
@@ -734,6 +810,18 @@ public interface CLib extends Library {
     int HistoricalRangeGetter_SetEndMSecSinceEpoch_ABI(_HistoricalRangeGetter_C pGetter, long endMSecSinceEpcoh, int exc);
     int HistoricalRangeGetter_GetStartMSecSinceEpoch_ABI(_HistoricalRangeGetter_C pGetter, long[] endMSecSinceEpoch, int exc);
     int HistoricalRangeGetter_SetStartMSecSinceEpoch_ABI( _HistoricalRangeGetter_C pGetter, long endMSecSinceEpoch, int exc);   
+    int HistoricalRangeGetter_Backfill_ABI( _HistoricalRangeGetter_C pGetter, long chunkMSec, 
+            _CandleTable_C pTable, int exc );
+    
+    /* CANDLE TABLE */
+    int CandleTable_Create_ABI( byte[] data, size_t dataLen, _CandleTable_C pTable, int exc );
+    int CandleTable_Destroy_ABI( _CandleTable_C pTable, int exc );
+    int CandleTable_GetSize_ABI( _CandleTable_C pTable, size_t[] n, int exc );
+    int CandleTable_GetColumns_ABI( _CandleTable_C pTable, PointerByReference open, 
+            PointerByReference high, PointerByReference low, PointerByReference close, 
+            PointerByReference volume, PointerByReference datetime, int exc );
+    int CandleTable_Find_ABI( _CandleTable_C pTable, long startMSec, long endMSec, 
+            size_t[] begin, size_t[] end, int exc );
 
     /* OPTION CHAIN GETTER */
     int OptionChainGetter_Create_ABI( Credentials._Credentials pCredentials, String symbol, int strikesType,     
@@ -758,6 +846,21 @@ public interface CLib extends Library {
     int OptionChainGetter_SetExpMonth_ABI( _OptionChainGetter_C pGetter, int expMonth, int exc );
     int OptionChainGetter_GetOptionType_ABI( _OptionChainGetter_C pGetter, int[] optionType, int exc );
     int OptionChainGetter_SetOptionType_ABI( _OptionChainGetter_C pGetter, int optionType, int exc );
+    int OptionChainGetter_GetTable_ABI( _OptionChainGetter_C pGetter, _OptionChainTable_C pTable, int exc );
+    
+    /* OPTION CHAIN TABLE */
+    int OptionChainTable_Create_ABI( byte[] data, size_t dataLen, _OptionChainTable_C pTable, int exc );
+    int OptionChainTable_Destroy_ABI( _OptionChainTable_C pTable, int exc );
+    int OptionChainTable_GetSize_ABI( _OptionChainTable_C pTable, size_t[] n, int exc );
+    int OptionChainTable_GetColumn_ABI( _OptionChainTable_C pTable, int column, PointerByReference data, int exc );
+    int OptionChainTable_GetSymbols_ABI( _OptionChainTable_C pTable, PointerByReference symbols, int exc );
+    int OptionChainTable_GetStrikeIndex_ABI( _OptionChainTable_C pTable, PointerByReference index, int exc );
+    int OptionChainTable_FindExpirations_ABI( _OptionChainTable_C pTable, double min, double max, 
+            size_t[] begin, size_t[] end, int exc );
+    int OptionChainTable_FindStrikes_ABI( _OptionChainTable_C pTable, double min, double max, 
+            size_t[] begin, size_t[] end, int exc );
+    int OptionChainTable_Filter_ABI( _OptionChainTable_C pTable, OptionChainTable.Filter filters, 
+            size_t nFilters, Pointer rows, size_t[] n, int exc );
     
     /* OPTION CHAIN STRATEGY GETTER */
     int OptionChainStrategyGetter_Destroy_ABI( _OptionChainStrategyGetter_C pGetter, int exc);
@@ -911,6 +1014,18 @@ public interface CLib extends Library {
     int StreamingSession_IsActive_ABI( _StreamingSession_C pSession, int[] b, int exc);
     int StreamingSession_GetQOS_ABI( _StreamingSession_C pSession, int[] qos, int exc);
     int StreamingSession_SetQOS_ABI( _StreamingSession_C pSession, int qos, int[] result, int exc);
+    int StreamingSession_SetInboundBuffer_ABI( _StreamingSession_C pSession, size_t capacity,
+            int overflowPolicy, int exc);
+    int StreamingSession_GetInboundBuffer_ABI( _StreamingSession_C pSession, size_t[] capacity,
+            int[] overflowPolicy, int exc);
+    int StreamingSession_SetLevelOneBookEnabled_ABI( _StreamingSession_C pSession, int enabled,
+            int exc);
+    int StreamingSession_IsLevelOneBookEnabled_ABI( _StreamingSession_C pSession, int[] enabled,
+            int exc);
+    int StreamingSession_GetLevelOneRecord_ABI( _StreamingSession_C pSession, int service, 
+            String symbol, LevelOneRecord record, int[] found, int exc);
+    int StreamingSession_GetLevelOneRecordById_ABI( _StreamingSession_C pSession, int service, 
+            int symbolId, LevelOneRecord record, int[] found, int exc);
     
     /* STREAMING SUBCRIPTION (BASE) */
     int StreamingSubscription_Destroy_ABI( _StreamingSubscription_C pSubscription, int exc );
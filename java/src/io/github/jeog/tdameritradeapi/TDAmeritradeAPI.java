@@ -22,6 +22,8 @@ import java.util.Map;
 
 import com.sun.jna.ptr.PointerByReference;
 
+import org.json.JSONObject;
+
 import io.github.jeog.tdameritradeapi.TDAmeritradeAPI.CLibException;
 
 import com.sun.jna.Native;
@@ -174,6 +176,222 @@ public final class TDAmeritradeAPI {
     }
  
     
+    /* gets and executes are admitted through prioritized lanes */
+    public enum RequestLane implements CLib.ConvertibleEnum {
+        EXECUTION(0),
+        ACCOUNT(1),
+        MARKETDATA(2);
+        
+        private int value;
+        
+        RequestLane(int value){ this.value = value; }
+        
+        @Override
+        public int toInt() { return value; }
+        
+        public static RequestLane
+        fromInt(int i) {
+            for(RequestLane d : RequestLane.values()) {
+                if(d.toInt() == i)
+                    return d;
+            }
+            return null;
+        }
+        
+        @Override
+        public String
+        toString() {
+            return CLib.Helpers.convertibleEnumToString( this, 
+                    getCLib()::RequestLane_to_string_ABI);
+        }
+    };
+    
+    public static class RequestLaneLimits {
+        public final int maxConcurrent; // 0 is unlimited
+        public final long waitMSec; // 0 disables
+        public final int burst;
+        
+        private RequestLaneLimits(int maxConcurrent, long waitMSec, int burst){
+            this.maxConcurrent = maxConcurrent;
+            this.waitMSec = waitMSec;
+            this.burst = burst;
+        }
+        
+        @Override
+        public String
+        toString(){
+            return "RequestLaneLimits{maxConcurrent=" + maxConcurrent 
+                    + ", waitMSec=" + waitMSec + ", burst=" + burst + "}";
+        }
+    }
+    
+    public static class RequestLaneStats {
+        public final int queued;
+        public final int inFlight;
+        public final long requests;
+        public final long waitMSec; // total
+        public final long maxWaitMSec;
+        
+        private RequestLaneStats(int queued, int inFlight, long requests, long waitMSec,
+                long maxWaitMSec){
+            this.queued = queued;
+            this.inFlight = inFlight;
+            this.requests = requests;
+            this.waitMSec = waitMSec;
+            this.maxWaitMSec = maxWaitMSec;
+        }
+        
+        @Override
+        public String
+        toString(){
+            return "RequestLaneStats{queued=" + queued + ", inFlight=" + inFlight 
+                    + ", requests=" + requests + ", waitMSec=" + waitMSec 
+                    + ", maxWaitMSec=" + maxWaitMSec + "}";
+        }
+    }
+    
+    public static void
+    setRequestLaneLimits(RequestLane lane, int maxConcurrent, long waitMSec, int burst) 
+            throws CLibException {
+        int err = getCLib().SetRequestLaneLimits_ABI(lane.toInt(), maxConcurrent, waitMSec, 
+                burst, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+    
+    public static void
+    setRequestLaneLimits(RequestLane lane, int maxConcurrent) throws CLibException {
+        setRequestLaneLimits(lane, maxConcurrent, 0, 1);
+    }
+    
+    public static RequestLaneLimits
+    getRequestLaneLimits(RequestLane lane) throws CLibException {
+        int[] maxConcurrent = {0};
+        long[] waitMSec = {0};
+        int[] burst = {0};
+        int err = getCLib().GetRequestLaneLimits_ABI(lane.toInt(), maxConcurrent, waitMSec, 
+                burst, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new RequestLaneLimits(maxConcurrent[0], waitMSec[0], burst[0]);
+    }
+    
+    public static RequestLaneStats
+    getRequestLaneStats(RequestLane lane) throws CLibException {
+        int[] queued = {0};
+        int[] inFlight = {0};
+        long[] requests = {0};
+        long[] waitMSec = {0};
+        long[] maxWaitMSec = {0};
+        int err = getCLib().GetRequestLaneStats_ABI(lane.toInt(), queued, inFlight, requests, 
+                waitMSec, maxWaitMSec, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new RequestLaneStats(queued[0], inFlight[0], requests[0], waitMSec[0], 
+                maxWaitMSec[0]);
+    }
+    
+    /* multiplex concurrent requests on one connection, falls back to HTTP/1.1 */
+    public static void
+    setHTTP2Enabled(boolean enabled) throws CLibException {
+        CLib.Helpers.setInt(enabled ? 1 : 0, getCLib()::SetHTTP2Enabled_ABI);
+    }
+    
+    public static boolean
+    isHTTP2Enabled() throws CLibException {
+        return CLib.Helpers.getInt(getCLib()::IsHTTP2Enabled_ABI) != 0;
+    }
+    
+    public static boolean
+    isHTTP2Supported() throws CLibException {
+        return CLib.Helpers.getInt(getCLib()::IsHTTP2Supported_ABI) != 0;
+    }
+    
+    public static class HTTPStats {
+        public final long requests;
+        public final long connections; // new connections opened
+        public final long http2Requests;
+        
+        private HTTPStats(long requests, long connections, long http2Requests){
+            this.requests = requests;
+            this.connections = connections;
+            this.http2Requests = http2Requests;
+        }
+        
+        @Override
+        public String
+        toString(){
+            return "HTTPStats{requests=" + requests + ", connections=" + connections 
+                    + ", http2Requests=" + http2Requests + "}";
+        }
+    }
+    
+    public static HTTPStats
+    getHTTPStats() throws CLibException {
+        long[] requests = {0};
+        long[] connections = {0};
+        long[] http2Requests = {0};
+        int err = getCLib().GetHTTPStats_ABI(requests, connections, http2Requests, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new HTTPStats(requests[0], connections[0], http2Requests[0]);
+    }
+    
+    /* per-endpoint request counters and latency histograms */
+    public static void
+    setMetricsEnabled(boolean enabled) throws CLibException {
+        CLib.Helpers.setInt(enabled ? 1 : 0, getCLib()::Metrics_SetEnabled_ABI);
+    }
+    
+    public static boolean
+    isMetricsEnabled() throws CLibException {
+        return CLib.Helpers.getInt(getCLib()::Metrics_IsEnabled_ABI) != 0;
+    }
+    
+    public static void
+    resetMetrics() throws CLibException {
+        int err = getCLib().Metrics_Reset_ABI(0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+    
+    /* prometheus text exposition format */
+    public static String
+    getMetricsText() throws CLibException {
+        return CLib.Helpers.getString(getCLib()::Metrics_GetText_ABI);
+    }
+    
+    public static JSONObject
+    getMetrics() throws CLibException {
+        return new JSONObject( CLib.Helpers.getString(getCLib()::Metrics_GetJSON_ABI) );
+    }
+    
+    /* base of all REST urls, e.g "http://127.0.0.1:8477/v1/" for tools/mock_server.py */
+    public static void
+    setAPIBaseURL(String url) throws CLibException {
+        int err = getCLib().SetAPIBaseURL_ABI(url, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+    
+    public static String
+    getAPIBaseURL() throws CLibException {
+        return CLib.Helpers.getString(getCLib()::GetAPIBaseURL_ABI);
+    }
+    
+    /* streamer websocket url, "" to use the one from UserPrincipals */
+    public static void
+    setStreamerURL(String url) throws CLibException {
+        int err = getCLib().SetStreamerURL_ABI(url, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+    
+    public static String
+    getStreamerURL() throws CLibException {
+        return CLib.Helpers.getString(getCLib()::GetStreamerURL_ABI);
+    }
+    
     public static int
     combineHashCodes(int code, int ...codes) {                  
         int tot = code;
@@ -17,10 +17,18 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 
 package io.github.jeog.tdameritradeapi.get;
 
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+
 import org.json.JSONArray;
 import org.json.JSONException;
 import org.json.JSONObject;
 
+import com.sun.jna.Pointer;
+import com.sun.jna.Structure;
+import java.util.Arrays;
+import java.util.List;
+
 import io.github.jeog.tdameritradeapi.CLib;
 import io.github.jeog.tdameritradeapi.TDAmeritradeAPI;
 import io.github.jeog.tdameritradeapi.TDAmeritradeAPI.CLibException;
@@ -28,6 +36,116 @@ import io.github.jeog.tdameritradeapi.TDAmeritradeAPI.CLibException;
 
 public class APIGetter implements AutoCloseable {    
     private CLib._Getter_C pGetter;
+    
+    public static interface AsyncCallback {
+        /* called from the async loop thread w/ data OR exception(other is null) */
+        public void
+        call(Object data, CLibException exception);
+    }
+    
+    public static class _AsyncCallbackWrapper implements com.sun.jna.Callback {
+        private AsyncCallback callback;
+        
+        public _AsyncCallbackWrapper(AsyncCallback callback) {
+            this.callback = callback;
+        }
+        
+        public void 
+        call(int err, String buf, CLib.size_t n, Pointer ctx) {
+            asyncCallbacks.remove(this);
+            if( err != 0 ) {
+                callback.call(null, new CLibException(err));
+                return;
+            }
+            callback.call( (buf == null || buf.isEmpty()) ? null : parse(buf), null);
+        }
+    } 
+    
+    public static interface ChunkCallback {
+        /* called (in the calling thread) w/ each chunk of the body; false to stop */
+        public boolean
+        call(byte[] chunk);
+    }
+    
+    public static class _ChunkCallbackWrapper implements com.sun.jna.Callback {
+        private ChunkCallback callback;
+        private RuntimeException exception;
+        
+        public _ChunkCallbackWrapper(ChunkCallback callback) {
+            this.callback = callback;
+        }
+        
+        public int 
+        call(Pointer buf, CLib.size_t n, Pointer ctx) {
+            try {
+                return callback.call( buf.getByteArray(0, n.intValue()) ) ? 1 : 0;
+            }catch( RuntimeException exc ) {
+                exception = exc;
+                return 0;
+            }
+        }
+    } 
+    
+    /* keep callbacks from being collected until they're called */
+    private static final Set<_AsyncCallbackWrapper> asyncCallbacks = 
+            ConcurrentHashMap.newKeySet();
+    
+    private static Object
+    parse(String j) {
+        try {
+            return new JSONObject(j);
+        }catch( JSONException exc ) {
+            return new JSONArray(j);
+        }
+    }
+    
+    public enum EndpointClass implements CLib.ConvertibleEnum {
+        MARKETDATA(0),
+        ACCOUNTS(1),
+        INSTRUMENTS(2);
+        
+        private int value;
+        
+        EndpointClass(int value){ this.value = value; }
+        
+        @Override
+        public int toInt() { return value; }
+        
+        public static EndpointClass
+        fromInt(int i) {
+            for(EndpointClass d : EndpointClass.values()) {
+                if(d.toInt() == i)
+                    return d;
+            }
+            return null;
+        }
+        
+        @Override
+        public String
+        toString() {
+            return CLib.Helpers.convertibleEnumToString( this, 
+                    TDAmeritradeAPI.getCLib()::EndpointClass_to_string_ABI);
+        }
+    };
+    
+    public static final int RETRY_MAX_CODES = 8;
+    
+    /* how get() calls of an EndpointClass are retried/hedged */
+    public static class RetryPolicy extends Structure {
+        public int maxAttempts; // 1 disables retries
+        public long backoffMSec; // base of the exponential backoff
+        public long maxBackoffMSec;
+        public int[] statusCodes = new int[RETRY_MAX_CODES]; // retryable, 0 ends
+        public int[] curlCodes = new int[RETRY_MAX_CODES]; // retryable, 0 ends
+        public int hedgePercentile; // 0 disables hedging, or 50 - 99
+        
+        @Override
+        protected List<String> 
+        getFieldOrder() {
+            return Arrays.asList("maxAttempts", "backoffMSec", "maxBackoffMSec", 
+                    "statusCodes", "curlCodes", "hedgePercentile");
+        }
+    }
  
     public String
     getRaw() throws CLibException {
@@ -36,11 +154,29 @@ public class APIGetter implements AutoCloseable {
     
     public Object
     get() throws  CLibException {        
-        String j = getRaw();
-        try {
-            return new JSONObject(j);
-        }catch( JSONException exc ) {
-            return new JSONArray(j);
+        return parse( getRaw() );
+    }
+    
+    public void
+    getAsync(AsyncCallback callback) throws CLibException {
+        _AsyncCallbackWrapper cb = new _AsyncCallbackWrapper(callback);
+        asyncCallbacks.add(cb);
+        int err = TDAmeritradeAPI.getCLib().APIGetter_GetAsync_ABI(pGetter, cb, null, 0);
+        if( err != 0 ) {
+            asyncCallbacks.remove(cb);
+            throw new CLibException(err); 
+        }
+    }
+    
+    /* pass the body to callback as it arrives instead of buffering it */
+    public void
+    getStream(ChunkCallback callback) throws CLibException {
+        _ChunkCallbackWrapper cb = new _ChunkCallbackWrapper(callback);
+        int err = TDAmeritradeAPI.getCLib().APIGetter_GetStream_ABI(pGetter, cb, null, 0);
+        if( err != 0 ) {
+            if( cb.exception != null )
+                throw cb.exception;
+            throw new CLibException(err); 
         }
     }
     
@@ -58,6 +194,37 @@ public class APIGetter implements AutoCloseable {
         return b != 0;
     }
     
+    /* share the response of an identical in-flight get (default) */
+    public void
+    setCoalesce(boolean coalesce) throws CLibException{
+        CLib.Helpers.setInt(pGetter, coalesce ? 1 : 0, 
+                TDAmeritradeAPI.getCLib()::APIGetter_SetCoalesce_ABI);
+    }
+    
+    public boolean
+    isCoalescing() throws CLibException{
+        return CLib.Helpers.getInt(pGetter, 
+                TDAmeritradeAPI.getCLib()::APIGetter_IsCoalescing_ABI) != 0;
+    }
+    
+    /* how long responses from get() are cached (0 disables) */
+    public void
+    setCacheTTL(long msec) throws CLibException{
+        CLib.Helpers.setLong(pGetter, msec, TDAmeritradeAPI.getCLib()::APIGetter_SetCacheTTL_ABI);
+    }
+    
+    public long
+    getCacheTTL() throws CLibException{
+        return CLib.Helpers.getLong(pGetter, TDAmeritradeAPI.getCLib()::APIGetter_GetCacheTTL_ABI);
+    }
+    
+    public void
+    invalidateCache() throws CLibException{
+        int err = TDAmeritradeAPI.getCLib().APIGetter_InvalidateCache_ABI(pGetter, 0);
+        if( err != 0 )
+            throw new CLibException(err); 
+    }
+    
     public void
     setTimeout(long msec) throws CLibException{
         CLib.Helpers.setLong(pGetter, msec, TDAmeritradeAPI.getCLib()::APIGetter_SetTimeout_ABI);     
@@ -99,6 +266,184 @@ public class APIGetter implements AutoCloseable {
     waitRemaining() throws  CLibException {
         return CLib.Helpers.getLong( TDAmeritradeAPI.getCLib()::APIGetter_WaitRemaining_ABI);
     }
+    
+    static public void
+    setBurst( int burst ) throws CLibException {
+        CLib.Helpers.setInt(burst, TDAmeritradeAPI.getCLib()::APIGetter_SetBurst_ABI);
+    }
+    
+    static public int
+    getBurst() throws CLibException {
+        return CLib.Helpers.getInt( TDAmeritradeAPI.getCLib()::APIGetter_GetBurst_ABI);
+    }
+    
+    static public void
+    setEndpointWaitMSec( EndpointClass endpointClass, long msec, int burst ) 
+            throws CLibException {
+        int err = TDAmeritradeAPI.getCLib().APIGetter_SetEndpointWaitMSec_ABI(
+                endpointClass.toInt(), msec, burst, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+    
+    static public void
+    setEndpointWaitMSec( EndpointClass endpointClass, long msec ) throws CLibException {
+        setEndpointWaitMSec(endpointClass, msec, 1);
+    }
+    
+    static public long
+    getEndpointWaitMSec( EndpointClass endpointClass ) throws CLibException {
+        long[] msec = {0};
+        int[] burst = {0};
+        int err = TDAmeritradeAPI.getCLib().APIGetter_GetEndpointWaitMSec_ABI(
+                endpointClass.toInt(), msec, burst, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return msec[0];
+    }
+    
+    static public int
+    getEndpointBurst( EndpointClass endpointClass ) throws CLibException {
+        long[] msec = {0};
+        int[] burst = {0};
+        int err = TDAmeritradeAPI.getCLib().APIGetter_GetEndpointWaitMSec_ABI(
+                endpointClass.toInt(), msec, burst, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return burst[0];
+    }
+    
+    static public long
+    endpointWaitRemaining( EndpointClass endpointClass ) throws CLibException {
+        long[] msec = {0};
+        int err = TDAmeritradeAPI.getCLib().APIGetter_EndpointWaitRemaining_ABI(
+                endpointClass.toInt(), msec, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return msec[0];
+    }
+    
+    static public void
+    setRetryPolicy( EndpointClass endpointClass, RetryPolicy policy ) 
+            throws CLibException {
+        int err = TDAmeritradeAPI.getCLib().APIGetter_SetRetryPolicy_ABI(
+                endpointClass.toInt(), policy, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+    
+    static public RetryPolicy
+    getRetryPolicy( EndpointClass endpointClass ) throws CLibException {
+        RetryPolicy policy = new RetryPolicy();
+        int err = TDAmeritradeAPI.getCLib().APIGetter_GetRetryPolicy_ABI(
+                endpointClass.toInt(), policy, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return policy;
+    }
+    
+    static public RetryPolicy
+    getDefaultRetryPolicy() throws CLibException {
+        RetryPolicy policy = new RetryPolicy();
+        int err = TDAmeritradeAPI.getCLib().APIGetter_GetDefRetryPolicy_ABI(policy, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return policy;
+    }
+    
+    static public void
+    setMaxConnections( int n ) throws CLibException {
+        CLib.Helpers.setInt(n, TDAmeritradeAPI.getCLib()::APIGetter_SetMaxConnections_ABI);
+    }
+    
+    static public int
+    getMaxConnections() throws CLibException {
+        return CLib.Helpers.getInt( TDAmeritradeAPI.getCLib()::APIGetter_GetMaxConnections_ABI);
+    }
+    
+    static public void
+    setConnectionMaxIdleMSec( long msec ) throws CLibException {
+        CLib.Helpers.setLong(msec, TDAmeritradeAPI.getCLib()::APIGetter_SetConnectionMaxIdleMSec_ABI);
+    }
+    
+    static public long
+    getConnectionMaxIdleMSec() throws CLibException {
+        return CLib.Helpers.getLong( TDAmeritradeAPI.getCLib()::APIGetter_GetConnectionMaxIdleMSec_ABI);
+    }
+    
+    public static class ConnectionPoolStats {
+        public final int inUse;
+        public final int idle;
+        public final long waits;
+        public final long waitMSec;
+        
+        private ConnectionPoolStats(int inUse, int idle, long waits, long waitMSec){
+            this.inUse = inUse;
+            this.idle = idle;
+            this.waits = waits;
+            this.waitMSec = waitMSec;
+        }
+        
+        @Override
+        public String
+        toString(){
+            return "ConnectionPoolStats{inUse=" + inUse + ", idle=" + idle 
+                    + ", waits=" + waits + ", waitMSec=" + waitMSec + "}";
+        }
+    }
+    
+    static public ConnectionPoolStats
+    getConnectionPoolStats() throws CLibException {
+        int[] inUse = {0};
+        int[] idle = {0};
+        long[] waits = {0};
+        long[] waitMSec = {0};
+        int err = TDAmeritradeAPI.getCLib().APIGetter_GetConnectionPoolStats_ABI(
+                inUse, idle, waits, waitMSec, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new ConnectionPoolStats(inUse[0], idle[0], waits[0], waitMSec[0]);
+    }
+    
+    static public void
+    setCacheEnabled( boolean enabled ) throws CLibException {
+        CLib.Helpers.setInt(enabled ? 1 : 0, TDAmeritradeAPI.getCLib()::APIGetter_SetCacheEnabled_ABI);
+    }
+    
+    static public boolean
+    isCacheEnabled() throws CLibException {
+        return CLib.Helpers.getInt( TDAmeritradeAPI.getCLib()::APIGetter_IsCacheEnabled_ABI) != 0;
+    }
+    
+    static public void
+    setCacheMaxEntries( int n ) throws CLibException {
+        CLib.Helpers.setInt(n, TDAmeritradeAPI.getCLib()::APIGetter_SetCacheMaxEntries_ABI);
+    }
+    
+    static public int
+    getCacheMaxEntries() throws CLibException {
+        return CLib.Helpers.getInt( TDAmeritradeAPI.getCLib()::APIGetter_GetCacheMaxEntries_ABI);
+    }
+    
+    /* (existing) directory to also store cached responses in, "" for none */
+    static public void
+    setCacheDirectory( String directory ) throws CLibException {
+        int err = TDAmeritradeAPI.getCLib().APIGetter_SetCacheDirectory_ABI(directory, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+    
+    static public String
+    getCacheDirectory() throws CLibException {
+        return CLib.Helpers.getString( TDAmeritradeAPI.getCLib()::APIGetter_GetCacheDirectory_ABI);
+    }
+    
+    static public void
+    clearCache() throws CLibException {
+        int err = TDAmeritradeAPI.getCLib().APIGetter_ClearCache_ABI(0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
         
     protected APIGetter(CLib._Getter_C pGetter){
         this.pGetter = pGetter;    
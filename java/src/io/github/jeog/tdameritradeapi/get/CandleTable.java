@@ -0,0 +1,122 @@
+/*
+Copyright (C) 2019 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+package io.github.jeog.tdameritradeapi.get;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.DoubleBuffer;
+import java.nio.LongBuffer;
+
+import com.sun.jna.ptr.PointerByReference;
+
+import io.github.jeog.tdameritradeapi.CLib;
+import io.github.jeog.tdameritradeapi.TDAmeritradeAPI;
+import io.github.jeog.tdameritradeapi.TDAmeritradeAPI.CLibException;
+
+/*
+ * Price history decoded into OHLCV columns, w/o json. Rows are ordered by 
+ * datetime(msec since epoch), one row per datetime. Column buffers are 
+ * views into the table (no copy) and only valid while it's reachable.
+ */
+public class CandleTable {
+
+    private CLib._CandleTable_C proxy;
+
+    CandleTable( CLib._CandleTable_C proxy ) {
+        this.proxy = proxy;
+    }
+
+    /* decode the raw json of a historical get, e.g from getAsync */
+    public
+    CandleTable( String data ) throws CLibException {
+        byte[] b = data.getBytes();
+        proxy = new CLib._CandleTable_C();
+        int err = TDAmeritradeAPI.getCLib().CandleTable_Create_ABI(b,
+                new CLib.size_t(b.length), proxy, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+
+    public int
+    size() throws CLibException {
+        CLib.size_t[] n = {new CLib.size_t(0)};
+        int err = TDAmeritradeAPI.getCLib().CandleTable_GetSize_ABI(proxy, n, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return n[0].intValue();
+    }
+
+    public DoubleBuffer
+    getOpen() throws CLibException {
+        return column(0).asDoubleBuffer();
+    }
+
+    public DoubleBuffer
+    getHigh() throws CLibException {
+        return column(1).asDoubleBuffer();
+    }
+
+    public DoubleBuffer
+    getLow() throws CLibException {
+        return column(2).asDoubleBuffer();
+    }
+
+    public DoubleBuffer
+    getClose() throws CLibException {
+        return column(3).asDoubleBuffer();
+    }
+
+    public LongBuffer
+    getVolume() throws CLibException {
+        return column(4).asLongBuffer();
+    }
+
+    /* msec since epoch */
+    public LongBuffer
+    getDatetime() throws CLibException {
+        return column(5).asLongBuffer();
+    }
+
+    /* rows [begin, end) w/ startMSec <= datetime <= endMSec */
+    public long[]
+    find( long startMSec, long endMSec ) throws CLibException {
+        CLib.size_t[] b = {new CLib.size_t(0)};
+        CLib.size_t[] e = {new CLib.size_t(0)};
+        int err = TDAmeritradeAPI.getCLib().CandleTable_Find_ABI(proxy,
+                startMSec, endMSec, b, e, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new long[]{ b[0].longValue(), e[0].longValue() };
+    }
+
+    /* all columns are 8 bytes */
+    private ByteBuffer
+    column( int i ) throws CLibException {
+        PointerByReference[] p = new PointerByReference[6];
+        p[i] = new PointerByReference();
+        int err = TDAmeritradeAPI.getCLib().CandleTable_GetColumns_ABI(proxy,
+                p[0], p[1], p[2], p[3], p[4], p[5], 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        int n = size();
+        if( n == 0 )
+            return ByteBuffer.allocate(0);
+        return p[i].getValue().getByteBuffer(0, (long)n * 8)
+                .order(ByteOrder.nativeOrder());
+    }
+}
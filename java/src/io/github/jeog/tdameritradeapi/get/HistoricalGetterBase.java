@@ -131,6 +131,17 @@ public abstract class HistoricalGetterBase extends APIGetter {
         CLib.Helpers.setInt(getProxy(), extendedHours ? 1 : 0, 
                 TDAmeritradeAPI.getCLib()::HistoricalGetterBase_SetExtendedHours_ABI);
     }
+    
+    /* get() decoded directly into a CandleTable, w/o the json */
+    public CandleTable
+    getCandles() throws CLibException {
+        CLib._CandleTable_C pTable = new CLib._CandleTable_C();
+        int err = TDAmeritradeAPI.getCLib().HistoricalGetterBase_GetCandles_ABI(getProxy(), 
+                pTable, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new CandleTable(pTable);
+    }
  
     public static boolean
     isValidFrequency( FrequencyType frequencyType, int frequency ) {
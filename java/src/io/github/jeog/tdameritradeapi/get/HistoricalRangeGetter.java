@@ -59,6 +59,23 @@ public class HistoricalRangeGetter extends HistoricalGetterBase {
                 TDAmeritradeAPI.getCLib()::HistoricalRangeGetter_SetEndMSecSinceEpoch_ABI);
     }
     
+    /* the range in 'chunkMSec' requests (0 for the default) sent concurrently,
+       merged and de-duplicated by datetime */
+    public CandleTable
+    backfill( long chunkMSec ) throws CLibException {
+        CLib._CandleTable_C pTable = new CLib._CandleTable_C();
+        int err = TDAmeritradeAPI.getCLib().HistoricalRangeGetter_Backfill_ABI(getProxy(), 
+                chunkMSec, pTable, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new CandleTable(pTable);
+    }
+    
+    public CandleTable
+    backfill() throws CLibException {
+        return backfill(0);
+    }
+    
     @Override
     protected CLib._HistoricalRangeGetter_C
     getProxy(){
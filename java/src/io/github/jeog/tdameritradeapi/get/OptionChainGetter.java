@@ -377,6 +377,17 @@ public class OptionChainGetter extends APIGetter {
                 TDAmeritradeAPI.getCLib()::OptionChainGetter_SetOptionType_ABI);
     }
         
+    /* get() decoded directly into an OptionChainTable, w/o the json */
+    public OptionChainTable
+    getTable() throws CLibException {
+        CLib._OptionChainTable_C pTable = new CLib._OptionChainTable_C();
+        int err = TDAmeritradeAPI.getCLib().OptionChainGetter_GetTable_ABI(getProxy(), 
+                pTable, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new OptionChainTable(pTable);
+    }
+    
     protected static OptionStrikesValue.ByValue
     buildOptionStrikesValueByValue( OptionStrikes strikes ){
         switch(strikes.getType()) {
@@ -0,0 +1,232 @@
+/*
+Copyright (C) 2019 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+package io.github.jeog.tdameritradeapi.get;
+
+import java.nio.ByteOrder;
+import java.nio.DoubleBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+import com.sun.jna.Memory;
+import com.sun.jna.Native;
+import com.sun.jna.Pointer;
+import com.sun.jna.Structure;
+import com.sun.jna.ptr.PointerByReference;
+
+import io.github.jeog.tdameritradeapi.CLib;
+import io.github.jeog.tdameritradeapi.TDAmeritradeAPI;
+import io.github.jeog.tdameritradeapi.TDAmeritradeAPI.CLibException;
+
+/*
+ * An option chain decoded into columns (of doubles), w/o json. Rows are
+ * ordered by expiration, strike, then call before put. Column buffers are
+ * views into the table (no copy) and only valid while it's reachable.
+ */
+public class OptionChainTable {
+
+    public enum Column implements CLib.ConvertibleEnum {
+        STRIKE(0),
+        EXPIRATION(1),
+        DAYS_TO_EXP(2),
+        PUT_CALL(3),
+        BID(4),
+        ASK(5),
+        LAST(6),
+        MARK(7),
+        BID_SIZE(8),
+        ASK_SIZE(9),
+        TOTAL_VOLUME(10),
+        OPEN_INTEREST(11),
+        VOLATILITY(12),
+        DELTA(13),
+        GAMMA(14),
+        THETA(15),
+        VEGA(16),
+        RHO(17),
+        THEORETICAL_VALUE(18),
+        TIME_VALUE(19),
+        MULTIPLIER(20),
+        IN_THE_MONEY(21),
+        QUOTE_TIME(22);
+
+        private int value;
+
+        Column(int value){ this.value = value; }
+
+        @Override
+        public int toInt() { return value; }
+
+        public static Column
+        fromInt(int i) {
+            for(Column c : Column.values()) {
+                if(c.toInt() == i)
+                    return c;
+            }
+            return null;
+        }
+
+        @Override
+        public String
+        toString() {
+            return CLib.Helpers.convertibleEnumToString( this,
+                    TDAmeritradeAPI.getCLib()::OptionChainColumn_to_string_ABI);
+        }
+    };
+
+    /* rows w/ min <= column <= max; NaNs never match */
+    public static class Filter extends Structure {
+        public int column;
+        public double min;
+        public double max;
+
+        public Filter() {}
+
+        public Filter(Column column, double min, double max) {
+            this.column = column.toInt();
+            this.min = min;
+            this.max = max;
+        }
+
+        @Override
+        protected List<String>
+        getFieldOrder() { return Arrays.asList("column", "min", "max"); }
+    }
+
+    private CLib._OptionChainTable_C proxy;
+
+    OptionChainTable( CLib._OptionChainTable_C proxy ) {
+        this.proxy = proxy;
+    }
+
+    /* decode the raw json of an option chain get, e.g from getAsync */
+    public
+    OptionChainTable( String data ) throws CLibException {
+        byte[] b = data.getBytes();
+        proxy = new CLib._OptionChainTable_C();
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_Create_ABI(b,
+                new CLib.size_t(b.length), proxy, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+    }
+
+    public int
+    size() throws CLibException {
+        CLib.size_t[] n = {new CLib.size_t(0)};
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_GetSize_ABI(proxy, n, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return n[0].intValue();
+    }
+
+    public DoubleBuffer
+    getColumn( Column column ) throws CLibException {
+        PointerByReference p = new PointerByReference();
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_GetColumn_ABI(proxy,
+                column.toInt(), p, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        int n = size();
+        if( n == 0 )
+            return DoubleBuffer.allocate(0);
+        return p.getValue().getByteBuffer(0, (long)n * Double.BYTES)
+                .order(ByteOrder.nativeOrder()).asDoubleBuffer();
+    }
+
+    public List<String>
+    getSymbols() throws CLibException {
+        PointerByReference p = new PointerByReference();
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_GetSymbols_ABI(proxy, p, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        int n = size();
+        List<String> symbols = new ArrayList<String>(n);
+        if( n > 0 ) {
+            for( Pointer s : p.getValue().getPointerArray(0, n) )
+                symbols.add( s == null ? "" : s.getString(0) );
+        }
+        return symbols;
+    }
+
+    /* rows ordered by strike, expiration, then call before put */
+    public long[]
+    getStrikeIndex() throws CLibException {
+        PointerByReference p = new PointerByReference();
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_GetStrikeIndex_ABI(proxy, p, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return readSizeTs( p.getValue(), size() );
+    }
+
+    /* rows [begin, end) w/ min <= expiration(msec) <= max */
+    public long[]
+    findExpirations( double min, double max ) throws CLibException {
+        CLib.size_t[] b = {new CLib.size_t(0)};
+        CLib.size_t[] e = {new CLib.size_t(0)};
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_FindExpirations_ABI(proxy,
+                min, max, b, e, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new long[]{ b[0].longValue(), e[0].longValue() };
+    }
+
+    /* getStrikeIndex() [begin, end) w/ min <= strike <= max */
+    public long[]
+    findStrikes( double min, double max ) throws CLibException {
+        CLib.size_t[] b = {new CLib.size_t(0)};
+        CLib.size_t[] e = {new CLib.size_t(0)};
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_FindStrikes_ABI(proxy,
+                min, max, b, e, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return new long[]{ b[0].longValue(), e[0].longValue() };
+    }
+
+    /* rows matching all filters */
+    public long[]
+    filter( Filter... filters ) throws CLibException {
+        int n = size();
+        Filter[] f = (Filter[])(new Filter()).toArray( Math.max(filters.length, 1) );
+        for( int i = 0; i < filters.length; ++i ) {
+            f[i].column = filters[i].column;
+            f[i].min = filters[i].min;
+            f[i].max = filters[i].max;
+            f[i].write();
+        }
+        Memory rows = new Memory( (long)Math.max(n, 1) * Native.SIZE_T_SIZE );
+        CLib.size_t[] nRows = {new CLib.size_t(n)};
+        int err = TDAmeritradeAPI.getCLib().OptionChainTable_Filter_ABI(proxy,
+                f[0], new CLib.size_t(filters.length), rows, nRows, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return readSizeTs( rows, nRows[0].intValue() );
+    }
+
+    private static long[]
+    readSizeTs( Pointer p, int n ) {
+        if( n == 0 )
+            return new long[0];
+        if( Native.SIZE_T_SIZE == 8 )
+            return p.getLongArray(0, n);
+        long[] l = new long[n];
+        int[] i = p.getIntArray(0, n);
+        for( int j = 0; j < n; ++j )
+            l[j] = i[j] & 0xFFFFFFFFL;
+        return l;
+    }
+}
@@ -59,6 +59,29 @@ public class QuoteGetter extends APIGetter{
                 TDAmeritradeAPI.getCLib()::QuoteGetter_SetSymbol_ABI);
     }
     
+    /* batch get() calls made within 'msec' of each other into one request;
+       0 (default) disables, max 1000 */
+    public static void
+    setBatchWindowMSec( long msec ) throws CLibException {
+        CLib.Helpers.setLong(msec, TDAmeritradeAPI.getCLib()::QuoteGetter_SetBatchWindowMSec_ABI);
+    }
+    
+    public static long
+    getBatchWindowMSec() throws CLibException {
+        return CLib.Helpers.getLong( TDAmeritradeAPI.getCLib()::QuoteGetter_GetBatchWindowMSec_ABI);
+    }
+    
+    /* get() decoded directly into a QuoteRecord, w/o the json; a symbol 
+       not found is all 0s w/ AssetType.NONE */
+    public QuoteRecord
+    getRecord() throws CLibException {
+        QuoteRecord r = new QuoteRecord();
+        int err = TDAmeritradeAPI.getCLib().QuoteGetter_GetRecord_ABI(getProxy(), r, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return r;
+    }
+    
     @Override
     protected CLib._QuoteGetter_C
     getProxy(){
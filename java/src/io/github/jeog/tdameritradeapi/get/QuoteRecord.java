@@ -0,0 +1,158 @@
+/*
+Copyright (C) 2019 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+package io.github.jeog.tdameritradeapi.get;
+
+import java.util.Arrays;
+import java.util.List;
+
+import com.sun.jna.Pointer;
+import com.sun.jna.Structure;
+
+import io.github.jeog.tdameritradeapi.CLib;
+import io.github.jeog.tdameritradeapi.TDAmeritradeAPI;
+import io.github.jeog.tdameritradeapi.TDAmeritradeAPI.CLibException;
+
+/* 
+ * A quote decoded directly from the response, w/o json. Fields not in 
+ * the quote are 0 (see README_GET.md for which asset types have which). 
+ * 'symbol' points into the library's interned symbols, use getSymbol().
+ */
+public class QuoteRecord extends Structure {
+    
+    public enum AssetType implements CLib.ConvertibleEnum {
+        NONE(0),
+        EQUITY(1),
+        ETF(2),
+        OPTION(3),
+        INDEX(4),
+        MUTUAL_FUND(5),
+        FUTURE(6),
+        FUTURE_OPTION(7),
+        FOREX(8);
+        
+        private int value;
+        
+        AssetType(int value){ this.value = value; } 
+        
+        @Override
+        public int toInt() { return value; }
+        
+        public static AssetType
+        fromInt(int i) {
+            for(AssetType a : AssetType.values()) {
+                if(a.toInt() == i)
+                    return a;
+            }
+            return null;
+        }   
+        
+        @Override
+        public String
+        toString() {
+            return CLib.Helpers.convertibleEnumToString( this, 
+                    TDAmeritradeAPI.getCLib()::QuoteAssetType_to_string_ABI);
+        }    
+    };
+    
+    public Pointer symbol; // interned, valid for the life of the library
+    public int symbolId; // same id for the same symbol, starts at 1
+    public int assetType;
+    public double bidPrice;
+    public double askPrice;
+    public double lastPrice;
+    public double openPrice;
+    public double highPrice;
+    public double lowPrice;
+    public double closePrice;
+    public double netChange;
+    public double mark;
+    public double volatility;
+    public double high52Wk; // EQUITY, ETF, INDEX, MUTUAL_FUND
+    public double low52Wk;
+    public double peRatio; // EQUITY, ETF
+    public double divYield;
+    public double strikePrice; // OPTION
+    public double underlyingPrice;
+    public double delta;
+    public double gamma;
+    public double theta;
+    public double vega;
+    public double rho;
+    public double multiplier; // OPTION, FUTURE
+    public long bidSize;
+    public long askSize;
+    public long lastSize;
+    public long totalVolume;
+    public long openInterest; // OPTION, FUTURE
+    public long quoteTime; // msec since epoch
+    public long tradeTime;
+    
+    public String
+    getSymbol() {
+        return symbol == null ? "" : symbol.getString(0);
+    }
+    
+    public AssetType
+    getAssetType() {
+        return AssetType.fromInt(assetType);
+    }
+    
+    /* contiguous array for the ABI; pass element 0 */
+    public static QuoteRecord[]
+    newArray(int n) {
+        return (QuoteRecord[])(new QuoteRecord()).toArray( Math.max(n, 1) );
+    }
+    
+    /* decode the raw json of a quote(s) get, e.g from getAsync */
+    public static QuoteRecord[]
+    decode(String data) throws CLibException {
+        byte[] b = data.getBytes();
+        CLib.size_t[] n = {new CLib.size_t(0)};
+        int err = TDAmeritradeAPI.getCLib().DecodeQuoteRecords_ABI(b, 
+                new CLib.size_t(b.length), null, n, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        
+        QuoteRecord[] records = newArray( n[0].intValue() );
+        err = TDAmeritradeAPI.getCLib().DecodeQuoteRecords_ABI(b, 
+                new CLib.size_t(b.length), records[0], n, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        return Arrays.copyOf(records, n[0].intValue());
+    }
+    
+    @Override
+    protected List<String> 
+    getFieldOrder() {
+        return Arrays.asList("symbol", "symbolId", "assetType", "bidPrice", 
+                "askPrice", "lastPrice", "openPrice", "highPrice", "lowPrice", 
+                "closePrice", "netChange", "mark", "volatility", "high52Wk", 
+                "low52Wk", "peRatio", "divYield", "strikePrice", "underlyingPrice", 
+                "delta", "gamma", "theta", "vega", "rho", "multiplier", "bidSize", 
+                "askSize", "lastSize", "totalVolume", "openInterest", "quoteTime", 
+                "tradeTime");
+    }
+    
+    @Override
+    public String
+    toString() {
+        return String.format("QuoteRecord(symbol=%s, assetType=%s, bidPrice=%f, "
+                + "askPrice=%f, lastPrice=%f, totalVolume=%d)", getSymbol(), 
+                getAssetType(), bidPrice, askPrice, lastPrice, totalVolume);
+    }
+}
@@ -17,6 +17,7 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 
 package io.github.jeog.tdameritradeapi.get;
 
+import java.util.Arrays;
 import java.util.Set;
 
 import org.json.JSONObject;
@@ -80,6 +81,25 @@ public class QuotesGetter extends APIGetter{
         CLib.Helpers.setStrings(getProxy(), symbols, TDAmeritradeAPI.getCLib()::QuotesGetter_RemoveSymbols_ABI );
     }
     
+    /* get() decoded directly into QuoteRecords, w/o the json; pass a
+       previous QuoteRecord.newArray(n) to reuse it. Symbols not found 
+       are skipped so the array returned may be shorter. */
+    public QuoteRecord[]
+    getRecords(QuoteRecord[] records) throws CLibException {
+        CLib.size_t[] n = {new CLib.size_t(records.length)};
+        int err = TDAmeritradeAPI.getCLib().QuotesGetter_GetRecords_ABI(getProxy(), 
+                records[0], n, 0);
+        if( err != 0 )
+            throw new CLibException(err);
+        int nRecords = n[0].intValue();
+        return nRecords < records.length ? Arrays.copyOf(records, nRecords) : records;
+    }
+    
+    public QuoteRecord[]
+    getRecords() throws CLibException {
+        return getRecords( QuoteRecord.newArray(getSymbols().size()) );
+    }
+    
     protected CLib._QuotesGetter_C
     getProxy(){
         return (CLib._QuotesGetter_C)super.getProxy();
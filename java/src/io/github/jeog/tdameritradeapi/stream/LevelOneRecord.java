@@ -0,0 +1,75 @@
+/*
+Copyright (C) 2019 Jonathon Ogden <jeog.dev@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses.
+*/
+
+package io.github.jeog.tdameritradeapi.stream;
+
+import java.util.Arrays;
+import java.util.List;
+
+import com.sun.jna.Pointer;
+import com.sun.jna.Structure;
+
+import io.github.jeog.tdameritradeapi.CLib;
+
+/* 
+ * Latest value of every field of a level one symbol, copied out of the 
+ * session's book (see StreamingSession.getLevelOneRecord). 'fields' is 
+ * indexed by the service's field enum; fields not received yet are NaN.
+ * 'symbol' points into the library's interned symbols, use getSymbol().
+ */
+public class LevelOneRecord extends Structure {
+    
+    public static final int MAX_FIELDS = 53;
+    
+    public Pointer symbol; // interned, valid for the life of the library
+    public int symbolId; // same id for the same symbol, starts at 1
+    public int service;
+    public long timestamp; // of the last update (msec since epoch)
+    public long nUpdates;
+    public double[] fields = new double[MAX_FIELDS];
+    
+    public String
+    getSymbol() {
+        return symbol == null ? "" : symbol.getString(0);
+    }
+    
+    public StreamingSession.ServiceType
+    getService() {
+        return StreamingSession.ServiceType.fromInt(service);
+    }
+    
+    /* e.g getField(QuotesSubscription.FieldType.BID_PRICE) */
+    public double
+    getField( CLib.ConvertibleEnum field ) {
+        return fields[field.toInt()];
+    }
+    
+    @Override
+    protected List<String> 
+    getFieldOrder() {
+        return Arrays.asList("symbol", "symbolId", "service", "timestamp", 
+                "nUpdates", "fields");
+    }
+    
+    @Override
+    public String
+    toString() {
+        return String.format("LevelOneRecord(symbol=%s, service=%s, "
+                + "timestamp=%d, nUpdates=%d)", getSymbol(), getService(), 
+                timestamp, nUpdates);
+    }
+}
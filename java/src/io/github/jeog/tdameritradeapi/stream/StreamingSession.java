@@ -205,6 +205,37 @@ public class StreamingSession implements AutoCloseable {
         }
     };
     
+    /* what the session does w/ messages when its inbound buffer is full */
+    public enum OverflowPolicyType implements CLib.ConvertibleEnum {
+        BLOCK(0), // DEFAULT - hold back up to 'capacity' more, then drop
+        DROP(1); // drop new messages right away
+                
+        private int value;
+        
+        OverflowPolicyType(int value){ this.value = value; }   
+        
+        @Override
+        public int toInt() { return value; }
+        
+        public static OverflowPolicyType
+        fromInt(int i) {
+            for(OverflowPolicyType p : OverflowPolicyType.values()) {
+                if(p.toInt() == i)
+                    return p;
+            }
+            return null;
+        }  
+        
+        @Override
+        public String
+        toString() {
+            return CLib.Helpers.convertibleEnumToString( this,
+                    TDAmeritradeAPI.getCLib()::OverflowPolicyType_to_string_ABI);
+        }
+    };
+    
+    public static final long DEF_INBOUND_CAPACITY = 4096;
+    
     private CLib._StreamingSession_C pSession; 
     private _CallbackWrapper callback;
     
@@ -287,6 +318,80 @@ public class StreamingSession implements AutoCloseable {
         return (b[0] == 1);
     }
     
+    /* takes effect the next time the session is started */
+    public void
+    setInboundBuffer( long capacity, OverflowPolicyType overflowPolicy ) throws CLibException {
+        int err = TDAmeritradeAPI.getCLib().StreamingSession_SetInboundBuffer_ABI(pSession, 
+                new CLib.size_t(capacity), overflowPolicy.toInt(), 0);
+        if(err != 0)
+            throw new CLibException(err);
+    }
+    
+    public void
+    setInboundBuffer( long capacity ) throws CLibException {
+        setInboundBuffer(capacity, OverflowPolicyType.BLOCK);
+    }
+    
+    public long
+    getInboundBufferCapacity() throws CLibException {
+        CLib.size_t[] c = {new CLib.size_t(0)};
+        int[] p = {0};
+        int err = TDAmeritradeAPI.getCLib().StreamingSession_GetInboundBuffer_ABI(pSession, c, p, 0);
+        if(err != 0)
+            throw new CLibException(err);
+        return c[0].longValue();
+    }
+    
+    public OverflowPolicyType
+    getInboundBufferOverflowPolicy() throws CLibException {
+        CLib.size_t[] c = {new CLib.size_t(0)};
+        int[] p = {0};
+        int err = TDAmeritradeAPI.getCLib().StreamingSession_GetInboundBuffer_ABI(pSession, c, p, 0);
+        if(err != 0)
+            throw new CLibException(err);
+        return OverflowPolicyType.fromInt(p[0]);
+    }
+    
+    /* keep the latest value of every field of every level one symbol 
+     * (QUOTE, OPTION, LEVELONE_*); can't change while the session is active */
+    public void
+    setLevelOneBookEnabled( boolean enabled ) throws CLibException {
+        int err = TDAmeritradeAPI.getCLib().StreamingSession_SetLevelOneBookEnabled_ABI(pSession, 
+                enabled ? 1 : 0, 0);
+        if(err != 0)
+            throw new CLibException(err);
+    }
+    
+    public boolean
+    isLevelOneBookEnabled() throws CLibException {
+        return CLib.Helpers.getInt(pSession, 
+                TDAmeritradeAPI.getCLib()::StreamingSession_IsLevelOneBookEnabled_ABI) == 1;
+    }
+    
+    /* null if nothing has been received for the symbol */
+    public LevelOneRecord
+    getLevelOneRecord( ServiceType service, String symbol ) throws CLibException {
+        LevelOneRecord r = new LevelOneRecord();
+        int[] found = {0};
+        int err = TDAmeritradeAPI.getCLib().StreamingSession_GetLevelOneRecord_ABI(pSession, 
+                service.toInt(), symbol, r, found, 0);
+        if(err != 0)
+            throw new CLibException(err);
+        return (found[0] == 1) ? r : null;
+    }
+    
+    /* by LevelOneRecord.symbolId; doesn't look the symbol up (never blocks) */
+    public LevelOneRecord
+    getLevelOneRecord( ServiceType service, int symbolId ) throws CLibException {
+        LevelOneRecord r = new LevelOneRecord();
+        int[] found = {0};
+        int err = TDAmeritradeAPI.getCLib().StreamingSession_GetLevelOneRecordById_ABI(pSession, 
+                service.toInt(), symbolId, r, found, 0);
+        if(err != 0)
+            throw new CLibException(err);
+        return (found[0] == 1) ? r : null;
+    }
+    
     @Override
     public void close() throws CLibException {
         stop();        
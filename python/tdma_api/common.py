@@ -17,7 +17,8 @@
 
 """ tdma_api/common.py - functions/objects used across interfaces """
 
-from ctypes import c_uint, c_double
+import json
+from ctypes import c_uint, c_double, c_int, c_ulonglong
 from . import clib
 
 def build_option_symbol(underlying, month, day, year, is_call, strike):
@@ -41,3 +42,134 @@ def check_option_symbol(symbol):
     (Note, this only checks the *format* not if the option actually exists.
     """
     clib.call("CheckOptionSymbol_ABI", clib.PCHAR(symbol))
+
+
+REQUEST_LANE_EXECUTION = 0
+REQUEST_LANE_ACCOUNT = 1
+REQUEST_LANE_MARKETDATA = 2
+
+def set_request_lane_limits(lane, max_concurrent, wait_msec=0, burst=1):
+    """Set limits for a REQUEST_LANE_[] constant.
+
+        max_concurrent :: int :: requests in flight at once (0 is unlimited)
+        wait_msec      :: int :: msec between requests (0 disables)
+        burst          :: int :: requests allowed at once before waiting
+
+    (Lanes don't have limits by default. Execution requests always go ahead
+     of account requests which go ahead of market data requests.)
+    """
+    clib.call('SetRequestLaneLimits_ABI', c_int(lane), c_uint(max_concurrent),
+              c_ulonglong(wait_msec), c_uint(burst))
+
+def get_request_lane_limits(lane):
+    """Returns (max_concurrent, wait_msec, burst) for a REQUEST_LANE_[]."""
+    mc = c_uint()
+    w = c_ulonglong()
+    b = c_uint()
+    clib.call('GetRequestLaneLimits_ABI', c_int(lane), clib.REF(mc),
+              clib.REF(w), clib.REF(b))
+    return (mc.value, w.value, b.value)
+
+def get_request_lane_stats(lane):
+    """Returns stats for a REQUEST_LANE_[] constant as a dict:
+
+        'queued'        :: requests waiting to be admitted
+        'in_flight'     :: requests admitted and not done
+        'requests'      :: number of requests admitted
+        'wait_msec'     :: total milliseconds admitted requests waited
+        'max_wait_msec' :: longest wait
+    """
+    q = c_uint()
+    f = c_uint()
+    r = c_ulonglong()
+    w = c_ulonglong()
+    mw = c_ulonglong()
+    clib.call('GetRequestLaneStats_ABI', c_int(lane), clib.REF(q),
+              clib.REF(f), clib.REF(r), clib.REF(w), clib.REF(mw))
+    return {'queued':q.value, 'in_flight':f.value, 'requests':r.value,
+            'wait_msec':w.value, 'max_wait_msec':mw.value}
+
+def set_http2_enabled(enabled):
+    """Enable/disable HTTP/2 (disabled by default).
+
+    Concurrent requests are multiplexed as streams on one connection. Falls
+    back to HTTP/1.1 if libcurl or the server doesn't support HTTP/2.
+    """
+    clib.set_val('SetHTTP2Enabled_ABI', c_int, enabled)
+
+def is_http2_enabled():
+    """Returns if HTTP/2 is enabled."""
+    return bool(clib.get_val('IsHTTP2Enabled_ABI', c_int))
+
+def is_http2_supported():
+    """Returns if the libcurl the library uses supports HTTP/2."""
+    return bool(clib.get_val('IsHTTP2Supported_ABI', c_int))
+
+def get_http_stats():
+    """Returns HTTP stats (since the library was loaded) as a dict:
+
+        'requests'       :: completed requests
+        'connections'    :: new connections they opened
+        'http2_requests' :: requests that used HTTP/2
+    """
+    r = c_ulonglong()
+    c = c_ulonglong()
+    h = c_ulonglong()
+    clib.call('GetHTTPStats_ABI', clib.REF(r), clib.REF(c), clib.REF(h))
+    return {'requests':r.value, 'connections':c.value,
+            'http2_requests':h.value}
+
+def set_metrics_enabled(enabled):
+    """Enable/disable request metrics (enabled by default)."""
+    clib.set_val('Metrics_SetEnabled_ABI', c_int, enabled)
+
+def is_metrics_enabled():
+    """Returns if request metrics are enabled."""
+    return bool(clib.get_val('Metrics_IsEnabled_ABI', c_int))
+
+def reset_metrics():
+    """Clear all request metrics."""
+    clib.call('Metrics_Reset_ABI')
+
+def get_metrics_text():
+    """Returns request metrics in prometheus text exposition format."""
+    return clib.get_str('Metrics_GetText_ABI')
+
+def get_metrics():
+    """Returns request metrics as a dict:
+
+        'token_refreshes' :: access token refreshes
+        'streaming_dropped' :: streaming messages dropped because a
+                               session's inbound buffer was full
+        'endpoints'       :: dict of endpoint (e.g 'GET marketdata/{}/quotes')
+                             to a dict of 'requests', 'errors', 'retries',
+                             'hedges', 'status_codes' and 'latency_usec'
+                             (phase to count/min/max/mean/percentiles)
+    """
+    return json.loads(clib.get_str('Metrics_GetJSON_ABI'))
+
+def set_api_base_url(url):
+    """Set the base of all REST urls (e.g to point at tools/mock_server.py).
+
+    url :: str :: 'http://' or 'https://' url, e.g 'http://127.0.0.1:8477/v1/'
+
+    throws -> LibraryNotLoaded, CLibException
+    """
+    clib.set_str('SetAPIBaseURL_ABI', url)
+
+def get_api_base_url():
+    """Returns the base of all REST urls."""
+    return clib.get_str('GetAPIBaseURL_ABI')
+
+def set_streamer_url(url):
+    """Set the streamer websocket url, '' to use the one from UserPrincipals.
+
+    url :: str :: 'ws://' or 'wss://' url, e.g 'ws://127.0.0.1:8477/ws'
+
+    throws -> LibraryNotLoaded, CLibException
+    """
+    clib.set_str('SetStreamerURL_ABI', url)
+
+def get_streamer_url():
+    """Returns the streamer websocket url ('' if from UserPrincipals)."""
+    return clib.get_str('GetStreamerURL_ABI')
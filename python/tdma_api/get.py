@@ -45,7 +45,10 @@ https://github.com/jeog/TDAmeritradeAPI/blob/master/README_GET.md
 """
 
 from ctypes import byref as _REF, c_int, c_ulonglong, c_double, \
-                    Union as _Union, c_uint, c_longlong
+                    Union as _Union, Structure as _Structure, c_uint, c_longlong, c_char_p, c_size_t, \
+                    c_void_p, CFUNCTYPE, POINTER, c_char, string_at
+from itertools import count as _count
+import threading
 import json
 
 from . import clib
@@ -159,12 +162,61 @@ ORDER_STATUS_TYPE_FILLED = 13
 ORDER_STATUS_TYPE_EXPIRED = 14
 ORDER_STATUS_TYPE_ALL = 15
 
+ENDPOINT_CLASS_MARKETDATA = 0
+ENDPOINT_CLASS_ACCOUNTS = 1
+ENDPOINT_CLASS_INSTRUMENTS = 2
+
+QUOTE_ASSET_TYPE_NONE = 0
+QUOTE_ASSET_TYPE_EQUITY = 1
+QUOTE_ASSET_TYPE_ETF = 2
+QUOTE_ASSET_TYPE_OPTION = 3
+QUOTE_ASSET_TYPE_INDEX = 4
+QUOTE_ASSET_TYPE_MUTUAL_FUND = 5
+QUOTE_ASSET_TYPE_FUTURE = 6
+QUOTE_ASSET_TYPE_FUTURE_OPTION = 7
+QUOTE_ASSET_TYPE_FOREX = 8
+
+OPTION_CHAIN_COLUMN_STRIKE = 0
+OPTION_CHAIN_COLUMN_EXPIRATION = 1
+OPTION_CHAIN_COLUMN_DAYS_TO_EXP = 2
+OPTION_CHAIN_COLUMN_PUT_CALL = 3
+OPTION_CHAIN_COLUMN_BID = 4
+OPTION_CHAIN_COLUMN_ASK = 5
+OPTION_CHAIN_COLUMN_LAST = 6
+OPTION_CHAIN_COLUMN_MARK = 7
+OPTION_CHAIN_COLUMN_BID_SIZE = 8
+OPTION_CHAIN_COLUMN_ASK_SIZE = 9
+OPTION_CHAIN_COLUMN_TOTAL_VOLUME = 10
+OPTION_CHAIN_COLUMN_OPEN_INTEREST = 11
+OPTION_CHAIN_COLUMN_VOLATILITY = 12
+OPTION_CHAIN_COLUMN_DELTA = 13
+OPTION_CHAIN_COLUMN_GAMMA = 14
+OPTION_CHAIN_COLUMN_THETA = 15
+OPTION_CHAIN_COLUMN_VEGA = 16
+OPTION_CHAIN_COLUMN_RHO = 17
+OPTION_CHAIN_COLUMN_THEORETICAL_VALUE = 18
+OPTION_CHAIN_COLUMN_TIME_VALUE = 19
+OPTION_CHAIN_COLUMN_MULTIPLIER = 20
+OPTION_CHAIN_COLUMN_IN_THE_MONEY = 21
+OPTION_CHAIN_COLUMN_QUOTE_TIME = 22
+
 
 class _Getter_C(clib._CProxy2):
     """C struct representing Getter_C type."""
     pass
 
 
+ASYNC_CALLBACK_FUNC_TYPE = CFUNCTYPE(None, c_int, c_char_p, c_size_t, c_void_p)
+
+CHUNK_CALLBACK_FUNC_TYPE = CFUNCTYPE(c_int, POINTER(c_char), c_size_t,
+                                     c_void_p)
+
+# keep async callback wrappers alive until they're called
+_async_callbacks = {}
+_async_callbacks_mtx = threading.Lock()
+_async_callbacks_key = _count(1)
+
+
 def get_def_wait_msec():
     """get default minimum wait milliseconds between .get() calls"""
     return clib.get_val('APIGetter_GetDefWaitMSec_ABI', c_ulonglong)
@@ -181,6 +233,307 @@ def wait_remaining():
     """milliseconds before .get() can be called without blocking"""
     return clib.get_val("APIGetter_WaitRemaining_ABI", c_ulonglong)
 
+def get_burst():
+    """get max number of .get() calls that can be made without waiting"""
+    return clib.get_val('APIGetter_GetBurst_ABI', c_uint)
+
+def set_burst(burst):
+    """set max number of .get() calls that can be made without waiting"""
+    clib.set_val('APIGetter_SetBurst_ABI', c_uint, burst)
+
+def get_endpoint_wait_msec(endpoint_class):
+    """get (wait milliseconds, burst) for an ENDPOINT_CLASS_[] constant"""
+    w = c_ulonglong()
+    b = c_uint()
+    clib.call('APIGetter_GetEndpointWaitMSec_ABI', c_int(endpoint_class),
+              _REF(w), _REF(b))
+    return (w.value, b.value)
+
+def set_endpoint_wait_msec(endpoint_class, msec, burst=1):
+    """set wait milliseconds and burst for an ENDPOINT_CLASS_[] constant
+
+    This is in addition to the global wait/burst; 0 msec disables (default).
+    """
+    clib.call('APIGetter_SetEndpointWaitMSec_ABI', c_int(endpoint_class),
+              c_ulonglong(msec), c_uint(burst))
+
+def endpoint_wait_remaining(endpoint_class):
+    """milliseconds before .get() of an ENDPOINT_CLASS_[] won't block"""
+    w = c_ulonglong()
+    clib.call('APIGetter_EndpointWaitRemaining_ABI', c_int(endpoint_class),
+              _REF(w))
+    return w.value
+
+RETRY_MAX_CODES = 8
+
+class RetryPolicy(_Structure):
+    """How .get() calls of an ENDPOINT_CLASS_[] are retried/hedged.
+
+        max_attempts     :: int :: 1 disables retries
+        backoff_msec     :: int :: base of the exponential backoff
+        max_backoff_msec :: int :: max backoff (before jitter)
+        status_codes     :: int[8] :: retryable HTTP codes, 0 ends
+        curl_codes       :: int[8] :: retryable curl codes, 0 ends
+        hedge_percentile :: int :: 0 disables hedging, or 50 - 99
+    """
+    _fields_ = [
+        ("max_attempts", c_uint),
+        ("backoff_msec", c_ulonglong),
+        ("max_backoff_msec", c_ulonglong),
+        ("status_codes", c_int * RETRY_MAX_CODES),
+        ("curl_codes", c_int * RETRY_MAX_CODES),
+        ("hedge_percentile", c_uint)
+        ]
+
+    def __str__(self):
+        return "RetryPolicy(max_attempts=%i, backoff_msec=%i, " \
+               "max_backoff_msec=%i, status_codes=%s, curl_codes=%s, " \
+               "hedge_percentile=%i)" % (self.max_attempts, self.backoff_msec,
+                self.max_backoff_msec, [c for c in self.status_codes if c],
+                [c for c in self.curl_codes if c], self.hedge_percentile)
+
+def get_retry_policy(endpoint_class):
+    """get RetryPolicy for an ENDPOINT_CLASS_[] constant"""
+    p = RetryPolicy()
+    clib.call('APIGetter_GetRetryPolicy_ABI', c_int(endpoint_class), _REF(p))
+    return p
+
+def set_retry_policy(endpoint_class, policy):
+    """set RetryPolicy for an ENDPOINT_CLASS_[] constant"""
+    clib.call('APIGetter_SetRetryPolicy_ABI', c_int(endpoint_class),
+              _REF(policy))
+
+def get_def_retry_policy():
+    """get default RetryPolicy (no retries, no hedging)"""
+    p = RetryPolicy()
+    clib.call('APIGetter_GetDefRetryPolicy_ABI', _REF(p))
+    return p
+
+class QuoteRecord(_Structure):
+    """A quote decoded directly from the response, w/o json.
+
+    Fields not in the quote are 0. 'symbol_ptr' points into the library's
+    interned symbols (valid for the life of the library); use 'symbol'.
+    An array of these can be viewed w/ numpy.ctypeslib.as_array(records).
+
+        asset_type :: int :: QUOTE_ASSET_TYPE_[] constant
+        quote_time, trade_time :: int :: msec since epoch
+
+    (see README_GET.md for which asset types have which fields)
+    """
+    _fields_ = [
+        ("symbol_ptr", c_void_p),
+        ("symbol_id", c_uint),
+        ("asset_type", c_int)
+        ] + [(f, c_double) for f in (
+        "bid_price", "ask_price", "last_price", "open_price", "high_price",
+        "low_price", "close_price", "net_change", "mark", "volatility",
+        "high_52wk", "low_52wk", "pe_ratio", "div_yield", "strike_price",
+        "underlying_price", "delta", "gamma", "theta", "vega", "rho",
+        "multiplier")
+        ] + [(f, c_longlong) for f in (
+        "bid_size", "ask_size", "last_size", "total_volume", "open_interest",
+        "quote_time", "trade_time")
+        ]
+
+    @property
+    def symbol(self):
+        return string_at(self.symbol_ptr).decode() if self.symbol_ptr else ""
+
+    def __str__(self):
+        return "QuoteRecord(symbol=%s, asset_type=%i, bid_price=%f, " \
+               "ask_price=%f, last_price=%f, total_volume=%i)" % (self.symbol,
+                self.asset_type, self.bid_price, self.ask_price,
+                self.last_price, self.total_volume)
+
+def decode_quote_records(data):
+    """Decode the raw json(str) of a quote(s) get into a QuoteRecord array."""
+    b = data.encode() if isinstance(data, str) else data
+    n = c_size_t(0)
+    clib.call('DecodeQuoteRecords_ABI', c_char_p(b), c_size_t(len(b)), None,
+              _REF(n))
+    records = (QuoteRecord * n.value)()
+    clib.call('DecodeQuoteRecords_ABI', c_char_p(b), c_size_t(len(b)),
+              records, _REF(n))
+    return records
+
+class OptionChainFilter(_Structure):
+    """OptionChainTable rows w/ min <= column <= max; NaNs never match.
+
+        column :: int :: OPTION_CHAIN_COLUMN_[] constant
+    """
+    _fields_ = [
+        ("column", c_int),
+        ("min", c_double),
+        ("max", c_double)
+        ]
+
+    def __init__(self, column, min=float('-inf'), max=float('inf')):
+        super().__init__(column, min, max)
+
+class _OptionChainTable_C(clib._CProxy2):
+    """C struct representing OptionChainTable_C type."""
+    pass
+
+class OptionChainTable(clib._ProxyBase):
+    """OptionChainTable - option chain decoded into columns, w/o json.
+
+        def __init__(self, data):
+
+            data :: str :: raw json of an option chain get (or use
+                           _OptionChainGetterBase.get_table())
+
+    Rows are ordered by expiration, strike, then call before put. Columns
+    (all doubles, OPTION_CHAIN_COLUMN_[] constants) are views into the
+    table, not copies; use numpy.ctypeslib.as_array(table.column(c)).
+
+    ALL METHODS THROW -> LibraryNotLoaded, CLibException
+    """
+    def __init__(self, data):
+        b = data.encode() if isinstance(data, str) else data
+        super().__init__(c_char_p(b), c_size_t(len(b)))
+
+    @classmethod
+    def _cproxy_type(cls):
+        return _OptionChainTable_C
+
+    @classmethod
+    def _from_cproxy(cls, obj):
+        table = cls.__new__(cls)
+        table._obj = obj
+        table._alive = True
+        return table
+
+    def _view(self, ctype, ptr):
+        a = (ctype * len(self)).from_address(ptr.value) if ptr.value \
+            else (ctype * 0)()
+        a._table = self # keep the table alive w/ the view
+        return a
+
+    def __len__(self):
+        return clib.get_val(self._abi('GetSize'), c_size_t, self._obj)
+
+    def column(self, column):
+        """Returns (c_double * len) view of an OPTION_CHAIN_COLUMN_[] column."""
+        p = c_void_p()
+        clib.call(self._abi('GetColumn'), _REF(self._obj), c_int(column),
+                  _REF(p))
+        return self._view(c_double, p)
+
+    def symbols(self):
+        """Returns list of the option symbols, by row."""
+        p = c_void_p()
+        clib.call(self._abi('GetSymbols'), _REF(self._obj), _REF(p))
+        return [string_at(s).decode() if s else ""
+                for s in self._view(c_void_p, p)]
+
+    def strike_index(self):
+        """Returns (c_size_t * len) view of rows ordered by strike, expiration,
+        then call before put."""
+        p = c_void_p()
+        clib.call(self._abi('GetStrikeIndex'), _REF(self._obj), _REF(p))
+        return self._view(c_size_t, p)
+
+    def find_expirations(self, min, max):
+        """Returns rows (begin, end) w/ min <= expiration(msec) <= max."""
+        b, e = c_size_t(), c_size_t()
+        clib.call(self._abi('FindExpirations'), _REF(self._obj), c_double(min),
+                  c_double(max), _REF(b), _REF(e))
+        return b.value, e.value
+
+    def find_strikes(self, min, max):
+        """Returns strike_index() (begin, end) w/ min <= strike <= max."""
+        b, e = c_size_t(), c_size_t()
+        clib.call(self._abi('FindStrikes'), _REF(self._obj), c_double(min),
+                  c_double(max), _REF(b), _REF(e))
+        return b.value, e.value
+
+    def filter(self, *filters):
+        """Returns (c_size_t * n) of rows matching all OptionChainFilters."""
+        f = (OptionChainFilter * len(filters))(*filters)
+        rows = (c_size_t * len(self))()
+        n = c_size_t(len(rows))
+        clib.call(self._abi('Filter'), _REF(self._obj), f,
+                  c_size_t(len(filters)), rows, _REF(n))
+        return (c_size_t * n.value).from_buffer(rows)
+
+class _CandleTable_C(clib._CProxy2):
+    """C struct representing CandleTable_C type."""
+    pass
+
+class CandleTable(clib._ProxyBase):
+    """CandleTable - price history decoded into OHLCV columns, w/o json.
+
+        def __init__(self, data):
+
+            data :: str :: raw json of a historical get (or use
+                           _HistoricalGetterBase.get_candles())
+
+    Rows are ordered by datetime(msec since epoch), one row per datetime.
+    Columns are views into the table, not copies; use
+    numpy.ctypeslib.as_array(table.close()).
+
+    ALL METHODS THROW -> LibraryNotLoaded, CLibException
+    """
+    def __init__(self, data):
+        b = data.encode() if isinstance(data, str) else data
+        super().__init__(c_char_p(b), c_size_t(len(b)))
+
+    @classmethod
+    def _cproxy_type(cls):
+        return _CandleTable_C
+
+    @classmethod
+    def _from_cproxy(cls, obj):
+        table = cls.__new__(cls)
+        table._obj = obj
+        table._alive = True
+        return table
+
+    def _column(self, i, ctype):
+        p = [None] * 6
+        p[i] = c_void_p()
+        clib.call(self._abi('GetColumns'), _REF(self._obj),
+                  *(_REF(x) if x is not None else None for x in p))
+        a = (ctype * len(self)).from_address(p[i].value) if p[i].value \
+            else (ctype * 0)()
+        a._table = self # keep the table alive w/ the view
+        return a
+
+    def __len__(self):
+        return clib.get_val(self._abi('GetSize'), c_size_t, self._obj)
+
+    def open(self):
+        """Returns (c_double * len) view of open prices."""
+        return self._column(0, c_double)
+
+    def high(self):
+        """Returns (c_double * len) view of high prices."""
+        return self._column(1, c_double)
+
+    def low(self):
+        """Returns (c_double * len) view of low prices."""
+        return self._column(2, c_double)
+
+    def close(self):
+        """Returns (c_double * len) view of close prices."""
+        return self._column(3, c_double)
+
+    def volume(self):
+        """Returns (c_longlong * len) view of volumes."""
+        return self._column(4, c_longlong)
+
+    def datetime(self):
+        """Returns (c_longlong * len) view of datetimes(msec since epoch)."""
+        return self._column(5, c_longlong)
+
+    def find(self, start_msec, end_msec):
+        """Returns rows (begin, end) w/ start_msec <= datetime <= end_msec."""
+        b, e = c_size_t(), c_size_t()
+        clib.call(self._abi('Find'), _REF(self._obj), c_longlong(start_msec),
+                  c_longlong(end_msec), _REF(b), _REF(e))
+        return b.value, e.value
+
 def share_connections(share):
     """True to make new getters share TCP/HTTP Connection. (default)"""
     clib.set_val('APIGetter_ShareConnections_ABI', c_int, share)
@@ -189,6 +542,67 @@ def is_sharing_connections():
     """returns if newly created getters will share TCP/HTTP Connection."""
     return bool(clib.get_val("APIGetter_IsSharingConnections_ABI", c_int))
 
+def set_max_connections(n):
+    """Set max connections in the shared connection pool (min of 1)."""
+    clib.set_val('APIGetter_SetMaxConnections_ABI', c_uint, n)
+
+def get_max_connections():
+    """Returns max connections in the shared connection pool."""
+    return clib.get_val('APIGetter_GetMaxConnections_ABI', c_uint)
+
+def set_connection_max_idle_msec(msec):
+    """Set milliseconds an idle pooled connection is kept alive."""
+    clib.set_val('APIGetter_SetConnectionMaxIdleMSec_ABI', c_ulonglong, msec)
+
+def get_connection_max_idle_msec():
+    """Returns milliseconds an idle pooled connection is kept alive."""
+    return clib.get_val('APIGetter_GetConnectionMaxIdleMSec_ABI', c_ulonglong)
+
+def get_connection_pool_stats():
+    """Returns shared connection pool stats as a dict:
+
+        'in_use'    :: connections checked out by getters
+        'idle'      :: warm connections waiting in the pool
+        'waits'     :: number of times a get had to wait for a connection
+        'wait_msec' :: total milliseconds spent waiting
+    """
+    in_use = c_uint()
+    idle = c_uint()
+    waits = c_ulonglong()
+    wait_msec = c_ulonglong()
+    clib.call('APIGetter_GetConnectionPoolStats_ABI', _REF(in_use),
+              _REF(idle), _REF(waits), _REF(wait_msec))
+    return {'in_use':in_use.value, 'idle':idle.value, 'waits':waits.value,
+            'wait_msec':wait_msec.value}
+
+def set_cache_enabled(enabled):
+    """Enable/disable the response cache (enabled by default)."""
+    clib.set_val('APIGetter_SetCacheEnabled_ABI', c_int, enabled)
+
+def is_cache_enabled():
+    """Returns if the response cache is enabled."""
+    return bool(clib.get_val('APIGetter_IsCacheEnabled_ABI', c_int))
+
+def set_cache_max_entries(n):
+    """Set max responses kept in memory (least recently used are dropped)."""
+    clib.set_val('APIGetter_SetCacheMaxEntries_ABI', c_uint, n)
+
+def get_cache_max_entries():
+    """Returns max responses kept in memory."""
+    return clib.get_val('APIGetter_GetCacheMaxEntries_ABI', c_uint)
+
+def set_cache_directory(directory):
+    """Set (existing) directory to also store cached responses in, '' for none."""
+    clib.set_str('APIGetter_SetCacheDirectory_ABI', directory)
+
+def get_cache_directory():
+    """Returns directory cached responses are stored in, '' if none."""
+    return clib.get_str('APIGetter_GetCacheDirectory_ABI')
+
+def clear_cache():
+    """Remove all responses from the (in-memory) cache."""
+    clib.call('APIGetter_ClearCache_ABI')
+
 
 class _APIGetter( clib._ProxyBase ):
     """_APIGetter - Base getter class. DO NOT INSTANTIATE!
@@ -228,6 +642,66 @@ class _APIGetter( clib._ProxyBase ):
         r = clib.get_str('APIGetter_Get_ABI', self._obj)
         return json.loads(r) if r else None
 
+    def get_async(self, callback):
+        """Makes HTTPS/GET request asynchronously and returns immediately.
+
+        Request is built with getter instance's current parameters. When
+        complete callback(data, exc) is called FROM A DIFFERENT THREAD with
+        the parsed data(or None) and None, OR None and a CLibException.
+
+            def callback(data, exc)
+        """
+        with _async_callbacks_mtx:
+            key = next(_async_callbacks_key)
+
+        def _wrapper(err, buf, n, ctx):
+            with _async_callbacks_mtx:
+                f = _async_callbacks.pop(ctx, None)
+            try:
+                if err:
+                    callback(None, clib.CLibException(err))
+                else:
+                    callback(json.loads(buf.decode()) if n > 1 else None, None)
+            except BaseException as e:
+                print("exception in", self.get_async, "callback:", str(e))
+
+        cb = ASYNC_CALLBACK_FUNC_TYPE(_wrapper)
+        with _async_callbacks_mtx:
+            _async_callbacks[key] = cb
+        try:
+            clib.call('APIGetter_GetAsync_ABI', _REF(self._obj), cb,
+                      c_void_p(key))
+        except:
+            with _async_callbacks_mtx:
+                _async_callbacks.pop(key, None)
+            raise
+
+    def get_stream(self, callback):
+        """Makes HTTPS/GET request, passing the body to callback as it arrives.
+
+        callback(chunk) is called (in this thread) with each chunk(bytes) of 
+        the response body instead of buffering and parsing it. Return False
+        to stop the transfer (CLibException is raised). Nothing is passed
+        if there's no data. e.g to feed an incremental parser.
+
+            def callback(chunk) -> bool
+        """
+        exc = []
+        def _wrapper(buf, n, ctx):
+            try:
+                return 1 if callback(string_at(buf, n)) else 0
+            except BaseException as e:
+                exc.append(e)
+                return 0
+
+        cb = CHUNK_CALLBACK_FUNC_TYPE(_wrapper)
+        try:
+            clib.call('APIGetter_GetStream_ABI', _REF(self._obj), cb, None)
+        except clib.CLibException:
+            if exc:
+                raise exc[0]
+            raise
+
     def close(self):
         """Closes underlying connection."""
         clib.call('APIGetter_Close_ABI', _REF(self._obj))
@@ -236,6 +710,26 @@ class _APIGetter( clib._ProxyBase ):
         """Returns True/False if underlying connection is open/closed."""
         return bool(clib.get_val('APIGetter_IsClosed_ABI', c_int, self._obj))
 
+    def set_coalesce(self, coalesce):
+        """Share the response of an identical in-flight .get() (default)."""
+        clib.set_val('APIGetter_SetCoalesce_ABI', c_int, coalesce, self._obj)
+
+    def is_coalescing(self):
+        """Returns if .get() shares the response of an identical in-flight get."""
+        return bool(clib.get_val('APIGetter_IsCoalescing_ABI', c_int, self._obj))
+
+    def set_cache_ttl(self, msec):
+        """Set milliseconds responses from .get() are cached, 0 disables."""
+        clib.set_val('APIGetter_SetCacheTTL_ABI', c_ulonglong, msec, self._obj)
+
+    def get_cache_ttl(self):
+        """Returns milliseconds responses from .get() are cached."""
+        return clib.get_val('APIGetter_GetCacheTTL_ABI', c_ulonglong, self._obj)
+
+    def invalidate_cache(self):
+        """Remove the cached response (if any) for the current request."""
+        clib.call('APIGetter_InvalidateCache_ABI', _REF(self._obj))
+
     def set_timeout(self, msec):
         """Set transfer timeout in milliseconds(NOT the connection timeout).
 
@@ -272,6 +766,28 @@ class QuoteGetter(_APIGetter):
         """Sets/changes symbol to use."""
         clib.set_str(self._abi('SetSymbol'), symbol, self._obj)
 
+    @staticmethod
+    def set_batch_window_msec(msec):
+        """Batch .get() calls made within 'msec' of each other into one request.
+
+        0 (default) disables batching, max is 1000.
+        """
+        clib.set_val('QuoteGetter_SetBatchWindowMSec_ABI', c_ulonglong, msec)
+
+    @staticmethod
+    def get_batch_window_msec():
+        """Returns batch window in milliseconds (0 if disabled)."""
+        return clib.get_val('QuoteGetter_GetBatchWindowMSec_ABI', c_ulonglong)
+
+    def get_record(self):
+        """Returns QuoteRecord decoded directly from the response(no json).
+
+        A symbol not found returns all 0s w/ QUOTE_ASSET_TYPE_NONE.
+        """
+        r = QuoteRecord()
+        clib.call(self._abi('GetRecord'), _REF(self._obj), _REF(r))
+        return r
+
 
 class QuotesGetter(_APIGetter):
     """QuotesGetter - Retrieve quotes for multiple securities
@@ -302,6 +818,20 @@ class QuotesGetter(_APIGetter):
         """Remove symbols."""
         clib.set_strs(self._abi('RemoveSymbols'), symbols, self._obj)
 
+    def get_records(self, records=None):
+        """Returns QuoteRecord array decoded directly from the response(no json).
+
+        Pass a previous (QuoteRecord * n) array to reuse it; symbols not found
+        are skipped so the array returned may be shorter.
+        """
+        if records is None:
+            records = (QuoteRecord * len(self.get_symbols()))()
+        n = c_size_t(len(records))
+        clib.call(self._abi('GetRecords'), _REF(self._obj), records, _REF(n))
+        if n.value < len(records):
+            records = (QuoteRecord * n.value).from_buffer(records)
+        return records
+
 
 class MarketHoursGetter(_APIGetter):
     """MarketHoursGetter - Retrieve market operation times for a certain date.
@@ -447,6 +977,13 @@ class _HistoricalGetterBase(_APIGetter):
         clib.set_val('HistoricalGetterBase_SetExtendedHours_ABI', c_int,
                  extended_hours, self._obj)
 
+    def get_candles(self):
+        """Returns CandleTable decoded directly from the response(no json)."""
+        t = _CandleTable_C()
+        clib.call('HistoricalGetterBase_GetCandles_ABI', _REF(self._obj),
+                  _REF(t))
+        return CandleTable._from_cproxy(t)
+
 
 class HistoricalPeriodGetter(_HistoricalGetterBase):
     """HistoricalPeriodGetter - Retrieve historical data over a certain period.
@@ -620,6 +1157,18 @@ class HistoricalRangeGetter(_HistoricalGetterBase):
         clib.set_val(self._abi('SetStartMSecSinceEpoch'), c_ulonglong, msec,
                  self._obj)
 
+    def backfill(self, chunk_msec=0):
+        """Returns CandleTable of the range requested in 'chunk_msec' chunks.
+
+        The chunks are sent concurrently (within the throttle), then merged
+        and de-duplicated by datetime. 0 uses the default chunk: 10 days for
+        minute candles, one request otherwise.
+        """
+        t = _CandleTable_C()
+        clib.call(self._abi('Backfill'), _REF(self._obj),
+                  c_ulonglong(chunk_msec), _REF(t))
+        return CandleTable._from_cproxy(t)
+
 
 class OptionStrikesValue(_Union):
     """C Union representing StrikesValue argument type.(IMPLEMENTATION DETAIL)"""
@@ -874,6 +1423,12 @@ class _OptionChainGetterBase(_APIGetter):
         clib.set_val('OptionChainGetter_SetOptionType_ABI', c_int, option_type,
                  self._obj)
 
+    def get_table(self):
+        """Returns OptionChainTable decoded directly from the response(no json)."""
+        t = _OptionChainTable_C()
+        clib.call('OptionChainGetter_GetTable_ABI', _REF(self._obj), _REF(t))
+        return OptionChainTable._from_cproxy(t)
+
 
 class OptionChainGetter(_OptionChainGetterBase):
     """OptionChainGetter - Retrieve standard option chain.
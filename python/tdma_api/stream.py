@@ -39,7 +39,8 @@ https://github.com/jeog/TDAmeritradeAPI/blob/master/README_STREAMING.md
 """
 
 from ctypes import byref as _REF, c_int, c_void_p, c_ulonglong, CFUNCTYPE, \
-                    c_char_p, c_ulong, c_size_t, pointer, POINTER
+                    c_char_p, c_ulong, c_size_t, pointer, POINTER, c_uint, \
+                    c_double, string_at, Structure as _Structure
 from inspect import signature
 from xml.etree import ElementTree                    
 import json
@@ -94,6 +95,13 @@ QOS_MODERATE = 3
 QOS_SLOW = 4
 QOS_DELAYED = 5
 
+OVERFLOW_POLICY_BLOCK = 0 # DEFAULT - hold back up to 'capacity' more, then drop
+OVERFLOW_POLICY_DROP = 1 # drop new messages right away
+
+DEF_INBOUND_CAPACITY = 4096
+
+LEVEL_ONE_MAX_FIELDS = 53
+
 COMMAND_TYPE_SUBS = 0
 COMMAND_TYPE_UNSUBS = 1
 COMMAND_TYPE_ADD = 2
@@ -116,11 +124,48 @@ def callback_type_to_str(cb_type):
     """Converts CALLBACK_TYPE_[] constant to str."""
     return clib.to_str("StreamingCallbackType_to_string_ABI", c_int, cb_type)
     
+def overflow_policy_to_str(policy):
+    """Converts OVERFLOW_POLICY_[] constant to str."""
+    return clib.to_str("OverflowPolicyType_to_string_ABI", c_int, policy)
+
 def command_type_to_str(command):
     """Convers COMMAND_TYPE_[] constatnt to str."""
     return clib.to_str("CommandType_to_string_ABI", c_int, command)    
 
 
+class LevelOneRecord(_Structure):
+    """The latest value of each field of a symbol on a level one service,
+    from the session's level one book (see README_STREAMING.md).
+
+    'fields' is indexed by the service's subscription FIELD_[] constants,
+    e.g record.fields[QuotesSubscription.FIELD_BID_PRICE]. Sizes, times etc.
+    are floats, booleans 0/1 and one-char strings (exchange ids, ticks) the
+    char's code; fields not received yet (or other strings) are NaN.
+    'symbol_ptr' points into the library's interned symbols; use 'symbol'.
+
+        service :: int :: SERVICE_TYPE_[] constant
+        timestamp :: int :: of the last update, msec since epoch
+    """
+    _fields_ = [
+        ("symbol_ptr", c_void_p),
+        ("symbol_id", c_uint),
+        ("service", c_int),
+        ("timestamp", c_ulonglong),
+        ("nupdates", c_ulonglong),
+        ("fields", c_double * LEVEL_ONE_MAX_FIELDS)
+        ]
+
+    @property
+    def symbol(self):
+        return string_at(self.symbol_ptr).decode() if self.symbol_ptr else ""
+
+    def __str__(self):
+        return "LevelOneRecord(symbol=%s, service=%s, timestamp=%i, " \
+               "nupdates=%i)" % (self.symbol,
+                service_type_to_str(self.service), self.timestamp,
+                self.nupdates)
+
+
 class _StreamingSession_C(clib._CProxy3): 
     """C struct representing StreamingSession_C type."""
     pass   
@@ -282,6 +327,72 @@ class StreamingSession( clib._ProxyBase ):
         """Returns the quality-of-service."""
         return clib.get_val(self._abi("GetQOS"), c_int, self._obj)            
 
+    def set_inbound_buffer(self, capacity, overflow_policy=OVERFLOW_POLICY_BLOCK):
+        """Sets the size of the buffer of messages waiting to be handled and
+        what to do when it's full. Takes effect the next time the session
+        is started.
+        
+            def set_inbound_buffer(self, capacity, 
+                                   overflow_policy=OVERFLOW_POLICY_BLOCK):
+            
+                capacity        :: int :: max messages waiting (> 0)
+                overflow_policy :: int :: OVERFLOW_POLICY_[] constant
+                                           
+            throws   -> LibraryNotLoaded, CLibException 
+        """
+        clib.call(self._abi("SetInboundBuffer"), _REF(self._obj),
+                  c_size_t(capacity), c_int(overflow_policy))
+
+    def get_inbound_buffer(self):
+        """Returns (capacity, OVERFLOW_POLICY_[] constant)."""
+        c = c_size_t()
+        p = c_int()
+        clib.call(self._abi("GetInboundBuffer"), _REF(self._obj), _REF(c),
+                  _REF(p))
+        return (c.value, p.value)
+
+    def set_level_one_book_enabled(self, enabled):
+        """Keep the latest QUOTE, OPTION and LEVELONE_[] fields of each
+        symbol, for get_level_one_record. Can't be changed while the
+        session is active.
+        
+            def set_level_one_book_enabled(self, enabled):
+            
+                enabled :: bool :: 
+                                           
+            throws   -> LibraryNotLoaded, CLibException 
+        """
+        clib.call(self._abi("SetLevelOneBookEnabled"), _REF(self._obj),
+                  c_int(enabled))
+
+    def is_level_one_book_enabled(self):
+        """Returns if the level one book is enabled."""
+        return bool(clib.get_val(self._abi("IsLevelOneBookEnabled"), c_int,
+                                 self._obj))
+
+    def get_level_one_record(self, service, symbol, record=None):
+        """Returns a LevelOneRecord w/ the latest fields for a symbol, or 
+        None if nothing has been received for it.
+        
+            def get_level_one_record(self, service, symbol, record=None):
+            
+                service :: int :: SERVICE_TYPE_[] constant (level one)
+                symbol  :: str or int :: symbol, or its 'symbol_id' (no 
+                                         symbol lookup)
+                record  :: LevelOneRecord :: a previous record to reuse
+                                           
+            throws   -> LibraryNotLoaded, CLibException 
+        """
+        r = record if record is not None else LevelOneRecord()
+        found = c_int()
+        if isinstance(symbol, int):
+            clib.call(self._abi("GetLevelOneRecordById"), _REF(self._obj),
+                      c_int(service), c_uint(symbol), _REF(r), _REF(found))
+        else:
+            clib.call(self._abi("GetLevelOneRecord"), _REF(self._obj),
+                      c_int(service), PCHAR(symbol), _REF(r), _REF(found))
+        return r if found.value else None
+
 
 class _StreamingSubscription( clib._ProxyBaseCopyable ):
     """_StreamingSubscription - Base Subscription class. DO NOT INSTANTIATE!
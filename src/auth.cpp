@@ -125,8 +125,6 @@ const std::string DEF_CERTIFICATE_BUNDLE_PATH;
  *  IV + BODY CHECKSUM (binary, 32 bytes)
  */
 
-const string URL_ACCESS_TOKEN = tdma::URL_BASE + "oauth2/token";
-
 const int CREDS_IV_LENGTH = 16;
 const int CREDS_CHECKSUM_LENGTH = 32;
 
@@ -404,8 +402,9 @@ store_credentials( const string& path,
     }
     file.exceptions(ios_base::badbit | ios_base::failbit);
 
+    /* the struct's token may be older than the one requests are using */
     stringstream input;
-    input << creds->access_token << endl
+    input << tdma::current_access_token(*creds) << endl
           << creds->refresh_token << endl
           << std::to_string(creds->epoch_sec_token_expiration) << endl
           << creds->client_id << endl;
@@ -664,7 +663,7 @@ RequestAccessTokenImpl( const string& code,
     if( client_id.empty() )
         TDMA_API_THROW(LocalCredentialException,"'client_id' required");
 
-    conn::HTTPConnection connection( URL_ACCESS_TOKEN,
+    conn::HTTPConnection connection( url_base() + "oauth2/token",
                                      conn::HttpMethod::http_post );
 
     vector<pair<string, string>> fields = {
@@ -692,6 +691,8 @@ RequestAccessTokenImpl( const string& code,
         TDMA_API_THROW(LocalCredentialException,
                        "creds.epoch_sec_toke_expiration contains invalid value");
     };
+
+    update_access_token( *pcreds, r_json.value("expires_in", 0LL) );
 }
 
 void
@@ -718,7 +719,7 @@ RefreshAccessTokenImpl(Credentials* creds)
     if( string(creds->refresh_token).empty() )
         TDMA_API_THROW(LocalCredentialException,"creds.refresh_token is empty");
 
-    conn::HTTPConnection connection( URL_ACCESS_TOKEN,
+    conn::HTTPConnection connection( url_base() + "oauth2/token",
                                      conn::HttpMethod::http_post );
 
     vector<pair<string, string>> fields = {
@@ -743,6 +744,8 @@ RefreshAccessTokenImpl(Credentials* creds)
     if( string(creds->access_token).empty() ){
         TDMA_API_THROW(LocalCredentialException,"creds.access_token is empty");
     }
+
+    update_access_token( *creds, r_json.value("expires_in", 0LL) );
 }
 
 void
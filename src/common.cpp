@@ -140,7 +140,7 @@ to_new_char_buffer( const string& s,
     if( err )
         return err;
 
-    strncpy(*buf, s.c_str(), (*n)-1);
+    memcpy(*buf, s.data(), (*n)-1);
     (*buf)[(*n)-1] = 0;
 
     return 0;
@@ -264,9 +264,194 @@ FreeFieldsBuffer_ABI( int* fields, int allow_exceptions )
     return 0;
 }
 
+int
+SetRequestLaneLimits_ABI( int lane,
+                          unsigned int max_concurrent,
+                          unsigned long long wait_msec,
+                          unsigned int burst,
+                          int allow_exceptions )
+{
+    CHECK_ENUM(RequestLane, lane, allow_exceptions);
 
+    request_scheduler().set_limits( lane, max_concurrent,
+                                    std::chrono::milliseconds(wait_msec),
+                                    burst );
+    return 0;
+}
 
+int
+GetRequestLaneLimits_ABI( int lane,
+                          unsigned int *max_concurrent,
+                          unsigned long long *wait_msec,
+                          unsigned int *burst,
+                          int allow_exceptions )
+{
+    CHECK_ENUM(RequestLane, lane, allow_exceptions);
+    CHECK_PTR(max_concurrent, "max_concurrent", allow_exceptions);
+    CHECK_PTR(wait_msec, "wait_msec", allow_exceptions);
+    CHECK_PTR(burst, "burst", allow_exceptions);
+
+    RequestScheduler& rs = request_scheduler();
+    *max_concurrent = static_cast<unsigned int>( rs.get_max_concurrent(lane) );
+    *wait_msec = static_cast<unsigned long long>( rs.get_wait(lane).count() );
+    *burst = rs.get_burst(lane);
+    return 0;
+}
 
+int
+GetRequestLaneStats_ABI( int lane,
+                         unsigned int *queued,
+                         unsigned int *in_flight,
+                         unsigned long long *requests,
+                         unsigned long long *wait_msec,
+                         unsigned long long *max_wait_msec,
+                         int allow_exceptions )
+{
+    CHECK_ENUM(RequestLane, lane, allow_exceptions);
+    CHECK_PTR(queued, "queued", allow_exceptions);
+    CHECK_PTR(in_flight, "in_flight", allow_exceptions);
+    CHECK_PTR(requests, "requests", allow_exceptions);
+    CHECK_PTR(wait_msec, "wait_msec", allow_exceptions);
+    CHECK_PTR(max_wait_msec, "max_wait_msec", allow_exceptions);
+
+    RequestScheduler::Stats stats = request_scheduler().get_stats(lane);
+    *queued = static_cast<unsigned int>(stats.queued);
+    *in_flight = static_cast<unsigned int>(stats.in_flight);
+    *requests = stats.requests;
+    *wait_msec = static_cast<unsigned long long>(stats.wait_time.count());
+    *max_wait_msec = static_cast<unsigned long long>(stats.max_wait.count());
+    return 0;
+}
 
+int
+SetHTTP2Enabled_ABI(int enabled, int allow_exceptions)
+{
+    conn::set_http2( static_cast<bool>(enabled) );
+    return 0;
+}
 
+int
+IsHTTP2Enabled_ABI(int *enabled, int allow_exceptions)
+{
+    CHECK_PTR(enabled, "enabled", allow_exceptions);
+
+    *enabled = static_cast<int>( conn::is_http2() );
+    return 0;
+}
+
+int
+IsHTTP2Supported_ABI(int *supported, int allow_exceptions)
+{
+    CHECK_PTR(supported, "supported", allow_exceptions);
+
+    *supported = static_cast<int>( conn::http2_supported() );
+    return 0;
+}
+
+int
+GetHTTPStats_ABI( unsigned long long *requests,
+                  unsigned long long *connections,
+                  unsigned long long *http2_requests,
+                  int allow_exceptions )
+{
+    CHECK_PTR(requests, "requests", allow_exceptions);
+    CHECK_PTR(connections, "connections", allow_exceptions);
+    CHECK_PTR(http2_requests, "http2_requests", allow_exceptions);
+
+    conn::HTTPStats stats = conn::get_http_stats();
+    *requests = stats.requests;
+    *connections = stats.connections;
+    *http2_requests = stats.http2_requests;
+    return 0;
+}
+
+int
+Metrics_SetEnabled_ABI(int enabled, int allow_exceptions)
+{
+    metrics().set_enabled( static_cast<bool>(enabled) );
+    return 0;
+}
+
+int
+Metrics_IsEnabled_ABI(int *enabled, int allow_exceptions)
+{
+    CHECK_PTR(enabled, "enabled", allow_exceptions);
+
+    *enabled = static_cast<int>( metrics().is_enabled() );
+    return 0;
+}
+
+int
+Metrics_Reset_ABI(int allow_exceptions)
+{
+    metrics().reset();
+    return 0;
+}
+
+int
+Metrics_GetText_ABI(char **buf, size_t *n, int allow_exceptions)
+{
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    return to_new_char_buffer(metrics().to_text(), buf, n, allow_exceptions);
+}
+
+int
+Metrics_GetJSON_ABI(char **buf, size_t *n, int allow_exceptions)
+{
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    return to_new_char_buffer(metrics().to_json(), buf, n, allow_exceptions);
+}
+
+int
+SetAPIBaseURL_ABI(const char *url, int allow_exceptions)
+{
+    CHECK_PTR(url, "url", allow_exceptions);
+    return CallImplFromABI(allow_exceptions, set_url_base, url);
+}
+
+int
+GetAPIBaseURL_ABI(char **buf, size_t *n, int allow_exceptions)
+{
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    return to_new_char_buffer(url_base(), buf, n, allow_exceptions);
+}
+
+int
+SetStreamerURL_ABI(const char *url, int allow_exceptions)
+{
+    CHECK_PTR(url, "url", allow_exceptions);
+    return CallImplFromABI(allow_exceptions, set_streamer_url, url);
+}
+
+int
+GetStreamerURL_ABI(char **buf, size_t *n, int allow_exceptions)
+{
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    return to_new_char_buffer(streamer_url(), buf, n, allow_exceptions);
+}
+
+int
+RequestLane_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
+{
+    CHECK_ENUM(RequestLane, v, allow_exceptions);
+
+    switch(static_cast<RequestLane>(v)){
+    case RequestLane::execution:
+        return to_new_char_buffer("execution", buf, n, allow_exceptions);
+    case RequestLane::account:
+        return to_new_char_buffer("account", buf, n, allow_exceptions);
+    case RequestLane::marketdata:
+        return to_new_char_buffer("marketdata", buf, n, allow_exceptions);
+    default:
+        throw std::runtime_error("invalid RequestLane");
+    }
+}
 
@@ -20,10 +20,16 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
-#include <regex>
+#include <thread>
+#include <condition_variable>
 
 #include <assert.h>
 
+#if LIBCURL_VERSION_NUM < 0x074400 && !defined(_WIN32)
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
 #include "../include/curl_connect.h"
 //#include "../include/util.h"
 
@@ -37,6 +43,404 @@ using std::ostream;
 
 namespace conn{
 
+namespace {
+
+const string AUTH_HEADER("Authorization");
+
+std::atomic<bool> use_http2(false);
+
+std::atomic<unsigned long long> nrequests(0);
+std::atomic<unsigned long long> nconnects(0);
+std::atomic<unsigned long long> nhttp2_requests(0);
+
+/* count a completed transfer, the connections it opened and its version */
+void
+record_transfer(CURL *handle)
+{
+    long n = 0;
+    if( curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &n) == CURLE_OK )
+        nconnects += static_cast<unsigned long long>(n);
+#if LIBCURL_VERSION_NUM >= 0x073200
+    long v = 0;
+    if( curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &v) == CURLE_OK
+        && v == CURL_HTTP_VERSION_2_0 )
+    {
+        ++nhttp2_requests;
+    }
+#endif
+    ++nrequests;
+}
+
+
+/*
+ * MultiLoop - single thread running a curl_multi handle that easy handles
+ *             can be added to for async execution
+ *
+ * Handles are queued w/ a start time (for throttling) and a completion
+ * callback that gets the CURLcode of the transfer. Callbacks are run from
+ * the loop thread AFTER the handle has been removed from the multi handle
+ * so they can clean up, re-use (e.g curl_easy_perform) or re-queue it.
+ *
+ * Transfers share the multi handle's connection cache so, w/ HTTP/2,
+ * concurrent requests to the same host are multiplexed on one connection.
+ * Submitting wakes the loop from curl_multi_wait (curl_multi_wakeup or a
+ * pipe, depending on the libcurl/platform) instead of waiting for it to
+ * time out.
+ *
+ * Callbacks hold up every transfer on the loop so they can't block. There
+ * are two loops: 'instance' for async requests and 'sync_instance' for
+ * synchronous multiplexed ones ('perform'), whose callbacks only wake the
+ * caller - a slow async callback can't hold up a synchronous get.
+ */
+class MultiLoop{
+public:
+    typedef std::function<void(CURLcode)> done_cb_ty;
+
+private:
+    /* max wait on the multi handle so we pick up newly queued handles */
+    static const int MAX_WAIT_MSEC = 10;
+
+    struct Pending{
+        CURL *handle;
+        done_cb_ty callback;
+        clock_ty::time_point start_at;
+    };
+
+    CURLM *_multi;
+#if LIBCURL_VERSION_NUM < 0x074400 && !defined(_WIN32)
+    int _wakeup_fds[2];
+#endif
+    std::vector<Pending> _pending;
+    std::unordered_map<CURL*, done_cb_ty> _active; // loop thread only
+    std::mutex _mtx;
+    std::condition_variable _cond;
+    bool _done;
+    std::thread _thread;
+
+    /* caller needs to hold _mtx */
+    clock_ty::time_point
+    _next_start() const
+    {
+        clock_ty::time_point tp = clock_ty::time_point::max();
+        for( auto& p : _pending )
+            tp = (std::min)(tp, p.start_at);
+        return tp;
+    }
+
+    /* move pending handles that are ready into the multi handle */
+    void
+    _add_ready()
+    {
+        vector<Pending> ready;
+        {
+            std::unique_lock<std::mutex> lock(_mtx);
+            while( !_done && _active.empty() ){
+                /* nothing in flight, sleep until the next start time */
+                if( _pending.empty() )
+                    _cond.wait(lock);
+                else if( _next_start() > clock_ty::now() )
+                    _cond.wait_until(lock, _next_start());
+                else
+                    break;
+            }
+            if( _done )
+                return;
+
+            auto now = clock_ty::now();
+            auto iter = std::partition( _pending.begin(), _pending.end(),
+                [&](const Pending& p){ return p.start_at > now; } );
+            std::move(iter, _pending.end(), std::back_inserter(ready));
+            _pending.erase(iter, _pending.end());
+        }
+
+        for( auto& p : ready ){
+            CURLMcode mc = curl_multi_add_handle(_multi, p.handle);
+            if( mc != CURLM_OK ){
+                _done_callback(p.callback, CURLE_FAILED_INIT);
+                continue;
+            }
+            _active[p.handle] = std::move(p.callback);
+        }
+    }
+
+    void
+    _read_done()
+    {
+        int nmsgs;
+        CURLMsg *msg;
+        while( (msg = curl_multi_info_read(_multi, &nmsgs)) ){
+            if( msg->msg != CURLMSG_DONE )
+                continue;
+
+            CURL *handle = msg->easy_handle;
+            CURLcode ccode = msg->data.result;
+            curl_multi_remove_handle(_multi, handle);
+
+            auto citer = _active.find(handle);
+            assert( citer != _active.end() );
+            done_cb_ty cb = std::move(citer->second);
+            _active.erase(citer);
+            _done_callback(cb, ccode);
+        }
+    }
+
+    void
+    _wakeup()
+    {
+#if LIBCURL_VERSION_NUM >= 0x074400
+        curl_multi_wakeup(_multi);
+#elif !defined(_WIN32)
+        if( _wakeup_fds[1] >= 0 ){
+            char c = 0;
+            if( write(_wakeup_fds[1], &c, 1) < 0 ){
+                // pipe is full, loop is already being woken up
+            }
+        }
+#endif
+    }
+
+    void
+    _wait(long msec)
+    {
+#if LIBCURL_VERSION_NUM >= 0x074400
+        curl_multi_poll(_multi, nullptr, 0, static_cast<int>(msec), nullptr);
+#elif !defined(_WIN32)
+        if( _wakeup_fds[0] < 0 ){
+            curl_multi_wait(_multi, nullptr, 0, static_cast<int>(msec), nullptr);
+            return;
+        }
+        curl_waitfd wfd = {_wakeup_fds[0], CURL_WAIT_POLLIN, 0};
+        curl_multi_wait(_multi, &wfd, 1, static_cast<int>(msec), nullptr);
+        if( wfd.revents ){
+            char buf[64];
+            while( read(_wakeup_fds[0], buf, sizeof(buf)) > 0 )
+                {}
+        }
+#else
+        curl_multi_wait(_multi, nullptr, 0, static_cast<int>(msec), nullptr);
+#endif
+    }
+
+    static void
+    _done_callback(done_cb_ty& cb, CURLcode ccode)
+    {
+        try{
+            cb(ccode);
+        }catch(std::exception& e){
+            std::cerr<< "exception in async completion callback: "
+                     << e.what() << std::endl;
+        }catch(...){
+            std::cerr<< "unknown exception in async completion callback"
+                     << std::endl;
+        }
+    }
+
+    void
+    _run()
+    {
+        while( true ){
+            _add_ready();
+            {
+                std::lock_guard<std::mutex> lock(_mtx);
+                if( _done )
+                    return;
+            }
+
+            int nrunning = 0;
+            curl_multi_perform(_multi, &nrunning);
+            _read_done();
+
+            if( !_active.empty() ){
+                long w = MAX_WAIT_MSEC;
+                {
+                    std::lock_guard<std::mutex> lock(_mtx);
+                    if( !_pending.empty() ){
+                        auto ms = std::chrono::duration_cast<
+                            std::chrono::milliseconds>(
+                                _next_start() - clock_ty::now()
+                            ).count();
+                        w = (std::max)(0L, (std::min)(w, static_cast<long>(ms)));
+                    }
+                }
+                _wait(w);
+            }
+        }
+    }
+
+    MultiLoop()
+        :
+            _multi( curl_multi_init() ),
+            _done(false)
+        {
+            if( !_multi )
+                throw CurlException("curl_multi_init failed");
+#ifdef CURLPIPE_MULTIPLEX
+            // (the default since 7.62)
+            curl_multi_setopt(_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+#if LIBCURL_VERSION_NUM < 0x074400 && !defined(_WIN32)
+            if( pipe(_wakeup_fds) == 0 ){
+                fcntl(_wakeup_fds[0], F_SETFL, O_NONBLOCK);
+                fcntl(_wakeup_fds[1], F_SETFL, O_NONBLOCK);
+            }else
+                _wakeup_fds[0] = _wakeup_fds[1] = -1; // fall back to polling
+#endif
+            _thread = std::thread( &MultiLoop::_run, this );
+        }
+
+public:
+    /* created on first use (after curl_global_init) */
+    static MultiLoop&
+    instance()
+    {
+        static MultiLoop loop;
+        return loop;
+    }
+
+    static MultiLoop&
+    sync_instance()
+    {
+        static MultiLoop loop;
+        return loop;
+    }
+
+    ~MultiLoop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _done = true;
+        }
+        _cond.notify_one();
+        if( _thread.joinable() )
+            _thread.join();
+
+        /*
+         * don't call back at exit, just drop what's left so whatever the
+         * callbacks own gets cleaned up AFTER removing handles from _multi
+         */
+        for( auto& a : _active )
+            curl_multi_remove_handle(_multi, a.first);
+        _active.clear();
+        _pending.clear();
+        curl_multi_cleanup(_multi);
+#if LIBCURL_VERSION_NUM < 0x074400 && !defined(_WIN32)
+        if( _wakeup_fds[0] >= 0 ){
+            ::close(_wakeup_fds[0]);
+            ::close(_wakeup_fds[1]);
+        }
+#endif
+    }
+
+    void
+    submit(CURL *handle, done_cb_ty callback, clock_ty::time_point start_at)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            if( _done )
+                throw CurlException("async loop has been stopped");
+            _pending.push_back( {handle, std::move(callback), start_at} );
+        }
+        _cond.notify_one();
+        _wakeup();
+    }
+
+    /* run a transfer on the loop and block until it's done */
+    CURLcode
+    perform(CURL *handle)
+    {
+        std::mutex mtx;
+        std::condition_variable cond;
+        bool done = false;
+        CURLcode ccode = CURLE_OK;
+
+        submit( handle,
+            [&](CURLcode c){
+                std::lock_guard<std::mutex> _(mtx);
+                ccode = c;
+                done = true;
+                cond.notify_one();
+            },
+            clock_ty::now()
+        );
+
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait( lock, [&done]{ return done; } );
+        return ccode;
+    }
+
+    /* callbacks on the loop thread can't block on the loop */
+    bool
+    on_loop_thread() const
+    { return std::this_thread::get_id() == _thread.get_id(); }
+};
+
+
+/*
+ * CurlShare - process-wide share of the DNS cache and TLS sessions, attached
+ *             to every easy handle the library creates (getters, auth,
+ *             execute, async loop)
+ *
+ * New handles to a host we've already talked to skip the DNS lookup and
+ * resume the TLS session instead of doing a full handshake. Handles are used
+ * from different threads so each type of shared data gets its own lock.
+ *
+ * The connection cache is NOT shared - libcurl doesn't support sharing it
+ * between concurrent threads. HTTPConnectionPool keeps connections warm.
+ *
+ * Intentionally never cleaned up: handles destroyed during static
+ * destruction still need the share(and its locks) to be alive.
+ */
+class CurlShare{
+    CURLSH *_share;
+    std::mutex _mtxs[CURL_LOCK_DATA_LAST];
+
+    static void
+    _lock(CURL*, curl_lock_data data, curl_lock_access, void *userp)
+    { static_cast<CurlShare*>(userp)->_mtxs[data].lock(); }
+
+    static void
+    _unlock(CURL*, curl_lock_data data, void *userp)
+    { static_cast<CurlShare*>(userp)->_mtxs[data].unlock(); }
+
+    CurlShare()
+        :
+            _share( curl_share_init() )
+        {
+            if( !_share )
+                return;
+
+            if( curl_share_setopt(_share, CURLSHOPT_LOCKFUNC, _lock)
+                    != CURLSHE_OK
+                || curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC, _unlock)
+                    != CURLSHE_OK
+                || curl_share_setopt(_share, CURLSHOPT_USERDATA, this)
+                    != CURLSHE_OK )
+            {
+                // without locks it's not safe to share anything
+                curl_share_cleanup(_share);
+                _share = nullptr;
+                return;
+            }
+
+            // not fatal if either isn't supported by this libcurl
+            curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(_share, CURLSHOPT_SHARE,
+                              CURL_LOCK_DATA_SSL_SESSION);
+        }
+
+public:
+    /* null if the share couldn't be created (handles just don't share) */
+    static CURLSH*
+    get()
+    {
+        static CurlShare *share = new CurlShare();
+        return share->_share;
+    }
+};
+
+} /* namespace */
+
+
 class CurlConnection::CurlConnectionImpl_ { 
     static struct Init {
         Init() { curl_global_init(CURL_GLOBAL_ALL); }
@@ -52,35 +456,114 @@ class CurlConnection::CurlConnectionImpl_ {
     }_init;
 
     struct curl_slist *_header;
+    struct curl_slist *_shared_header; // not owned, see SET_header_list
     CURL *_handle;
     map<CURLoption, string> _options;
     char *_error_buffer;
+    bool _multiplex; // sync transfers can go on the (HTTP/2) multi handle
  
     /* to string overloads for our different stored option values */
     template<typename T, typename Dummy = void>
     struct to;
 
+    /*
+     * response buffer, moved (not copied) into the result
+     *
+     * if created with a handle the buffer is pre-sized from Content-Length
+     * (when the server sends it) on the first write so large responses
+     * aren't grown/copied piece by piece
+     */
     struct WriteCallback {
-        std::stringbuf _buf;
+        string _buf;
+        CURL *_handle;
+        const chunk_cb_ty *_on_chunk;
+        bool _sized;
+        bool _streaming;
+
+        WriteCallback( CURL *handle = nullptr,
+                       const chunk_cb_ty *on_chunk = nullptr )
+            :
+                _handle(handle),
+                _on_chunk( (on_chunk && *on_chunk) ? on_chunk : nullptr ),
+                _sized(false),
+                _streaming(false)
+            {}
+
+        void
+        presize()
+        {
+            _sized = true;
+            if( !_handle )
+                return;
+
+            if( _on_chunk ){
+                /* only stream successful responses; buffer errors as usual */
+                long c = 0;
+                curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &c);
+                _streaming = (c >= 200 && c < 300);
+                if( _streaming )
+                    return;
+            }
+#if LIBCURL_VERSION_NUM >= 0x073700
+            curl_off_t len = -1;
+            if( curl_easy_getinfo(_handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                                  &len) == CURLE_OK && len > 0 )
+                _buf.reserve( static_cast<size_t>(len) );
+#else
+            double len = -1;
+            if( curl_easy_getinfo(_handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD,
+                                  &len) == CURLE_OK && len > 0 )
+                _buf.reserve( static_cast<size_t>(len) );
+#endif
+        }
 
         static size_t
         write( char* input, size_t sz, size_t n, void* output )
         {
-            std::stringbuf& buf = ((WriteCallback*)output)->_buf;
-            std::streamsize ssz = buf.sputn(input, sz*n);
-            //assert(ssz >= 0);
-            return ssz;
+            WriteCallback *cb = (WriteCallback*)output;
+            if( !cb->_sized )
+                cb->presize();
+            if( cb->_streaming ){
+                /* returning less than sz*n makes curl abort the transfer */
+                return (*cb->_on_chunk)(input, sz*n) ? sz*n : 0;
+            }
+            cb->_buf.append(input, sz*n);
+            return sz*n;
         }
 
+        /* moves the data out; leaves the buffer empty */
         string
-        str()
-        { return _buf.str(); }
-
-        void
-        clear()
-        { _buf.str(""); }
+        take()
+        {
+            string s( std::move(_buf) );
+            _buf.clear();
+            _sized = _streaming = false;
+            return s;
+        }
     };
 
+    /* HTTP/2 if enabled(and supported) or libcurl's default, per transfer */
+    bool
+    _set_http_version()
+    {
+        bool h2 = use_http2 && http2_supported();
+        set_option( CURLOPT_HTTP_VERSION,
+                    static_cast<long>( h2 ? CURL_HTTP_VERSION_2TLS
+                                          : CURL_HTTP_VERSION_NONE ) );
+        /* wait for a connection that can multiplex instead of opening one */
+        set_option(CURLOPT_PIPEWAIT, h2 ? 1L : 0L);
+        return h2;
+    }
+
+    /* don't leave a header callback pointing at a previous call's buffer */
+    void
+    _clear_header_callback()
+    {
+        set_option(CURLOPT_HEADERFUNCTION,
+                   static_cast<curl_write_callback>(nullptr));
+        set_option(CURLOPT_HEADERDATA, static_cast<void*>(nullptr));
+    }
+
 public:
     CurlConnectionImpl_(string url)
         :
@@ -92,12 +575,18 @@ public:
     CurlConnectionImpl_()
         :
             _header(nullptr),
+            _shared_header(nullptr),
             _handle(curl_easy_init()),
-            _error_buffer(new char[CURL_ERROR_SIZE+1])
+            _error_buffer(new char[CURL_ERROR_SIZE+1]),
+            _multiplex(true)
         {
             set_option(CURLOPT_NOSIGNAL, 1L);
             _error_buffer[CURL_ERROR_SIZE] = 0;
             set_option(CURLOPT_ERRORBUFFER, _error_buffer);
+
+            CURLSH *share = CurlShare::get();
+            if( share )
+                set_option(CURLOPT_SHARE, share);
         }
     
     ~CurlConnectionImpl_()
@@ -110,9 +599,11 @@ public:
     CurlConnectionImpl_(CurlConnectionImpl_&& connection)
         :
             _header(connection._header),
+            _shared_header(connection._shared_header),
             _handle(connection._handle),
             _options(move(connection._options)),
-            _error_buffer(connection._error_buffer)
+            _error_buffer(connection._error_buffer),
+            _multiplex(connection._multiplex)
         {
             connection._header = nullptr;
             connection._handle = nullptr;
@@ -133,9 +624,11 @@ public:
                 delete[] _error_buffer;
 
             _header = connection._header;
+            _shared_header = connection._shared_header;
             _handle = connection._handle;
             _options = move(connection._options);
             _error_buffer = connection._error_buffer;
+            _multiplex = connection._multiplex;
 
             connection._header = nullptr;
             connection._handle = nullptr;
@@ -192,37 +685,91 @@ public:
     
     // <status code, data, header, time>
     tuple<long, string, string, clock_ty::time_point>
-    execute( bool return_header_data )
+    execute( bool return_header_data,
+             const chunk_cb_ty& on_chunk = chunk_cb_ty() )
     {
         if (!_handle)
             throw CurlException("connection/handle has been closed");
 
-        WriteCallback cb_data, cb_header;
+        WriteCallback cb_data(_handle, &on_chunk), cb_header;
         set_option(CURLOPT_WRITEFUNCTION, &WriteCallback::write);
         set_option(CURLOPT_WRITEDATA, &cb_data);
 
         if( return_header_data ){
             set_option(CURLOPT_HEADERFUNCTION, &WriteCallback::write);
             set_option(CURLOPT_HEADERDATA, &cb_header);
-        }
+        }else
+            _clear_header_callback();
 
-        CURLcode ccode = curl_easy_perform(_handle);
+        /*
+         * w/ HTTP/2 run it on the (sync) multi handle so it shares a
+         * connection w/ other requests; streams stay here so 'on_chunk'
+         * isn't called from (and doesn't hold up) the loop thread, as do
+         * connections that opted out (e.g orders)
+         */
+        MultiLoop& loop = MultiLoop::sync_instance();
+        bool multiplex = _set_http_version() && _multiplex && !on_chunk
+                         && !loop.on_loop_thread();
+        CURLcode ccode = multiplex
+            ? loop.perform(_handle)
+            : curl_easy_perform(_handle);
         auto tp = clock_ty::now();
         if (ccode != CURLE_OK)
             throw CurlConnectionError(ccode, _error_buffer);
 
-        string res = cb_data.str();
-        cb_data.clear();
+        record_transfer(_handle);
         long c;
         curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &c);
 
-        string head;
+        return make_tuple(c, cb_data.take(), cb_header.take(), tp);
+    }
+
+    void
+    execute_async( bool return_header_data,
+                   async_callback_ty callback,
+                   clock_ty::time_point start_at )
+    {
+        if (!_handle)
+            throw CurlException("connection/handle has been closed");
+
+        /* write buffers are owned by the completion callback */
+        std::shared_ptr<WriteCallback> cb_data( new WriteCallback(_handle) );
+        std::shared_ptr<WriteCallback> cb_header;
+        set_option(CURLOPT_WRITEFUNCTION, &WriteCallback::write);
+        set_option(CURLOPT_WRITEDATA, cb_data.get());
+
         if( return_header_data ){
-            head = cb_header.str();
-            cb_data.clear();
-        }
+            cb_header.reset( new WriteCallback );
+            set_option(CURLOPT_HEADERFUNCTION, &WriteCallback::write);
+            set_option(CURLOPT_HEADERDATA, cb_header.get());
+        }else
+            _clear_header_callback();
+
+        _set_http_version();
+        CURL *handle = _handle;
+        const char *error_buffer = _error_buffer;
+
+        MultiLoop::instance().submit( handle,
+            [=](CURLcode ccode){
+                auto tp = clock_ty::now();
+                if( ccode != CURLE_OK ){
+                    callback( tuple<long, string, string, clock_ty::time_point>(),
+                              std::make_exception_ptr(
+                                  CurlConnectionError(ccode, error_buffer)
+                                  ) );
+                    return;
+                }
 
-        return make_tuple(c, res, head, tp);
+                record_transfer(handle);
+                long c;
+                curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &c);
+                callback( make_tuple( c, cb_data->take(),
+                                      (cb_header ? cb_header->take() : string()),
+                                      tp ),
+                          nullptr );
+            },
+            start_at
+        );
     }
 
     void
@@ -232,6 +779,7 @@ public:
             curl_slist_free_all(_header);
             _header = nullptr;
         }
+        _shared_header = nullptr;
         if (_handle) {
             curl_easy_cleanup(_handle);
             _handle = nullptr;
@@ -286,6 +834,10 @@ public:
     SET_keepalive(bool on)
     { set_option(CURLOPT_TCP_KEEPALIVE, on ? 1L : 0L); }
 
+    void
+    SET_multiplex(bool on)
+    { _multiplex = on; }
+
     void
     SET_timeout(long timeout)
     { set_option(CURLOPT_TIMEOUT_MS, (timeout > 0 ? timeout : 0)); }
@@ -306,6 +858,7 @@ public:
         if (headers.empty())
             return;
 
+        _shared_header = nullptr;
         for (auto& h : headers) {
             string s = h.first + ": " + h.second;
             _header = curl_slist_append(_header, s.c_str());
@@ -321,7 +874,7 @@ public:
     vector<pair<string,string>>
     GET_headers() const
     {
-        struct curl_slist * tmp = _header;
+        struct curl_slist * tmp = _header ? _header : _shared_header;
 
         vector<pair<string,string>> headers;
         while( tmp ){
@@ -341,12 +894,79 @@ public:
     {
         curl_slist_free_all(_header);
         _header = nullptr;
+        _shared_header = nullptr;
         _options.erase(CURLOPT_HTTPHEADER);
     }
     
     bool
     has_headers()
-    { return _header != nullptr; }
+    { return _header != nullptr || _shared_header != nullptr; }
+
+    TransferTimes
+    GET_transfer_times() const
+    {
+        using std::chrono::microseconds;
+
+        TransferTimes t{};
+        if( !_handle )
+            return t;
+
+        /* each is from the start of the transfer */
+        long long dns = 0, conn = 0, tls = 0, pre = 0, start = 0, total = 0;
+#if LIBCURL_VERSION_NUM >= 0x073D00
+        auto usec = [this](CURLINFO info){
+            curl_off_t v = 0;
+            curl_easy_getinfo(_handle, info, &v);
+            return static_cast<long long>(v);
+        };
+        dns = usec(CURLINFO_NAMELOOKUP_TIME_T);
+        conn = usec(CURLINFO_CONNECT_TIME_T);
+        tls = usec(CURLINFO_APPCONNECT_TIME_T);
+        pre = usec(CURLINFO_PRETRANSFER_TIME_T);
+        start = usec(CURLINFO_STARTTRANSFER_TIME_T);
+        total = usec(CURLINFO_TOTAL_TIME_T);
+#else
+        auto usec = [this](CURLINFO info){
+            double v = 0;
+            curl_easy_getinfo(_handle, info, &v);
+            return static_cast<long long>(v * 1000000);
+        };
+        dns = usec(CURLINFO_NAMELOOKUP_TIME);
+        conn = usec(CURLINFO_CONNECT_TIME);
+        tls = usec(CURLINFO_APPCONNECT_TIME);
+        pre = usec(CURLINFO_PRETRANSFER_TIME);
+        start = usec(CURLINFO_STARTTRANSFER_TIME);
+        total = usec(CURLINFO_TOTAL_TIME);
+#endif
+        auto diff = [](long long a, long long b){
+            return microseconds( a > b ? a - b : 0 );
+        };
+
+        long nconn = 0;
+        curl_easy_getinfo(_handle, CURLINFO_NUM_CONNECTS, &nconn);
+        if( nconn > 0 ){
+            t.dns = microseconds(dns);
+            t.connect = diff(conn, dns);
+            t.tls = tls ? diff(tls, conn) : microseconds(0);
+        }
+        t.ttfb = diff(start, pre);
+        t.transfer = diff(total, start);
+        t.total = microseconds(total);
+        return t;
+    }
+
+    void
+    SET_header_list(struct curl_slist *list)
+    {
+        if (!_handle)
+            throw CurlException("connection/handle has been closed");
+
+        RESET_headers();
+        if (list) {
+            set_option(CURLOPT_HTTPHEADER, list);
+            _shared_header = list;
+        }
+    }
 
     void
     SET_fields(const string& fields)
@@ -381,6 +1001,28 @@ public:
 
 CurlConnection::CurlConnectionImpl_::Init CurlConnection::CurlConnectionImpl_::_init;
 
+
+void
+set_http2(bool on)
+{ use_http2 = on; }
+
+bool
+is_http2()
+{ return use_http2; }
+
+bool
+http2_supported()
+{
+    static const bool supported =
+        (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) != 0;
+    return supported;
+}
+
+HTTPStats
+get_http_stats()
+{ return HTTPStats{nrequests, nconnects, nhttp2_requests}; }
+
+
 template<typename T, typename Dummy>
 struct CurlConnection::CurlConnectionImpl_::to {
     static string str(T t)
@@ -462,6 +1104,16 @@ tuple<long, string, string, clock_ty::time_point>
 CurlConnection::execute( bool return_header_data )
 { return _pimpl->execute(return_header_data); }
 
+tuple<long, string, string, clock_ty::time_point>
+CurlConnection::execute( bool return_header_data, const chunk_cb_ty& on_chunk )
+{ return _pimpl->execute(return_header_data, on_chunk); }
+
+void
+CurlConnection::execute_async( bool return_header_data,
+                               async_callback_ty callback,
+                               clock_ty::time_point start_at )
+{ _pimpl->execute_async(return_header_data, callback, start_at); }
+
 void
 CurlConnection::close()
 { _pimpl->close(); }
@@ -502,6 +1154,10 @@ void
 CurlConnection::set_keepalive(bool on)
 { _pimpl->SET_keepalive(on); }
 
+void
+CurlConnection::set_multiplex(bool on)
+{ _pimpl->SET_multiplex(on); }
+
 void
 CurlConnection::set_timeout(long timeout)
 { _pimpl->SET_timeout(timeout); }
@@ -526,6 +1182,14 @@ bool
 CurlConnection::has_headers()
 { return _pimpl->has_headers(); }
 
+void
+CurlConnection::set_header_list(struct curl_slist *list)
+{ _pimpl->SET_header_list(list); }
+
+TransferTimes
+CurlConnection::get_transfer_times() const
+{ return _pimpl->GET_transfer_times(); }
+
 void
 CurlConnection::set_fields(const vector<pair<string, string>>& fields)
 { _pimpl->SET_fields(fields); }
@@ -546,6 +1210,8 @@ const string HTTPConnection::DEFAULT_ENCODING("gzip");
 HttpMethod
 HTTPConnection::_set_method(HttpMethod meth)
 {
+    /* orders(and auth) keep their own connection, never wait on a loop */
+    set_multiplex( meth == HttpMethod::http_get );
     switch( meth ){
     case HttpMethod::http_get:
         set_option(CURLOPT_HTTPGET, 1L);
@@ -606,6 +1272,215 @@ HTTPConnection::set_url(const std::string& url)
         throw CurlException("invalid protocol in url: " + url);
 
     _pimpl->SET_url(url);
+    _tmpl.reset();
+}
+
+
+void
+HTTPConnection::_rebuild_headers()
+{
+    CurlConnection::reset_headers();
+    CurlConnection::add_headers(_headers);
+    if( !_auth.empty() )
+        CurlConnection::add_headers( {{AUTH_HEADER, _auth}} );
+}
+
+
+/* leave the template's headers in place, but as our own */
+#define UNSHARE_TEMPLATE_HEADERS() \
+do{ \
+    if( _tmpl ){ \
+        _headers = _tmpl->get_headers(); \
+        _auth = _tmpl->get_auth_header(); \
+        _tmpl.reset(); \
+    } \
+}while(0)
+
+void
+HTTPConnection::add_headers(const std::vector<std::pair<std::string,std::string>>& headers)
+{
+    UNSHARE_TEMPLATE_HEADERS();
+    for( auto& h : headers ){
+        if( h.first == AUTH_HEADER )
+            _auth = h.second;
+        else
+            _headers.push_back(h);
+    }
+    _rebuild_headers();
+}
+
+
+void
+HTTPConnection::reset_headers()
+{
+    _headers.clear();
+    _auth.clear();
+    _tmpl.reset();
+    CurlConnection::reset_headers();
+}
+
+
+void
+HTTPConnection::set_auth_header(const std::string& value)
+{
+    if( value == get_auth_header() )
+        return;
+    UNSHARE_TEMPLATE_HEADERS();
+    _auth = value;
+    _rebuild_headers();
+}
+
+#undef UNSHARE_TEMPLATE_HEADERS
+
+
+void
+HTTPConnection::use_template(const std::shared_ptr<const RequestTemplate>& tmpl)
+{
+    assert( tmpl );
+    if( tmpl == _tmpl )
+        return;
+
+    if( !_tmpl || _tmpl->get_url() != tmpl->get_url() )
+        set_url( tmpl->get_url() );
+
+    CurlConnection::set_header_list( tmpl->get_header_list() );
+    _headers.clear();
+    _auth.clear();
+    _tmpl = tmpl; // keeps the shared list alive
+}
+
+
+RequestTemplate::RequestTemplate( const std::string& url,
+                                  const std::vector<std::pair<std::string,std::string>>& headers,
+                                  const std::string& auth )
+    :
+        _url(url),
+        _headers(headers),
+        _auth(auth),
+        _header_list(nullptr)
+    {
+        auto append = [this](const std::string& s){
+            struct curl_slist *l = curl_slist_append(_header_list, s.c_str());
+            if( !l ){
+                curl_slist_free_all(_header_list);
+                throw CurlOptionException("curl_slist_append failed trying to "
+                    "add header", CURLOPT_HTTPHEADER, s);
+            }
+            _header_list = l;
+        };
+        for( auto& h : _headers )
+            append(h.first + ": " + h.second);
+        if( !_auth.empty() )
+            append(AUTH_HEADER + ": " + _auth);
+    }
+
+
+RequestTemplate::~RequestTemplate()
+{ curl_slist_free_all(_header_list); }
+
+
+const size_t HTTPConnectionPool::DEF_MAX_CONNECTIONS = 4;
+const std::chrono::milliseconds HTTPConnectionPool::DEF_MAX_IDLE(60000);
+
+std::atomic<size_t>
+HTTPConnectionPool::max_connections(HTTPConnectionPool::DEF_MAX_CONNECTIONS);
+
+std::atomic<long long>
+HTTPConnectionPool::max_idle_msec(HTTPConnectionPool::DEF_MAX_IDLE.count());
+
+HTTPConnectionPool::HTTPConnectionPool(HttpMethod meth)
+    :
+        _meth(meth),
+        _in_use(0),
+        _waits(0),
+        _wait_time(0)
+    {
+    }
+
+// caller needs to hold _mtx
+std::vector<std::unique_ptr<HTTPConnection>>
+HTTPConnectionPool::_evict_idle()
+{
+    std::vector<std::unique_ptr<HTTPConnection>> stale;
+    auto now = clock_ty::now();
+    auto max_idle = get_max_idle();
+    // oldest at front; also trim if max_connections was lowered
+    while( !_idle.empty() ){
+        auto& front = _idle.front();
+        if( (now - front.second) < max_idle
+            && (_idle.size() + _in_use) <= max_connections )
+            break;
+        stale.emplace_back( std::move(front.first) );
+        _idle.erase( _idle.begin() );
+    }
+    return stale;
+}
+
+HTTPConnectionPool::Handle
+HTTPConnectionPool::checkout()
+{
+    std::unique_ptr<HTTPConnection> conn;
+    std::vector<std::unique_ptr<HTTPConnection>> stale;
+    {
+        std::unique_lock<std::mutex> lock(_mtx);
+        stale = _evict_idle();
+
+        if( _idle.empty() && _in_use >= max_connections ){
+            auto tbeg = clock_ty::now();
+            ++_waits;
+            _cond.wait( lock, [this]{
+                return !_idle.empty() || _in_use < max_connections;
+            });
+            _wait_time += std::chrono::duration_cast<std::chrono::milliseconds>(
+                clock_ty::now() - tbeg
+                );
+        }
+
+        if( !_idle.empty() ){
+            // most recently used is the most likely to still be alive
+            conn = std::move(_idle.back().first);
+            _idle.pop_back();
+        }
+        ++_in_use;
+    }
+    // close stale connections outside the lock
+
+    if( !conn ){
+        try{
+            conn.reset( new HTTPConnection(_meth) );
+        }catch(...){
+            {
+                std::lock_guard<std::mutex> lock(_mtx);
+                --_in_use;
+            }
+            _cond.notify_one();
+            throw;
+        }
+    }
+    return Handle(this, std::move(conn));
+}
+
+void
+HTTPConnectionPool::_checkin(std::unique_ptr<HTTPConnection> conn, bool reuse)
+{
+    std::vector<std::unique_ptr<HTTPConnection>> stale;
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        assert( _in_use > 0 );
+        --_in_use;
+        if( reuse && (_in_use + _idle.size()) < max_connections )
+            _idle.emplace_back( std::move(conn), clock_ty::now() );
+        stale = _evict_idle();
+    }
+    _cond.notify_one();
+    // 'conn' (if not re-used) and 'stale' close outside the lock
+}
+
+ConnectionPoolStats
+HTTPConnectionPool::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(_mtx);
+    return {_in_use, _idle.size(), _waits, _wait_time};
 }
 
 
@@ -620,31 +1495,21 @@ SharedHTTPConnection::SharedHTTPConnection( const std::string& url,
         _url(url),
         _meth(meth),
         _headers(),
+        _auth(),
         _fields(),
         _timeout(0),
-        _id(context_id)
+        _id(context_id),
+        _tmpl(),
+        _times()
     {
         { // all 'opening' context ops should hold static mutex
             std::lock_guard<std::mutex> lock(contexts_mtx);
 
-            auto citer = contexts.find(context_id);
-            if( citer == contexts.cend() ){
-                // if new id add a context with new connection
-                contexts[context_id] = Context(
-                        url.empty() ? new HTTPConnection(meth)
-                                    : new HTTPConnection(url,meth)
-                );
-            }else{
-                assert( citer->second.nref > 0 );
-                {
-                    // if old but not all have been closed
-                    std::lock_guard<std::mutex> lock( *(citer->second.mtx) );
-                    citer->second.conn->set_method(meth);
-                    // set url (redundant) to force ssl verify check
-                    if( !url.empty() )
-                        citer->second.conn->set_url(url);
-                }
-            }
+            // if new id add a context with an empty pool
+            if( contexts.find(context_id) == contexts.cend() )
+                contexts[context_id] = Context(meth);
+            else
+                assert( contexts[context_id].nref > 0 );
             incr_ref(context_id);
         }
         _is_open = true;
@@ -657,9 +1522,12 @@ SharedHTTPConnection::SharedHTTPConnection( const SharedHTTPConnection& connecti
         _url( connection._url ),
         _meth( connection._meth),
         _headers( connection._headers ),
+        _auth( connection._auth ),
         _fields( connection._fields ),
         _timeout( connection._timeout ),
-        _id( connection._id )
+        _id( connection._id ),
+        _tmpl( connection._tmpl ),
+        _times( connection._times )
     {
         if( _is_open ){
             std::lock_guard<std::mutex> lock(contexts_mtx);
@@ -688,9 +1556,12 @@ SharedHTTPConnection::operator=( const SharedHTTPConnection& connection )
         _url = connection._url;
         _meth = connection._meth;
         _headers = connection._headers;
+        _auth = connection._auth;
         _fields = connection._fields;
         _timeout = connection._timeout;
         _id = connection._id;
+        _tmpl = connection._tmpl;
+        _times = connection._times;
     }
     return *this;
 }
@@ -702,6 +1573,7 @@ SharedHTTPConnection::operator==( const SharedHTTPConnection& connection )
             && _url == connection._url
             && _meth == connection._meth
             && _headers == connection._headers
+            && _auth == connection._auth
             && _fields == connection._fields
             && _timeout == connection._timeout
             && _id == connection._id;
@@ -709,45 +1581,68 @@ SharedHTTPConnection::operator==( const SharedHTTPConnection& connection )
 }
 
 std::tuple<long, std::string, std::string, clock_ty::time_point>
-SharedHTTPConnection::execute(bool return_header_data)
+SharedHTTPConnection::execute( bool return_header_data,
+                               const chunk_cb_ty& on_chunk )
 {
     if( is_closed() )
         throw CurlException("connection has been closed");
 
-    Context& ctx = _get_context();
-    assert( ctx.conn );
-    assert( ctx.mtx );
-
-    // protect from concurrent access by other shared connections
-    std::lock_guard<std::mutex> lock( *ctx.mtx );
-
-    ctx.conn->set_url(_url);
-
-    ctx.conn->reset_headers();
-    if( !_headers.empty() )
-        ctx.conn->add_headers(_headers);
-
-    ctx.conn->set_method(_meth);
-    if( _meth != HttpMethod::http_get && !_fields.empty() )
-        ctx.conn->set_fields(_fields);
-    _fields.clear();
-
-    ctx.conn->set_timeout(_timeout);
-
-    return ctx.conn->execute(return_header_data);
+    auto pool = _get_pool();
+    assert( pool );
+
+    if( !_tmpl )
+        _tmpl = std::make_shared<const RequestTemplate>(_url, _headers, _auth);
+
+    // each caller gets its own connection; blocks if the pool is maxed out
+    auto conn = pool->checkout();
+    try{
+        /* (a connection re-used w/ the same template is already set up) */
+        conn->use_template(_tmpl);
+
+        if( conn->get_method() != _meth )
+            conn->set_method(_meth);
+        if( _meth != HttpMethod::http_get && !_fields.empty() )
+            conn->set_fields(_fields);
+        _fields.clear();
+
+        if( conn->get_timeout() != _timeout )
+            conn->set_timeout(_timeout);
+
+        auto r = conn->execute(return_header_data, on_chunk);
+        _times = conn->get_transfer_times();
+        return r;
+    }catch(...){
+        // don't put a connection in an unknown state back in the pool
+        conn.discard();
+        throw;
+    }
 }
 
-SharedHTTPConnection::Context&
-SharedHTTPConnection::_get_context() const
+std::shared_ptr<HTTPConnectionPool>
+SharedHTTPConnection::_get_pool() const
 {
     std::lock_guard<std::mutex> lock(contexts_mtx);
     /*
-     * only hold the static mutex for the find - if open the only
-     *   shared-state at risk of data race is nref which we don't need
+     * only hold the static mutex for the find; copy the pool ptr so it
+     * outlives the context if the last ref is closed while executing
      */
     auto citer = contexts.find(_id);
     assert( citer != contexts.cend() );
-    return citer->second;
+    return citer->second.pool;
+}
+
+ConnectionPoolStats
+SharedHTTPConnection::get_pool_stats(int context_id)
+{
+    std::shared_ptr<HTTPConnectionPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(contexts_mtx);
+        auto citer = contexts.find(context_id);
+        if( citer != contexts.cend() )
+            pool = citer->second.pool;
+    }
+    return pool ? pool->get_stats()
+                : ConnectionPoolStats{0, 0, 0, std::chrono::milliseconds(0)};
 }
 
 void
@@ -765,14 +1660,36 @@ SharedHTTPConnection::close()
 void
 SharedHTTPConnection::set_url(const std::string& url)
 {
-    using namespace std::regex_constants;
+    if( url.rfind("https://", 0) != 0 && url.rfind("http://", 0) != 0 )
+        throw CurlException("invalid protocol in url: " + url);
+
+    if( url != _url ){
+        _url = url;
+        _tmpl.reset();
+    }
+}
 
-    static const std::regex PROTO_RX("http[s]?\\://");
 
-    if( !std::regex_search(url, PROTO_RX, match_continuous) )
-        throw CurlException("invalid protocol in url: " + url);
+void
+SharedHTTPConnection::add_headers(const std::vector<std::pair<std::string,std::string>>& headers)
+{
+    for( auto& h : headers ){
+        if( h.first == AUTH_HEADER )
+            _auth = h.second;
+        else
+            _headers.push_back(h);
+    }
+    _tmpl.reset();
+}
 
-    _url = url;
+
+std::vector<std::pair<std::string,std::string>>
+SharedHTTPConnection::get_headers() const
+{
+    std::vector<std::pair<std::string,std::string>> headers(_headers);
+    if( !_auth.empty() )
+        headers.emplace_back(AUTH_HEADER, _auth);
+    return headers;
 }
 
 
@@ -782,7 +1699,7 @@ SharedHTTPConnection::decr_ref(int id)
 {
     auto citer = contexts.find(id);
     assert( citer != contexts.cend() );
-    assert( citer->second.conn );
+    assert( citer->second.pool );
     --(citer->second.nref);
     assert(citer->second.nref >= 0);
     if( citer->second.nref == 0 )
@@ -795,7 +1712,7 @@ SharedHTTPConnection::incr_ref(int id)
 {
     auto citer = contexts.find(id);
     assert( citer != contexts.cend() );
-    assert( citer->second.conn );
+    assert( citer->second.pool );
     ++(citer->second.nref);
 }
 
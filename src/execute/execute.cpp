@@ -26,9 +26,10 @@ namespace {
 string
 order_id_from_header(const string& header)
 {
+    /* any host (the base url is overridable), any case (HTTP/2) */
     static const std::regex ID_RX(
-        "Location:[ ]*https://api\\.tdameritrade\\.com/.+/[0-9]+/orders/"
-        "([0-9]+)[ ]*[\r\n]+"
+        "Location:[ ]*[^ \r\n]+/[0-9]+/orders/([0-9]+)[ ]*[\r\n]+",
+        std::regex::ECMAScript | std::regex::icase
     );
 
     std::smatch m;
@@ -50,7 +51,7 @@ Execute_SendOrderImpl( Credentials& creds,
                        const string& account_id,
                        const OrderTicketImpl& order )
 {
-    string url = URL_ACCOUNTS + util::url_encode(account_id) + "/orders";
+    string url = url_accounts() + util::url_encode(account_id) + "/orders";
     string body = order.as_json_string();
 
     if( body.empty() )
@@ -72,7 +73,7 @@ Execute_CancelOrderImpl( Credentials& creds,
                          const string& account_id,
                          const string& order_id )
 {
-    string url = URL_ACCOUNTS + util::url_encode(account_id)
+    string url = url_accounts() + util::url_encode(account_id)
                + "/orders/" + util::url_encode(order_id); // encode uncessary
 
     conn::HTTPConnection connection( url, conn::HttpMethod::http_delete );
@@ -82,7 +82,7 @@ class AccountInfoGetterImpl
             fields = "?fields=orders";
         }
 
-        string url = URL_ACCOUNTS + util::url_encode(get_account_id()) + fields;
+        string url = url_accounts() + util::url_encode(get_account_id()) + fields;
         APIGetterImpl::set_url(url);
     }
 
@@ -135,7 +135,7 @@ class PreferencesGetterImpl
     void
     _build()
     {
-        string url = URL_ACCOUNTS + util::url_encode(get_account_id())
+        string url = url_accounts() + util::url_encode(get_account_id())
                      + "/preferences";
         APIGetterImpl::set_url(url);
     }
@@ -153,6 +153,7 @@ public:
         :
             AccountGetterBaseImpl(creds, account_id)
         {
+            set_cache_ttl( std::chrono::hours(1) );
             _build();
         }
 
@@ -166,7 +167,7 @@ class StreamerSubscriptionKeysGetterImpl
     _build()
     {
         string params = "?accountIds=" + util::url_encode(get_account_id());
-        string url = URL_BASE + "userprincipals/streamersubscriptionkeys"
+        string url = url_base() + "userprincipals/streamersubscriptionkeys"
                      + params;
         APIGetterImpl::set_url(url);
     }
@@ -211,7 +212,7 @@ class TransactionHistoryGetterImpl
             params.emplace_back("endDate", _end_date);
 
         string qstr = util::build_encoded_query_str(params);
-        string url = URL_ACCOUNTS + util::url_encode(get_account_id())
+        string url = url_accounts() + util::url_encode(get_account_id())
                      + "/transactions?" + qstr;
         APIGetterImpl::set_url(url);
     }
@@ -313,7 +314,7 @@ class IndividualTransactionHistoryGetterImpl
     void
     _build()
     {
-        string url = URL_ACCOUNTS + util::url_encode(get_account_id())
+        string url = url_accounts() + util::url_encode(get_account_id())
                      + "/transactions/" + util::url_encode(_transaction_id);
         APIGetterImpl::set_url(url);
     }
@@ -382,7 +383,7 @@ class UserPrincipalsGetterImpl
             fields_str = "?fields=" + util::join(fields, ',');
         }
 
-        string url = URL_BASE + "userprincipals" + fields_str;
+        string url = url_base() + "userprincipals" + fields_str;
         APIGetterImpl::set_url(url);
     }
 
@@ -407,6 +408,8 @@ public:
             _preferences(preferences),
             _surrogate_ids(surrogate_ids)
         {
+            /* short, the streamer connection info has a login token */
+            set_cache_ttl( std::chrono::minutes(5) );
             _build();
         }
 
@@ -470,7 +473,7 @@ class OrderGetterImpl
     void
     _build()
     {
-        string url = URL_ACCOUNTS + util::url_encode(get_account_id())
+        string url = url_accounts() + util::url_encode(get_account_id())
                     + "/orders/" + util::url_encode(_order_id);
         APIGetterImpl::set_url(url);
     }
@@ -533,7 +536,7 @@ class OrdersGetterImpl
             params.push_back( {"status", to_string(_order_status_type)} );
 
         string qstr = util::build_encoded_query_str(params);
-        string url = URL_ACCOUNTS + util::url_encode(get_account_id())
+        string url = url_accounts() + util::url_encode(get_account_id())
                     + "/orders?" + qstr;
 
         APIGetterImpl::set_url(url);
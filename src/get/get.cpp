@@ -20,6 +20,9 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <regex>
 #include <cctype>
 #include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <limits>
 #include <string.h>
 
 #include "../../include/_tdma_api.h"
@@ -30,18 +33,186 @@ using std::tie;
 using std::chrono::milliseconds;
 
 
+namespace {
+
+tdma::EndpointClass
+endpoint_class_from_url(const string& url)
+{
+    using namespace tdma;
+
+    string prefix = url_marketdata();
+    if( url.compare(0, prefix.size(), prefix) == 0 )
+        return EndpointClass::marketdata;
+    prefix = url_instruments();
+    if( url.compare(0, prefix.size(), prefix) == 0 )
+        return EndpointClass::instruments;
+    /* accounts, userprincipals etc. */
+    return EndpointClass::accounts;
+}
+
+
+/* account/order-status gets ahead of market data (see request_scheduler.h) */
+int
+lane_from_endpoint_class(tdma::EndpointClass endpoint_class)
+{
+    using namespace tdma;
+
+    return static_cast<int>( endpoint_class == EndpointClass::accounts
+                             ? RequestLane::account
+                             : RequestLane::marketdata );
+}
+
+
+/*
+ * InFlightGets - identical gets(same client_id and url) in progress
+ *
+ * The first caller makes the request; callers that arrive before it's
+ * done wait for and share its result(or exception) instead of making
+ * their own request and using another throttle token.
+ */
+class InFlightGets{
+    struct Flight{
+        bool done;
+        size_t nwaiting;
+        string data;
+        std::exception_ptr error;
+
+        Flight() : done(false), nwaiting(0) {}
+    };
+
+    std::mutex _mtx;
+    std::condition_variable _cond;
+    std::unordered_map<string, std::shared_ptr<Flight>> _flights;
+
+    void
+    _finish( const string& key,
+             const std::shared_ptr<Flight>& flight,
+             const string *data,
+             std::exception_ptr error )
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            if( flight->nwaiting > 0 ){
+                if( data )
+                    flight->data = *data;
+                flight->error = error;
+            }
+            flight->done = true;
+            _flights.erase(key);
+        }
+        _cond.notify_all();
+    }
+
+public:
+    template<typename F>
+    string
+    get(const string& key, F make_request)
+    {
+        std::shared_ptr<Flight> flight;
+        {
+            std::unique_lock<std::mutex> lock(_mtx);
+            auto fiter = _flights.find(key);
+            if( fiter != _flights.end() ){
+                flight = fiter->second;
+                ++flight->nwaiting;
+                _cond.wait( lock, [&flight]{ return flight->done; } );
+                if( flight->error )
+                    std::rethrow_exception(flight->error);
+                return flight->data;
+            }
+            flight = std::make_shared<Flight>();
+            _flights.emplace(key, flight);
+        }
+
+        string data;
+        try{
+            data = make_request();
+        }catch(...){
+            _finish(key, flight, nullptr, std::current_exception());
+            throw;
+        }
+        _finish(key, flight, &data, nullptr);
+        return data;
+    }
+};
+
+InFlightGets in_flight_gets;
+
+
+void
+record_waits( const string& endpoint,
+              milliseconds throttle_wait,
+              std::chrono::steady_clock::duration queue_wait )
+{
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+
+    MetricsRegistry& m = tdma::metrics();
+    m.record_phase( endpoint, MetricsRegistry::Phase::throttle_wait,
+                    duration_cast<microseconds>(throttle_wait) );
+    m.record_phase( endpoint, MetricsRegistry::Phase::queue_wait,
+                    duration_cast<microseconds>(queue_wait) );
+}
+
+
+bool
+code_in(int code, const int codes[TDMA_API_RETRY_MAX_CODES])
+{
+    for( int i = 0; i < TDMA_API_RETRY_MAX_CODES && codes[i]; ++i ){
+        if( codes[i] == code )
+            return true;
+    }
+    return false;
+}
+
+bool
+is_retryable(const RetryPolicy& policy, std::exception_ptr e)
+{
+    try{
+        std::rethrow_exception(e);
+    }catch( tdma::CurlConnectException& ce ){
+        return code_in(ce.curl_code(), policy.curl_codes);
+    }catch( tdma::ConnectException& ce ){
+        return ce.status_code() && code_in(ce.status_code(), policy.status_codes);
+    }catch(...){
+    }
+    return false;
+}
+
+} /* namespace */
+
+
 namespace tdma{
 
 const milliseconds APIGetterImpl::DEF_WAIT_MSEC(500);
+const unsigned int APIGetterImpl::DEF_BURST = 1;
 
-milliseconds APIGetterImpl::wait_msec(APIGetterImpl::DEF_WAIT_MSEC);
-milliseconds APIGetterImpl::last_get_msec(
-    util::get_msec_since_epoch<conn::clock_ty>()
-    );
+TokenBucket APIGetterImpl::throttle( APIGetterImpl::DEF_WAIT_MSEC,
+                                     APIGetterImpl::DEF_BURST );
 
-std::mutex APIGetterImpl::get_mtx;
+TokenBucket APIGetterImpl::endpoint_throttles[3];
 
 int APIGetterImpl::current_connection_group = 0;
+ResponseCache APIGetterImpl::response_cache;
+
+const RetryPolicy APIGetterImpl::DEF_RETRY_POLICY = {
+    1, 250, 8000,
+    {429, 500, 502, 503, 504},
+    { CURLE_COULDNT_RESOLVE_HOST, CURLE_COULDNT_CONNECT,
+      CURLE_OPERATION_TIMEDOUT, CURLE_SSL_CONNECT_ERROR, CURLE_GOT_NOTHING,
+      CURLE_SEND_ERROR, CURLE_RECV_ERROR },
+    0
+};
+
+std::mutex APIGetterImpl::retry_policy_mtx;
+
+RetryPolicy APIGetterImpl::retry_policies[3] = {
+    APIGetterImpl::DEF_RETRY_POLICY,
+    APIGetterImpl::DEF_RETRY_POLICY,
+    APIGetterImpl::DEF_RETRY_POLICY
+};
+
+LatencyTracker APIGetterImpl::latencies[3];
 
 APIGetterImpl::APIGetterImpl( Credentials& creds,
                               api_on_error_cb_ty on_error_callback )
@@ -58,20 +229,176 @@ APIGetterImpl::APIGetterImpl( Credentials& creds,
                                 conn::HttpMethod::http_get,
                                 current_connection_group)
                         )
-                )
+                ),
+        _connection_mtx( new std::mutex ),
+        _endpoint_class( EndpointClass::accounts ),
+        _coalesce(true),
+        _cache_ttl(0)
     {
     }
 
 void
 APIGetterImpl::set_url(const string& url)
 {
+    /* read on other threads by requests already in flight */
+    std::lock_guard<std::mutex> _(*_connection_mtx);
     _connection->set_url(url);
+    _endpoint_class = endpoint_class_from_url(url);
+    _endpoint = MetricsRegistry::endpoint("GET", url);
+}
+
+string
+APIGetterImpl::endpoint() const
+{
+    std::lock_guard<std::mutex> _(*_connection_mtx);
+    return _endpoint;
+}
+
+EndpointClass
+APIGetterImpl::get_endpoint_class() const
+{
+    std::lock_guard<std::mutex> _(*_connection_mtx);
+    return _endpoint_class;
+}
+
+string
+APIGetterImpl::account_key(const Credentials& creds)
+{
+    /* the key can end up on disk so the token is hashed */
+    std::ostringstream ss;
+    ss << (creds.client_id ? creds.client_id : "") << ' ' << std::hex
+       << ResponseCacheStore::fnv1a(creds.refresh_token ? creds.refresh_token
+                                                        : "");
+    return ss.str();
+}
+
+string
+APIGetterImpl::request_key() const
+{
+    string url;
+    {
+        std::lock_guard<std::mutex> _(*_connection_mtx);
+        url = _connection->get_url();
+    }
+    /* different accounts shouldn't share responses, even under the same
+     * client id */
+    return account_key(_credentials.get()) + ' ' + url;
 }
 
 string
 APIGetterImpl::get()
 {
-    return APIGetterImpl::throttled_get(*this);
+    bool use_cache = _cache_ttl.count() > 0;
+    if( !_coalesce && !use_cache )
+        return APIGetterImpl::throttled_get(*this);
+
+    string key = request_key();
+    string data;
+    if( use_cache && response_cache.get(key, data) )
+        return data;
+
+    if( _coalesce ){
+        data = in_flight_gets.get( key,
+            [this]{ return APIGetterImpl::throttled_get(*this); } );
+    }else
+        data = APIGetterImpl::throttled_get(*this);
+
+    if( use_cache && !data.empty() )
+        response_cache.put(key, data, _cache_ttl);
+    return data;
+}
+
+void
+APIGetterImpl::set_cache_directory(const string& directory)
+{
+    if( directory.empty() )
+        response_cache.set_store(nullptr);
+    else
+        response_cache.set_store( std::make_shared<DiskCacheStore>(directory) );
+}
+
+string
+APIGetterImpl::get_cache_directory()
+{
+    auto store = std::dynamic_pointer_cast<DiskCacheStore>(
+        response_cache.get_store()
+        );
+    return store ? store->get_directory() : string();
+}
+
+std::shared_ptr<conn::HTTPConnection>
+APIGetterImpl::async_connection() const
+{
+    /*
+     * copy the current request into its own connection so the getter can be
+     * changed/re-used right away; transfers on the async loop share its
+     * connection cache so the TCP/TLS connection still gets re-used
+     */
+    std::lock_guard<std::mutex> _(*_connection_mtx);
+    if( _connection->is_closed() )
+        TDMA_API_THROW( APIException, "connection is closed");
+
+    auto connection = std::make_shared<conn::HTTPConnection>(
+        _connection->get_url(), conn::HttpMethod::http_get
+        );
+    connection->set_timeout( _connection->get_timeout() );
+    return connection;
+}
+
+void
+APIGetterImpl::get_async(connect_async_cb_ty callback)
+{
+    std::shared_ptr<conn::HTTPConnection> connection = async_connection();
+    string ep = endpoint();
+    EndpointClass endpoint_class = get_endpoint_class();
+    Credentials& creds = _credentials.get();
+    api_on_error_cb_ty on_error_callback = _on_error_callback;
+
+    /*
+     * take the throttle tokens now, but wait for them on the async loop;
+     * queue for the lane w/o blocking - it's taken when the scheduler
+     * admits us (maybe from the loop thread) and given back when done
+     */
+    milliseconds w = max( throttle.reserve(),
+                          endpoint_throttle(endpoint_class).reserve() );
+    auto tq = std::chrono::steady_clock::now();
+
+    request_scheduler().acquire_async(
+        lane_from_endpoint_class(endpoint_class),
+        [=, &creds]( RequestScheduler::Ticket&& t,
+                     RequestScheduler::clock_ty::time_point ready_at )
+        {
+            auto ticket = std::make_shared<RequestScheduler::Ticket>(
+                std::move(t)
+                );
+            record_waits(ep, w, std::chrono::steady_clock::now() - tq);
+            try{
+                connect_get_async( connection, creds, on_error_callback,
+                                   std::max(tq + w, ready_at),
+                    [ticket, callback, connection, ep]( const string& data,
+                                                        std::exception_ptr e )
+                    {
+                        ticket->release();
+                        record_request_metrics( ep,
+                            (e ? status_from_exception(e)
+                               : conn::HTTP_RESPONSE_OK),
+                            *connection );
+                        callback(data, e);
+                    } );
+            }catch(...){
+                ticket->release();
+                callback( string(), std::current_exception() );
+            }
+        } );
+}
+
+void
+APIGetterImpl::get_stream(const conn::chunk_cb_ty& on_chunk)
+{
+    if( !on_chunk )
+        TDMA_API_THROW( ValueException, "invalid chunk callback");
+
+    APIGetterImpl::throttled_get(*this, on_chunk);
 }
 
 void
@@ -99,62 +426,307 @@ APIGetterImpl::get_timeout() const
 }
 
 string
-APIGetterImpl::throttled_get(APIGetterImpl& getter)
+APIGetterImpl::throttled_get( APIGetterImpl& getter,
+                              const conn::chunk_cb_ty& on_chunk )
+{
+    EndpointClass endpoint_class = getter.get_endpoint_class();
+    int ec = static_cast<int>(endpoint_class);
+    RetryPolicy policy = get_retry_policy(endpoint_class);
+
+    /*
+     * each attempt(and hedge) takes its own throttle tokens so retries
+     * come out of the same rate budget as everything else; a stream that
+     * already passed data along can't be retried
+     */
+    for( unsigned int attempt = 1; ; ++attempt ){
+        bool chunked = false;
+        try{
+            if( on_chunk ){
+                return throttled_get_once( getter,
+                    [&]( const char* p, size_t n ){
+                        chunked = true;
+                        return on_chunk(p, n);
+                    } );
+            }
+
+            milliseconds hedge_after(0);
+            if( policy.hedge_percentile )
+                hedge_after = latencies[ec].percentile(policy.hedge_percentile);
+
+            return (hedge_after.count() > 0)
+                ? hedged_get(getter, hedge_after)
+                : throttled_get_once(getter, conn::chunk_cb_ty());
+        }catch(...){
+            if( attempt >= policy.max_attempts || chunked
+                || !is_retryable(policy, std::current_exception()) )
+            {
+                throw;
+            }
+        }
+
+        metrics().count_retry( getter.endpoint() );
+        milliseconds w = backoff_with_jitter(
+            milliseconds(policy.backoff_msec),
+            milliseconds(policy.max_backoff_msec),
+            attempt
+            );
+        util::debug_out( "APIGetter", "retrying get (attempt "
+            + std::to_string(attempt + 1) + " of "
+            + std::to_string(policy.max_attempts) + ") in "
+            + std::to_string(w.count()) + " msec" );
+        std::this_thread::sleep_for(w);
+    }
+}
+
+string
+APIGetterImpl::throttled_get_once( APIGetterImpl& getter,
+                                   const conn::chunk_cb_ty& on_chunk )
 {
     /*
-     * get_mtx allows threaded api execution from different getters in
-     * different threads AND the same getter in different threads.
-     *
-     * IT DOESN'T HANDLE OTHER OTHER SYNC ISSUES INSIDE THE CurlConnection
-     * CLASSES.
+     * 'throttle' is a global token bucket for ALL get requests to avoid
+     * excessive calls to TDMA servers; 'endpoint_throttles' are optional
+     * buckets for each class of endpoint. Take a token from each and wait
+     * for the longer of the two - OUTSIDE of any lock - so other threads
+     * can reserve their own tokens and have requests in flight at the same
+     * time.
+     */
+    EndpointClass endpoint_class = getter.get_endpoint_class();
+    milliseconds w = max( throttle.reserve(),
+                          endpoint_throttle(endpoint_class).reserve() );
+    if( w.count() > 0 )
+        std::this_thread::sleep_for(w);
+
+    /* wait for the lane; orders in flight hold back all gets */
+    auto tq = std::chrono::steady_clock::now();
+    RequestScheduler::Ticket ticket = request_scheduler().acquire(
+        lane_from_endpoint_class(endpoint_class)
+        );
+    auto queue_wait = std::chrono::steady_clock::now() - tq;
+
+    /*
+     * _connection_mtx allows the same getter to be used from different
+     * threads. SharedHTTPConnection checks out its own connection from
+     * the group's pool so different getters don't serialize here.
      */
-    std::lock_guard<std::mutex> _(get_mtx);
-
-    auto remaining = throttled_wait_remaining();
-    if( remaining.count() > 0 ){
-        /*
-         * wait_msec and last_get_msec provide a global throttling mechanism
-         * for ALL get requests to avoid excessive calls to TDMA servers
-         */
-        assert( remaining <= wait_msec );
-        std::this_thread::sleep_for( remaining );
+    std::lock_guard<std::mutex> _(*getter._connection_mtx);
+
+    record_waits(getter._endpoint, w, queue_wait);
+    try{
+        if( on_chunk ){
+            connect_get_stream( *(getter._connection), getter._credentials,
+                                getter._on_error_callback, on_chunk );
+            record_request_metrics( getter._endpoint, conn::HTTP_RESPONSE_OK,
+                                    *(getter._connection) );
+            return string();
+        }
+
+        auto tbeg = std::chrono::steady_clock::now();
+        string s;
+        conn::clock_ty::time_point tp;
+        tie(s, tp) = connect_get( *(getter._connection), getter._credentials,
+                                  getter._on_error_callback );
+        latencies[ static_cast<int>(getter._endpoint_class) ].add(
+            std::chrono::duration_cast<milliseconds>(
+                std::chrono::steady_clock::now() - tbeg
+                )
+            );
+        record_request_metrics( getter._endpoint, conn::HTTP_RESPONSE_OK,
+                                *(getter._connection) );
+        return s;
+    }catch(...){
+        record_request_metrics( getter._endpoint,
+                                status_from_exception(std::current_exception()),
+                                *(getter._connection) );
+        throw;
     }
+}
+
+string
+APIGetterImpl::hedged_get(APIGetterImpl& getter, milliseconds hedge_after)
+{
+    /*
+     * both requests go through the async loop on their own connections;
+     * the first success wins and the other is ignored when it finishes.
+     * The loser can outlive this call (and the caller's credentials) so
+     * both use their own copy of the credentials.
+     */
+    struct State{
+        std::mutex mtx;
+        std::condition_variable cond;
+        int pending;
+        bool done;
+        string data;
+        std::exception_ptr error;
+
+        State() : pending(0), done(false) {}
+    };
+
+    auto state = std::make_shared<State>();
+    EndpointClass endpoint_class = getter.get_endpoint_class();
+    LatencyTracker& latency = latencies[ static_cast<int>(endpoint_class) ];
+    string ep = getter.endpoint();
+    auto creds = std::make_shared<Credentials>( getter._credentials.get() );
+
+    auto send = [&]() -> milliseconds {
+        std::shared_ptr<conn::HTTPConnection> connection =
+            getter.async_connection();
+        milliseconds w = max(
+            throttle.reserve(), endpoint_throttle(endpoint_class).reserve()
+            );
+        auto tq = std::chrono::steady_clock::now();
+        auto ticket = std::make_shared<RequestScheduler::Ticket>(
+            request_scheduler().acquire(
+                lane_from_endpoint_class(endpoint_class) )
+            );
+        record_waits(ep, w, std::chrono::steady_clock::now() - tq);
+        auto start_at = conn::clock_ty::now() + w;
+        {
+            std::lock_guard<std::mutex> _(state->mtx);
+            ++state->pending;
+        }
+        try{
+            connect_get_async( connection, *creds,
+                               getter._on_error_callback, start_at,
+                [state, start_at, ticket, &latency, connection, ep, creds](
+                    const string& data, std::exception_ptr e )
+                {
+                    ticket->release();
+                    record_request_metrics( ep,
+                        (e ? status_from_exception(e) : conn::HTTP_RESPONSE_OK),
+                        *connection );
+                    {
+                        std::lock_guard<std::mutex> _(state->mtx);
+                        --state->pending;
+                        if( !e ){
+                            latency.add( std::chrono::duration_cast<milliseconds>(
+                                conn::clock_ty::now() - start_at) );
+                        }
+                        if( state->done )
+                            return;
+                        if( !e ){
+                            state->data = data;
+                            state->error = nullptr;
+                            state->done = true;
+                        }else{
+                            state->error = e;
+                            state->done = (state->pending == 0);
+                        }
+                    }
+                    state->cond.notify_all();
+                }
+            );
+        }catch(...){
+            ticket->release();
+            {
+                std::lock_guard<std::mutex> _(state->mtx);
+                --state->pending;
+                /* the other request may have already failed */
+                if( state->error && state->pending == 0 )
+                    state->done = true;
+            }
+            state->cond.notify_all();
+            throw;
+        }
+        return w;
+    };
+
+    milliseconds w = send();
 
-    string s;
-    conn::clock_ty::time_point tp;
-    tie(s, tp) = connect_get( *(getter._connection), getter._credentials,
-                              getter._on_error_callback );
+    std::unique_lock<std::mutex> lock(state->mtx);
+    if( !state->cond.wait_for( lock, w + hedge_after,
+                               [&state]{ return state->done; } ) )
+    {
+        lock.unlock();
+        util::debug_out( "APIGetter", "hedging get after "
+                         + std::to_string(hedge_after.count()) + " msec" );
+        metrics().count_hedge(ep);
+        try{
+            send();
+        }catch(std::exception& e){
+            /* keep waiting on the first request */
+            util::debug_out( "APIGetter",
+                             string("failed to send hedge: ") + e.what() );
+        }
+        lock.lock();
+    }
+    state->cond.wait( lock, [&state]{ return state->done; } );
 
-    last_get_msec =
-        std::chrono::duration_cast<milliseconds>(tp.time_since_epoch());
-    return s;
+    if( state->error )
+        std::rethrow_exception(state->error);
+    return state->data;
 }
 
-milliseconds
-APIGetterImpl::throttled_wait_remaining()
+void
+APIGetterImpl::set_retry_policy( EndpointClass endpoint_class,
+                                 const RetryPolicy& policy )
 {
-    auto elapsed = util::get_msec_since_epoch<conn::clock_ty>() - last_get_msec;
-    assert( elapsed.count() >= 0 );
-    return wait_msec - elapsed;
+    if( policy.max_attempts < 1 )
+        TDMA_API_THROW(ValueException, "max_attempts < 1");
+    if( policy.max_backoff_msec < policy.backoff_msec )
+        TDMA_API_THROW(ValueException, "max_backoff_msec < backoff_msec");
+    if( policy.hedge_percentile
+        && (policy.hedge_percentile < 50 || policy.hedge_percentile > 99) )
+    {
+        TDMA_API_THROW(ValueException, "hedge_percentile not 0 or 50 - 99");
+    }
+
+    std::lock_guard<std::mutex> _(retry_policy_mtx);
+    retry_policies[ static_cast<int>(endpoint_class) ] = policy;
 }
 
-milliseconds
-APIGetterImpl::wait_remaining()
+RetryPolicy
+APIGetterImpl::get_retry_policy(EndpointClass endpoint_class)
+{
+    std::lock_guard<std::mutex> _(retry_policy_mtx);
+    return retry_policies[ static_cast<int>(endpoint_class) ];
+}
+
+TokenBucket&
+APIGetterImpl::endpoint_throttle(EndpointClass endpoint_class)
 {
-    static const milliseconds ms0(0);
-    return max(throttled_wait_remaining(), ms0);
+    return endpoint_throttles[ static_cast<int>(endpoint_class) ];
 }
 
+milliseconds
+APIGetterImpl::wait_remaining()
+{ return throttle.wait_remaining(); }
+
 void
 APIGetterImpl::set_wait_msec(milliseconds msec)
+{ throttle.set_refill(msec); }
+
+milliseconds
+APIGetterImpl::get_wait_msec()
+{ return throttle.get_refill(); }
+
+void
+APIGetterImpl::set_burst(unsigned int burst)
+{ throttle.set_burst(burst); }
+
+unsigned int
+APIGetterImpl::get_burst()
+{ return throttle.get_burst(); }
+
+void
+APIGetterImpl::set_endpoint_wait_msec( EndpointClass endpoint_class,
+                                       milliseconds msec,
+                                       unsigned int burst )
 {
-    std::lock_guard<std::mutex> _(get_mtx);
-    wait_msec = msec;
+    TokenBucket& tb = endpoint_throttle(endpoint_class);
+    tb.set_refill(msec);
+    tb.set_burst(burst);
+}
+
+std::pair<milliseconds, unsigned int>
+APIGetterImpl::get_endpoint_wait_msec(EndpointClass endpoint_class)
+{
+    TokenBucket& tb = endpoint_throttle(endpoint_class);
+    return std::make_pair(tb.get_refill(), tb.get_burst());
 }
 
 milliseconds
-APIGetterImpl::get_wait_msec()
-{ return wait_msec; }
+APIGetterImpl::endpoint_wait_remaining(EndpointClass endpoint_class)
+{ return endpoint_throttle(endpoint_class).wait_remaining(); }
 
 } /* tdma */
 
@@ -173,6 +745,149 @@ APIGetter_Get_ABI( Getter_C *pgetter,
         );
 }
 
+int
+APIGetter_GetAsync_ABI( Getter_C *pgetter,
+                        getter_async_cb_ty callback,
+                        void *ctx,
+                        int allow_exceptions )
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(callback, "callback", allow_exceptions);
+
+    static auto meth = +[](void* obj, getter_async_cb_ty cb, void* ctx){
+        reinterpret_cast<APIGetterImpl*>(obj)->get_async(
+            [=](const string& data, std::exception_ptr e){
+                if( e ){
+                    int code;
+                    string msg;
+                    tie(code, msg) = error_from_exception_ptr(e);
+                    cb(code, msg.c_str(), msg.size() + 1, ctx);
+                }else{
+                    cb(0, data.c_str(), data.size() + 1, ctx);
+                }
+            }
+        );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj, callback, ctx);
+}
+
+int
+APIGetter_GetStream_ABI( Getter_C *pgetter,
+                         getter_chunk_cb_ty callback,
+                         void *ctx,
+                         int allow_exceptions )
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(callback, "callback", allow_exceptions);
+
+    static auto meth = +[](void* obj, getter_chunk_cb_ty cb, void* ctx){
+        reinterpret_cast<APIGetterImpl*>(obj)->get_stream(
+            [=](const char* chunk, size_t n){
+                return cb(chunk, n, ctx) != 0;
+            }
+        );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj, callback, ctx);
+}
+
+int
+APIGetter_SetCoalesce_ABI(Getter_C *pgetter, int coalesce, int allow_exceptions)
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    static auto meth = +[](void* obj, int c){
+        reinterpret_cast<APIGetterImpl*>(obj)->set_coalesce( c != 0 );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj, coalesce);
+}
+
+int
+APIGetter_IsCoalescing_ABI(Getter_C *pgetter, int *b, int allow_exceptions)
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(b, "b", allow_exceptions);
+
+    static auto meth = +[](void* obj){
+        return static_cast<int>(
+            reinterpret_cast<APIGetterImpl*>(obj)->is_coalescing()
+            );
+    };
+
+    tie(*b, err) = CallImplFromABI(allow_exceptions, meth, pgetter->obj);
+    return err;
+}
+
+int
+APIGetter_SetCacheTTL_ABI( Getter_C *pgetter,
+                           unsigned long long msec,
+                           int allow_exceptions )
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    static auto meth = +[](void* obj, unsigned long long m){
+        static const unsigned long long MAX_LL =
+            static_cast<unsigned long long>(
+                (std::numeric_limits<milliseconds::rep>::max)()
+                );
+        reinterpret_cast<APIGetterImpl*>(obj)->set_cache_ttl(
+            milliseconds( static_cast<milliseconds::rep>(m > MAX_LL ? MAX_LL : m) )
+            );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj, msec);
+}
+
+int
+APIGetter_GetCacheTTL_ABI( Getter_C *pgetter,
+                           unsigned long long *msec,
+                           int allow_exceptions )
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(msec, "msec", allow_exceptions);
+
+    static auto meth = +[](void* obj){
+        return static_cast<unsigned long long>(
+            reinterpret_cast<APIGetterImpl*>(obj)->get_cache_ttl().count()
+            );
+    };
+
+    tie(*msec, err) = CallImplFromABI(allow_exceptions, meth, pgetter->obj);
+    return err;
+}
+
+int
+APIGetter_InvalidateCache_ABI(Getter_C *pgetter, int allow_exceptions)
+{
+    int err = proxy_is_callable<APIGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    static auto meth = +[](void* obj){
+        reinterpret_cast<APIGetterImpl*>(obj)->invalidate_cache();
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj);
+}
+
 int
 APIGetter_Close_ABI(Getter_C *pgetter, int allow_exceptions)
 {
@@ -287,6 +1002,113 @@ APIGetter_WaitRemaining_ABI(unsigned long long *msec, int allow_exceptions)
     return 0;
 }
 
+int
+APIGetter_SetBurst_ABI(unsigned int burst, int allow_exceptions)
+{
+    return CallImplFromABI( allow_exceptions, APIGetterImpl::set_burst,
+                            burst );
+}
+
+int
+APIGetter_GetBurst_ABI(unsigned int *burst, int allow_exceptions)
+{
+    CHECK_PTR(burst, "burst", allow_exceptions);
+
+    *burst = APIGetterImpl::get_burst();
+    return 0;
+}
+
+int
+APIGetter_SetEndpointWaitMSec_ABI( int endpoint_class,
+                                   unsigned long long msec,
+                                   unsigned int burst,
+                                   int allow_exceptions )
+{
+    CHECK_ENUM(EndpointClass, endpoint_class, allow_exceptions);
+
+    return CallImplFromABI( allow_exceptions,
+                            APIGetterImpl::set_endpoint_wait_msec,
+                            static_cast<EndpointClass>(endpoint_class),
+                            milliseconds(msec), burst );
+}
+
+int
+APIGetter_GetEndpointWaitMSec_ABI( int endpoint_class,
+                                   unsigned long long *msec,
+                                   unsigned int *burst,
+                                   int allow_exceptions )
+{
+    CHECK_ENUM(EndpointClass, endpoint_class, allow_exceptions);
+    CHECK_PTR(msec, "msec", allow_exceptions);
+    CHECK_PTR(burst, "burst", allow_exceptions);
+
+    std::pair<milliseconds, unsigned int> wb;
+    int err;
+    tie(wb, err) = CallImplFromABI( allow_exceptions,
+                                    APIGetterImpl::get_endpoint_wait_msec,
+                                    static_cast<EndpointClass>(endpoint_class) );
+    if(err)
+        return err;
+
+    *msec = static_cast<unsigned long long>(wb.first.count());
+    *burst = wb.second;
+    return 0;
+}
+
+int
+APIGetter_EndpointWaitRemaining_ABI( int endpoint_class,
+                                     unsigned long long *msec,
+                                     int allow_exceptions )
+{
+    CHECK_ENUM(EndpointClass, endpoint_class, allow_exceptions);
+    CHECK_PTR(msec, "msec", allow_exceptions);
+
+    *msec = static_cast<unsigned long long>(
+        APIGetterImpl::endpoint_wait_remaining(
+            static_cast<EndpointClass>(endpoint_class)
+            ).count()
+        );
+    return 0;
+}
+
+int
+APIGetter_SetRetryPolicy_ABI( int endpoint_class,
+                              const RetryPolicy *policy,
+                              int allow_exceptions )
+{
+    CHECK_ENUM(EndpointClass, endpoint_class, allow_exceptions);
+    CHECK_PTR(policy, "policy", allow_exceptions);
+
+    static auto meth = +[](int ec, const RetryPolicy *p){
+        APIGetterImpl::set_retry_policy( static_cast<EndpointClass>(ec), *p );
+    };
+
+    return CallImplFromABI( allow_exceptions, meth, endpoint_class, policy );
+}
+
+int
+APIGetter_GetRetryPolicy_ABI( int endpoint_class,
+                              RetryPolicy *policy,
+                              int allow_exceptions )
+{
+    CHECK_ENUM(EndpointClass, endpoint_class, allow_exceptions);
+    CHECK_PTR(policy, "policy", allow_exceptions);
+
+    *policy = APIGetterImpl::get_retry_policy(
+        static_cast<EndpointClass>(endpoint_class)
+        );
+    return 0;
+}
+
+int
+APIGetter_GetDefRetryPolicy_ABI(RetryPolicy *policy, int allow_exceptions)
+{
+    CHECK_PTR(policy, "policy", allow_exceptions);
+
+    *policy = APIGetterImpl::DEF_RETRY_POLICY;
+    return 0;
+}
+
 int
 APIGetter_ShareConnections_ABI(int b, int allow_exceptions)
 {
@@ -303,6 +1125,130 @@ APIGetter_IsSharingConnections_ABI(int *b, int allow_exceptions)
     return 0;
 }
 
+int
+APIGetter_SetMaxConnections_ABI(unsigned int n, int allow_exceptions)
+{
+    return CallImplFromABI( allow_exceptions,
+                            APIGetterImpl::set_max_connections, n );
+}
+
+int
+APIGetter_GetMaxConnections_ABI(unsigned int *n, int allow_exceptions)
+{
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    *n = APIGetterImpl::get_max_connections();
+    return 0;
+}
+
+int
+APIGetter_SetConnectionMaxIdleMSec_ABI( unsigned long long msec,
+                                        int allow_exceptions )
+{
+    return CallImplFromABI( allow_exceptions,
+                            APIGetterImpl::set_connection_max_idle,
+                            milliseconds(msec) );
+}
+
+int
+APIGetter_GetConnectionMaxIdleMSec_ABI( unsigned long long *msec,
+                                        int allow_exceptions )
+{
+    CHECK_PTR(msec, "msec", allow_exceptions);
+
+    *msec = static_cast<unsigned long long>(
+        APIGetterImpl::get_connection_max_idle().count()
+        );
+    return 0;
+}
+
+int
+APIGetter_GetConnectionPoolStats_ABI( unsigned int *in_use,
+                                      unsigned int *idle,
+                                      unsigned long long *waits,
+                                      unsigned long long *wait_msec,
+                                      int allow_exceptions )
+{
+    CHECK_PTR(in_use, "in_use", allow_exceptions);
+    CHECK_PTR(idle, "idle", allow_exceptions);
+    CHECK_PTR(waits, "waits", allow_exceptions);
+    CHECK_PTR(wait_msec, "wait_msec", allow_exceptions);
+
+    conn::ConnectionPoolStats stats =
+        APIGetterImpl::get_connection_pool_stats();
+    *in_use = static_cast<unsigned int>(stats.in_use);
+    *idle = static_cast<unsigned int>(stats.idle);
+    *waits = stats.waits;
+    *wait_msec = static_cast<unsigned long long>(stats.wait_time.count());
+    return 0;
+}
+
+int
+APIGetter_SetCacheEnabled_ABI(int enabled, int allow_exceptions)
+{
+    return CallImplFromABI( allow_exceptions, APIGetterImpl::set_cache_enabled,
+                            static_cast<bool>(enabled) );
+}
+
+int
+APIGetter_IsCacheEnabled_ABI(int *b, int allow_exceptions)
+{
+    CHECK_PTR(b, "b", allow_exceptions);
+
+    *b = static_cast<int>( APIGetterImpl::is_cache_enabled() );
+    return 0;
+}
+
+int
+APIGetter_SetCacheMaxEntries_ABI(unsigned int n, int allow_exceptions)
+{
+    return CallImplFromABI( allow_exceptions,
+                            APIGetterImpl::set_cache_max_entries, n );
+}
+
+int
+APIGetter_GetCacheMaxEntries_ABI(unsigned int *n, int allow_exceptions)
+{
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    *n = APIGetterImpl::get_cache_max_entries();
+    return 0;
+}
+
+int
+APIGetter_SetCacheDirectory_ABI(const char *directory, int allow_exceptions)
+{
+    CHECK_PTR(directory, "directory", allow_exceptions);
+
+    return CallImplFromABI( allow_exceptions,
+                            APIGetterImpl::set_cache_directory,
+                            string(directory) );
+}
+
+int
+APIGetter_GetCacheDirectory_ABI( char **buf,
+                                 size_t *n,
+                                 int allow_exceptions )
+{
+    CHECK_PTR(buf, "buf", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    string dir;
+    int err;
+    tie(dir, err) = CallImplFromABI( allow_exceptions,
+                                     APIGetterImpl::get_cache_directory );
+    if( err )
+        return err;
+
+    return to_new_char_buffer(dir, buf, n, allow_exceptions);
+}
+
+int
+APIGetter_ClearCache_ABI(int allow_exceptions)
+{
+    return CallImplFromABI( allow_exceptions, APIGetterImpl::clear_cache );
+}
+
 int
 PeriodType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
 {
@@ -662,3 +1608,106 @@ OrderStatusType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
         throw std::runtime_error("invalid OrderStatusType");
     }
 }
+
+int
+EndpointClass_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
+{
+    CHECK_ENUM(EndpointClass, v, allow_exceptions);
+
+    switch(static_cast<EndpointClass>(v)){
+    case EndpointClass::marketdata:
+        return to_new_char_buffer("marketdata", buf, n, allow_exceptions);
+    case EndpointClass::accounts:
+        return to_new_char_buffer("accounts", buf, n, allow_exceptions);
+    case EndpointClass::instruments:
+        return to_new_char_buffer("instruments", buf, n, allow_exceptions);
+    default:
+        throw std::runtime_error("invalid EndpointClass");
+    }
+}
+
+int
+QuoteAssetType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
+{
+    CHECK_ENUM(QuoteAssetType, v, allow_exceptions);
+
+    switch(static_cast<QuoteAssetType>(v)){
+    case QuoteAssetType::NONE:
+        return to_new_char_buffer("NONE", buf, n, allow_exceptions);
+    case QuoteAssetType::EQUITY:
+        return to_new_char_buffer("EQUITY", buf, n, allow_exceptions);
+    case QuoteAssetType::ETF:
+        return to_new_char_buffer("ETF", buf, n, allow_exceptions);
+    case QuoteAssetType::OPTION:
+        return to_new_char_buffer("OPTION", buf, n, allow_exceptions);
+    case QuoteAssetType::INDEX:
+        return to_new_char_buffer("INDEX", buf, n, allow_exceptions);
+    case QuoteAssetType::MUTUAL_FUND:
+        return to_new_char_buffer("MUTUAL_FUND", buf, n, allow_exceptions);
+    case QuoteAssetType::FUTURE:
+        return to_new_char_buffer("FUTURE", buf, n, allow_exceptions);
+    case QuoteAssetType::FUTURE_OPTION:
+        return to_new_char_buffer("FUTURE_OPTION", buf, n, allow_exceptions);
+    case QuoteAssetType::FOREX:
+        return to_new_char_buffer("FOREX", buf, n, allow_exceptions);
+    default:
+        throw std::runtime_error("invalid QuoteAssetType");
+    }
+}
+
+int
+OptionChainColumn_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
+{
+    CHECK_ENUM(OptionChainColumn, v, allow_exceptions);
+
+    switch(static_cast<OptionChainColumn>(v)){
+    case OptionChainColumn::strike:
+        return to_new_char_buffer("strike", buf, n, allow_exceptions);
+    case OptionChainColumn::expiration:
+        return to_new_char_buffer("expiration", buf, n, allow_exceptions);
+    case OptionChainColumn::days_to_exp:
+        return to_new_char_buffer("days_to_exp", buf, n, allow_exceptions);
+    case OptionChainColumn::put_call:
+        return to_new_char_buffer("put_call", buf, n, allow_exceptions);
+    case OptionChainColumn::bid:
+        return to_new_char_buffer("bid", buf, n, allow_exceptions);
+    case OptionChainColumn::ask:
+        return to_new_char_buffer("ask", buf, n, allow_exceptions);
+    case OptionChainColumn::last:
+        return to_new_char_buffer("last", buf, n, allow_exceptions);
+    case OptionChainColumn::mark:
+        return to_new_char_buffer("mark", buf, n, allow_exceptions);
+    case OptionChainColumn::bid_size:
+        return to_new_char_buffer("bid_size", buf, n, allow_exceptions);
+    case OptionChainColumn::ask_size:
+        return to_new_char_buffer("ask_size", buf, n, allow_exceptions);
+    case OptionChainColumn::total_volume:
+        return to_new_char_buffer("total_volume", buf, n, allow_exceptions);
+    case OptionChainColumn::open_interest:
+        return to_new_char_buffer("open_interest", buf, n, allow_exceptions);
+    case OptionChainColumn::volatility:
+        return to_new_char_buffer("volatility", buf, n, allow_exceptions);
+    case OptionChainColumn::delta:
+        return to_new_char_buffer("delta", buf, n, allow_exceptions);
+    case OptionChainColumn::gamma:
+        return to_new_char_buffer("gamma", buf, n, allow_exceptions);
+    case OptionChainColumn::theta:
+        return to_new_char_buffer("theta", buf, n, allow_exceptions);
+    case OptionChainColumn::vega:
+        return to_new_char_buffer("vega", buf, n, allow_exceptions);
+    case OptionChainColumn::rho:
+        return to_new_char_buffer("rho", buf, n, allow_exceptions);
+    case OptionChainColumn::theoretical_value:
+        return to_new_char_buffer("theoretical_value", buf, n, allow_exceptions);
+    case OptionChainColumn::time_value:
+        return to_new_char_buffer("time_value", buf, n, allow_exceptions);
+    case OptionChainColumn::multiplier:
+        return to_new_char_buffer("multiplier", buf, n, allow_exceptions);
+    case OptionChainColumn::in_the_money:
+        return to_new_char_buffer("in_the_money", buf, n, allow_exceptions);
+    case OptionChainColumn::quote_time:
+        return to_new_char_buffer("quote_time", buf, n, allow_exceptions);
+    default:
+        throw std::runtime_error("invalid OptionChainColumn");
+    }
+}
@@ -21,9 +21,18 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <tuple>
 #include <cctype>
 #include <string>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
 
 #include "../../include/_tdma_api.h"
 #include "../../include/_get.h"
+#include "../../include/json_scanner.h"
 
 using std::string;
 using std::vector;
@@ -34,6 +43,238 @@ namespace tdma {
 
 using std::to_string;
 
+/*
+ * CandleTableImpl - decodes the 'candles' array of a price history response
+ * directly into OHLCV columns, no json DOM. Rows are kept ordered by
+ * datetime w/ one row per datetime (the first one seen).
+ */
+class CandleTableImpl{
+    enum class Field{ open, high, low, close, volume, datetime };
+
+    vector<double> _open, _high, _low, _close;
+    vector<long long> _volume, _datetime;
+
+    static const KeyMap<Field>&
+    fields()
+    {
+        static const KeyMap<Field> f = {
+            {"open", Field::open},
+            {"high", Field::high},
+            {"low", Field::low},
+            {"close", Field::close},
+            {"volume", Field::volume},
+            {"datetime", Field::datetime}
+        };
+        return f;
+    }
+
+    static void
+    price(JSONScanner& scanner, double& d)
+    {
+        if( scanner.peek() == '"' ){ // e.g "NaN"
+            const char *s;
+            size_t n;
+            scanner.string(s, n);
+            d = std::numeric_limits<double>::quiet_NaN();
+        }else{
+            scanner.number(d);
+        }
+    }
+
+    void
+    decode_candle(JSONScanner& scanner)
+    {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        _open.push_back(nan);
+        _high.push_back(nan);
+        _low.push_back(nan);
+        _close.push_back(nan);
+        _volume.push_back(0);
+        _datetime.push_back(0);
+
+        const char *k;
+        size_t kn;
+        scanner.begin_object();
+        for( bool first = true; scanner.next_member(first, k, kn); ){
+            const Field *f = fields().find(k, kn);
+            if( !f ){
+                scanner.skip_value();
+                continue;
+            }
+            if( scanner.null() )
+                continue;
+            switch( *f ){
+            case Field::open: price(scanner, _open.back()); break;
+            case Field::high: price(scanner, _high.back()); break;
+            case Field::low: price(scanner, _low.back()); break;
+            case Field::close: price(scanner, _close.back()); break;
+            case Field::volume: scanner.number(_volume.back()); break;
+            case Field::datetime: scanner.number(_datetime.back()); break;
+            }
+        }
+    }
+
+    void
+    decode(const char *data, size_t data_len)
+    {
+        JSONScanner scanner(data, data + data_len);
+        const char *k;
+        size_t kn;
+        scanner.begin_object();
+        for( bool first = true; scanner.next_member(first, k, kn); ){
+            if( kn != 7 || memcmp(k, "candles", 7) ){
+                scanner.skip_value();
+                continue;
+            }
+            if( scanner.null() )
+                continue;
+            scanner.begin_array();
+            for( bool f = true; scanner.next_element(f); )
+                decode_candle(scanner);
+        }
+    }
+
+    template<typename T>
+    static void
+    permute(vector<T>& v, const vector<size_t>& order)
+    {
+        vector<T> tmp( order.size() );
+        for( size_t i = 0; i < order.size(); ++i )
+            tmp[i] = v[order[i]];
+        v.swap(tmp);
+    }
+
+    template<typename T>
+    static void
+    keep(vector<T>& v, const vector<size_t>& rows)
+    {
+        for( size_t i = 0; i < rows.size(); ++i )
+            v[i] = v[rows[i]];
+        v.resize( rows.size() );
+    }
+
+    /* sort by datetime (if needed) and drop repeated datetimes */
+    void
+    normalize()
+    {
+        if( !std::is_sorted(_datetime.begin(), _datetime.end()) ){
+            vector<size_t> order( size() );
+            std::iota( order.begin(), order.end(), 0 );
+            const long long *dt = _datetime.data();
+            std::stable_sort( order.begin(), order.end(),
+                [=](size_t l, size_t r){ return dt[l] < dt[r]; } );
+            permute(_open, order);
+            permute(_high, order);
+            permute(_low, order);
+            permute(_close, order);
+            permute(_volume, order);
+            permute(_datetime, order);
+        }
+
+        if( std::adjacent_find(_datetime.begin(), _datetime.end())
+                == _datetime.end() ){
+            return;
+        }
+
+        vector<size_t> rows;
+        rows.reserve( size() );
+        for( size_t i = 0; i < size(); ++i ){
+            if( i == 0 || _datetime[i] != _datetime[i-1] )
+                rows.push_back(i);
+        }
+        keep(_open, rows);
+        keep(_high, rows);
+        keep(_low, rows);
+        keep(_close, rows);
+        keep(_volume, rows);
+        keep(_datetime, rows);
+    }
+
+public:
+    typedef CandleTable ProxyType;
+    static const int TYPE_ID_LOW = TYPE_ID_CANDLE_TABLE;
+    static const int TYPE_ID_HIGH = TYPE_ID_CANDLE_TABLE;
+
+    CandleTableImpl()
+    {}
+
+    CandleTableImpl(const char *data, size_t data_len)
+    {
+        try{
+            decode(data, data_len);
+        }catch( JSONScanError& e ){
+            TDMA_API_THROW( ValueException,
+                            string("invalid candle data: ") + e.what() );
+        }
+        normalize();
+    }
+
+    /* concatenate tables of (overlapping) ranges into one */
+    static CandleTableImpl
+    merge(const vector<CandleTableImpl>& tables)
+    {
+        CandleTableImpl m;
+        size_t n = 0;
+        for( auto& t : tables )
+            n += t.size();
+        for( auto *c : {&m._open, &m._high, &m._low, &m._close} )
+            c->reserve(n);
+        m._volume.reserve(n);
+        m._datetime.reserve(n);
+
+        for( auto& t : tables ){
+            m._open.insert(m._open.end(), t._open.begin(), t._open.end());
+            m._high.insert(m._high.end(), t._high.begin(), t._high.end());
+            m._low.insert(m._low.end(), t._low.begin(), t._low.end());
+            m._close.insert(m._close.end(), t._close.begin(), t._close.end());
+            m._volume.insert(m._volume.end(), t._volume.begin(),
+                             t._volume.end());
+            m._datetime.insert(m._datetime.end(), t._datetime.begin(),
+                               t._datetime.end());
+        }
+        m.normalize();
+        return m;
+    }
+
+    size_t
+    size() const
+    { return _datetime.size(); }
+
+    const double*
+    open() const
+    { return _open.data(); }
+
+    const double*
+    high() const
+    { return _high.data(); }
+
+    const double*
+    low() const
+    { return _low.data(); }
+
+    const double*
+    close() const
+    { return _close.data(); }
+
+    const long long*
+    volume() const
+    { return _volume.data(); }
+
+    const long long*
+    datetime() const
+    { return _datetime.data(); }
+
+    pair<size_t, size_t>
+    find(long long start_msec, long long end_msec) const
+    {
+        auto l = std::lower_bound(_datetime.begin(), _datetime.end(),
+                                  start_msec);
+        auto u = std::upper_bound(l, _datetime.end(), end_msec);
+        return { static_cast<size_t>(l - _datetime.begin()),
+                 static_cast<size_t>(u - _datetime.begin()) };
+    }
+};
+
 class HistoricalGetterBaseImpl
         : public APIGetterImpl {
     string _symbol;
@@ -157,7 +398,7 @@ class HistoricalPeriodGetterImpl
         }
 
         string qstr = util::build_encoded_query_str(params);
-        string url = URL_MARKETDATA + util::url_encode(get_symbol())
+        string url = url_marketdata() + util::url_encode(get_symbol())
                      + "/pricehistory?" + qstr;
         APIGetterImpl::set_url(url);
     }
@@ -255,6 +496,20 @@ public:
          *        to be changed by the second call */
         return HistoricalGetterBaseImpl::get();
     }
+
+    void
+    get_async(connect_async_cb_ty callback)
+    {
+        _throw_if_invalid_frequency_type(_period_type, get_frequency_type());
+        HistoricalGetterBaseImpl::get_async(callback);
+    }
+
+    void
+    get_stream(const conn::chunk_cb_ty& on_chunk)
+    {
+        _throw_if_invalid_frequency_type(_period_type, get_frequency_type());
+        HistoricalGetterBaseImpl::get_stream(on_chunk);
+    }
 };
 
 
@@ -283,7 +538,7 @@ class HistoricalRangeGetterImpl
         }
 
         string qstr = util::build_encoded_query_str(params);
-        string url = URL_MARKETDATA + util::url_encode(get_symbol())
+        string url = url_marketdata() + util::url_encode(get_symbol())
                      + "/pricehistory?" + qstr;
         APIGetterImpl::set_url(url);
     }
@@ -297,6 +552,9 @@ public:
     static const int TYPE_ID_LOW = TYPE_ID_GETTER_HISTORICAL_RANGE;
     static const int TYPE_ID_HIGH = TYPE_ID_GETTER_HISTORICAL_RANGE;
 
+    /* default backfill chunk for minute candles */
+    static const unsigned long long DEF_MINUTE_CHUNK_MSEC;
+
     HistoricalRangeGetterImpl( Credentials& creds,
                                const string& symbol,
                                FrequencyType frequency_type,
@@ -334,8 +592,117 @@ public:
        _start_msec_since_epoch = start_msec_since_epoch;
        build();
    }
+   /*
+    * split the range into chunks, send them all through the async loop
+    * (each still takes throttle tokens and a request lane so the global
+    * rate budget holds), decode each as it arrives then merge. A chunk that
+    * fails is re-sent once through get() so it gets the retry policy.
+    */
+   CandleTableImpl
+   backfill(unsigned long long chunk_msec)
+   {
+       if( chunk_msec == 0 ){
+           chunk_msec = (get_frequency_type() == FrequencyType::minute)
+                      ? DEF_MINUTE_CHUNK_MSEC
+                      : std::numeric_limits<unsigned long long>::max();
+       }
+
+       const unsigned long long start = _start_msec_since_epoch;
+       const unsigned long long end = _end_msec_since_epoch;
+       if( end < start )
+           TDMA_API_THROW(ValueException, "end before start");
+
+       vector<pair<unsigned long long, unsigned long long>> ranges;
+       for( unsigned long long b = start; ; b += chunk_msec ){
+           unsigned long long e = (end - b < chunk_msec) ? end
+                                                         : b + chunk_msec - 1;
+           ranges.emplace_back(b, e);
+           if( e == end )
+               break;
+       }
+
+       struct State{
+           std::mutex mtx;
+           std::condition_variable cond;
+           size_t pending;
+           vector<CandleTableImpl> tables;
+           vector<bool> failed;
+
+           State(size_t n) : pending(0), tables(n), failed(n, false) {}
+       };
+       auto state = std::make_shared<State>( ranges.size() );
+
+       auto set_range = [this](unsigned long long b, unsigned long long e){
+           _start_msec_since_epoch = b;
+           _end_msec_since_epoch = e;
+           _build();
+       };
+
+       try{
+           for( size_t i = 0; i < ranges.size(); ++i ){
+               set_range(ranges[i].first, ranges[i].second);
+               {
+                   std::lock_guard<std::mutex> _(state->mtx);
+                   ++state->pending;
+               }
+               try{
+                   HistoricalGetterBaseImpl::get_async(
+                       [state, i](const string& data, std::exception_ptr e){
+                           CandleTableImpl t;
+                           bool failed = static_cast<bool>(e);
+                           if( !failed ){
+                               try{
+                                   t = CandleTableImpl(data.c_str(),
+                                                       data.size());
+                               }catch(...){
+                                   failed = true;
+                               }
+                           }
+                           {
+                               std::lock_guard<std::mutex> _(state->mtx);
+                               state->tables[i] = std::move(t);
+                               state->failed[i] = failed;
+                               --state->pending;
+                           }
+                           state->cond.notify_all();
+                       });
+               }catch(...){
+                   std::lock_guard<std::mutex> _(state->mtx);
+                   --state->pending;
+                   throw;
+               }
+           }
+       }catch(...){
+           set_range(start, end);
+           throw;
+       }
+
+       {
+           std::unique_lock<std::mutex> lock(state->mtx);
+           state->cond.wait(lock, [&]{ return state->pending == 0; });
+       }
+
+       try{
+           for( size_t i = 0; i < ranges.size(); ++i ){
+               if( !state->failed[i] )
+                   continue;
+               set_range(ranges[i].first, ranges[i].second);
+               string r = HistoricalGetterBaseImpl::get();
+               state->tables[i] = CandleTableImpl(r.c_str(), r.size());
+           }
+       }catch(...){
+           set_range(start, end);
+           throw;
+       }
+       set_range(start, end);
+
+       return CandleTableImpl::merge(state->tables);
+   }
 };
 
+const unsigned long long HistoricalRangeGetterImpl::DEF_MINUTE_CHUNK_MSEC =
+    10ULL * 24 * 60 * 60 * 1000;
+
 } /* tdma */
 
 
@@ -425,6 +792,35 @@ HistoricalGetterBase_SetFrequency_ABI( Getter_C *pgetter,
             );
 }
 
+int
+HistoricalGetterBase_GetCandles_ABI( Getter_C *pgetter,
+                                     CandleTable_C *ptable,
+                                     int allow_exceptions )
+{
+    int err = proxy_is_callable<HistoricalGetterBaseImpl>(pgetter,
+                                                          allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(ptable, "table", allow_exceptions);
+
+    static auto meth = +[](void *obj){
+        string r = reinterpret_cast<HistoricalGetterBaseImpl*>(obj)->get();
+        return new CandleTableImpl(r.c_str(), r.size());
+    };
+
+    CandleTableImpl *tobj;
+    tie(tobj, err) = CallImplFromABI(allow_exceptions, meth, pgetter->obj);
+    if( err ){
+        kill_proxy(ptable);
+        return err;
+    }
+
+    ptable->obj = reinterpret_cast<void*>(tobj);
+    ptable->type_id = CandleTableImpl::TYPE_ID_LOW;
+    return 0;
+}
+
 /* HistoricalPeriodGetter */
 int
 HistoricalPeriodGetter_Create_ABI( struct Credentials *pcreds,
@@ -651,3 +1047,132 @@ HistoricalRangeGetter_SetStartMSecSinceEpoch_ABI(
             );
 }
 
+int
+HistoricalRangeGetter_Backfill_ABI( HistoricalRangeGetter_C *pgetter,
+                                    unsigned long long chunk_msec,
+                                    CandleTable_C *ptable,
+                                    int allow_exceptions )
+{
+    int err = proxy_is_callable<HistoricalRangeGetterImpl>(pgetter,
+                                                           allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(ptable, "table", allow_exceptions);
+
+    static auto meth = +[](void *obj, unsigned long long c){
+        return new CandleTableImpl(
+            reinterpret_cast<HistoricalRangeGetterImpl*>(obj)->backfill(c)
+            );
+    };
+
+    CandleTableImpl *tobj;
+    tie(tobj, err) = CallImplFromABI( allow_exceptions, meth, pgetter->obj,
+                                      chunk_msec );
+    if( err ){
+        kill_proxy(ptable);
+        return err;
+    }
+
+    ptable->obj = reinterpret_cast<void*>(tobj);
+    ptable->type_id = CandleTableImpl::TYPE_ID_LOW;
+    return 0;
+}
+
+
+/* CandleTable */
+int
+CandleTable_Create_ABI( const char *data,
+                        size_t data_len,
+                        CandleTable_C *ptable,
+                        int allow_exceptions )
+{
+    CHECK_PTR(ptable, "table", allow_exceptions);
+    CHECK_PTR_KILL_PROXY(data, "data", allow_exceptions, ptable);
+
+    static auto meth = +[](const char *d, size_t n){
+        return new CandleTableImpl(d, n);
+    };
+
+    int err;
+    CandleTableImpl *obj;
+    tie(obj, err) = CallImplFromABI(allow_exceptions, meth, data, data_len);
+    if( err ){
+        kill_proxy(ptable);
+        return err;
+    }
+
+    ptable->obj = reinterpret_cast<void*>(obj);
+    ptable->type_id = CandleTableImpl::TYPE_ID_LOW;
+    return 0;
+}
+
+int
+CandleTable_Destroy_ABI( CandleTable_C *ptable, int allow_exceptions )
+{ return destroy_proxy<CandleTableImpl>(ptable, allow_exceptions); }
+
+int
+CandleTable_GetSize_ABI( CandleTable_C *ptable,
+                         size_t *n,
+                         int allow_exceptions )
+{
+    int err = proxy_is_callable<CandleTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    *n = reinterpret_cast<CandleTableImpl*>(ptable->obj)->size();
+    return 0;
+}
+
+int
+CandleTable_GetColumns_ABI( CandleTable_C *ptable,
+                            const double **open,
+                            const double **high,
+                            const double **low,
+                            const double **close,
+                            const long long **volume,
+                            const long long **datetime,
+                            int allow_exceptions )
+{
+    int err = proxy_is_callable<CandleTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    const CandleTableImpl *t =
+        reinterpret_cast<CandleTableImpl*>(ptable->obj);
+    if( open )
+        *open = t->open();
+    if( high )
+        *high = t->high();
+    if( low )
+        *low = t->low();
+    if( close )
+        *close = t->close();
+    if( volume )
+        *volume = t->volume();
+    if( datetime )
+        *datetime = t->datetime();
+    return 0;
+}
+
+int
+CandleTable_Find_ABI( CandleTable_C *ptable,
+                      long long start_msec,
+                      long long end_msec,
+                      size_t *begin,
+                      size_t *end,
+                      int allow_exceptions )
+{
+    int err = proxy_is_callable<CandleTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(begin, "begin", allow_exceptions);
+    CHECK_PTR(end, "end", allow_exceptions);
+
+    tie(*begin, *end) = reinterpret_cast<CandleTableImpl*>(ptable->obj)
+        ->find(start_msec, end_msec);
+    return 0;
+}
@@ -36,7 +36,7 @@ class InstrumentInfoGetterImpl
         string url;
 
         if( _search_type == InstrumentSearchType::cusip ){
-             url = URL_INSTRUMENTS + "/" + util::url_encode(_query_string);
+             url = url_instruments() + "/" + util::url_encode(_query_string);
         }else{
             vector<pair<string,string>> params{
                 {"symbol", _query_string},
@@ -44,7 +44,7 @@ class InstrumentInfoGetterImpl
             };
 
             string qstr = util::build_encoded_query_str(params);
-            url = URL_INSTRUMENTS + "?" + qstr;
+            url = url_instruments() + "?" + qstr;
         }
 
         APIGetterImpl::set_url(url);
@@ -70,6 +70,7 @@ public:
             if( query_string.empty() )
                 TDMA_API_THROW(ValueException,"empty query_string");
 
+            set_cache_ttl( std::chrono::hours(1) );
             _build();
         }
 
@@ -39,7 +39,8 @@ class MarketHoursGetterImpl
     _build()
     {
         string qstr = util::build_encoded_query_str({{"date", _date}});
-        string url = URL_MARKETDATA + util::url_encode(to_string(_market_type))
+        string url = url_marketdata()
+                     + util::url_encode(to_string(_market_type))
                      + "/hours?" + qstr;
         APIGetterImpl::set_url(url);
     }
@@ -65,6 +66,7 @@ public:
                 TDMA_API_THROW( ValueException,
                                 "invalid ISO-8601 date/time: " + date );
             }
+            set_cache_ttl( std::chrono::hours(1) );
             _build();
         }
 
@@ -50,7 +50,7 @@ class MoversGetterImpl
         }
 
         string qstr = util::build_encoded_query_str(params);
-        string url = URL_MARKETDATA + util::url_encode(to_string(_index))
+        string url = url_marketdata() + util::url_encode(to_string(_index))
                      + "/movers?" + qstr;
         APIGetterImpl::set_url(url);
     }
@@ -21,9 +21,16 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <tuple>
 #include <cctype>
 #include <string>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cstring>
 
 #include "../../include/_tdma_api.h"
 #include "../../include/_get.h"
+#include "../../include/json_scanner.h"
+#include "../../include/symbol_table.h"
 
 using std::string;
 using std::vector;
@@ -53,7 +60,7 @@ class OptionChainGetterImpl
     {
         auto params = build_query_params();
         string qstr = util::build_encoded_query_str(params);
-        string url = URL_MARKETDATA + "chains?" + qstr;
+        string url = url_marketdata() + "chains?" + qstr;
         APIGetterImpl::set_url(url);
     }
 
@@ -255,7 +262,7 @@ class OptionChainStrategyGetterImpl
     _build()
     {
         string qstr = util::build_encoded_query_str( build_query_params() );
-        string url = URL_MARKETDATA + "chains?" + qstr;
+        string url = url_marketdata() + "chains?" + qstr;
         APIGetterImpl::set_url(url);
     }
 
@@ -327,7 +334,7 @@ class OptionChainAnalyticalGetterImpl
     _build()
     {
         string qstr = util::build_encoded_query_str( build_query_params() );
-        string url = URL_MARKETDATA + "chains?" + qstr;
+        string url = url_marketdata() + "chains?" + qstr;
         APIGetterImpl::set_url(url);
     }
 
@@ -428,6 +435,293 @@ public:
     }
 };
 
+/*
+ * OptionChainTableImpl - decodes the (call/put)ExpDateMap trees of a chain
+ * response directly into columns, no json DOM. Strategy chains
+ * (monthlyStrategyList) aren't decoded, only single contracts.
+ */
+class OptionChainTableImpl{
+public:
+    static const size_t NCOLUMNS =
+        static_cast<size_t>(OptionChainColumn::quote_time) + 1;
+
+private:
+    enum class FieldKind{ real, boolean, put_call, symbol };
+
+    struct Field{
+        FieldKind kind;
+        OptionChainColumn column;
+    };
+
+    vector<double> _columns[NCOLUMNS];
+    vector<const char*> _symbols;
+    vector<size_t> _strike_index;
+    string _symbol; // reused while decoding
+
+    static const KeyMap<Field>&
+    fields()
+    {
+#define CHAIN_FIELD(k, kind, c) {k, {FieldKind::kind, OptionChainColumn::c}}
+        static const KeyMap<Field> f = {
+            CHAIN_FIELD("putCall", put_call, put_call),
+            CHAIN_FIELD("symbol", symbol, strike),
+            CHAIN_FIELD("strikePrice", real, strike),
+            CHAIN_FIELD("expirationDate", real, expiration),
+            CHAIN_FIELD("daysToExpiration", real, days_to_exp),
+            CHAIN_FIELD("bid", real, bid),
+            CHAIN_FIELD("ask", real, ask),
+            CHAIN_FIELD("last", real, last),
+            CHAIN_FIELD("mark", real, mark),
+            CHAIN_FIELD("bidSize", real, bid_size),
+            CHAIN_FIELD("askSize", real, ask_size),
+            CHAIN_FIELD("totalVolume", real, total_volume),
+            CHAIN_FIELD("openInterest", real, open_interest),
+            CHAIN_FIELD("volatility", real, volatility),
+            CHAIN_FIELD("delta", real, delta),
+            CHAIN_FIELD("gamma", real, gamma),
+            CHAIN_FIELD("theta", real, theta),
+            CHAIN_FIELD("vega", real, vega),
+            CHAIN_FIELD("rho", real, rho),
+            CHAIN_FIELD("theoreticalOptionValue", real, theoretical_value),
+            CHAIN_FIELD("timeValue", real, time_value),
+            CHAIN_FIELD("multiplier", real, multiplier),
+            CHAIN_FIELD("inTheMoney", boolean, in_the_money),
+            CHAIN_FIELD("quoteTimeInLong", real, quote_time)
+        };
+#undef CHAIN_FIELD
+        return f;
+    }
+
+    double&
+    cell(OptionChainColumn c)
+    { return _columns[static_cast<size_t>(c)].back(); }
+
+    void
+    decode_contract(JSONScanner& scanner, bool is_put)
+    {
+        for( auto& c : _columns )
+            c.push_back(0.0);
+        _symbols.push_back(nullptr);
+        cell(OptionChainColumn::put_call) = is_put;
+
+        const char *k, *s;
+        size_t kn, sn;
+        scanner.begin_object();
+        for( bool first = true; scanner.next_member(first, k, kn); ){
+            const Field *f = fields().find(k, kn);
+            if( !f ){
+                scanner.skip_value();
+                continue;
+            }
+            if( scanner.null() )
+                continue;
+            switch( f->kind ){
+            case FieldKind::real:
+                /* e.g "NaN" for greeks that can't be calculated */
+                if( scanner.peek() == '"' ){
+                    scanner.string(s, sn);
+                    cell(f->column) = std::numeric_limits<double>::quiet_NaN();
+                }else{
+                    scanner.number( cell(f->column) );
+                }
+                break;
+            case FieldKind::boolean:
+                cell(f->column) = scanner.boolean();
+                break;
+            case FieldKind::put_call:
+                scanner.string(s, sn);
+                cell(f->column) = (sn == 3 && !memcmp(s, "PUT", 3));
+                break;
+            case FieldKind::symbol:
+                scanner.string(s, sn);
+                if( memchr(s, '\\', sn) )
+                    JSONScanner::unescape(s, sn, _symbol);
+                else
+                    _symbol.assign(s, sn);
+                _symbols.back() = SymbolTable::instance().intern(_symbol).first;
+                break;
+            }
+        }
+    }
+
+    /* {"YYYY-MM-DD:DTE": {"STRIKE": [{contract}, ...], ...}, ...} */
+    void
+    decode_exp_date_map(JSONScanner& scanner, bool is_put)
+    {
+        const char *k;
+        size_t kn;
+        if( scanner.null() )
+            return;
+        scanner.begin_object();
+        for( bool first = true; scanner.next_member(first, k, kn); ){
+            scanner.begin_object();
+            for( bool first2 = true; scanner.next_member(first2, k, kn); ){
+                scanner.begin_array();
+                for( bool first3 = true; scanner.next_element(first3); )
+                    decode_contract(scanner, is_put);
+            }
+        }
+    }
+
+    void
+    decode(const char *data, size_t data_len)
+    {
+        JSONScanner scanner(data, data + data_len);
+        if( scanner.at_end() )
+            return;
+
+        const char *k;
+        size_t kn;
+        scanner.begin_object();
+        for( bool first = true; scanner.next_member(first, k, kn); ){
+            if( kn == 14 && !memcmp(k, "callExpDateMap", 14) )
+                decode_exp_date_map(scanner, false);
+            else if( kn == 13 && !memcmp(k, "putExpDateMap", 13) )
+                decode_exp_date_map(scanner, true);
+            else
+                scanner.skip_value();
+        }
+        if( !scanner.at_end() )
+            scanner.fail("trailing data");
+    }
+
+    /* order rows by expiration, strike, put_call; build the strike index */
+    void
+    sort()
+    {
+        const double *exp = column(OptionChainColumn::expiration);
+        const double *strike = column(OptionChainColumn::strike);
+        const double *pc = column(OptionChainColumn::put_call);
+
+        for( OptionChainColumn c : { OptionChainColumn::expiration,
+                                     OptionChainColumn::strike } ){
+            for( double& d : _columns[static_cast<size_t>(c)] ){
+                if( std::isnan(d) )
+                    d = 0.0; // keep the sort keys totally ordered
+            }
+        }
+
+        vector<size_t> order( size() );
+        std::iota( order.begin(), order.end(), 0 );
+        std::stable_sort( order.begin(), order.end(),
+            [=](size_t l, size_t r){
+                return std::tie(exp[l], strike[l], pc[l])
+                    < std::tie(exp[r], strike[r], pc[r]);
+            });
+
+        vector<double> tmp( size() );
+        for( auto& c : _columns ){
+            for( size_t i = 0; i < order.size(); ++i )
+                tmp[i] = c[order[i]];
+            c.swap(tmp);
+        }
+        vector<const char*> tmp_symbols( size() );
+        for( size_t i = 0; i < order.size(); ++i )
+            tmp_symbols[i] = _symbols[order[i]];
+        _symbols.swap(tmp_symbols);
+
+        exp = column(OptionChainColumn::expiration);
+        strike = column(OptionChainColumn::strike);
+        pc = column(OptionChainColumn::put_call);
+        _strike_index.resize( size() );
+        std::iota( _strike_index.begin(), _strike_index.end(), 0 );
+        std::stable_sort( _strike_index.begin(), _strike_index.end(),
+            [=](size_t l, size_t r){
+                return std::tie(strike[l], exp[l], pc[l])
+                    < std::tie(strike[r], exp[r], pc[r]);
+            });
+    }
+
+public:
+    typedef OptionChainTable ProxyType;
+    static const int TYPE_ID_LOW = TYPE_ID_OPTION_CHAIN_TABLE;
+    static const int TYPE_ID_HIGH = TYPE_ID_OPTION_CHAIN_TABLE;
+
+    OptionChainTableImpl(const char *data, size_t data_len)
+    {
+        try{
+            decode(data, data_len);
+        }catch( JSONScanError& e ){
+            TDMA_API_THROW( ValueException,
+                            string("invalid option chain data: ") + e.what() );
+        }
+        sort();
+    }
+
+    size_t
+    size() const
+    { return _symbols.size(); }
+
+    const double*
+    column(OptionChainColumn c) const
+    { return _columns[static_cast<size_t>(c)].data(); }
+
+    const char * const *
+    symbols() const
+    { return _symbols.data(); }
+
+    const size_t*
+    strike_index() const
+    { return _strike_index.data(); }
+
+    pair<size_t, size_t>
+    find_expirations(double min, double max) const
+    {
+        const double *beg = column(OptionChainColumn::expiration);
+        const double *end = beg + size();
+        const double *l = std::lower_bound(beg, end, min);
+        const double *u = std::upper_bound(l, end, max);
+        return {l - beg, u - beg};
+    }
+
+    pair<size_t, size_t>
+    find_strikes(double min, double max) const
+    {
+        const double *strike = column(OptionChainColumn::strike);
+        auto l = std::lower_bound( _strike_index.begin(), _strike_index.end(),
+            min, [=](size_t i, double v){ return strike[i] < v; } );
+        auto u = std::upper_bound( l, _strike_index.end(), max,
+            [=](double v, size_t i){ return v < strike[i]; } );
+        return { static_cast<size_t>(l - _strike_index.begin()),
+                 static_cast<size_t>(u - _strike_index.begin()) };
+    }
+
+    /* returns the # of rows; each filter is a flat pass over its column
+       (compiler vectorizes it) that narrows a mask of rows still in */
+    size_t
+    filter( const OptionChainFilter *filters,
+            size_t nfilters,
+            size_t *rows,
+            size_t max ) const
+    {
+        const size_t n = size();
+        vector<unsigned char> mask(n, 1);
+        unsigned char *m = mask.data();
+
+        for( size_t f = 0; f < nfilters; ++f ){
+            if( !OptionChainColumn_is_valid(filters[f].column) )
+                TDMA_API_THROW(ValueException, "invalid OptionChainColumn");
+            const double *c = column(
+                static_cast<OptionChainColumn>(filters[f].column) );
+            const double lo = filters[f].min;
+            const double hi = filters[f].max;
+            for( size_t i = 0; i < n; ++i )
+                m[i] &= static_cast<unsigned char>((c[i] >= lo) & (c[i] <= hi));
+        }
+
+        size_t nrows = 0;
+        for( size_t i = 0; i < n; ++i ){
+            if( m[i] ){
+                if( nrows == max )
+                    TDMA_API_THROW(ValueException, "more rows than 'rows'");
+                rows[nrows++] = i;
+            }
+        }
+        return nrows;
+    }
+};
+
+
 } /* tdma */
 
 
@@ -1046,4 +1340,200 @@ OptionChainAnalyticalGetter_SetDaysToExp_ABI(
 }
 
 
+int
+OptionChainGetter_GetTable_ABI( OptionChainGetter_C *pgetter,
+                                OptionChainTable_C *ptable,
+                                int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(ptable, "table", allow_exceptions);
+
+    static auto meth = +[](void *obj){
+        string r = reinterpret_cast<OptionChainGetterImpl*>(obj)->get();
+        return new OptionChainTableImpl(r.c_str(), r.size());
+    };
+
+    OptionChainTableImpl *obj;
+    tie(obj, err) = CallImplFromABI(allow_exceptions, meth, pgetter->obj);
+    if( err ){
+        kill_proxy(ptable);
+        return err;
+    }
+
+    ptable->obj = reinterpret_cast<void*>(obj);
+    ptable->type_id = OptionChainTableImpl::TYPE_ID_LOW;
+    return 0;
+}
+
+
+int
+OptionChainTable_Create_ABI( const char *data,
+                             size_t data_len,
+                             OptionChainTable_C *ptable,
+                             int allow_exceptions )
+{
+    CHECK_PTR(ptable, "table", allow_exceptions);
+    CHECK_PTR_KILL_PROXY(data, "data", allow_exceptions, ptable);
+
+    static auto meth = +[](const char *d, size_t n){
+        return new OptionChainTableImpl(d, n);
+    };
 
+    int err;
+    OptionChainTableImpl *obj;
+    tie(obj, err) = CallImplFromABI(allow_exceptions, meth, data, data_len);
+    if( err ){
+        kill_proxy(ptable);
+        return err;
+    }
+
+    ptable->obj = reinterpret_cast<void*>(obj);
+    ptable->type_id = OptionChainTableImpl::TYPE_ID_LOW;
+    return 0;
+}
+
+int
+OptionChainTable_Destroy_ABI( OptionChainTable_C *ptable,
+                              int allow_exceptions )
+{ return destroy_proxy<OptionChainTableImpl>(ptable, allow_exceptions); }
+
+int
+OptionChainTable_GetSize_ABI( OptionChainTable_C *ptable,
+                              size_t *n,
+                              int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    *n = reinterpret_cast<OptionChainTableImpl*>(ptable->obj)->size();
+    return 0;
+}
+
+int
+OptionChainTable_GetColumn_ABI( OptionChainTable_C *ptable,
+                                int column,
+                                const double **data,
+                                int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(OptionChainColumn, column, allow_exceptions);
+    CHECK_PTR(data, "data", allow_exceptions);
+
+    *data = reinterpret_cast<OptionChainTableImpl*>(ptable->obj)
+        ->column( static_cast<OptionChainColumn>(column) );
+    return 0;
+}
+
+int
+OptionChainTable_GetSymbols_ABI( OptionChainTable_C *ptable,
+                                 const char * const **symbols,
+                                 int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(symbols, "symbols", allow_exceptions);
+
+    *symbols = reinterpret_cast<OptionChainTableImpl*>(ptable->obj)->symbols();
+    return 0;
+}
+
+int
+OptionChainTable_GetStrikeIndex_ABI( OptionChainTable_C *ptable,
+                                     const size_t **index,
+                                     int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(index, "index", allow_exceptions);
+
+    *index = reinterpret_cast<OptionChainTableImpl*>(ptable->obj)
+        ->strike_index();
+    return 0;
+}
+
+int
+OptionChainTable_FindExpirations_ABI( OptionChainTable_C *ptable,
+                                      double min,
+                                      double max,
+                                      size_t *begin,
+                                      size_t *end,
+                                      int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(begin, "begin", allow_exceptions);
+    CHECK_PTR(end, "end", allow_exceptions);
+
+    tie(*begin, *end) = reinterpret_cast<OptionChainTableImpl*>(ptable->obj)
+        ->find_expirations(min, max);
+    return 0;
+}
+
+int
+OptionChainTable_FindStrikes_ABI( OptionChainTable_C *ptable,
+                                  double min,
+                                  double max,
+                                  size_t *begin,
+                                  size_t *end,
+                                  int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(begin, "begin", allow_exceptions);
+    CHECK_PTR(end, "end", allow_exceptions);
+
+    tie(*begin, *end) = reinterpret_cast<OptionChainTableImpl*>(ptable->obj)
+        ->find_strikes(min, max);
+    return 0;
+}
+
+int
+OptionChainTable_Filter_ABI( OptionChainTable_C *ptable,
+                             const OptionChainFilter *filters,
+                             size_t nfilters,
+                             size_t *rows,
+                             size_t *n,
+                             int allow_exceptions )
+{
+    int err = proxy_is_callable<OptionChainTableImpl>(ptable, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(n, "n", allow_exceptions);
+    if( nfilters )
+        CHECK_PTR(filters, "filters", allow_exceptions);
+    if( *n )
+        CHECK_PTR(rows, "rows", allow_exceptions);
+
+    static auto meth = +[]( void *obj, const OptionChainFilter *f, size_t nf,
+                            size_t *r, size_t max ){
+        return reinterpret_cast<OptionChainTableImpl*>(obj)
+            ->filter(f, nf, r, max);
+    };
+
+    size_t nrows;
+    tie(nrows, err) = CallImplFromABI( allow_exceptions, meth, ptable->obj,
+                                       filters, nfilters, rows, *n );
+    if( err )
+        return err;
+
+    *n = nrows;
+    return 0;
+}
@@ -16,16 +16,314 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 */
 
 #include <string>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <cstddef>
+#include <cstring>
 
 #include "../../include/_tdma_api.h"
 #include "../../include/_get.h"
+#include "../../include/symbol_table.h"
+#include "../../include/json_scanner.h"
 
 using std::string;
 using std::set;
 using std::tie;
+using std::chrono::milliseconds;
 
 namespace tdma {
 
+namespace {
+
+/*
+ * QuoteBatcher - collect single-symbol quote gets(for the same account)
+ * made during the batch window and make one multi-symbol request for
+ * all of them; each caller gets back only its own symbol's object.
+ */
+class QuoteBatcher{
+    struct Batch{
+        set<string> symbols;
+        bool full;
+        bool done;
+        json data;
+        std::exception_ptr error;
+
+        Batch() : full(false), done(false) {}
+    };
+
+    std::mutex _mtx;
+    std::condition_variable _cond;
+    std::unordered_map<string, std::shared_ptr<Batch>> _pending;
+    milliseconds _window;
+
+    static string
+    result(const Batch& batch, const string& symbol)
+    {
+        if( batch.error )
+            std::rethrow_exception(batch.error);
+
+        /* same layout as the single-symbol endpoint: {"SYMBOL":{...}} */
+        json j = json::object();
+        auto jiter = batch.data.find(symbol);
+        if( jiter != batch.data.end() )
+            j[symbol] = *jiter;
+        return j.dump();
+    }
+
+public:
+    static const size_t MAX_SYMBOLS = 200;
+    static const milliseconds MAX_WINDOW;
+
+    QuoteBatcher() : _window(0) {}
+
+    void
+    set_window(milliseconds msec)
+    {
+        if( msec < milliseconds(0) || msec > MAX_WINDOW )
+            TDMA_API_THROW(ValueException,"invalid batch window");
+        std::lock_guard<std::mutex> _(_mtx);
+        _window = msec;
+    }
+
+    milliseconds
+    get_window()
+    {
+        std::lock_guard<std::mutex> _(_mtx);
+        return _window;
+    }
+
+    /* make_request(set<string>) -> raw json of the multi-symbol request */
+    template<typename F>
+    string
+    get(const string& key, const string& symbol, F make_request)
+    {
+        std::unique_lock<std::mutex> lock(_mtx);
+        auto biter = _pending.find(key);
+        if( biter != _pending.end() ){
+            std::shared_ptr<Batch> batch = biter->second;
+            batch->symbols.insert(symbol);
+            if( batch->symbols.size() >= MAX_SYMBOLS ){
+                /* send it now, the next caller starts a new batch */
+                batch->full = true;
+                _pending.erase(biter);
+                _cond.notify_all();
+            }
+            _cond.wait( lock, [&batch]{ return batch->done; } );
+            return result(*batch, symbol);
+        }
+
+        std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+        batch->symbols.insert(symbol);
+        _pending.emplace(key, batch);
+
+        _cond.wait_for( lock, _window, [&batch]{ return batch->full; } );
+        if( !batch->full )
+            _pending.erase(key);
+        set<string> symbols = batch->symbols;
+        lock.unlock();
+
+        try{
+            string r = make_request(symbols);
+            batch->data = r.empty() ? json::object() : json::parse(r);
+        }catch(...){
+            batch->error = std::current_exception();
+        }
+
+        lock.lock();
+        batch->done = true;
+        lock.unlock();
+        _cond.notify_all();
+
+        return result(*batch, symbol);
+    }
+};
+
+const milliseconds QuoteBatcher::MAX_WINDOW(1000);
+
+QuoteBatcher quote_batcher;
+
+/*
+ * QuoteRecordDecoder - decodes a quote(s) response, {"SYMBOL":{...}, ...},
+ * directly into QuoteRecords: no json DOM and, once the symbols have been
+ * interned, no allocation. W/o 'records' it only counts them.
+ */
+class QuoteRecordDecoder{
+    enum class FieldKind{ real, integer, asset_type };
+
+    struct Field{
+        FieldKind kind;
+        size_t offset;
+    };
+
+    static const KeyMap<Field>&
+    fields()
+    {
+#define QUOTE_FIELD(k, kind, m) {k, {FieldKind::kind, offsetof(QuoteRecord, m)}}
+        static const KeyMap<Field> f = {
+            QUOTE_FIELD("assetType", asset_type, asset_type),
+            QUOTE_FIELD("bidPrice", real, bid_price),
+            QUOTE_FIELD("askPrice", real, ask_price),
+            QUOTE_FIELD("lastPrice", real, last_price),
+            QUOTE_FIELD("openPrice", real, open_price),
+            QUOTE_FIELD("highPrice", real, high_price),
+            QUOTE_FIELD("lowPrice", real, low_price),
+            QUOTE_FIELD("closePrice", real, close_price),
+            QUOTE_FIELD("netChange", real, net_change),
+            QUOTE_FIELD("mark", real, mark),
+            QUOTE_FIELD("volatility", real, volatility),
+            QUOTE_FIELD("52WkHigh", real, high_52wk),
+            QUOTE_FIELD("52WkLow", real, low_52wk),
+            QUOTE_FIELD("peRatio", real, pe_ratio),
+            QUOTE_FIELD("divYield", real, div_yield),
+            QUOTE_FIELD("strikePrice", real, strike_price),
+            QUOTE_FIELD("underlyingPrice", real, underlying_price),
+            QUOTE_FIELD("delta", real, delta),
+            QUOTE_FIELD("gamma", real, gamma),
+            QUOTE_FIELD("theta", real, theta),
+            QUOTE_FIELD("vega", real, vega),
+            QUOTE_FIELD("rho", real, rho),
+            QUOTE_FIELD("multiplier", real, multiplier),
+            QUOTE_FIELD("futureMultiplier", real, multiplier),
+            QUOTE_FIELD("bidSize", integer, bid_size),
+            QUOTE_FIELD("askSize", integer, ask_size),
+            QUOTE_FIELD("lastSize", integer, last_size),
+            QUOTE_FIELD("totalVolume", integer, total_volume),
+            QUOTE_FIELD("openInterest", integer, open_interest),
+            QUOTE_FIELD("quoteTimeInLong", integer, quote_time),
+            QUOTE_FIELD("tradeTimeInLong", integer, trade_time),
+            /* FUTURE, FOREX */
+            QUOTE_FIELD("bidPriceInDouble", real, bid_price),
+            QUOTE_FIELD("askPriceInDouble", real, ask_price),
+            QUOTE_FIELD("lastPriceInDouble", real, last_price),
+            QUOTE_FIELD("openPriceInDouble", real, open_price),
+            QUOTE_FIELD("highPriceInDouble", real, high_price),
+            QUOTE_FIELD("lowPriceInDouble", real, low_price),
+            QUOTE_FIELD("closePriceInDouble", real, close_price),
+            QUOTE_FIELD("netChangeInDouble", real, net_change)
+        };
+#undef QUOTE_FIELD
+        return f;
+    }
+
+    static int
+    asset_type_from_string(const char *s, size_t n)
+    {
+        static const KeyMap<QuoteAssetType> types = {
+            {"EQUITY", QuoteAssetType::EQUITY},
+            {"ETF", QuoteAssetType::ETF},
+            {"OPTION", QuoteAssetType::OPTION},
+            {"INDEX", QuoteAssetType::INDEX},
+            {"MUTUAL_FUND", QuoteAssetType::MUTUAL_FUND},
+            {"FUTURE", QuoteAssetType::FUTURE},
+            {"FUTURE_OPTION", QuoteAssetType::FUTURE_OPTION},
+            {"FOREX", QuoteAssetType::FOREX}
+        };
+        const QuoteAssetType *t = types.find(s, n);
+        return static_cast<int>( t ? *t : QuoteAssetType::NONE );
+    }
+
+    JSONScanner _scanner;
+    std::string _symbol; // reused, no allocation
+
+    void
+    decode_fields(QuoteRecord *record)
+    {
+        const char *k;
+        size_t kn;
+        for( bool first = true; _scanner.next_member(first, k, kn); ){
+            const Field *f = fields().find(k, kn);
+            if( !f ){
+                _scanner.skip_value();
+                continue;
+            }
+            if( _scanner.null() )
+                continue;
+            char *p = reinterpret_cast<char*>(record) + f->offset;
+            switch( f->kind ){
+            case FieldKind::real:
+                _scanner.number( *reinterpret_cast<double*>(p) );
+                break;
+            case FieldKind::integer:
+                _scanner.number( *reinterpret_cast<long long*>(p) );
+                break;
+            case FieldKind::asset_type:
+                const char *s;
+                size_t sn;
+                _scanner.string(s, sn);
+                record->asset_type = asset_type_from_string(s, sn);
+                break;
+            }
+        }
+    }
+
+public:
+    QuoteRecordDecoder(const char *data, size_t data_len)
+        : _scanner(data, data + data_len)
+        {}
+
+    /* returns the # of records */
+    size_t
+    decode(QuoteRecord *records, size_t max)
+    {
+        if( _scanner.peek() != '{' )
+            TDMA_API_THROW(ValueException, "quote data is not an object");
+
+        size_t n = 0;
+        try{
+            const char *k;
+            size_t kn;
+            _scanner.begin_object();
+            for( bool first = true; _scanner.next_member(first, k, kn); ){
+                if( _scanner.peek() != '{' ){
+                    _scanner.skip_value();
+                    continue;
+                }
+                if( !records ){
+                    _scanner.skip_value();
+                    ++n;
+                    continue;
+                }
+                if( n == max )
+                    TDMA_API_THROW(ValueException, "more quotes than records");
+
+                QuoteRecord *r = records + n++;
+                *r = QuoteRecord();
+                if( memchr(k, '\\', kn) )
+                    JSONScanner::unescape(k, kn, _symbol);
+                else
+                    _symbol.assign(k, kn);
+                std::tie(r->symbol, r->symbol_id) =
+                    SymbolTable::instance().intern(_symbol);
+
+                _scanner.begin_object();
+                decode_fields(r);
+            }
+            if( !_scanner.at_end() )
+                _scanner.fail("trailing data");
+        }catch( JSONScanError& e ){
+            TDMA_API_THROW( ValueException,
+                            std::string("invalid quote data: ") + e.what() );
+        }
+        return n;
+    }
+};
+
+/* returns the # of records */
+size_t
+decode_quote_records( const char *data,
+                      size_t data_len,
+                      QuoteRecord *records,
+                      size_t max )
+{
+    if( !data_len )
+        return 0;
+    return QuoteRecordDecoder(data, data_len).decode(records, max);
+}
+
+} /* namespace */
+
+
 class QuoteGetterImpl
         : public APIGetterImpl {
     string _symbol;
@@ -33,7 +331,7 @@ class QuoteGetterImpl
     void
     _build()
     {
-        string url = URL_MARKETDATA + util::url_encode(_symbol) + "/quotes";
+        string url = url_marketdata() + util::url_encode(_symbol) + "/quotes";
         APIGetterImpl::set_url(url);
     }
 
@@ -70,6 +368,29 @@ public:
         _symbol = util::toupper(symbol);
         build();
     }
+
+    string
+    get();
+
+    /* quote for a symbol not found is all 0s w/ asset_type NONE */
+    void
+    get_record(QuoteRecord *record)
+    {
+        string r = get();
+        if( !decode_quote_records(r.c_str(), r.size(), record, 1) ){
+            *record = QuoteRecord();
+            std::tie(record->symbol, record->symbol_id) =
+                SymbolTable::instance().intern(_symbol);
+        }
+    }
+
+    static void
+    set_batch_window(milliseconds msec)
+    { quote_batcher.set_window(msec); }
+
+    static milliseconds
+    get_batch_window()
+    { return quote_batcher.get_window(); }
 };
 
 
@@ -83,7 +404,7 @@ class QuotesGetterImpl
         string qstr = util::build_encoded_query_str(
             {{"symbol", util::join(_symbols,',')}}
         );
-        string url = URL_MARKETDATA + "/quotes?" + qstr;
+        string url = url_marketdata() + "/quotes?" + qstr;
         APIGetterImpl::set_url(url);
     }
 
@@ -125,6 +446,30 @@ public:
     get()
     { return _symbols.empty() ? string() : APIGetterImpl::get(); }
 
+    void
+    get_async(connect_async_cb_ty callback)
+    {
+        if( _symbols.empty() )
+            callback(string(), nullptr);
+        else
+            APIGetterImpl::get_async(callback);
+    }
+
+    void
+    get_stream(const conn::chunk_cb_ty& on_chunk)
+    {
+        if( !_symbols.empty() )
+            APIGetterImpl::get_stream(on_chunk);
+    }
+
+    /* returns the # of records, symbols not found are skipped */
+    size_t
+    get_records(QuoteRecord *records, size_t max)
+    {
+        string r = get();
+        return decode_quote_records(r.c_str(), r.size(), records, max);
+    }
+
     set<string>
     get_symbols() const
     { return _symbols; }
@@ -172,6 +517,27 @@ public:
     }
 };
 
+
+string
+QuoteGetterImpl::get()
+{
+    if( quote_batcher.get_window() == milliseconds(0) )
+        return APIGetterImpl::get();
+
+    milliseconds timeout = get_timeout();
+    bool coalesce = is_coalescing();
+
+    /* the batch is sent w/ the leader's credentials so only batch gets
+     * for the same account */
+    return quote_batcher.get( account_key(get_credentials()), _symbol,
+        [this, timeout, coalesce](const set<string>& symbols){
+            QuotesGetterImpl getter(get_credentials(), symbols);
+            getter.set_timeout(timeout);
+            getter.set_coalesce(coalesce);
+            return getter.get();
+        } );
+}
+
 } /* tdma */
 
 using namespace tdma;
@@ -239,6 +605,57 @@ QuoteGetter_SetSymbol_ABI( QuoteGetter_C *pgetter,
 }
 
 
+int
+QuoteGetter_SetBatchWindowMSec_ABI( unsigned long long msec,
+                                    int allow_exceptions )
+{
+    /* (> 1000 msec throws ValueException) */
+    if( msec > 1000 )
+        msec = 1001;
+
+    return CallImplFromABI( allow_exceptions,
+                            QuoteGetterImpl::set_batch_window,
+                            milliseconds(msec) );
+}
+
+
+int
+QuoteGetter_GetBatchWindowMSec_ABI( unsigned long long *msec,
+                                    int allow_exceptions )
+{
+    CHECK_PTR(msec, "msec", allow_exceptions);
+
+    milliseconds ms;
+    int err;
+    tie(ms, err) = CallImplFromABI( allow_exceptions,
+                                    QuoteGetterImpl::get_batch_window );
+    if(err)
+        return err;
+
+    *msec = static_cast<unsigned long long>(ms.count());
+    return 0;
+}
+
+
+int
+QuoteGetter_GetRecord_ABI( QuoteGetter_C *pgetter,
+                           QuoteRecord *record,
+                           int allow_exceptions )
+{
+    int err = proxy_is_callable<QuoteGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(record, "record", allow_exceptions);
+
+    static auto meth = +[](void *obj, QuoteRecord *r){
+        reinterpret_cast<QuoteGetterImpl*>(obj)->get_record(r);
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, pgetter->obj, record);
+}
+
+
 int
 QuotesGetter_Create_ABI( Credentials *pcreds,
                          const char** symbols,
@@ -352,3 +769,55 @@ QuotesGetter_RemoveSymbols_ABI( QuotesGetter_C *pgetter,
         );
 }
 
+
+int
+QuotesGetter_GetRecords_ABI( QuotesGetter_C *pgetter,
+                             QuoteRecord *records,
+                             size_t *n,
+                             int allow_exceptions )
+{
+    int err = proxy_is_callable<QuotesGetterImpl>(pgetter, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(records, "records", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    static auto meth = +[](void *obj, QuoteRecord *r, size_t max){
+        return reinterpret_cast<QuotesGetterImpl*>(obj)->get_records(r, max);
+    };
+
+    size_t nrecords;
+    tie(nrecords, err) = CallImplFromABI( allow_exceptions, meth,
+                                          pgetter->obj, records, *n );
+    if( err )
+        return err;
+
+    *n = nrecords;
+    return 0;
+}
+
+
+int
+DecodeQuoteRecords_ABI( const char *data,
+                        size_t data_len,
+                        QuoteRecord *records,
+                        size_t *n,
+                        int allow_exceptions )
+{
+    CHECK_PTR(data, "data", allow_exceptions);
+    CHECK_PTR(n, "n", allow_exceptions);
+
+    /* w/o 'records' just count them */
+    size_t nrecords;
+    int err;
+    tie(nrecords, err) = CallImplFromABI( allow_exceptions,
+                                          decode_quote_records, data,
+                                          data_len, records,
+                                          records ? *n : 0 );
+    if( err )
+        return err;
+
+    *n = nrecords;
+    return 0;
+}
@@ -20,6 +20,7 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <string>
 
 #include "../../include/_streaming.h"
+#include "../../include/json_scanner.h"
 
 using std::string;
 
@@ -146,8 +147,11 @@ get_streamer_info(Credentials& creds, const std::string& desired_acct)
         si.credentials.timestamp = timestamp_to_ms(i_sinfo->at("tokenTimestamp"));
         si.credentials.app_id = i_sinfo->at("appId");
         si.credentials.acl = i_sinfo->at("acl");
-        string addr = i_sinfo->at("streamerSocketUrl");
-        si.url = "wss://" + addr + "/ws";
+        si.url = streamer_url();
+        if( si.url.empty() ){
+            string addr = i_sinfo->at("streamerSocketUrl");
+            si.url = "wss://" + addr + "/ws";
+        }
         si.encode_credentials();
     }catch(json::exception& e){
         TDMA_API_THROW(APIException,"failed to convert UserPrincipals JSON to"
@@ -202,6 +206,15 @@ streamer_service_from_str(string service_name)
     return f->second;
 }
 
+StreamerServiceType
+streamer_service_from_str(const char *service_name, size_t n)
+{
+    static const KeyMap<StreamerServiceType> services(
+        service_str_to_enum.cbegin(), service_str_to_enum.cend() );
+    const StreamerServiceType *s = services.find(service_name, n);
+    return s ? *s : StreamerServiceType::UNKNOWN;
+}
+
 } /* tdma */
 
 
@@ -231,6 +244,21 @@ QOSType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
     }
 }
 
+int
+OverflowPolicyType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
+{
+    CHECK_ENUM(OverflowPolicyType, v, allow_exceptions);
+
+    switch(static_cast<OverflowPolicyType>(v)){
+    case OverflowPolicyType::block:
+        return to_new_char_buffer("block", buf, n, allow_exceptions);
+    case OverflowPolicyType::drop:
+        return to_new_char_buffer("drop", buf, n, allow_exceptions);
+    default:
+        throw std::runtime_error("Invalid OverflowPolicyType");
+    }
+}
+
 int
 CommandType_to_string_ABI( TDMA_API_TO_STRING_ABI_ARGS )
 {
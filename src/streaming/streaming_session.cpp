@@ -28,6 +28,8 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include "../../include/util.h"
 #include "../../include/websocket_connect.h"
 #include "../../include/threadsafe_hashmap.h"
+#include "../../include/stream_frame_scanner.h"
+#include "../../include/level_one_book.h"
 
 using std::string;
 using std::vector;
@@ -37,6 +39,7 @@ using std::set;
 using std::stringstream;
 using std::tie;
 using std::mutex;
+using std::lock_guard;
 using std::cout;
 using std::cerr;
 using std::endl;
@@ -68,7 +71,30 @@ D(string msg, StreamingSessionImpl *obj)
 { util::debug_out("StreamingSessionImpl", msg, obj, cout); }
 
 
-set<string> active_accounts;
+/*
+ * primary accounts w/ an active session - the server only allows one per
+ * account - shared by sessions on any thread
+ */
+class ActiveAccounts{
+    mutex _mtx;
+    set<string> _accounts;
+
+public:
+    /* false if already active */
+    bool
+    add(const string& acct)
+    {
+        lock_guard<mutex> _(_mtx);
+        return _accounts.insert(acct).second;
+    }
+
+    void
+    remove(const string& acct)
+    {
+        lock_guard<mutex> _(_mtx);
+        _accounts.erase(acct);
+    }
+} active_accounts;
 
 class AdminSubscriptionImpl
         : public StreamingSubscriptionImpl {
@@ -250,8 +276,10 @@ const milliseconds StreamingSession::DEF_SUBSCRIBE_TIMEOUT(
 class StreamingSessionImpl{
     StreamerInfo _streamer_info;
     string _account_id;
+    string _active_account; // primary account we hold in 'active_accounts'
     std::unique_ptr<conn::WebSocketClient> _client;
     streaming_cb_ty _callback;
+    streaming_json_cb_ty _json_callback;
     milliseconds _connect_timeout;
     milliseconds _listening_timeout;
     milliseconds _subscribe_timeout;
@@ -261,8 +289,13 @@ class StreamingSessionImpl{
     bool _logged_in;
     bool _listening;
     QOSType _qos;
+    size_t _inbound_capacity;
+    OverflowPolicyType _inbound_policy;
     unsigned long long _last_heartbeat;
     ThreadSafeHashMap<int, PendingResponse> _responses_pending;
+    StreamFrameScanner _frame_scanner;
+    std::unique_ptr<LevelOneBook> _level_one_book; // kept once created
+    bool _level_one_book_enabled;
 
     class ListenerThreadTarget{
         static const string RESPONSE_TO_REQUEST;
@@ -281,9 +314,6 @@ class StreamingSessionImpl{
         void
         exec();
 
-        void
-        parse(const string& responses);
-
         void
         parse_response_to_request(const json& response);
 
@@ -300,6 +330,10 @@ class StreamingSessionImpl{
         ListenerThreadTarget( StreamingSessionImpl *ss )
             : _ss(ss) {}
 
+        /* (public for StreamingResponseParser) */
+        void
+        parse(const string& responses);
+
         void
         operator()();
     };
@@ -319,6 +353,9 @@ class StreamingSessionImpl{
     void
     _reset();
 
+    void
+    _release_account();
+
     void
     _send_requests( const vector<StreamingSubscriptionImpl>& subscriptions,
                     PendingResponse::response_cb_ty callback = nullptr );
@@ -329,6 +366,11 @@ class StreamingSessionImpl{
                     unsigned long long ts,
                     const json& j )
     {
+        /* only serialize if someone (i.e the C ABI) wants a string */
+        if( _json_callback ){
+            _json_callback( static_cast<int>(cb_type),
+                            static_cast<int>(ss_type), ts, j );
+        }
         if( _callback ){
             _callback( static_cast<int>(cb_type), static_cast<int>(ss_type),
                        ts, j.dump().c_str() );
@@ -342,14 +384,17 @@ public:
 
     StreamingSessionImpl( const StreamerInfo& streamer_info,
                           streaming_cb_ty callback,
+                          streaming_json_cb_ty json_callback,
                           milliseconds connect_timeout,
                           milliseconds listening_timeout,
                           milliseconds subscribe_timeout )
         :
             _streamer_info( streamer_info ),
             _account_id( streamer_info.desired_acct_id ),
+            _active_account(),
             _client(nullptr),
             _callback( callback ),
+            _json_callback( json_callback ),
             _connect_timeout( max(connect_timeout,
                                   StreamingSession::MIN_TIMEOUT) ),
             _listening_timeout( max(listening_timeout,
@@ -362,8 +407,13 @@ public:
             _logged_in(false),
             _listening(false),
             _qos( QOSType::fast ),
+            _inbound_capacity( STREAMING_DEF_INBOUND_CAPACITY ),
+            _inbound_policy( OverflowPolicyType::block ),
             _last_heartbeat(0),
-            _responses_pending()
+            _responses_pending(),
+            _frame_scanner(),
+            _level_one_book(),
+            _level_one_book_enabled(false)
         {
             D("construct", this);
             D("primary account: " + streamer_info.primary_acct_id, this);
@@ -404,6 +454,70 @@ public:
     bool
     set_qos(const QOSType& qos);
 
+    /* (next start) */
+    void
+    set_inbound_buffer(size_t capacity, OverflowPolicyType policy)
+    {
+        if( capacity == 0 )
+            TDMA_API_THROW(ValueException, "inbound buffer capacity == 0");
+        _inbound_capacity = capacity;
+        _inbound_policy = policy;
+    }
+
+    std::pair<size_t, OverflowPolicyType>
+    get_inbound_buffer() const
+    { return {_inbound_capacity, _inbound_policy}; }
+
+    /* typed 'data' content for 'service' straight from the frame, before
+     * (or, w/o callbacks, instead of) the json; not while active */
+    void
+    set_field_handler(StreamerServiceType service, StreamFieldHandler *handler)
+    {
+        if( is_active() ){
+            TDMA_API_THROW( StreamingException,
+                            "can't set field handler while session is active" );
+        }
+        _frame_scanner.set_handler(service, handler);
+    }
+
+    /* the book (and its records) outlive being disabled, so readers on
+     * other threads never see it go away */
+    void
+    set_level_one_book_enabled(bool enabled)
+    {
+        if( enabled == _level_one_book_enabled )
+            return;
+        if( is_active() ){
+            TDMA_API_THROW( StreamingException,
+                            "can't change level one book while session is active" );
+        }
+        if( enabled && !_level_one_book )
+            _level_one_book.reset( new LevelOneBook );
+        for( int i = 0; i < LevelOneBook::NSERVICES; ++i ){
+            set_field_handler( LevelOneBook::services()[i],
+                               enabled ? _level_one_book.get() : nullptr );
+        }
+        _level_one_book_enabled = enabled;
+    }
+
+    bool
+    is_level_one_book_enabled() const
+    { return _level_one_book_enabled; }
+
+    template<typename SymbolTy>
+    bool
+    get_level_one_record( StreamerServiceType service,
+                          const SymbolTy& symbol,
+                          LevelOneRecord *record ) const
+    {
+        if( !LevelOneBook::has_service(service) ){
+            TDMA_API_THROW( ValueException,
+                            "not a level one service: " + to_string(service) );
+        }
+        return _level_one_book
+            && _level_one_book->snapshot(service, symbol, record);
+    }
+
     string
     get_primary_account_id() const
     { return _streamer_info.primary_acct_id; }
@@ -411,6 +525,11 @@ public:
     string
     get_streamer_subscription_key() const
     { return _streamer_info.streamer_subscription_key; }
+
+    /* what the listener thread does w/ each message, w/o a connection */
+    void
+    parse_responses(const string& responses)
+    { ListenerThreadTarget(this).parse(responses); }
 };
 
 
@@ -475,6 +594,7 @@ void
 StreamingSessionImpl::ListenerThreadTarget::exec()
 {
     D("begin listening loop", _ss);
+    unsigned long long ndropped = 0;
     while( _ss->_listening ){
 
         /* _client should *always* be connected while listening */
@@ -484,19 +604,19 @@ StreamingSessionImpl::ListenerThreadTarget::exec()
         }
 
         /* BLOCK for _listening_timeout msec until we get at least 1 message */
-        auto results = _ss->_client->recv_atleast_n_or_wait_for( 1,
-                           _ss->_listening_timeout
-                        );
-
-        if( results.empty() ) /* TIMED OUT */
+        if( !_ss->_client->wait_for_messages(_ss->_listening_timeout) )
             throw Timeout("exec timeout", __LINE__, __FILE__);
 
-        /* each message can have mutliple results */
-        for(string& res : results){
-            if( res.empty() ){
+        /*
+         * handle everything that's ready in place; the client's in ring
+         * reuses the message buffers, so no copy or allocation per message
+         */
+        for( const string *res; (res = _ss->_client->peek_message()); ){
+            if( res->empty() ){
                 /* empty message is the signal to stop listening */
                 D("stop-listening message", _ss);
                 _ss->_listening = false;
+                _ss->_client->pop_message();
                 break;
             }
             /*
@@ -514,12 +634,24 @@ StreamingSessionImpl::ListenerThreadTarget::exec()
              *      snapshot: NOT IMPLEMENTED
              */
             try{
-                parse(res);
+                parse(*res);
             }catch( json::exception& e ){
                 cerr << "Error Parsing Json: " << endl
                      << '\t' << e.what() << endl
-                     << '\t' << res << endl;
+                     << '\t' << *res << endl;
+            }catch( JSONScanError& e ){
+                cerr << "Error Scanning Json: " << endl
+                     << '\t' << e.what() << endl
+                     << '\t' << *res << endl;
             }
+            _ss->_client->pop_message();
+        }
+
+        /* messages that didn't fit (or, w/ block, couldn't be held back) */
+        unsigned long long nd = _ss->_client->ndropped();
+        if( nd != ndropped ){
+            metrics().count_streaming_drops(nd - ndropped);
+            ndropped = nd;
         }
     }
     D("end listening loop", _ss);
@@ -529,13 +661,22 @@ StreamingSessionImpl::ListenerThreadTarget::exec()
 void
 StreamingSessionImpl::ListenerThreadTarget::parse(const string& responses)
 {
+    if( _ss->_frame_scanner.has_handlers() ){
+        /* a bad frame throws JSONScanError; skipped like bad json */
+        bool is_data = _ss->_frame_scanner.scan( responses.data(),
+                                                 responses.size() );
+        /* no one left to give the json to */
+        if( is_data && !_ss->_callback && !_ss->_json_callback )
+            return;
+    }
+
     auto resp = json::parse(responses);
     auto r = resp.begin();
     if( r == resp.end() )
         TDMA_API_THROW(StreamingException,"invalid response JSON");
 
     string resp_ty = r.key();
-    auto resp_array = r.value();
+    const json& resp_array = r.value();
 
     if(resp_ty == RESPONSE_TO_REQUEST){
         for(auto& resp : resp_array)
@@ -890,15 +1031,13 @@ StreamingSessionImpl::_send_requests(
     }
 
     vector<int> req_ids;
-    for(auto& s : subscriptions)
+    for(size_t i = 0; i < subscriptions.size(); ++i)
         req_ids.push_back( _next_request_id++ );
 
     StreamingRequests requests( subscriptions, _account_id,
                                 _streamer_info.credentials.app_id, req_ids );
 
-    auto msg = requests.to_json().dump();
-    _client->send( msg );
-
+    /* before sending, the listener can see the response before we return */
     for( size_t i = 0; i < subscriptions.size(); ++i ){
         _responses_pending.insert(
             req_ids[i],
@@ -908,6 +1047,9 @@ StreamingSessionImpl::_send_requests(
                              callback )
             );
     }
+
+    auto msg = requests.to_json().dump();
+    _client->send( msg );
 }
 
 
@@ -993,31 +1135,40 @@ StreamingSessionImpl::start(
                 "using Subscriptions with command 'SUBS'");
     }
 
+    /* reserve the account first so two sessions can't both get past here */
     D("check unique session", this);
     string acct = get_primary_account_id();
-    if( active_accounts.count(acct) ){
+    if( !active_accounts.add(acct) ){
         TDMA_API_THROW( StreamingException,
                         "Can not start Session; one is already active "
                         "for this primary account: " + acct );
     }
+    _active_account = acct;
 
-    D("_client->reset", this);
-    _client.reset( new conn::WebSocketClient(_streamer_info.url) );
+    /* only after connect AND login do we consider this an active session */
+    try{
+        D("_client->reset", this);
+        _client.reset(
+            new conn::WebSocketClient( _streamer_info.url, _inbound_capacity,
+                static_cast<MessageRing::OverflowPolicy>(_inbound_policy) )
+            );
 
-    D("_client->connect", this);
-    _client->connect( _connect_timeout );
-    if( !_client->is_connected() ){
-        _client.reset();
-        TDMA_API_THROW( StreamingException,
-                        "streaming session failed to connect" );
-    }
+        D("_client->connect", this);
+        _client->connect( _connect_timeout );
+        if( !_client->is_connected() ){
+            _client.reset();
+            TDMA_API_THROW( StreamingException,
+                            "streaming session failed to connect" );
+        }
 
-    _logged_in = _login();
-    if( !_logged_in )
-        TDMA_API_THROW(StreamingException,"login failed");
+        _logged_in = _login();
+        if( !_logged_in )
+            TDMA_API_THROW(StreamingException,"login failed");
+    }catch(...){
+        _release_account();
+        throw;
+    }
 
-    /* only after connect AND login do we consider this an active session */
-    active_accounts.insert(acct);
     _start_listener_thread();
     return add_subscriptions(subscriptions);
 }
@@ -1051,9 +1202,17 @@ StreamingSessionImpl::_reset()
     _client.reset();
     _responses_pending.clear();
     _server_id.clear();
-    try{
-        active_accounts.erase( get_primary_account_id() );
-    }catch(...){}
+    _release_account();
+}
+
+
+void
+StreamingSessionImpl::_release_account()
+{
+    if( !_active_account.empty() ){
+        active_accounts.remove(_active_account);
+        _active_account.clear();
+    }
 }
 
 
@@ -1089,6 +1248,48 @@ StreamingSessionImpl::_stop_listener_thread()
     D("join listener thread DONE", this);
 }
 
+
+StreamingResponseParser::StreamingResponseParser(streaming_cb_ty callback)
+    :
+        _ss( new StreamingSessionImpl( StreamerInfo(), callback, nullptr,
+                                       StreamingSession::DEF_CONNECT_TIMEOUT,
+                                       StreamingSession::DEF_LISTENING_TIMEOUT,
+                                       StreamingSession::DEF_SUBSCRIBE_TIMEOUT ) )
+    {
+    }
+
+StreamingResponseParser::StreamingResponseParser(
+    streaming_json_cb_ty callback
+    )
+    :
+        _ss( new StreamingSessionImpl( StreamerInfo(), nullptr, callback,
+                                       StreamingSession::DEF_CONNECT_TIMEOUT,
+                                       StreamingSession::DEF_LISTENING_TIMEOUT,
+                                       StreamingSession::DEF_SUBSCRIBE_TIMEOUT ) )
+    {
+    }
+
+StreamingResponseParser::StreamingResponseParser()
+    :
+        _ss( new StreamingSessionImpl( StreamerInfo(), nullptr, nullptr,
+                                       StreamingSession::DEF_CONNECT_TIMEOUT,
+                                       StreamingSession::DEF_LISTENING_TIMEOUT,
+                                       StreamingSession::DEF_SUBSCRIBE_TIMEOUT ) )
+    {
+    }
+
+StreamingResponseParser::~StreamingResponseParser()
+{}
+
+void
+StreamingResponseParser::set_field_handler( StreamerServiceType service,
+                                            StreamFieldHandler *handler )
+{ _ss->set_field_handler(service, handler); }
+
+void
+StreamingResponseParser::parse(const string& responses)
+{ _ss->parse_responses(responses); }
+
 } /*tdma*/
 
 
@@ -1179,15 +1380,26 @@ call_session_with_subs(
 
 using namespace tdma;
 
+namespace {
+
+inline std::pair<streaming_cb_ty, streaming_json_cb_ty>
+as_callbacks(streaming_cb_ty callback)
+{ return {callback, nullptr}; }
+
+inline std::pair<streaming_cb_ty, streaming_json_cb_ty>
+as_callbacks(streaming_json_cb_ty callback)
+{ return {nullptr, callback}; }
+
+template<typename CallbackTy>
 int
-StreamingSession_Create_ABI( struct Credentials *pcreds,
-                             streaming_cb_ty callback,
-                             const char* account_id,
-                             unsigned long connect_timeout,
-                             unsigned long listening_timeout,
-                             unsigned long subscribe_timeout,
-                             StreamingSession_C *psession,
-                             int allow_exceptions )
+create_session( struct Credentials *pcreds,
+                CallbackTy callback,
+                const char* account_id,
+                unsigned long connect_timeout,
+                unsigned long listening_timeout,
+                unsigned long subscribe_timeout,
+                StreamingSession_C *psession,
+                int allow_exceptions )
 {
     CHECK_PTR(psession, "session", allow_exceptions);
     CHECK_PTR_KILL_PROXY(pcreds, "credentials", allow_exceptions, psession);
@@ -1199,13 +1411,15 @@ StreamingSession_Create_ABI( struct Credentials *pcreds,
                                 allow_exceptions, psession );
     }
 
-    static auto meth = +[](struct Credentials *pcreds, streaming_cb_ty cb,
+    static auto meth = +[](struct Credentials *pcreds, CallbackTy cb,
                             const char* acct, unsigned long cto,
                            unsigned long lto, unsigned long sto)
                            {
         StreamerInfo si = get_streamer_info(*pcreds, acct ? acct : "");
-        return new StreamingSessionImpl( si, cb, milliseconds(cto),
-                                         milliseconds(lto), milliseconds(sto) );
+        auto cbs = as_callbacks(cb);
+        return new StreamingSessionImpl( si, cbs.first, cbs.second,
+                                         milliseconds(cto), milliseconds(lto),
+                                         milliseconds(sto) );
     };
 
     int err;
@@ -1224,6 +1438,39 @@ StreamingSession_Create_ABI( struct Credentials *pcreds,
     return 0;
 }
 
+} /* namespace */
+
+
+int
+StreamingSession_Create_ABI( struct Credentials *pcreds,
+                             streaming_cb_ty callback,
+                             const char* account_id,
+                             unsigned long connect_timeout,
+                             unsigned long listening_timeout,
+                             unsigned long subscribe_timeout,
+                             StreamingSession_C *psession,
+                             int allow_exceptions )
+{
+    return create_session( pcreds, callback, account_id, connect_timeout,
+                           listening_timeout, subscribe_timeout, psession,
+                           allow_exceptions );
+}
+
+int
+StreamingSession_CreateJson_ABI( struct Credentials *pcreds,
+                                 streaming_json_cb_ty callback,
+                                 const char* account_id,
+                                 unsigned long connect_timeout,
+                                 unsigned long listening_timeout,
+                                 unsigned long subscribe_timeout,
+                                 StreamingSession_C *psession,
+                                 int allow_exceptions )
+{
+    return create_session( pcreds, callback, account_id, connect_timeout,
+                           listening_timeout, subscribe_timeout, psession,
+                           allow_exceptions );
+}
+
 
 int
 StreamingSession_Destroy_ABI( StreamingSession_C *psession,
@@ -1339,3 +1586,148 @@ StreamingSession_GetQOS_ABI( StreamingSession_C *psession,
     tie(*qos, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
     return err;
 }
+
+int
+StreamingSession_SetInboundBuffer_ABI( StreamingSession_C *psession,
+                                       size_t capacity,
+                                       int overflow_policy,
+                                       int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(OverflowPolicyType, overflow_policy, allow_exceptions);
+
+    auto meth = +[](void *obj, size_t c, int p){
+        reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->set_inbound_buffer( c, static_cast<OverflowPolicyType>(p) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, capacity,
+                           overflow_policy);
+}
+
+int
+StreamingSession_GetInboundBuffer_ABI( StreamingSession_C *psession,
+                                       size_t *capacity,
+                                       int *overflow_policy,
+                                       int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(capacity, "capacity", allow_exceptions);
+    CHECK_PTR(overflow_policy, "overflow_policy", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->get_inbound_buffer();
+    };
+
+    std::pair<size_t, OverflowPolicyType> buf;
+    tie(buf, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
+    if( err )
+        return err;
+
+    *capacity = buf.first;
+    *overflow_policy = static_cast<int>(buf.second);
+    return 0;
+}
+
+int
+StreamingSession_SetLevelOneBookEnabled_ABI( StreamingSession_C *psession,
+                                             int enabled,
+                                             int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    auto meth = +[](void *obj, int e){
+        reinterpret_cast<StreamingSessionImpl*>(obj)
+            ->set_level_one_book_enabled( static_cast<bool>(e) );
+    };
+
+    return CallImplFromABI(allow_exceptions, meth, psession->obj, enabled);
+}
+
+int
+StreamingSession_IsLevelOneBookEnabled_ABI( StreamingSession_C *psession,
+                                            int *enabled,
+                                            int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_PTR(enabled, "enabled", allow_exceptions);
+
+    auto meth = +[](void *obj){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)
+                ->is_level_one_book_enabled()
+            );
+    };
+
+    tie(*enabled, err) = CallImplFromABI(allow_exceptions, meth, psession->obj);
+    return err;
+}
+
+int
+StreamingSession_GetLevelOneRecord_ABI( StreamingSession_C *psession,
+                                        int service,
+                                        const char *symbol,
+                                        LevelOneRecord *record,
+                                        int *found,
+                                        int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(symbol, "symbol", allow_exceptions);
+    CHECK_PTR(record, "record", allow_exceptions);
+    CHECK_PTR(found, "found", allow_exceptions);
+
+    auto meth = +[](void *obj, int s, const char *sym, LevelOneRecord *r){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_level_one_record(
+                static_cast<StreamerServiceType>(s), string(sym), r )
+            );
+    };
+
+    tie(*found, err) = CallImplFromABI(allow_exceptions, meth, psession->obj,
+                                       service, symbol, record);
+    return err;
+}
+
+int
+StreamingSession_GetLevelOneRecordById_ABI( StreamingSession_C *psession,
+                                            int service,
+                                            unsigned int symbol_id,
+                                            LevelOneRecord *record,
+                                            int *found,
+                                            int allow_exceptions )
+{
+    int err = proxy_is_callable<StreamingSessionImpl>(psession, allow_exceptions);
+    if( err )
+        return err;
+
+    CHECK_ENUM(StreamerServiceType, service, allow_exceptions);
+    CHECK_PTR(record, "record", allow_exceptions);
+    CHECK_PTR(found, "found", allow_exceptions);
+
+    auto meth = +[](void *obj, int s, unsigned int id, LevelOneRecord *r){
+        return static_cast<int>(
+            reinterpret_cast<StreamingSessionImpl*>(obj)->get_level_one_record(
+                static_cast<StreamerServiceType>(s), id, r )
+            );
+    };
+
+    tie(*found, err) = CallImplFromABI(allow_exceptions, meth, psession->obj,
+                                       service, symbol_id, record);
+    return err;
+}
@@ -20,6 +20,11 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 #include <regex>
 #include <cctype>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <deque>
+#include <functional>
 #include <string.h>
 
 #include "../include/_tdma_api.h"
@@ -40,6 +45,35 @@ util::SignalBlocker signal_blocker({SIGPIPE});
 
 namespace {
 
+/* (function statics so they're usable during static initialization) */
+std::mutex&
+url_mutex()
+{
+    static std::mutex mtx;
+    return mtx;
+}
+
+string&
+url_base_ref()
+{
+    static string url(tdma::DEF_URL_BASE);
+    return url;
+}
+
+string&
+streamer_url_ref()
+{
+    static string url;
+    return url;
+}
+
+bool
+has_scheme(const string& url, const string& scheme)
+{
+    return url.size() > scheme.size()
+        && url.compare(0, scheme.size(), scheme) == 0;
+}
+
 bool
 error_msg_about_token_expiration(const string& msg)
 {
@@ -147,18 +181,28 @@ query_api_on_error_callback(long code, const string& data)
 }
 
 
-tuple<long, string, string, conn::clock_ty::time_point>
-curl_execute(conn::HTTPConnectionInterface& connection, bool return_header_data)
+[[noreturn]] void
+throw_connect_exception(const conn::CurlConnectionError& e)
 {   /*
-     * Curl exceptions are not exposed publicly so we catch and wrap
+     * Curl exceptions are not exposed publicly so we wrap
      */
+    cerr<< "CurlConnectionError --> ConnectionException" << endl;
+    string msg = e.what() + string("(curl code=")
+               + std::to_string(e.code) + ')';
+    TDMA_API_THROW( CurlConnectException, msg, static_cast<int>(e.code) );
+}
+
+
+tuple<long, string, string, conn::clock_ty::time_point>
+curl_execute( conn::HTTPConnectionInterface& connection,
+              bool return_header_data,
+              const conn::chunk_cb_ty& on_chunk = conn::chunk_cb_ty() )
+{
     try{
-        return connection.execute(return_header_data);
+        return on_chunk ? connection.execute(return_header_data, on_chunk)
+                        : connection.execute(return_header_data);
     }catch( conn::CurlConnectionError& e ){
-        cerr<< "CurlConnectionError --> ConnectionException" << endl;
-        string msg = e.what() + string("(curl code=")
-                   + std::to_string(e.code) + ')';
-        TDMA_API_THROW( ConnectException, msg );
+        throw_connect_exception(e);
     }
 }
 
@@ -204,13 +248,20 @@ build_auth_headers( const vector<pair<string,string>>& headers,
 }
 
 
-tuple<string, string, conn::clock_ty::time_point>
-connect( conn::HTTPConnectionInterface& connection,
-         Credentials& creds,
-         const vector<pair<string,string>>& static_headers,
-         api_on_error_cb_ty on_error_cb,
-         bool return_headers,
-         long success_code )
+/* if 'header' is "Bearer [token]", w/o building the string */
+bool
+is_bearer_header(const string& header, const string& token)
+{
+    static const string BEARER("Bearer ");
+    return header.size() == BEARER.size() + token.size()
+        && header.compare(0, BEARER.size(), BEARER) == 0
+        && header.compare(BEARER.size(), string::npos, token) == 0;
+}
+
+
+void
+check_connect_args( conn::HTTPConnectionInterface& connection,
+                    Credentials& creds )
 {
     if( !creds.access_token || !creds.client_id )
         TDMA_API_THROW( LocalCredentialException, "invalid credentials" );
@@ -223,120 +274,682 @@ connect( conn::HTTPConnectionInterface& connection,
 
     if( connection.is_closed() )
         TDMA_API_THROW( APIException, "connection is closed");
+}
+
+
+/*
+ * TokenManager - access tokens shared by account (client_id + refresh_token)
+ *
+ * All cred structs of the same account are linked but different accounts -
+ * even those authorized through the same client_id - aren't. The cached
+ * token takes priority over the cred struct's to avoid refresh 'thrashing'
+ * between unsynced callers. Requests don't write refreshed tokens back to
+ * the (shared, unlocked) cred struct; StoreCredentials writes the current
+ * one.
+ *
+ * Refreshes are single-flight: one caller refreshes while the others with
+ * the same stale token wait for (and use) the result. Once a token's
+ * lifetime is known (from RefreshAccessToken or RequestAccessToken) a
+ * background thread refreshes it REFRESH_MARGIN before it expires so
+ * requests shouldn't see a 401 at all.
+ *
+ * An account not used (get_token/refresh) for a token lifetime - and at
+ * least MIN_IDLE - stops being refreshed and its entry (w/ its copy of the
+ * creds) is erased; a later request just starts over w/ its own token.
+ * Entries in use are never erased so references remain valid while the
+ * lock is dropped.
+ */
+class TokenManager{
+public:
+    static const std::chrono::seconds REFRESH_MARGIN;
+    static const std::chrono::seconds RETRY_WAIT;
+    static const std::chrono::seconds MIN_IDLE;
+    static const std::chrono::seconds EXIT_WAIT;
+
+    /* the new token, or the refresh error */
+    typedef std::function<void(const string&, std::exception_ptr)>
+        refresh_cb_ty;
+
+private:
+    struct Entry{
+        string token;
+        conn::clock_ty::time_point refresh_at; // max() if lifetime unknown
+        bool refreshing;
+        std::exception_ptr error; // from the last refresh
+        std::unique_ptr<Credentials> creds; // copy for background refresh
+        conn::clock_ty::time_point last_used;
+        std::chrono::seconds lifetime; // MIN_IDLE if unknown
+
+        Entry()
+            : refresh_at(conn::clock_ty::time_point::max()),
+              refreshing(false),
+              last_used(conn::clock_ty::now()),
+              lifetime(MIN_IDLE)
+            {}
+
+        bool
+        idle(conn::clock_ty::time_point now) const
+        { return !refreshing && now - last_used > std::max(lifetime, MIN_IDLE); }
+    };
+
+    std::mutex _mtx;
+    std::condition_variable _refresh_cond; // a refresh finished
+    std::condition_variable _bg_cond; // schedule changed or shutting down
+    struct RefreshRequest{
+        Credentials creds;
+        string stale_token;
+        refresh_cb_ty callback;
+    };
+
+    std::unordered_map<string, Entry> _entries;
+    std::deque<RefreshRequest> _requests; // from 'refresh_async'
+    std::thread _bg_thread;
+    bool _bg_running;
+    bool _done;
 
+    TokenManager()
+        : _bg_running(false), _done(false)
+        {}
+
+    ~TokenManager() = delete; // see 'instance'
+
+    static string
+    _key(const Credentials& creds)
+    {
+        return string(creds.client_id) + ' '
+            + (creds.refresh_token ? creds.refresh_token : "");
+    }
+
+    // caller needs to hold _mtx
+    Entry&
+    _get_entry(const Credentials& creds, bool used = true)
+    {
+        Entry& e = _entries[ _key(creds) ];
+        if( e.token.empty() )
+            e.token = creds.access_token;
+        if( used )
+            e.last_used = conn::clock_ty::now();
+        return e;
+    }
+
+    // caller needs to hold _mtx
+    void
+    _start_background()
+    {
+        if( !_bg_thread.joinable() && !_done ){
+            _bg_running = true;
+            _bg_thread = std::thread( &TokenManager::_run_background, this );
+        }
+        _bg_cond.notify_all();
+    }
+
+    // caller needs to hold _mtx
+    void
+    _erase_idle();
+
+    void
+    _run_background();
+
+    void
+    _shutdown();
+
+public:
     /*
-     * cache access tokens across calls by client_id so all cred structs
-     * of the same account are linked but different client_ids aren't
-     *
-     * NOTE - the cached token takes priority to avoid refresh 'thrashing'
-     *        between unsynced callers
+     * never destroyed: at exit the background thread may be stuck in a
+     * refresh request so '_shutdown' only waits EXIT_WAIT for it before
+     * detaching, and it still needs the manager after that
      */
-    static std::unordered_map<string, string> token_cache;
-    string& cached_token = token_cache.insert(
-        {creds.client_id, creds.access_token}
-    ).first->second;
-
-    /* only add headers if we don't already have them */
-    if( !connection.has_headers() ){
-        auto headers = build_auth_headers(static_headers, cached_token);
-        connection.add_headers(headers);
+    static TokenManager&
+    instance()
+    {
+        static TokenManager *tm = new TokenManager;
+        static struct Shutdown{
+            ~Shutdown() { tm->_shutdown(); }
+        } shutdown;
+        return *tm;
     }
 
-    long r_code;
-    string r_data, r_head;
-    conn::clock_ty::time_point r_tp;
-    tie(r_code, r_data, r_head, r_tp) = curl_execute(connection, return_headers);
+    string
+    get_token(const Credentials& creds)
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _get_entry(creds).token;
+    }
 
-    if( !on_return(r_code, success_code, r_data, true, on_error_cb) ){
-        /*
-         * if 'on_return' returns FALSE initially we have an expired token
-         * IN THE HEADER (or in the header AND cache):
-         *
-         * 1) if current token in the header is different than cache:
-         *     a) update the cred struct w/ the cache token (if different)
-         *     b) reset auth header w/ the cache token
-         *     c) try the call again
-         *     d) if 'on_return' returns TRUE, return, else...
-         * 2) refresh the token (automatically updates 'creds.access_token')
-         * 3) update the cache
-         * 4) update the header
-         * 5) try again (this should either return true or THROW)
-         */
+    /*
+     * return a token newer than 'stale_token': the cached token if it's
+     * already different, the result of an in-flight refresh, or refresh
+     * ('used' is FALSE for the scheduled refresh so it doesn't keep an
+     * idle account alive)
+     */
+    string
+    refresh( const Credentials& creds,
+             const string& stale_token,
+             bool used = true );
+
+    /*
+     * 'refresh' w/o blocking the caller (e.g the async loop): 'callback' is
+     * called right away if there's already a newer token, otherwise from
+     * the background thread; it shouldn't throw. (Requests still queued at
+     * exit are dropped.)
+     */
+    void
+    refresh_async( const Credentials& creds,
+                   const string& stale_token,
+                   refresh_cb_ty callback );
+
+    /* record a newly issued token and its lifetime */
+    void
+    update(const Credentials& creds, long long expires_in_sec);
+};
+
+const std::chrono::seconds TokenManager::REFRESH_MARGIN(120);
+const std::chrono::seconds TokenManager::RETRY_WAIT(30);
+const std::chrono::seconds TokenManager::MIN_IDLE(1800);
+const std::chrono::seconds TokenManager::EXIT_WAIT(3);
+
+string
+TokenManager::refresh( const Credentials& creds,
+                       const string& stale_token,
+                       bool used )
+{
+    std::unique_lock<std::mutex> lock(_mtx);
+    Entry& e = _get_entry(creds, used);
+
+    if( e.token != stale_token )
+        return e.token;
+
+    if( e.refreshing ){
+        _refresh_cond.wait( lock, [&e]{ return !e.refreshing; } );
+        if( e.token != stale_token )
+            return e.token;
+        if( e.error )
+            std::rethrow_exception(e.error);
+    }
+
+    e.refreshing = true;
+    e.error = nullptr;
+    lock.unlock();
+
+    cerr<< "access token expired; try to refresh..." << endl;
+    try{
+        Credentials c(creds);
+        RefreshAccessToken(c); // calls 'update'
+    }catch(...){
+        lock.lock();
+        e.refreshing = false;
+        e.error = std::current_exception();
+        lock.unlock();
+        _refresh_cond.notify_all();
+        throw;
+    }
+    cerr<< "...successfully refreshed access token" << endl;
+    metrics().count_token_refresh();
+
+    lock.lock();
+    e.refreshing = false;
+    string token = e.token;
+    lock.unlock();
+    _refresh_cond.notify_all();
+    return token;
+}
+
+void
+TokenManager::update(const Credentials& creds, long long expires_in_sec)
+{
+    std::lock_guard<std::mutex> lock(_mtx);
+    Entry& e = _entries[ _key(creds) ];
+    e.token = creds.access_token;
+    if( expires_in_sec <= 0 )
+        return;
+
+    std::chrono::seconds life(expires_in_sec);
+    /* for (unexpectedly) short lifetimes refresh halfway through */
+    auto margin = (life > REFRESH_MARGIN * 2) ? REFRESH_MARGIN : life / 2;
+    e.refresh_at = conn::clock_ty::now() + (life - margin);
+    e.lifetime = life;
+    e.creds.reset( new Credentials(creds) );
+    _start_background();
+}
+
+void
+TokenManager::refresh_async( const Credentials& creds,
+                             const string& stale_token,
+                             refresh_cb_ty callback )
+{
+    string token;
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        token = _get_entry(creds).token;
+        if( token == stale_token ){
+            _requests.push_back( {creds, stale_token, std::move(callback)} );
+            _start_background();
+            return;
+        }
+    }
+    callback(token, nullptr);
+}
+
+void
+TokenManager::_erase_idle()
+{
+    auto now = conn::clock_ty::now();
+    for( auto iter = _entries.begin(); iter != _entries.end(); ){
+        if( iter->second.idle(now) )
+            iter = _entries.erase(iter);
+        else
+            ++iter;
+    }
+}
 
-        auto old_headers = connection.get_headers();
-        assert( old_headers.back().first == "Authorization");
-
-        /* first check that header token is same as cached version */
-        if( old_headers.back().second != ("Bearer " + cached_token) ){
-
-            /* overwrite the token in creds w/ cached */
-            if( strcmp(creds.access_token, cached_token.c_str()) ){
-                /*
-                 * should only get in here if client is using references
-                 * to different cred structs (not recommended)
-                 */
-                delete[] creds.access_token;
-                creds.access_token = new char[cached_token.size() + 1];
-                creds.access_token[cached_token.size()] = 0;
-                strcpy(creds.access_token, cached_token.c_str());
+void
+TokenManager::_shutdown()
+{
+    std::unique_lock<std::mutex> lock(_mtx);
+    _done = true;
+    _bg_cond.notify_all();
+    if( !_bg_thread.joinable() )
+        return;
+
+    if( _bg_cond.wait_for( lock, EXIT_WAIT, [this]{ return !_bg_running; } ) ){
+        lock.unlock();
+        _bg_thread.join();
+    }else{
+        cerr<< "background access token refresh still running at exit" << endl;
+        _bg_thread.detach();
+    }
+}
+
+void
+TokenManager::_run_background()
+{
+    std::unique_lock<std::mutex> lock(_mtx);
+    while( !_done ){
+        /* requests waiting on a refresh go before the schedule */
+        if( !_requests.empty() ){
+            RefreshRequest r( std::move(_requests.front()) );
+            _requests.pop_front();
+            lock.unlock();
+            string token;
+            std::exception_ptr error;
+            try{
+                token = refresh(r.creds, r.stale_token);
+            }catch(...){
+                error = std::current_exception();
             }
+            r.callback(token, error);
+            lock.lock();
+            continue;
+        }
+
+        _erase_idle();
 
-            /* update headers w/ cached */
-            connection.reset_headers();
-            auto new_headers = build_auth_headers(static_headers, cached_token);
-            connection.add_headers(new_headers);
+        Entry *next = nullptr;
+        for( auto& p : _entries ){
+            Entry& e = p.second;
+            if( e.creds && !e.refreshing
+                && (!next || e.refresh_at < next->refresh_at) )
+            {
+                next = &e;
+            }
+        }
 
-            /* try again */
-            tie(r_code, r_data, r_head, r_tp) =
-                curl_execute(connection, return_headers);
+        if( !next || next->refresh_at == conn::clock_ty::time_point::max() ){
+            _bg_cond.wait(lock);
+            continue;
+        }
+
+        if( conn::clock_ty::now() < next->refresh_at ){
+            _bg_cond.wait_until(lock, next->refresh_at);
+            continue;
+        }
 
-            /* if still FALSE, expired token IN CACHE, continue to refresh */
-            if( on_return(r_code, success_code, r_data, true, on_error_cb) )
-                return make_tuple(r_data, r_head, r_tp);
+        /* due; 'update' will re-schedule on success */
+        string stale = next->token;
+        next->refresh_at = conn::clock_ty::now() + RETRY_WAIT;
+        Credentials c( *next->creds );
+        lock.unlock();
+        string key = _key(c);
+        try{
+            refresh(c, stale, false);
+            lock.lock();
+        }catch( LocalCredentialException& exc ){
+            /* e.g refresh token expired; don't keep trying */
+            cerr<< "background access token refresh failed: " << exc.what()
+                << endl;
+            lock.lock();
+            Entry& e = _entries[key];
+            if( e.token == stale )
+                e.refresh_at = conn::clock_ty::time_point::max();
+        }catch( std::exception& exc ){
+            /* try again after RETRY_WAIT; requests still refresh reactively */
+            cerr<< "background access token refresh failed: " << exc.what()
+                << endl;
+            lock.lock();
         }
+    }
+    _bg_running = false;
+    lock.unlock();
+    _bg_cond.notify_all();
+}
+
+
+void
+update_access_token(const Credentials& creds, long long expires_in_sec)
+{ TokenManager::instance().update(creds, expires_in_sec); }
+
 
-        cerr<< "access token expired; try to refresh..." << endl;
-        RefreshAccessToken(creds); // updates creds.access_token
+string
+current_access_token(const Credentials& creds)
+{
+    if( !creds.client_id || !creds.access_token )
+        return creds.access_token ? creds.access_token : "";
+    return TokenManager::instance().get_token(creds);
+}
+
+
+tuple<string, string, conn::clock_ty::time_point>
+retry_with_new_token( conn::HTTPConnectionInterface& connection,
+                      Credentials& creds,
+                      api_on_error_cb_ty on_error_cb,
+                      bool return_headers,
+                      long success_code,
+                      const conn::chunk_cb_ty& on_chunk )
+{
+    /*
+     * if 'on_return' returns FALSE initially we have an expired token
+     * IN THE HEADER (or in the header AND cache):
+     *
+     * 1) get a newer token from the manager: the cached token if it's
+     *    different than the header's, or the result of a (single-flight)
+     *    refresh
+     * 2) update the header (the cred struct is left alone; other threads
+     *    may be reading it and requests always take the manager's token)
+     * 3) try the call again
+     * 4) if 'on_return' returns FALSE the cached token had expired too;
+     *    refresh it and try once more (this should return true or THROW)
+     */
+    static const string BEARER("Bearer ");
+
+    TokenManager& tm = TokenManager::instance();
+    long r_code;
+    string r_data, r_head;
+    conn::clock_ty::time_point r_tp;
+
+    const string& old_auth = connection.get_auth_header();
+    assert( old_auth.compare(0, BEARER.size(), BEARER) == 0 );
+    string token = old_auth.substr( BEARER.size() );
 
-        /* update the cache */
-        cached_token = creds.access_token;
+    for( int i = 0; i < 2; ++i ){
+        token = tm.refresh(creds, token);
 
-        /* update the header */
-        connection.reset_headers();
-        auto new_headers = build_auth_headers(static_headers, cached_token);
-        connection.add_headers(new_headers);
+        /* the static headers stay as they are */
+        connection.set_auth_header(BEARER + token);
 
-        /* try again */
         tie(r_code, r_data, r_head, r_tp) =
-            curl_execute(connection, return_headers);
+            curl_execute(connection, return_headers, on_chunk);
 
-        bool r = on_return(r_code, success_code, r_data, false, on_error_cb);
-        assert(r); /* should either be true or have thrown */
-        cerr<< "...successfully refreshed access token" << endl;
-    } 
+        if( on_return(r_code, success_code, r_data, i == 0, on_error_cb) )
+            return make_tuple( std::move(r_data), std::move(r_head), r_tp );
+    }
 
-    return make_tuple(r_data, r_head, r_tp);
+    assert(false); /* should have returned true or thrown */
+    TDMA_API_THROW( ConnectException, "failed to refresh access token" );
 }
 
 
+tuple<string, string, conn::clock_ty::time_point>
+connect( conn::HTTPConnectionInterface& connection,
+         Credentials& creds,
+         const vector<pair<string,string>>& static_headers,
+         api_on_error_cb_ty on_error_cb,
+         bool return_headers,
+         long success_code,
+         const conn::chunk_cb_ty& on_chunk = conn::chunk_cb_ty() )
+{
+    check_connect_args(connection, creds);
+
+    string token = TokenManager::instance().get_token(creds);
+
+    /*
+     * only add headers if we don't already have them; only swap the
+     * auth header if the token has been refreshed (e.g in the background)
+     * since it was set
+     */
+    if( !connection.has_headers() )
+        connection.add_headers(static_headers);
+    if( !is_bearer_header(connection.get_auth_header(), token) )
+        connection.set_auth_header("Bearer " + token);
+
+    long r_code;
+    string r_data, r_head;
+    conn::clock_ty::time_point r_tp;
+    tie(r_code, r_data, r_head, r_tp) =
+        curl_execute(connection, return_headers, on_chunk);
+
+    if( !on_return(r_code, success_code, r_data, true, on_error_cb) ){
+        return retry_with_new_token( connection, creds, on_error_cb,
+                                     return_headers, success_code, on_chunk );
+    }
+
+    return make_tuple( std::move(r_data), std::move(r_head), r_tp );
+}
+
+
+const vector<pair<string,string>> GET_STATIC_HEADERS = {
+    {"Accept", "application/json"}
+};
+
 pair<string, conn::clock_ty::time_point>
 connect_get( conn::HTTPConnectionInterface& connection,
              Credentials& creds,
              api_on_error_cb_ty on_error_cb )
 {
-    static const vector<pair<string,string>> STATIC_HEADERS = {
-        {"Accept", "application/json"}
-    };
-
     assert( connection.get_method() == conn::HttpMethod::http_get );
 
     string r_data, r_head;
     conn::clock_ty::time_point r_tp;
-    tie(r_data, r_head, r_tp) = connect(connection, creds, STATIC_HEADERS,
+    tie(r_data, r_head, r_tp) = connect(connection, creds, GET_STATIC_HEADERS,
                                         on_error_cb, false,
                                         conn::HTTP_RESPONSE_OK);
 
-    return make_pair(r_data, r_tp);
+    return make_pair( std::move(r_data), r_tp );
+}
+
+
+conn::clock_ty::time_point
+connect_get_stream( conn::HTTPConnectionInterface& connection,
+                    Credentials& creds,
+                    api_on_error_cb_ty on_error_cb,
+                    const conn::chunk_cb_ty& on_chunk )
+{
+    assert( connection.get_method() == conn::HttpMethod::http_get );
+    assert( on_chunk );
+
+    /* error responses are still buffered and handled as usual */
+    string r_data, r_head;
+    conn::clock_ty::time_point r_tp;
+    tie(r_data, r_head, r_tp) = connect(connection, creds, GET_STATIC_HEADERS,
+                                        on_error_cb, false,
+                                        conn::HTTP_RESPONSE_OK, on_chunk);
+    return r_tp;
+}
+
+
+/*
+ * the callback (run on the async loop thread) owns the connection; if the
+ * token has expired it's refreshed on the token manager's thread - never
+ * on the loop - and the request re-sent, at most twice (like 'connect')
+ */
+void
+execute_get_async( std::shared_ptr<conn::HTTPConnection> connection,
+                   Credentials *pcreds,
+                   api_on_error_cb_ty on_error_cb,
+                   conn::clock_ty::time_point start_at,
+                   connect_async_cb_ty callback,
+                   int nrefreshes )
+{
+    static const string BEARER("Bearer ");
+
+    connection->execute_async( false,
+        [=]( tuple<long, string, string, conn::clock_ty::time_point> r,
+             std::exception_ptr e )
+        {
+            string r_data;
+            try{
+                if( e ){
+                    try{
+                        std::rethrow_exception(e);
+                    }catch( conn::CurlConnectionError& ce ){
+                        throw_connect_exception(ce);
+                    }
+                }
+
+                r_data = std::move( std::get<1>(r) );
+                if( !on_return( std::get<0>(r), conn::HTTP_RESPONSE_OK,
+                                r_data, nrefreshes < 2, on_error_cb) )
+                {
+                    string stale = connection->get_auth_header()
+                                              .substr( BEARER.size() );
+                    TokenManager::instance().refresh_async( *pcreds, stale,
+                        [=]( const string& token, std::exception_ptr re ){
+                            if( re ){
+                                callback( string(), re );
+                                return;
+                            }
+                            try{
+                                connection->set_auth_header(BEARER + token);
+                                execute_get_async( connection, pcreds,
+                                                   on_error_cb,
+                                                   conn::clock_ty::now(),
+                                                   callback, nrefreshes + 1 );
+                            }catch(...){
+                                callback( string(), std::current_exception() );
+                            }
+                        } );
+                    return;
+                }
+            }catch(...){
+                callback( string(), std::current_exception() );
+                return;
+            }
+            callback( r_data, nullptr );
+        },
+        start_at
+    );
+}
+
+
+void
+connect_get_async( std::shared_ptr<conn::HTTPConnection> connection,
+                   Credentials& creds,
+                   api_on_error_cb_ty on_error_cb,
+                   conn::clock_ty::time_point start_at,
+                   connect_async_cb_ty callback )
+{
+    assert( connection );
+    assert( connection->get_method() == conn::HttpMethod::http_get );
+
+    check_connect_args(*connection, creds);
+
+    if( !connection->has_headers() ){
+        auto headers = build_auth_headers(
+            GET_STATIC_HEADERS, TokenManager::instance().get_token(creds)
+            );
+        connection->add_headers(headers);
+    }
+
+    execute_get_async( connection, &creds, on_error_cb, start_at, callback, 0 );
+}
+
+
+string
+url_base()
+{
+    std::lock_guard<std::mutex> _(url_mutex());
+    return url_base_ref();
+}
+
+
+void
+set_url_base(const string& url)
+{
+    if( !has_scheme(url, "http://") && !has_scheme(url, "https://") )
+        TDMA_API_THROW(ValueException, "url base must be http(s): " + url);
+
+    std::lock_guard<std::mutex> _(url_mutex());
+    url_base_ref() = (url.back() == '/') ? url : url + '/';
+}
+
+
+string
+streamer_url()
+{
+    std::lock_guard<std::mutex> _(url_mutex());
+    return streamer_url_ref();
+}
+
+
+void
+set_streamer_url(const string& url)
+{
+    if( !url.empty() && !has_scheme(url, "ws://") && !has_scheme(url, "wss://") )
+        TDMA_API_THROW(ValueException, "streamer url must be ws(s): " + url);
+
+    std::lock_guard<std::mutex> _(url_mutex());
+    streamer_url_ref() = url;
+}
+
+
+RequestScheduler&
+request_scheduler()
+{
+    static RequestScheduler scheduler;
+    return scheduler;
+}
+
+
+MetricsRegistry&
+metrics()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+
+long
+status_from_exception(std::exception_ptr e)
+{
+    try{
+        std::rethrow_exception(e);
+    }catch( ConnectException& ce ){
+        return ce.status_code();
+    }catch(...){
+    }
+    return 0;
+}
+
+
+void
+record_request_metrics( const string& endpoint,
+                        long status,
+                        const conn::HTTPConnectionInterface& connection )
+{
+    typedef MetricsRegistry::Phase Phase;
+
+    MetricsRegistry& m = metrics();
+    if( !m.is_enabled() )
+        return;
+
+    conn::TransferTimes t = connection.get_transfer_times();
+    std::chrono::microseconds phases[MetricsRegistry::NPHASES] = {};
+    phases[ static_cast<int>(Phase::dns) ] = t.dns;
+    phases[ static_cast<int>(Phase::connect) ] = t.connect;
+    phases[ static_cast<int>(Phase::tls) ] = t.tls;
+    phases[ static_cast<int>(Phase::ttfb) ] = t.ttfb;
+    phases[ static_cast<int>(Phase::transfer) ] = t.transfer;
+    phases[ static_cast<int>(Phase::total) ] = t.total;
+    m.record_request(endpoint, status, phases);
 }
 
 
@@ -352,13 +965,36 @@ connect_execute( conn::HTTPConnectionInterface& connection,
 
     assert( connection.get_method() != conn::HttpMethod::http_get );
 
+    static const char* METHODS[] = {"GET", "POST", "DELETE", "PUT"};
+    string endpoint = MetricsRegistry::endpoint(
+        METHODS[ static_cast<int>(connection.get_method()) ],
+        connection.get_url()
+        );
+
+    /* orders/cancels go ahead of everything else(see request_scheduler.h) */
+    auto tbeg = std::chrono::steady_clock::now();
+    RequestScheduler::Ticket ticket =
+        request_scheduler().acquire( static_cast<int>(RequestLane::execution) );
+    metrics().record_phase( endpoint, MetricsRegistry::Phase::queue_wait,
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - tbeg )
+        );
+
     string r_data, r_head;
     conn::clock_ty::time_point r_tp;
-    tie(r_data, r_head, r_tp) = connect( connection, creds, STATIC_HEADERS,
-                                         account_api_on_error_callback,
-                                         true, success_code );
+    try{
+        tie(r_data, r_head, r_tp) = connect( connection, creds, STATIC_HEADERS,
+                                             account_api_on_error_callback,
+                                             true, success_code );
+    }catch(...){
+        record_request_metrics( endpoint,
+                                status_from_exception(std::current_exception()),
+                                connection );
+        throw;
+    }
+    record_request_metrics(endpoint, success_code, connection);
 
-    return make_pair(r_head, r_tp);
+    return make_pair( std::move(r_head), r_tp );
 }
 
 
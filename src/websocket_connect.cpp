@@ -16,6 +16,9 @@ along with this program.  If not, see http://www.gnu.org/licenses.
 */
 
 #include <iostream>
+#include <future>
+#include <cassert>
+#include <algorithm>
 
 #include "../include/websocket_connect.h"
 
@@ -23,6 +26,7 @@ using std::string;
 using std::vector;
 using std::lock_guard;
 using std::mutex;
+using std::shared_ptr;
 using std::chrono::milliseconds;
 
 
@@ -32,29 +36,168 @@ void
 D(string msg, WebSocketClient *obj)
 { util::debug_out("WebSocket", msg, obj, std::cout); }
 
-WebSocketClient *WebSocketClient::Callbacks::wsc = nullptr;
+void
+D(string msg, WebSocketEventLoop *obj)
+{ util::debug_out("WebSocketEventLoop", msg, obj, std::cout); }
+
 
-WebSocketClient::WebSocketClient(string url)
+WebSocketEventLoop::WebSocketEventLoop()
     :
         _hub(),
-        _url(url),
-        _signal(new uS::Async(_hub.getLoop())),
+        _wakeup(new uS::Async(_hub.getLoop())),
+        _drain_timer(new uS::Timer(_hub.getLoop())),
         _thread(),
-        _in_queue(),
+        _tasks_mtx(),
+        _tasks(),
+        _running(),
+        _held_back()
+    {
+        _hub.onConnection( WebSocketClient::Callbacks::on_connect );
+        _hub.onDisconnection( WebSocketClient::Callbacks::on_disconnect );
+        _hub.onError( WebSocketClient::Callbacks::on_error );
+        _hub.onMessage( WebSocketClient::Callbacks::on_message );
+        _wakeup->start( on_wakeup );
+        _wakeup->setData( reinterpret_cast<void*>(this) );
+        _drain_timer->setData( reinterpret_cast<void*>(this) );
+
+        /* '_wakeup' keeps the loop running w/o any sockets */
+        _thread = std::thread( [this]{
+            D("loop thread IN", this);
+            _hub.run();
+            D("loop thread OUT", this);
+        } );
+        D("construct", this);
+    }
+
+
+WebSocketEventLoop::~WebSocketEventLoop()
+{
+    D("destruct", this);
+    assert( !in_loop_thread() );
+
+    /* once '_wakeup' is gone (and any closing sockets are done) run returns */
+    post( [this]{
+        _drain_timer->stop();
+        _drain_timer->close();
+        _wakeup->close();
+    } );
+
+    D("destruct, join _thread", this);
+    if( _thread.joinable() )
+        _thread.join();
+    D("destruct, join _thread DONE", this);
+}
+
+
+shared_ptr<WebSocketEventLoop>
+WebSocketEventLoop::acquire()
+{
+    static mutex mtx;
+    static std::weak_ptr<WebSocketEventLoop> current;
+
+    lock_guard<mutex> _(mtx);
+    shared_ptr<WebSocketEventLoop> loop = current.lock();
+    if( !loop ){
+        loop = std::make_shared<WebSocketEventLoop>();
+        current = loop;
+    }
+    return loop;
+}
+
+
+void
+WebSocketEventLoop::post(std::function<void()> task)
+{
+    {
+        lock_guard<mutex> _(_tasks_mtx);
+        _tasks.emplace_back( std::move(task) );
+    }
+    _wakeup->send();
+}
+
+
+void
+WebSocketEventLoop::on_wakeup(uS::Async *a)
+{
+    auto loop = reinterpret_cast<WebSocketEventLoop*>(a->getData());
+    assert(loop);
+    loop->_run_tasks();
+}
+
+
+void
+WebSocketEventLoop::_run_tasks()
+{
+    {
+        lock_guard<mutex> _(_tasks_mtx);
+        _running.swap(_tasks);
+    }
+    /* a task can post, or close '_wakeup'; it's only deleted by the loop */
+    for( auto& task : _running )
+        task();
+    _running.clear();
+}
+
+
+void
+WebSocketEventLoop::hold_back(WebSocketClient *client)
+{
+    assert( in_loop_thread() );
+    if( std::find(_held_back.begin(), _held_back.end(), client)
+        != _held_back.end() )
+    {
+        return;
+    }
+    if( _held_back.empty() )
+        _drain_timer->start( on_drain, DRAIN_INTERVAL_MSEC, DRAIN_INTERVAL_MSEC );
+    _held_back.push_back(client);
+}
+
+
+void
+WebSocketEventLoop::release(WebSocketClient *client)
+{
+    assert( in_loop_thread() );
+    auto iter = std::find(_held_back.begin(), _held_back.end(), client);
+    if( iter == _held_back.end() )
+        return;
+    _held_back.erase(iter);
+    if( _held_back.empty() )
+        _drain_timer->stop();
+}
+
+
+void
+WebSocketEventLoop::on_drain(uS::Timer *t)
+{
+    auto loop = reinterpret_cast<WebSocketEventLoop*>(t->getData());
+    assert(loop);
+
+    auto& held = loop->_held_back;
+    held.erase( std::remove_if( held.begin(), held.end(),
+                    [](WebSocketClient *c){ return c->_drain_held_back(); } ),
+                held.end() );
+    if( held.empty() )
+        t->stop();
+}
+
+
+WebSocketClient::WebSocketClient( string url,
+                                  size_t in_capacity,
+                                  MessageRing::OverflowPolicy in_overflow_policy )
+    :
+        _loop(),
+        _url(url),
+        _in_ring(in_capacity, in_overflow_policy),
+        _held_back(),
         _out_queue(),
         _init_cond(),
         _init_flag(false),
+        _done_flag(true),
         _init_mtx(),
         _ws(nullptr),
         _closing_state( CloseType::none )
     {
-        Callbacks::wsc = this;
-        _hub.onConnection( Callbacks::on_connect );
-        _hub.onDisconnection( Callbacks::on_disconnect );
-        _hub.onError( Callbacks::on_error );
-        _hub.onMessage( Callbacks::on_message );
-        _signal->start( Callbacks::on_signal );
-        _signal->setData( reinterpret_cast<void*>(this) );
         D("construct", this);
     }
 
@@ -66,18 +209,27 @@ WebSocketClient::~WebSocketClient()
 }
 
 
+void
+WebSocketClient::_set_flags(bool init, bool done)
+{
+    {
+        lock_guard<mutex> _(_init_mtx);
+        _init_flag = _init_flag || init;
+        _done_flag = _done_flag || done;
+    }
+    _init_cond.notify_all();
+}
+
+
 void
 WebSocketClient::Callbacks::on_connect( uws_client_ty *ws, uWS::HttpRequest r)
 {
+    auto wsc = reinterpret_cast<WebSocketClient*>(ws->getUserData());
     D("on_connect", wsc);
 
     assert(wsc);
     wsc->_ws = ws;
-    {
-        lock_guard<mutex> _(wsc->_init_mtx);
-        wsc->_init_flag = true;
-    }
-    wsc->_init_cond.notify_all();
+    wsc->_set_flags(true, false);
 }
 
 
@@ -87,31 +239,25 @@ WebSocketClient::Callbacks::on_disconnect( uws_client_ty *ws,
                                            char* msg,
                                            size_t msg_len )
 {
+    auto wsc = reinterpret_cast<WebSocketClient*>(ws->getUserData());
     D("on_disconnect", wsc);
 
     assert(wsc);
     wsc->_ws = nullptr;
-
-    D("on_disconnect, _signal->close", wsc);
-    wsc->_signal->close();
+    wsc->_set_flags(true, true);
 }
 
 
 void
 WebSocketClient::Callbacks::on_error(void *v)
 {
+    /* 'v' is the user data passed to connect, i.e the client */
+    auto wsc = reinterpret_cast<WebSocketClient*>(v);
     D("on_error", wsc);
 
     assert(wsc);
     wsc->_ws = nullptr;
-
-    D("on_error, _signal->close", wsc);
-    wsc->_signal->close();
-    {
-        lock_guard<mutex> _(wsc->_init_mtx);
-        wsc->_init_flag = true;
-    }
-    wsc->_init_cond.notify_all();
+    wsc->_set_flags(true, true);
 }
 
 
@@ -121,56 +267,117 @@ WebSocketClient::Callbacks::on_message( uws_client_ty *ws,
                                         size_t msg_len,
                                         uWS::OpCode op )
 {
+    auto wsc = reinterpret_cast<WebSocketClient*>(ws->getUserData());
     D("on_message", wsc);
 
     assert(wsc);
-    string msg_s(msg, msg_len);
-    assert( !msg_s.empty() );
+    assert( msg_len ); // empty is the consumer's stop signal
 
-    D("message: " + msg_s, wsc);
-    wsc->_in_queue.emplace( msg_s );
+#ifdef DEBUG_VERBOSE_1_
+    D("message: " + string(msg, msg_len), wsc);
+#endif /* DEBUG_VERBOSE_1_ */
+    wsc->_push_message(msg, msg_len);
 }
 
 
 void
-WebSocketClient::Callbacks::on_signal(uS::Async *a)
+WebSocketClient::_push_message(const char *msg, size_t msg_len)
 {
-    D("on_signal", wsc);
+    assert( _loop->in_loop_thread() );
+
+    /* the loop thread is shared, never wait on our consumer */
+    if( _in_ring.policy() == MessageRing::OverflowPolicy::drop ){
+        if( !_in_ring.push(msg, msg_len) )
+            D("message dropped, in ring full", this);
+        return;
+    }
+
+    /* keep order: nothing goes in ahead of what's already held back */
+    if( _held_back.empty() && _in_ring.try_push(msg, msg_len) )
+        return;
+
+    if( _held_back.size() >= _in_ring.capacity() ){
+        _in_ring.add_dropped();
+        D("message dropped, in ring full and held back", this);
+        return;
+    }
+
+    if( _held_back.empty() )
+        _loop->hold_back(this);
+    _held_back.emplace_back(msg, msg_len);
+}
+
+
+bool
+WebSocketClient::_drain_held_back()
+{
+    while( !_held_back.empty() ){
+        const string& msg = _held_back.front();
+        if( !_in_ring.try_push(msg.c_str(), msg.size()) )
+            return false;
+        _held_back.pop_front();
+    }
+    return true;
+}
 
-    auto wsc = reinterpret_cast<WebSocketClient*>(a->getData());
-    assert(wsc);
-    assert(wsc == WebSocketClient::Callbacks::wsc);
-    assert(wsc->_ws);
 
-    if( wsc->_closing_state == CloseType::immediate ){
-        D("on_signal, _ws->terminate", wsc);
-        wsc->_ws->terminate();
+void
+WebSocketClient::_flush()
+{
+    D("_flush", this);
+    assert( _loop->in_loop_thread() );
+
+    if( !_ws )
+        return;
+
+    if( _closing_state == CloseType::immediate ){
+        D("_flush, _ws->terminate", this);
+        _ws->terminate();
         return;
     }
 
-    while( !wsc->_out_queue.empty() ){
-        string msg = wsc->_out_queue.front();
-        wsc->_out_queue.pop();
-        D("on_signal, _ws->send: " + msg, wsc);
-        wsc->_ws->send(msg.c_str(), msg.size(), uWS::OpCode::TEXT);
+    while( !_out_queue.empty() ){
+        string msg = _out_queue.front();
+        _out_queue.pop();
+        D("_flush, _ws->send: " + msg, this);
+        _ws->send(msg.c_str(), msg.size(), uWS::OpCode::TEXT);
     }
 
-    if( wsc->_closing_state == CloseType::graceful ){
-        D("on_signal, _ws->close", wsc);
-        wsc->_ws->close();
+    if( _closing_state == CloseType::graceful ){
+        D("_flush, _ws->close", this);
+        _ws->close();
     }
 }
 
 
+void
+WebSocketClient::_sync_with_loop()
+{
+    std::promise<void> done;
+    _loop->post( [&done]{ done.set_value(); } );
+    done.get_future().wait();
+}
+
+
 void
 WebSocketClient::connect(milliseconds timeout)
 {
     D("connect", this);
-    if( _ws || _closing_state != CloseType::none )
+    if( _ws || _closing_state != CloseType::none || _loop )
         return;
 
-    D("connect, move new _thread", this);
-    _thread = std::move( std::thread( SocketThreadTarget(this, timeout) ) );
+    _loop = WebSocketEventLoop::acquire();
+    {
+        lock_guard<mutex> _(_init_mtx);
+        _init_flag = false;
+        _done_flag = false;
+    }
+
+    D("connect, post hub connect", this);
+    _loop->post( [this, timeout]{
+        _loop->hub().connect( _url, reinterpret_cast<void*>(this), {},
+                              static_cast<int>(timeout.count()) );
+    } );
 
     D("connect, wait for callback notify", this);
     /*
@@ -199,17 +406,34 @@ void
 WebSocketClient::close(bool graceful)
 {
     D("close", this);
+    if( !_loop )
+        return;
+
     if( is_connected() ){
         _closing_state = graceful ? CloseType::graceful : CloseType::immediate;
-        D("close, _signal->send", this);
-        _signal->send();
+        D("close, post _flush", this);
+        _loop->post( [this]{ _flush(); } );
     }
 
-    D("close, join _thread", this);
-    if( _thread.joinable() ){
-        _thread.join();
+    /* don't let a full in ring hold up the loop thread */
+    _in_ring.close();
+
+    D("close, wait for socket", this);
+    {
+        std::unique_lock<mutex> lock(_init_mtx);
+        _init_cond.wait( lock, [this]{ return _done_flag; } );
     }
-    D("close, join _thread DONE", this);
+
+    /* stop draining held back messages into a ring no one's reading */
+    _loop->post( [this]{
+        _loop->release(this);
+        _held_back.clear();
+    } );
+
+    /* nothing posted for this client can run after we return */
+    _sync_with_loop();
+    _loop.reset();
+    D("close, DONE", this);
 }
 
 
@@ -218,32 +442,49 @@ WebSocketClient::send(string msg)
 {
     if( is_connected() ){
         _out_queue.emplace(msg);
-        D("send, _signal->send: " + msg, this);
-        _signal->send();
+        D("send, post _flush: " + msg, this);
+        _loop->post( [this]{ _flush(); } );
     }
 }
 
 
+bool
+WebSocketClient::_pop_message(string& msg)
+{
+    const string *m = _in_ring.front();
+    if( !m )
+        return false;
+    msg = *m;
+    _in_ring.pop();
+    return true;
+}
+
+
 string
 WebSocketClient::recv()
 {
-    auto p = _in_queue.front_safe();
-    return p.second ? p.first : "";
+    const string *m = _in_ring.front();
+    return m ? *m : "";
 }
 
 
 string
 WebSocketClient::recv_or_wait()
 {
-    return _in_queue.pop_front_or_wait();
+    string msg;
+    while( !_pop_message(msg) )
+        _in_ring.wait_for( std::chrono::hours(1) );
+    return msg;
 }
 
 
 string
 WebSocketClient::recv_or_wait_for(milliseconds timeout)
 {
-    auto p = _in_queue.pop_front_or_wait_for(timeout);
-    return p.second ? p.first : "";
+    string msg;
+    if( _in_ring.wait_for(timeout) )
+        _pop_message(msg);
+    return msg;
 }
 
 
@@ -251,12 +492,8 @@ vector<string>
 WebSocketClient::recv_all()
 {
     vector<string> ret;
-
-    auto p = _in_queue.pop_front_safe();
-    while( p.second ){
-        ret.emplace_back( p.first );
-        p = _in_queue.pop_front_safe();
-    }
+    for( string msg; _pop_message(msg); )
+        ret.emplace_back( std::move(msg) );
     return ret;
 }
 
@@ -276,7 +513,9 @@ WebSocketClient::recv_atleast_n_or_wait(size_t n)
     if( all_n >= n )
         return all;
 
-    return recv_n_or_wait(n - all_n);
+    vector<string> rest = recv_n_or_wait(n - all_n);
+    all.insert( all.end(), rest.begin(), rest.end() );
+    return all;
 }
 
 
@@ -288,7 +527,9 @@ WebSocketClient::recv_atleast_n_or_wait_for(size_t n, milliseconds timeout)
     if( all_n >= n )
         return all;
 
-    return recv_n_or_wait_for(n - all_n, timeout);
+    vector<string> rest = recv_n_or_wait_for(n - all_n, timeout);
+    all.insert( all.end(), rest.begin(), rest.end() );
+    return all;
 }
 
 
@@ -296,12 +537,8 @@ vector<string>
 WebSocketClient::recv_atmost_n(size_t n)
 {
     vector<string> ret;
-    while( ret.size() < n ){
-        auto p = _in_queue.pop_front_safe();
-        if( !p.second )
-            break;
-        ret.emplace_back(p.first);
-    }
+    for( string msg; ret.size() < n && _pop_message(msg); )
+        ret.emplace_back( std::move(msg) );
     return ret;
 }
 
@@ -310,10 +547,8 @@ vector<string>
 WebSocketClient::recv_n_or_wait(size_t n)
 {
     vector<string> ret;
-    while( ret.size() < n ){
-        auto p = _in_queue.pop_front_or_wait();
-        ret.emplace_back(p);
-    }
+    while( ret.size() < n )
+        ret.emplace_back( recv_or_wait() );
     return ret;
 }
 
@@ -328,10 +563,10 @@ WebSocketClient::recv_n_or_wait_for(size_t n, milliseconds timeout)
     auto t_left = timeout;
 
     while( ret.size() < n && t_left.count() >= 0 ){
-        auto p = _in_queue.pop_front_or_wait_for(t_left);
-        if( !p.second )
+        if( !_in_ring.wait_for(t_left) )
             break;
-        ret.emplace_back(p.first);
+        for( string msg; ret.size() < n && _pop_message(msg); )
+            ret.emplace_back( std::move(msg) );
         auto t_elapsed =
             duration_cast<milliseconds>(steady_clock::now() - t_beg);
         t_left = timeout - t_elapsed;
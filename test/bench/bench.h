@@ -0,0 +1,127 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+#include "tdma_common.h"
+
+/*
+ * BenchResult - throughput and per-op latency percentiles of one benchmark
+ *
+ * Latencies are per op, from samples of 'ops_per_sample' ops each, so
+ * percentiles of very fast ops are averages over a sample.
+ */
+struct BenchResult{
+    std::string name;
+    unsigned long long ops;
+    unsigned long long bytes; // processed per op, 0 if n/a
+    double seconds;
+    std::vector<double> ns_per_op; // sorted samples
+
+    double
+    ops_per_sec() const
+    { return seconds > 0 ? ops / seconds : 0; }
+
+    double
+    mb_per_sec() const
+    { return seconds > 0 ? (bytes * ops) / seconds / 1e6 : 0; }
+
+    double
+    percentile(double p) const
+    {
+        if( ns_per_op.empty() )
+            return 0;
+        size_t i = static_cast<size_t>( (ns_per_op.size() - 1) * p / 100.0 );
+        return ns_per_op[i];
+    }
+
+    json
+    to_json() const;
+};
+
+
+/*
+ * BenchRunner - runs the registered benchmarks that match the filter
+ *
+ * measure() calls 'op' in samples of 'ops_per_sample' until 'time_per_bench'
+ * is used (after a warm-up sample), for ops that run on one thread.
+ * Benchmarks that time themselves (e.g across threads) call add_result.
+ */
+class BenchRunner{
+public:
+    typedef std::chrono::steady_clock clock_ty;
+    typedef std::function<void(BenchRunner&)> bench_ty;
+
+private:
+    std::string _filter;
+    std::chrono::milliseconds _time_per_bench;
+    std::string _payloads_dir;
+    std::vector<BenchResult> _results;
+
+    static std::vector<std::pair<std::string, bench_ty>>&
+    registry();
+
+public:
+    BenchRunner( const std::string& filter,
+                 std::chrono::milliseconds time_per_bench,
+                 const std::string& payloads_dir )
+        :
+            _filter(filter),
+            _time_per_bench(time_per_bench),
+            _payloads_dir(payloads_dir)
+        {}
+
+    /* register a group of benchmarks; use BENCH_GROUP below */
+    static int
+    add_group(const std::string& name, bench_ty bench);
+
+    void
+    run();
+
+    bool
+    matches(const std::string& name) const
+    { return _filter.empty() || name.find(_filter) != std::string::npos; }
+
+    std::chrono::milliseconds
+    time_per_bench() const
+    { return _time_per_bench; }
+
+    /* contents of a payload file, throws if it can't be read */
+    std::string
+    payload(const std::string& fname) const;
+
+    void
+    measure( const std::string& name,
+             unsigned long long ops_per_sample,
+             std::function<void()> op,
+             unsigned long long bytes_per_op = 0 );
+
+    void
+    add_result(BenchResult result);
+
+    const std::vector<BenchResult>&
+    results() const
+    { return _results; }
+};
+
+#define BENCH_GROUP(name, func) \
+static int bench_group_##func = BenchRunner::add_group(name, func);
+
+/* keep the optimizer from discarding a result */
+template<typename T>
+inline void
+do_not_optimize(const T& v)
+{
+#ifdef _MSC_VER
+    static const void* volatile sink;
+    sink = &v;
+#else
+    asm volatile("" : : "g"(&v) : "memory");
+#endif
+}
+
+#endif /* BENCH_H */
@@ -0,0 +1,88 @@
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+
+#include "bench.h"
+#include "tdma_data_store.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+const string SYMBOL("BENCH");
+const unsigned int NBARS = 390 * 20; // ~a month of 1-min bars
+
+/* an index and a front store of contiguous bars in a temp directory */
+string
+build_store(unsigned long long first_min)
+{
+    char dir[] = "/tmp/tdma_bench_XXXXXX";
+    if( !mkdtemp(dir) )
+        throw runtime_error("failed to create temp directory");
+
+    ofstream( string(dir) + "/main.dsindex" ) << SYMBOL << endl;
+    ofstream front( string(dir) + "/" + SYMBOL + ".front.store" );
+    for( unsigned int i = 0; i < NBARS; ++i ){
+        double p = 100.0 + (i % 100) / 100.0;
+        front << (first_min + i) << ' ' << p << ' ' << p + .05 << ' '
+              << p - .05 << ' ' << p << ' ' << 1000 + i << '\n';
+    }
+    return dir;
+}
+
+void
+remove_store(const string& dir)
+{
+    for( string f : {"main.dsindex", "log.log", ".front.store", ".back.store"} )
+        remove( (dir + "/" + (f[0] == '.' ? SYMBOL + f : f)).c_str() );
+    rmdir( dir.c_str() );
+}
+
+void
+bench_data_accessor(BenchRunner& runner)
+{
+    const unsigned long long first_min =
+        duration_cast<minutes>(system_clock::now().time_since_epoch()).count()
+        - NBARS;
+    const minutes last_min(first_min + NBARS - 1);
+
+    string dir = build_store(first_min);
+    Credentials creds( "bench", "bench",
+        duration_cast<seconds>(
+            system_clock::now().time_since_epoch() + hours(24 * 90) ).count(),
+        "bench" );
+
+    if( !ds::Initialize(dir, creds) ){
+        remove_store(dir);
+        throw runtime_error("failed to initialize data store in " + dir);
+    }
+
+    try{
+        ds::DataAccessor da(SYMBOL);
+        /* by time; by index requires a running(streaming) store */
+        for( auto& p : { make_pair("1", minutes(0)),
+                         make_pair("390", minutes(389)),
+                         make_pair("all", minutes(NBARS - 1)) } )
+        {
+            minutes start = last_min - p.second;
+            runner.measure( string("data_accessor.between.") + p.first, 64,
+                [&]{ do_not_optimize( da.between(start, last_min) ); } );
+            runner.measure( string("data_accessor.copy_between.") + p.first,
+                p.second.count() > 1000 ? 1 : 16,
+                [&]{ do_not_optimize( da.copy_between(start, last_min) ); },
+                (p.second.count() + 1) * sizeof(ds::OHLCVData) );
+        }
+    }catch(...){
+        ds::Finalize();
+        remove_store(dir);
+        throw;
+    }
+
+    ds::Finalize();
+    remove_store(dir);
+}
+
+BENCH_GROUP("data accessor", bench_data_accessor)
+
+} /* namespace */
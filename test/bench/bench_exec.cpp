@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "_tdma_api.h"
+#include "_execute.h"
+
+using namespace tdma;
+using namespace std;
+
+namespace {
+
+/* time the impl directly, w/o the ABI copy to the proxy */
+const OrderTicketImpl&
+impl(const OrderTicket& order)
+{ return *reinterpret_cast<OrderTicketImpl*>(order.get_cproxy()->obj); }
+
+void
+bench_order_json(BenchRunner& runner)
+{
+    auto equity = SimpleOrderBuilder::Equity::Build("SPY", 100, true, true,
+                                                    300.25);
+    auto vertical = SpreadOrderBuilder::Vertical::Build(
+        "SPY", 1, 17, 2020, true, 300.0, 305.0, 10, true, 1.25 );
+    auto oco = ConditionalOrderBuilder::OCO(
+        SimpleOrderBuilder::Equity::Build("SPY", 100, false, false, 310.0),
+        SimpleOrderBuilder::Equity::Stop::Build("SPY", 100, false, false, 290.0)
+        );
+    auto oto = ConditionalOrderBuilder::OTO(equity, oco);
+
+    for( auto& p : { make_pair("equity", &equity),
+                     make_pair("vertical", &vertical),
+                     make_pair("oco", &oco),
+                     make_pair("oto_oco", &oto) } )
+    {
+        const OrderTicketImpl& o = impl(*p.second);
+        runner.measure( string("order.as_json_string.") + p.first, 16,
+                        [&o]{ do_not_optimize( o.as_json_string() ); } );
+    }
+}
+
+void
+bench_option_symbol(BenchRunner& runner)
+{
+    runner.measure( "option_symbol.build", 64, []{
+        do_not_optimize( BuildOptionSymbol("SPY", 1, 17, 2020, true, 300.5) );
+    });
+
+    runner.measure( "option_symbol.check", 64, []{
+        CheckOptionSymbol("SPY_011720C300.5");
+    });
+}
+
+BENCH_GROUP("order tickets", bench_order_json)
+BENCH_GROUP("option symbols", bench_option_symbol)
+
+} /* namespace */
@@ -0,0 +1,291 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <ctime>
+#include <cstring>
+#include <stdexcept>
+
+#include "bench.h"
+
+using namespace std;
+
+/*
+ * bench - microbenchmarks of the library's hot paths, w/o a connection
+ *
+ *   bench [--payloads DIR] [--filter NAME] [--time MSEC] [--format json|csv]
+ *         [--out FILE] [--compare BASELINE.json] [--threshold PCT]
+ *
+ *   --payloads  : directory of recorded payloads (default: test/bench/payloads)
+ *   --filter    : only run benchmarks whose name contains NAME
+ *   --time      : time to spend on each benchmark (default: 500)
+ *   --format    : output format (default: json)
+ *   --out       : write output to FILE instead of stdout
+ *   --compare   : compare throughput w/ a previous json output; exits w/ 2
+ *                 if any benchmark is more than --threshold(default: 10)
+ *                 percent slower
+ */
+
+namespace {
+
+const char* DEF_PAYLOADS_DIR = "test/bench/payloads";
+const long DEF_TIME_MSEC = 500;
+const double DEF_THRESHOLD_PCT = 10.0;
+const int EXIT_REGRESSION = 2;
+
+void
+usage()
+{
+    cerr<< "usage: bench [--payloads DIR] [--filter NAME] [--time MSEC]" << endl
+        << "             [--format json|csv] [--out FILE]" << endl
+        << "             [--compare BASELINE.json] [--threshold PCT]" << endl;
+}
+
+string
+iso_time_now()
+{
+    time_t t = time(nullptr);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+    return buf;
+}
+
+json
+to_json(const vector<BenchResult>& results, long time_msec)
+{
+    json j;
+    j["version"] = 1;
+    j["library_build"] = tdma::str_from_abi_vargs(LibraryBuildDateTime_ABI, true);
+    j["timestamp"] = iso_time_now();
+    j["time_per_bench_msec"] = time_msec;
+    j["results"] = json::array();
+    for( auto& r : results )
+        j["results"].push_back( r.to_json() );
+    return j;
+}
+
+void
+write_csv(ostream& out, const vector<BenchResult>& results)
+{
+    out<< "name,ops,seconds,ops_per_sec,mb_per_sec,"
+          "ns_min,ns_p50,ns_p90,ns_p99,ns_p99.9,ns_max" << endl;
+    out<< fixed << setprecision(3);
+    for( auto& r : results ){
+        out<< r.name << ',' << r.ops << ',' << r.seconds << ','
+           << r.ops_per_sec() << ',' << r.mb_per_sec() << ','
+           << r.percentile(0) << ',' << r.percentile(50) << ','
+           << r.percentile(90) << ',' << r.percentile(99) << ','
+           << r.percentile(99.9) << ',' << r.percentile(100) << endl;
+    }
+}
+
+/* returns the # of regressions */
+int
+compare( const vector<BenchResult>& results,
+         const string& baseline_path,
+         double threshold_pct )
+{
+    ifstream in(baseline_path);
+    if( !in )
+        throw runtime_error("can't open baseline: " + baseline_path);
+
+    json baseline = json::parse(in);
+    map<string, double> base_ops;
+    for( auto& r : baseline.at("results") )
+        base_ops[ r.at("name") ] = r.at("ops_per_sec");
+
+    int nregress = 0;
+    cerr<< fixed << setprecision(1);
+    for( auto& r : results ){
+        auto b = base_ops.find(r.name);
+        if( b == base_ops.end() || b->second <= 0 ){
+            cerr<< "  [new]  " << r.name << endl;
+            continue;
+        }
+        double pct = (r.ops_per_sec() - b->second) / b->second * 100.0;
+        bool regressed = pct < -threshold_pct;
+        nregress += regressed;
+        cerr<< (regressed ? "  [SLOW] " : "  [ok]   ") << r.name << ' '
+            << showpos << pct << noshowpos << '%' << endl;
+    }
+    return nregress;
+}
+
+} /* namespace */
+
+
+json
+BenchResult::to_json() const
+{
+    json j = {
+        {"name", name},
+        {"ops", ops},
+        {"seconds", seconds},
+        {"ops_per_sec", ops_per_sec()},
+        {"ns_per_op", {
+            {"min", percentile(0)},
+            {"p50", percentile(50)},
+            {"p90", percentile(90)},
+            {"p99", percentile(99)},
+            {"p99.9", percentile(99.9)},
+            {"max", percentile(100)}
+        }}
+    };
+    if( bytes )
+        j["mb_per_sec"] = mb_per_sec();
+    return j;
+}
+
+
+vector<pair<string, BenchRunner::bench_ty>>&
+BenchRunner::registry()
+{
+    static vector<pair<string, bench_ty>> groups;
+    return groups;
+}
+
+int
+BenchRunner::add_group(const string& name, bench_ty bench)
+{
+    registry().emplace_back(name, bench);
+    return static_cast<int>( registry().size() );
+}
+
+void
+BenchRunner::run()
+{
+    for( auto& g : registry() ){
+        cerr<< "+ " << g.first << endl;
+        g.second(*this);
+    }
+}
+
+string
+BenchRunner::payload(const string& fname) const
+{
+    string path = _payloads_dir + '/' + fname;
+    ifstream in(path, ios::binary);
+    if( !in )
+        throw runtime_error("can't open payload: " + path);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+void
+BenchRunner::measure( const string& name,
+                      unsigned long long ops_per_sample,
+                      function<void()> op,
+                      unsigned long long bytes_per_op )
+{
+    using namespace chrono;
+
+    if( !matches(name) )
+        return;
+
+    ops_per_sample = (max)(ops_per_sample, 1ULL);
+    for( unsigned long long i = 0; i < ops_per_sample; ++i ) // warm up
+        op();
+
+    BenchResult r{name, 0, bytes_per_op, 0, {}};
+    auto deadline = clock_ty::now() + _time_per_bench;
+    do{
+        auto tbeg = clock_ty::now();
+        for( unsigned long long i = 0; i < ops_per_sample; ++i )
+            op();
+        auto ns = duration_cast<nanoseconds>(clock_ty::now() - tbeg).count();
+        r.ops += ops_per_sample;
+        r.seconds += ns / 1e9;
+        r.ns_per_op.push_back( static_cast<double>(ns) / ops_per_sample );
+    }while( clock_ty::now() < deadline );
+
+    add_result( move(r) );
+}
+
+void
+BenchRunner::add_result(BenchResult result)
+{
+    sort( result.ns_per_op.begin(), result.ns_per_op.end() );
+    cerr<< "    " << left << setw(44) << result.name << right << fixed
+        << setprecision(0) << setw(14) << result.ops_per_sec() << " ops/s"
+        << setprecision(1) << setw(12) << result.percentile(50) << " ns(p50)"
+        << setw(12) << result.percentile(99) << " ns(p99)" << endl;
+    _results.push_back( move(result) );
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    string payloads_dir(DEF_PAYLOADS_DIR);
+    string filter, format("json"), out_path, baseline_path;
+    long time_msec = DEF_TIME_MSEC;
+    double threshold_pct = DEF_THRESHOLD_PCT;
+
+    for( int i = 1; i < argc; ++i ){
+        string arg(argv[i]);
+        if( i + 1 >= argc ){
+            usage();
+            return 1;
+        }
+        string val(argv[++i]);
+        if( arg == "--payloads" )
+            payloads_dir = val;
+        else if( arg == "--filter" )
+            filter = val;
+        else if( arg == "--time" )
+            time_msec = stol(val);
+        else if( arg == "--format" )
+            format = val;
+        else if( arg == "--out" )
+            out_path = val;
+        else if( arg == "--compare" )
+            baseline_path = val;
+        else if( arg == "--threshold" )
+            threshold_pct = stod(val);
+        else{
+            usage();
+            return 1;
+        }
+    }
+
+    if( format != "json" && format != "csv" ){
+        usage();
+        return 1;
+    }
+
+    BenchRunner runner(filter, chrono::milliseconds(time_msec), payloads_dir);
+    try{
+        runner.run();
+    }catch( exception& e ){
+        cerr<< "benchmark failed: " << e.what() << endl;
+        return 1;
+    }
+
+    ofstream fout;
+    if( !out_path.empty() ){
+        fout.open(out_path);
+        if( !fout ){
+            cerr<< "can't open output file: " << out_path << endl;
+            return 1;
+        }
+    }
+    ostream& out = out_path.empty() ? cout : fout;
+
+    if( format == "csv" )
+        write_csv(out, runner.results());
+    else
+        out << setw(2) << to_json(runner.results(), time_msec) << endl;
+
+    if( !baseline_path.empty() ){
+        try{
+            if( compare(runner.results(), baseline_path, threshold_pct) )
+                return EXIT_REGRESSION;
+        }catch( exception& e ){
+            cerr<< "compare failed: " << e.what() << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include <sstream>
+#include <atomic>
+#include <map>
+#include <limits>
+
+#include "bench.h"
+#include "tdma_api_get.h"
+#include "_streaming.h"
+#include "stream_frame_scanner.h"
+#include "level_one_book.h"
+
+using namespace tdma;
+using namespace std;
+
+namespace {
+
+atomic<unsigned long long> ncallbacks(0);
+
+void
+callback(int, int, unsigned long long, const char*)
+{ ++ncallbacks; }
+
+/* what a C++ client of the string callback has to do w/ the data */
+void
+reparse_callback(int, int, unsigned long long, const char* data)
+{
+    if( data )
+        do_not_optimize( json::parse(data) );
+    ++ncallbacks;
+}
+
+void
+json_callback(int, int, unsigned long long, const json&)
+{ ++ncallbacks; }
+
+/* touches every value so nothing is skipped */
+class SumFieldHandler
+        : public StreamFieldHandler {
+public:
+    double sum = 0;
+
+    bool
+    begin_item(StreamerServiceType, unsigned long long, const char*,
+               size_t key_len)
+    {
+        sum += key_len;
+        return true;
+    }
+
+    void
+    set_number(int, double v)
+    { sum += v; }
+
+    void
+    set_integer(int, long long v)
+    { sum += v; }
+
+    void
+    set_string(int, const char*, size_t n)
+    { sum += n; }
+
+    void
+    set_boolean(int, bool v)
+    { sum += v; }
+};
+
+/* e.g 'data.QUOTE' or 'notify' */
+string
+frame_name(const string& frame)
+{
+    json j = json::parse(frame);
+    auto r = j.begin();
+    string name = r.key();
+    auto& first = r.value().at(0);
+    auto s = first.find("service");
+    if( s != first.end() )
+        name += "." + s->get<string>();
+    return name;
+}
+
+void
+bench_json_parse(BenchRunner& runner)
+{
+    for( string p : {"chains", "quotes", "pricehistory"} ){
+        string s = runner.payload(p + ".json");
+        runner.measure( "json.parse." + p, 1,
+                        [&s]{ do_not_optimize( json::parse(s) ); },
+                        s.size() );
+    }
+}
+
+/* vs json.parse.quotes */
+void
+bench_quote_records(BenchRunner& runner)
+{
+    string s = runner.payload("quotes.json");
+    vector<QuoteRecord> records( DecodeQuoteRecords(s).size() );
+    runner.measure( "quote_records.decode", 1, [&]{
+        size_t n = records.size();
+        DecodeQuoteRecords_ABI(s.c_str(), s.size(), records.data(), &n, 1);
+        do_not_optimize(n);
+    }, s.size() );
+}
+
+/* vs json.parse.chains; filter vs walking the parsed json */
+void
+bench_option_chain_table(BenchRunner& runner)
+{
+    string s = runner.payload("chains.json");
+    runner.measure( "option_chain_table.decode", 1, [&s]{
+        OptionChainTable_C t;
+        OptionChainTable_Create_ABI(s.c_str(), s.size(), &t, 1);
+        OptionChainTable_Destroy_ABI(&t, 1);
+    }, s.size() );
+
+    /* .2 <= delta <= .3 && open interest >= 1000 */
+    const vector<OptionChainFilter> filters = {
+        {static_cast<int>(OptionChainColumn::delta), .2, .3},
+        {static_cast<int>(OptionChainColumn::open_interest), 1000,
+         numeric_limits<double>::infinity()}
+    };
+    OptionChainTable table(s);
+    vector<size_t> rows( table.size() );
+    runner.measure( "option_chain_table.filter", 16, [&]{
+        size_t n = rows.size();
+        OptionChainTable_Filter_ABI( table.get_cproxy(), filters.data(),
+                                     filters.size(), rows.data(), &n, 1 );
+        do_not_optimize(n);
+    });
+
+    json j = json::parse(s);
+    runner.measure( "option_chain_json.filter", 16, [&j]{
+        size_t n = 0;
+        for( auto m : {"callExpDateMap", "putExpDateMap"} ){
+            for( auto& exp : j[m] ){
+                for( auto& strike : exp ){
+                    for( auto& c : strike ){
+                        double d = c["delta"].get<double>();
+                        n += (d >= .2 && d <= .3
+                              && c["openInterest"].get<double>() >= 1000);
+                    }
+                }
+            }
+        }
+        do_not_optimize(n);
+    });
+}
+
+/* vs json.parse.pricehistory */
+void
+bench_candle_table(BenchRunner& runner)
+{
+    string s = runner.payload("pricehistory.json");
+    runner.measure( "candle_table.decode", 1, [&s]{
+        CandleTable_C t;
+        CandleTable_Create_ABI(s.c_str(), s.size(), &t, 1);
+        CandleTable_Destroy_ABI(&t, 1);
+    }, s.size() );
+}
+
+/* recorded frames, one per line */
+vector<string>
+stream_frames(BenchRunner& runner)
+{
+    vector<string> frames;
+    stringstream ss( runner.payload("stream_frames.txt") );
+    for( string line; getline(ss, line); ){
+        if( !line.empty() )
+            frames.push_back(line);
+    }
+    return frames;
+}
+
+/* through the listener's parser */
+void
+bench_streaming_parse(BenchRunner& runner)
+{
+    StreamingResponseParser parser(callback);
+    vector<string> frames = stream_frames(runner);
+
+    size_t total_bytes = 0;
+    map<string, int> nseen;
+    for( auto& f : frames ){
+        total_bytes += f.size();
+        string name = "streaming.parse." + frame_name(f);
+        if( nseen[name]++ ) // e.g full quote, then an update
+            name += "." + to_string(nseen[name]);
+        runner.measure( name, 1, [&]{ parser.parse(f); }, f.size() );
+    }
+
+    runner.measure( "streaming.parse.all", 1,
+                    [&]{ for( auto& f : frames ) parser.parse(f); },
+                    total_bytes );
+
+    /* string callback + client re-parse vs. the parsed content directly */
+    StreamingResponseParser reparse_parser(reparse_callback);
+    runner.measure( "streaming.parse.all.reparse", 1,
+                    [&]{ for( auto& f : frames ) reparse_parser.parse(f); },
+                    total_bytes );
+
+    StreamingResponseParser json_parser(json_callback);
+    runner.measure( "streaming.parse.all.json", 1,
+                    [&]{ for( auto& f : frames ) json_parser.parse(f); },
+                    total_bytes );
+
+    /* the frame scanner straight into typed setters, vs. the above */
+    SumFieldHandler handler;
+    StreamFrameScanner scanner;
+    for( int i = static_cast<int>(StreamerServiceType::QUOTE);
+         i < static_cast<int>(StreamerServiceType::UNKNOWN); ++i ){
+        if( i != static_cast<int>(StreamerServiceType::ADMIN) )
+            scanner.set_handler(static_cast<StreamerServiceType>(i), &handler);
+    }
+
+    nseen.clear();
+    for( auto& f : frames ){
+        string name = "streaming.scan." + frame_name(f);
+        if( nseen[name]++ )
+            name += "." + to_string(nseen[name]);
+        runner.measure( name, 1, [&]{ scanner.scan(f.data(), f.size()); },
+                        f.size() );
+    }
+
+    runner.measure( "streaming.scan.all", 1, [&]{
+        for( auto& f : frames )
+            scanner.scan(f.data(), f.size());
+    }, total_bytes );
+
+    /* through the listener: 'data' scanned only, the rest still parsed */
+    StreamingResponseParser fields_parser;
+    fields_parser.set_field_handler(StreamerServiceType::QUOTE, &handler);
+    fields_parser.set_field_handler(StreamerServiceType::CHART_EQUITY, &handler);
+    fields_parser.set_field_handler(StreamerServiceType::TIMESALE_EQUITY,
+                                    &handler);
+    runner.measure( "streaming.parse.all.fields", 1,
+                    [&]{ for( auto& f : frames ) fields_parser.parse(f); },
+                    total_bytes );
+    do_not_optimize(handler.sum);
+}
+
+/* merging the level one frames into the book, and reading it back */
+void
+bench_level_one_book(BenchRunner& runner)
+{
+    vector<string> frames;
+    size_t total_bytes = 0;
+    for( auto& f : stream_frames(runner) ){
+        string name = frame_name(f);
+        for( int i = 0; i < LevelOneBook::NSERVICES; ++i ){
+            if( name == "data." + to_string(LevelOneBook::services()[i]) ){
+                frames.push_back(f);
+                total_bytes += f.size();
+                break;
+            }
+        }
+    }
+
+    LevelOneBook book;
+    StreamFrameScanner scanner;
+    for( int i = 0; i < LevelOneBook::NSERVICES; ++i )
+        scanner.set_handler(LevelOneBook::services()[i], &book);
+
+    runner.measure( "level_one_book.update", 1, [&]{
+        for( auto& f : frames )
+            scanner.scan(f.data(), f.size());
+    }, total_bytes );
+
+    /* first symbol of the first quote frame */
+    json j = json::parse(frames.at(0));
+    auto& r = j["data"][0];
+    StreamerServiceType service =
+        streamer_service_from_str( r["service"].get<string>() );
+    string symbol = r["content"][0]["key"];
+
+    LevelOneRecord rec;
+    if( !book.snapshot(service, symbol, &rec) )
+        throw runtime_error("symbol not in level one book: " + symbol);
+    unsigned int id = rec.symbol_id;
+
+    runner.measure( "level_one_book.snapshot.id", 1,
+                    [&]{ book.snapshot(service, id, &rec); } );
+    runner.measure( "level_one_book.snapshot.symbol", 1,
+                    [&]{ book.snapshot(service, symbol, &rec); } );
+    do_not_optimize(rec.fields[1]);
+}
+
+BENCH_GROUP("json parse", bench_json_parse)
+BENCH_GROUP("quote records", bench_quote_records)
+BENCH_GROUP("option chain table", bench_option_chain_table)
+BENCH_GROUP("candle table", bench_candle_table)
+BENCH_GROUP("streaming parse", bench_streaming_parse)
+BENCH_GROUP("level one book", bench_level_one_book)
+
+} /* namespace */
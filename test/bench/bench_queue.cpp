@@ -0,0 +1,198 @@
+#include <thread>
+#include <atomic>
+
+#include "bench.h"
+#include "threadsafe_queue.h"
+#include "message_ring.h"
+
+using namespace std;
+
+namespace {
+
+typedef BenchRunner::clock_ty clock_ty;
+
+/* producers back off here so latency isn't just the backlog */
+const size_t MAX_BACKLOG = 4096;
+
+long long
+now_ns()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+        clock_ty::now().time_since_epoch() ).count();
+}
+
+/*
+ * 'nproducers' push timestamps as fast as they can until time's up;
+ * 'nconsumers' pop them (waiting when empty, like the listener) and
+ * record the time each spent in the queue
+ */
+void
+contention( BenchRunner& runner,
+            unsigned int nproducers,
+            unsigned int nconsumers )
+{
+    string name = "queue.contention." + to_string(nproducers) + "x"
+                + to_string(nconsumers);
+    if( !runner.matches(name) )
+        return;
+
+    ThreadSafeQueue<long long> queue;
+    atomic<bool> producing(true);
+    atomic<unsigned int> nproducing(nproducers);
+    vector<vector<double>> latencies(nconsumers);
+    vector<thread> threads;
+
+    auto tbeg = clock_ty::now();
+    for( unsigned int i = 0; i < nproducers; ++i ){
+        threads.emplace_back( [&]{
+            while( producing ){
+                if( queue.size() < MAX_BACKLOG )
+                    queue.push( now_ns() );
+                else
+                    this_thread::yield();
+            }
+            --nproducing;
+        });
+    }
+    for( unsigned int i = 0; i < nconsumers; ++i ){
+        threads.emplace_back( [&, i]{
+            auto& lat = latencies[i];
+            lat.reserve(1 << 20);
+            while( true ){
+                auto v = queue.pop_front_or_wait_for( chrono::milliseconds(1) );
+                if( v.second )
+                    lat.push_back( static_cast<double>(now_ns() - v.first) );
+                else if( nproducing == 0 )
+                    break;
+            }
+        });
+    }
+
+    this_thread::sleep_for( runner.time_per_bench() );
+    producing = false;
+    for( auto& t : threads )
+        t.join();
+    double seconds = chrono::duration<double>(clock_ty::now() - tbeg).count();
+
+    BenchResult r{name, 0, 0, seconds, {}};
+    for( auto& lat : latencies ){
+        r.ops += lat.size();
+        r.ns_per_op.insert(r.ns_per_op.end(), lat.begin(), lat.end());
+    }
+    runner.add_result( move(r) );
+}
+
+/*
+ * the websocket hand-off: one producer pushes FRAME_SIZE byte messages
+ * (stamped w/ the time) to one consumer, through the old queue of strings
+ * and through the ring the client uses now
+ */
+const size_t FRAME_SIZE = 512;
+
+/* (uWS hands us a char buffer it owns, so stamp one in place) */
+char*
+stamp_frame(char *frame)
+{
+    long long t = now_ns();
+    std::copy( reinterpret_cast<const char*>(&t),
+               reinterpret_cast<const char*>(&t) + sizeof(t), frame );
+    return frame;
+}
+
+long long
+frame_stamp(const string& frame)
+{
+    long long t;
+    frame.copy(reinterpret_cast<char*>(&t), sizeof(t));
+    return t;
+}
+
+BenchResult
+handoff( BenchRunner& runner,
+         const string& name,
+         function<void()> produce_one,
+         function<void(vector<double>&)> consume_some,
+         function<bool()> backed_up )
+{
+    atomic<bool> producing(true);
+    vector<double> lat;
+    lat.reserve(1 << 20);
+
+    auto tbeg = clock_ty::now();
+    thread producer( [&]{
+        while( producing ){
+            if( backed_up() )
+                this_thread::yield();
+            else
+                produce_one();
+        }
+    });
+    thread consumer( [&]{
+        while( producing )
+            consume_some(lat);
+        consume_some(lat);
+    });
+
+    this_thread::sleep_for( runner.time_per_bench() );
+    producing = false;
+    producer.join();
+    consumer.join();
+    double seconds = chrono::duration<double>(clock_ty::now() - tbeg).count();
+
+    BenchResult r{name, lat.size(), 0, seconds, {}};
+    r.ns_per_op = move(lat);
+    return r;
+}
+
+void
+bench_handoff(BenchRunner& runner)
+{
+    char frame[FRAME_SIZE] = {};
+
+    if( runner.matches("queue.strings.1x1") ){
+        ThreadSafeQueue<string> queue;
+        runner.add_result( handoff( runner, "queue.strings.1x1",
+            [&]{ queue.emplace( string(stamp_frame(frame), FRAME_SIZE) ); },
+            [&](vector<double>& lat){
+                /* like the listener: wait for one, then drain */
+                auto v = queue.pop_front_or_wait_for( chrono::milliseconds(1) );
+                while( v.second ){
+                    lat.push_back( now_ns() - frame_stamp(v.first) );
+                    v = queue.pop_front_safe();
+                }
+            },
+            [&]{ return queue.size() >= MAX_BACKLOG; } ) );
+    }
+
+    if( runner.matches("ring.strings.1x1") ){
+        MessageRing ring(MAX_BACKLOG);
+        runner.add_result( handoff( runner, "ring.strings.1x1",
+            [&]{ ring.push( stamp_frame(frame), FRAME_SIZE ); },
+            [&](vector<double>& lat){
+                if( !ring.wait_for( chrono::milliseconds(1) ) )
+                    return;
+                for( const string *f; (f = ring.front()); ring.pop() )
+                    lat.push_back( now_ns() - frame_stamp(*f) );
+            },
+            [&]{ return ring.size() >= MAX_BACKLOG; } ) );
+    }
+}
+
+void
+bench_queue(BenchRunner& runner)
+{
+    ThreadSafeQueue<long long> queue;
+    runner.measure( "queue.push_pop.uncontended", 256, [&queue]{
+        queue.push(1);
+        do_not_optimize( queue.pop_front() );
+    });
+
+    contention(runner, 1, 1);
+    contention(runner, 4, 1);
+    contention(runner, 4, 4);
+}
+
+BENCH_GROUP("thread-safe queue", bench_queue)
+BENCH_GROUP("websocket hand-off", bench_handoff)
+
+} /* namespace */
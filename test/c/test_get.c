@@ -80,6 +80,24 @@ Test_Getters(struct Credentials *creds, const char* acct, long wait)
 
     printf( "change wait sec: %llu --> %llu \n", w, w2 );
 
+    {
+        unsigned int b = 0;
+        if( (err = APIGetter_SetEndpointWaitMSec(EndpointClass_instruments, 1000, 2)) )
+            CHECK_AND_RETURN_ON_ERROR(err, "APIGetter_SetEndpointWaitMSec");
+
+        if( (err = APIGetter_GetEndpointWaitMSec(EndpointClass_instruments, &w, &b)) )
+            CHECK_AND_RETURN_ON_ERROR(err, "APIGetter_GetEndpointWaitMSec");
+
+        printf( "instruments endpoint wait/burst: %llu / %u \n", w, b);
+        if( w != 1000 || b != 2 ){
+            fprintf(stderr, "invalid endpoint wait/burst\n");
+            return -1;
+        }
+
+        if( (err = APIGetter_SetEndpointWaitMSec(EndpointClass_instruments, 0, 1)) )
+            CHECK_AND_RETURN_ON_ERROR(err, "APIGetter_SetEndpointWaitMSec");
+    }
+
     /*
     err = Test_ConvenienceFunctions(creds, acct);
     if( err )
@@ -3,6 +3,8 @@
 #include <iomanip>
 #include <chrono>
 #include <ctime>
+#include <cmath>
+#include <thread>
 
 #include "test.h"
 
@@ -55,10 +57,117 @@ test_getters(const string& account_id, Credentials& creds)
     APIGetter::set_wait_msec( milliseconds(1500) );
     cout<< APIGetter::get_wait_msec().count() << endl;
 
+    cout<< endl <<"*** SET BURST ***" << endl;
+    cout<< APIGetter::get_burst() << " --> ";
+    APIGetter::set_burst(2);
+    cout<< APIGetter::get_burst() << endl;
+    if( APIGetter::get_burst() != 2 )
+        throw std::runtime_error("failed to set burst");
+    APIGetter::set_burst(1);
+
+    cout<< endl <<"*** SET ENDPOINT WAIT ***" << endl;
+    APIGetter::set_endpoint_wait_msec( EndpointClass::accounts,
+                                       milliseconds(1000), 3 );
+    auto ewb = APIGetter::get_endpoint_wait_msec(EndpointClass::accounts);
+    cout<< EndpointClass::accounts << ": " << ewb.first.count()
+        << ", " << ewb.second << endl;
+    if( ewb.first != milliseconds(1000) || ewb.second != 3 )
+        throw std::runtime_error("failed to set endpoint wait");
+    cout<< "EndpointWaitRemaining: "
+        << APIGetter::endpoint_wait_remaining(EndpointClass::accounts).count()
+        << endl;
+    APIGetter::set_endpoint_wait_msec( EndpointClass::accounts,
+                                       milliseconds(0) );
+
+    cout<< endl <<"*** SET RETRY POLICY ***" << endl;
+    RetryPolicy rp = APIGetter::get_retry_policy(EndpointClass::marketdata);
+    if( rp.max_attempts != 1 || rp.hedge_percentile != 0
+        || rp.status_codes[0] == 0 || rp.curl_codes[0] == 0 )
+    {
+        throw std::runtime_error("invalid default retry policy");
+    }
+    rp.max_attempts = 3;
+    rp.hedge_percentile = 95;
+    APIGetter::set_retry_policy(EndpointClass::marketdata, rp);
+    rp = APIGetter::get_retry_policy(EndpointClass::marketdata);
+    cout<< EndpointClass::marketdata << ": max_attempts=" << rp.max_attempts
+        << ", hedge_percentile=" << rp.hedge_percentile << endl;
+    if( rp.max_attempts != 3 || rp.hedge_percentile != 95 )
+        throw std::runtime_error("failed to set retry policy");
+
+    rp.hedge_percentile = 10;
+    try{
+        APIGetter::set_retry_policy(EndpointClass::marketdata, rp);
+        throw std::runtime_error("set invalid retry policy");
+    }catch( ValueException& ){
+    }
+
+    cout<< endl <<"*** SET CONNECTION POOL ***" << endl;
+    cout<< APIGetter::get_max_connections() << " --> ";
+    APIGetter::set_max_connections(2);
+    cout<< APIGetter::get_max_connections() << endl;
+    if( APIGetter::get_max_connections() != 2 )
+        throw std::runtime_error("failed to set max connections");
+    APIGetter::set_connection_max_idle( milliseconds(30000) );
+    if( APIGetter::get_connection_max_idle() != milliseconds(30000) )
+        throw std::runtime_error("failed to set connection max idle");
+
+    cout<< endl <<"*** SET REQUEST LANES ***" << endl;
+    SetRequestLaneLimits(RequestLane::marketdata, 2);
+    RequestLaneLimits rll = GetRequestLaneLimits(RequestLane::marketdata);
+    cout<< RequestLane::marketdata << ": max_concurrent=" << rll.max_concurrent
+        << ", wait_msec=" << rll.wait_msec.count() << ", burst=" << rll.burst
+        << endl;
+    if( rll.max_concurrent != 2 || rll.wait_msec.count() != 0 || rll.burst != 1 )
+        throw std::runtime_error("failed to set request lane limits");
+    unsigned long long nrequests =
+        GetRequestLaneStats(RequestLane::marketdata).requests;
+
+    cout<< endl <<"*** SET HTTP/2 ***" << endl;
+    cout<< "supported: " << std::boolalpha << IsHTTP2Supported() << endl;
+    SetHTTP2Enabled(true);
+    if( !IsHTTP2Enabled() )
+        throw std::runtime_error("failed to enable HTTP/2");
+    HTTPStats hstats = GetHTTPStats();
+
+    cout<< endl <<"*** RESET METRICS ***" << endl;
+    ResetMetrics();
+    if( !IsMetricsEnabled() )
+        throw std::runtime_error("metrics not enabled");
+    if( !GetMetricsJSON()["endpoints"].empty() )
+        throw std::runtime_error("failed to reset metrics");
+
     cout<< endl << "*** QUOTE DATA ***" << endl;
     quote_getters(creds);
+    HTTPStats hstats2 = GetHTTPStats();
+    cout<< "HTTP requests: " << (hstats2.requests - hstats.requests)
+        << ", connections: " << (hstats2.connections - hstats.connections)
+        << ", HTTP/2: " << (hstats2.http2_requests - hstats.http2_requests)
+        << endl;
+    if( hstats2.requests <= hstats.requests )
+        throw std::runtime_error("invalid HTTP stats");
+    RequestLaneStats rls = GetRequestLaneStats(RequestLane::marketdata);
+    cout<< RequestLane::marketdata << ": requests=" << rls.requests
+        << ", wait_msec=" << rls.wait_msec.count() << ", max_wait_msec="
+        << rls.max_wait_msec.count() << endl;
+    if( rls.requests <= nrequests )
+        throw std::runtime_error("invalid request lane stats");
+    json mj = GetMetricsJSON()["endpoints"];
+    cout<< "Metrics: " << mj.dump() << endl;
+    if( mj.find("GET marketdata/{}/quotes") == mj.end()
+        || mj["GET marketdata/{}/quotes"]["requests"].get<int>() < 1 )
+    {
+        throw std::runtime_error("invalid metrics");
+    }
     cout<< "WaitRemaining: " << APIGetter::wait_remaining().count() << endl;
 
+    ConnectionPoolStats ps = APIGetter::get_connection_pool_stats();
+    cout<< "ConnectionPoolStats: in_use=" << ps.in_use << ", idle=" << ps.idle
+        << ", waits=" << ps.waits << ", wait_time=" << ps.wait_time.count()
+        << endl;
+    if( ps.in_use + ps.idle > 2 )
+        throw std::runtime_error("connection pool exceeds max connections");
+
     historical_getters(creds);
     this_thread::sleep_for( seconds(3) );
 
@@ -110,6 +219,53 @@ Get(APIGetter& getter, bool test_exc = false, string test_exc_msg="")
         cout<< "CAN NOT TEST GET WITHOUT USING LIVE CONNECTION" << endl;
 }
 
+void
+GetAsync(APIGetter& getter)
+{
+    if( use_live_connection ){
+        auto f = getter.get_async();
+        cout<< f.get().dump(4) << endl << endl;
+    }else
+        cout<< "CAN NOT TEST GET_ASYNC WITHOUT USING LIVE CONNECTION" << endl;
+}
+
+/* count values as they're parsed, don't build the json object */
+struct CountingSAX
+        : public APIGetter::sax_handler_ty {
+    size_t nvalues = 0;
+    size_t nkeys = 0;
+
+    bool null() { ++nvalues; return true; }
+    bool boolean(bool) { ++nvalues; return true; }
+    bool number_integer(number_integer_t) { ++nvalues; return true; }
+    bool number_unsigned(number_unsigned_t) { ++nvalues; return true; }
+    bool number_float(number_float_t, const string_t&) { ++nvalues; return true; }
+    bool string(string_t&) { ++nvalues; return true; }
+    bool start_object(std::size_t) { return true; }
+    bool key(string_t&) { ++nkeys; return true; }
+    bool end_object() { return true; }
+    bool start_array(std::size_t) { return true; }
+    bool end_array() { return true; }
+
+    bool
+    parse_error( std::size_t, const std::string&,
+                 const nlohmann::detail::exception& e )
+    { throw runtime_error( std::string("SAX parse error: ") + e.what() ); }
+};
+
+void
+GetStream(APIGetter& getter)
+{
+    if( use_live_connection ){
+        CountingSAX sax;
+        if( !getter.get(sax) )
+            throw runtime_error("streaming get stopped early");
+        cout<< "streamed: " << sax.nvalues << " values, " << sax.nkeys
+            << " keys" << endl << endl;
+    }else
+        cout<< "CAN NOT TEST GET(SAX) WITHOUT USING LIVE CONNECTION" << endl;
+}
+
 json
 GetJson(APIGetter& getter, bool test_exc = false, string test_exc_msg="")
 {
@@ -541,6 +697,30 @@ market_hours_getter(Credentials& c)
         throw runtime_error("invalid market type");
 
     Get(o);
+
+    if( !APIGetter::is_cache_enabled() )
+        throw runtime_error("cache not enabled (default)");
+    if( o.get_cache_ttl() != std::chrono::hours(1) )
+        throw runtime_error("invalid cache ttl");
+
+    if( use_live_connection ){
+        /* cached, shouldn't use the throttle */
+        APIGetter::set_wait_msec( std::chrono::milliseconds(5000) );
+        auto tbeg = std::chrono::steady_clock::now();
+        json j1 = o.get();
+        json j2 = o.get();
+        auto tend = std::chrono::steady_clock::now();
+        APIGetter::set_wait_msec( APIGetter::get_def_wait_msec() );
+        if( j1 != j2 )
+            throw runtime_error("invalid cached response");
+        if( tend - tbeg > std::chrono::milliseconds(5000) )
+            throw runtime_error("cached get was throttled");
+    }
+
+    o.invalidate_cache();
+    o.set_cache_ttl( std::chrono::milliseconds(0) );
+    if( o.get_cache_ttl() != std::chrono::milliseconds(0) )
+        throw runtime_error("invalid cache ttl(2)");
 }
 
 
@@ -760,6 +940,7 @@ void option_chain_getter(Credentials& c)
                               OptionExpMonth::all, OptionType::all);
 
     Get(ocg);
+    GetStream(ocg);
 
     strikes = OptionStrikes::Single(70.00);
     ocg.set_strikes(strikes);
@@ -784,6 +965,51 @@ void option_chain_getter(Credentials& c)
                               OptionExpMonth::jul, OptionType::ns);
 
     Get(ocg);
+
+    /* rows ordered by expiration, strike, then call/put */
+    OptionChainTable table(
+        R"({"symbol":"SPY","putExpDateMap":{"2019-02-15:30":{"70.0":[)"
+        R"({"putCall":"PUT","symbol":"SPY_021519P70","strikePrice":70.0,)"
+        R"("expirationDate":1550264400000,"delta":"NaN","openInterest":5}]}},)"
+        R"("callExpDateMap":{"2019-02-15:30":{"75.0":[)"
+        R"({"putCall":"CALL","symbol":"SPY_021519C75","strikePrice":75.0,)"
+        R"("expirationDate":1550264400000,"delta":0.25,"openInterest":2000}],)"
+        R"("70.0":[{"putCall":"CALL","symbol":"SPY_021519C70","strikePrice":70.0,)"
+        R"("expirationDate":1550264400000,"delta":0.55,"openInterest":10}]},)"
+        R"("2019-01-18:2":{"75.0":[{"putCall":"CALL","symbol":"SPY_011819C75",)"
+        R"("strikePrice":75.0,"expirationDate":1547845200000,"delta":0.2,)"
+        R"("openInterest":1500,"inTheMoney":false}]}}})" );
+    if( table.size() != 4
+        || string(table.symbols()[0]) != "SPY_011819C75"
+        || string(table.symbols()[1]) != "SPY_021519C70"
+        || string(table.symbols()[2]) != "SPY_021519P70"
+        || table.column(OptionChainColumn::put_call)[2] != 1.0
+        || !std::isnan(table.column(OptionChainColumn::delta)[2])
+        || table.column(OptionChainColumn::open_interest)[3] != 2000 )
+    {
+        throw runtime_error("invalid option chain table");
+    }
+    if( table.strike_index()[3] != 3
+        || table.find_strikes(75.0, 75.0) != make_pair<size_t,size_t>(2, 4)
+        || table.find_expirations(1550264400000, 1550264400000)
+            != make_pair<size_t,size_t>(1, 4) )
+    {
+        throw runtime_error("invalid option chain table index");
+    }
+    auto rows = table.filter( {
+        {static_cast<int>(OptionChainColumn::delta), .2, .3},
+        {static_cast<int>(OptionChainColumn::open_interest), 1000, 1e9} } );
+    if( rows != vector<size_t>{0, 3} )
+        throw runtime_error("invalid option chain table filter");
+
+    if( use_live_connection ){
+        OptionChainTable t = ocg.get_table();
+        cout<< "option chain table: " << t.size() << " rows" << endl;
+        for( size_t i = 0; i < t.size(); ++i ){
+            if( string(t.symbols()[i]).find("KORS") != 0 )
+                throw runtime_error("invalid option chain table symbol");
+        }
+    }
 }
 
 
@@ -983,6 +1209,44 @@ historical_getters(Credentials& c)
         //if( ji->size() != 2 )
         //    throw runtime_error("not 2 monthly candles in json");
     }
+
+    /* rows ordered by datetime, first of a repeated datetime kept */
+    CandleTable candles(
+        R"({"candles":[{"open":1.0,"high":2.0,"low":0.5,"close":1.5,)"
+        R"("volume":10,"datetime":3000},{"open":2.0,"high":3.0,"low":1.0,)"
+        R"("close":2.5,"volume":20,"datetime":1000},{"open":9.0,"high":9.0,)"
+        R"("low":9.0,"close":9.0,"volume":90,"datetime":1000},{"open":"NaN",)"
+        R"("high":4.0,"low":2.0,"close":3.0,"volume":30,"datetime":2000}],)"
+        R"("symbol":"SPY","empty":false})" );
+    if( candles.size() != 3
+        || candles.datetime()[0] != 1000
+        || candles.datetime()[2] != 3000
+        || candles.open()[0] != 2.0
+        || !std::isnan(candles.open()[1])
+        || candles.close()[1] != 3.0
+        || candles.volume()[2] != 10
+        || candles.find(1500, 3000) != make_pair<size_t,size_t>(1, 3) )
+    {
+        throw runtime_error("invalid candle table");
+    }
+
+    if( use_live_connection ){
+        unsigned long long day_msec = 86400000;
+        hrg.set_frequency(FrequencyType::minute, 1);
+        CandleTable one = hrg.get_candles();
+        CandleTable chunked = hrg.backfill(day_msec);
+        cout<< "candles: " << one.size() << " get, " << chunked.size()
+            << " backfill" << endl;
+        for( size_t i = 1; i < chunked.size(); ++i ){
+            if( chunked.datetime()[i] <= chunked.datetime()[i-1] )
+                throw runtime_error("backfill candles not ordered/unique");
+        }
+        if( hrg.get_start_msec_since_epoch() != start
+            || hrg.get_end_msec_since_epoch() != end )
+        {
+            throw runtime_error("backfill changed the range");
+        }
+    }
 }
 
 
@@ -1002,6 +1266,14 @@ quote_getters(Credentials& c)
     if( qg.get_timeout() != std::chrono::milliseconds(3001) )
         throw runtime_error("invalid timeout(2)");
 
+    if( !qg.is_coalescing() )
+        throw runtime_error("invalid coalesce");
+
+    qg.set_coalesce(false);
+    if( qg.is_coalescing() )
+        throw runtime_error("invalid coalesce(2)");
+    qg.set_coalesce(true);
+
     Get(qg);
 
     QuoteGetter qg2(move(qg));
@@ -1013,6 +1285,28 @@ quote_getters(Credentials& c)
 
     Get(qg2);
 
+    if( QuoteGetter::get_batch_window() != std::chrono::milliseconds(0) )
+        throw runtime_error("invalid batch window");
+
+    QuoteGetter::set_batch_window( std::chrono::milliseconds(20) );
+    if( QuoteGetter::get_batch_window() != std::chrono::milliseconds(20) )
+        throw runtime_error("invalid batch window(2)");
+
+    if( use_live_connection ){
+        /* should be sent as one request */
+        json jspy, jqqq;
+        thread t( [&]{ jspy = QuoteGetter(c, "SPY").get(); } );
+        jqqq = QuoteGetter(c, "QQQ").get();
+        t.join();
+        if( jspy.size() != 1 || !jspy.count("SPY")
+            || jqqq.size() != 1 || !jqqq.count("QQQ") )
+        {
+            throw runtime_error("invalid batched quotes");
+        }
+    }
+
+    QuoteGetter::set_batch_window( std::chrono::milliseconds(0) );
+
     QuotesGetter qsg(c, {"spy", "qqq"});
     for( auto s: qsg.get_symbols() ){
         cout<< s << ' ';
@@ -1022,6 +1316,7 @@ quote_getters(Credentials& c)
         throw runtime_error("invalid symbol");
 
     Get(qsg);
+    GetAsync(qsg);
 
     qsg.set_symbols( {"/es","SPY_081718C276"} );
     for( auto s: qsg.get_symbols() ){
@@ -1111,6 +1406,42 @@ quote_getters(Credentials& c)
         throw runtime_error("invalid symbols in quotes getter");
 
     Get(qsg);
+
+    auto records = DecodeQuoteRecords(
+        R"({"SPY":{"assetType":"ETF","bidPrice":300.5,"bidSize":200,)"
+        R"("quoteTimeInLong":1571000000000,"other":{"x":[1,2]}},)"
+        R"("/ES":{"assetType":"FUTURE","lastPriceInDouble":3000.25}})" );
+    if( records.size() != 2
+        || string(records[0].symbol) != "SPY"
+        || records[0].asset_type != static_cast<int>(QuoteAssetType::ETF)
+        || records[0].bid_price != 300.5 || records[0].bid_size != 200
+        || records[0].quote_time != 1571000000000LL
+        || string(records[1].symbol) != "/ES"
+        || records[1].last_price != 3000.25 )
+    {
+        throw runtime_error("invalid decoded quote records");
+    }
+    if( DecodeQuoteRecords(R"({"SPY":{}})")[0].symbol_id
+        != records[0].symbol_id )
+    {
+        throw runtime_error("quote record symbol not interned");
+    }
+
+    if( use_live_connection ){
+        QuoteRecord r = QuoteGetter(c, "SPY").get_record();
+        cout<< r.symbol << ' ' << r.bid_price << ' ' << r.ask_price << endl;
+        if( string(r.symbol) != "SPY" || !r.quote_time )
+            throw runtime_error("invalid quote record");
+
+        auto rs = qsg.get_records();
+        if( rs.size() != 3 )
+            throw runtime_error("invalid quote records");
+        for( auto& r : rs ){
+            cout<< r.symbol << ' ' << r.last_price << endl;
+            if( !qsg.get_symbols().count(r.symbol) )
+                throw runtime_error("invalid quote record symbol");
+        }
+    }
 }
 
 
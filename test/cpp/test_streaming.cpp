@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cmath>
 
 #include "test.h"
 
@@ -20,6 +21,19 @@ callback( int cb_type,
         << "\t content: " << json::parse(string(msg)) << endl << endl;
 };
 
+void
+json_callback( int cb_type,
+               int ss_type,
+               unsigned long long timestamp,
+               const json& content )
+{
+    cout<< to_string(static_cast<StreamingCallbackType>(cb_type)) << endl
+        << "\t service: "
+        << to_string(static_cast<StreamerServiceType>(ss_type)) << endl
+        << "\t timestamp: " << timestamp << endl
+        << "\t content: " << content << endl << endl;
+};
+
 
 template<typename S>
 void display_sub( S& sub,
@@ -422,11 +436,56 @@ test_streaming(const string& account_id, Credentials& c)
         bool res;
         deque<bool> results;
 
+        auto ib = ss->get_inbound_buffer();
+        if( ib.first != STREAMING_DEF_INBOUND_CAPACITY
+            || ib.second != OverflowPolicyType::block )
+        {
+            throw std::runtime_error("invalid default inbound buffer");
+        }
+        ss->set_inbound_buffer(1024, OverflowPolicyType::drop);
+        ib = ss->get_inbound_buffer();
+        if( ib.first != 1024 || ib.second != OverflowPolicyType::drop )
+            throw std::runtime_error("failed to set inbound buffer");
+        try{
+            ss->set_inbound_buffer(0);
+            throw std::runtime_error("failed to catch 0 capacity exception");
+        }catch(ValueException& e){
+            cout<< "successfully caught: " << e.what() << endl;
+        }
+
+        if( ss->is_level_one_book_enabled() )
+            throw std::runtime_error("level one book enabled by default");
+        ss->set_level_one_book_enabled(true);
+        if( !ss->is_level_one_book_enabled() )
+            throw std::runtime_error("failed to enable level one book");
+
         res = ss->start( {q1} );
         cout<< boolalpha << res << endl;
 
         std::this_thread::sleep_for( seconds(3) );
 
+        {
+            LevelOneRecord r;
+            if( !ss->get_level_one_record(StreamerServiceType::QUOTE, "SPY", r) )
+                throw std::runtime_error("SPY not in level one book");
+            if( std::isnan(level_one_field(r, ft::last_price))
+                || r.service != static_cast<int>(StreamerServiceType::QUOTE) )
+                throw std::runtime_error("invalid level one record");
+            LevelOneRecord r2;
+            if( !ss->get_level_one_record(StreamerServiceType::QUOTE,
+                                          r.symbol_id, r2)
+                || string(r2.symbol) != "SPY" )
+                throw std::runtime_error("invalid level one record (by id)");
+            cout<< "SPY last: " << level_one_field(r, ft::last_price)
+                << " (" << r.nupdates << " updates)" << endl;
+            try{
+                ss->set_level_one_book_enabled(false);
+                throw std::runtime_error("failed to catch 'active' exception");
+            }catch(StreamingException& e){
+                cout<< "successfully caught: " << e.what() << endl;
+            }
+        }
+
         res = ss->add_subscription( q1b );
         cout<< boolalpha << res << endl;
 
@@ -520,4 +579,21 @@ test_streaming(const string& account_id, Credentials& c)
         auto ss4 = std::move(ss2);
     }
 
+    {
+        /* content passed as parsed json */
+        auto ss = StreamingSession::Create(c, json_callback, "",
+                                           milliseconds(3000),
+                                           milliseconds(15000));
+        bool res = ss->start( {q1} );
+        cout<< boolalpha << res << endl;
+
+        std::this_thread::sleep_for( seconds(3) );
+
+        res = ss->add_subscription( q3 );
+        cout<< boolalpha << res << endl;
+
+        std::this_thread::sleep_for( seconds(3) );
+        ss->stop();
+    }
+
 }
@@ -0,0 +1,683 @@
+#
+# Copyright (C) 2019 Jonathon Ogden <jeog.dev@gmail.com>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see http://www.gnu.org/licenses.
+#
+
+"""mock_server.py - local stand-in for the TDAmeritrade REST and streamer APIs
+
+dependencies: none (python 3.7+ standard library)
+
+Serves enough of the REST API (oauth2/token, quotes, chains, pricehistory,
+movers, hours, instruments, accounts, orders, userprincipals) and of the
+streamer websocket protocol (LOGIN, LOGOUT, QOS, SUBS/ADD/UNSUBS/VIEW,
+'response', 'notify' and 'data' frames) to run the library offline. REST is
+served under /v1/ and the streamer under /ws, on the same port.
+
+Point the library at it before using any getters or sessions:
+
+    C++    : SetAPIBaseURL("http://127.0.0.1:8477/v1/");
+             SetStreamerURL("ws://127.0.0.1:8477/ws");
+    python : common.set_api_base_url(...), common.set_streamer_url(...)
+    java   : TDAmeritradeAPI.setAPIBaseURL(...), setStreamerURL(...)
+
+Credentials don't need to be real; any Bearer token is accepted unless it
+was issued by, and has since expired on, this server (--token-ttl) or was
+expired by --expire-every.
+
+Responses are generated unless --payloads names a directory of canned
+(e.g recorded) responses, one file per endpoint:
+
+    token.json quotes.json quote.json chains.json pricehistory.json
+    movers.json hours.json instruments.json accounts.json account.json
+    orders.json order.json userprincipals.json streamersubscriptionkeys.json
+
+Error injection:
+    --error-rate P      : fraction of REST requests that get a 503
+    --expire-every N    : every Nth REST request gets a 401 'access token
+                          expired' and its token stops working (forces the
+                          library to refresh)
+    --token-ttl SEC     : lifetime of tokens issued by oauth2/token
+
+Streaming:
+    --flood-rate N      : 'data' frames per second for each subscribed
+                          service (all its symbols in each frame)
+    --heartbeat SEC     : interval of 'notify' heartbeats
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import os
+import random
+import struct
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import urlparse, parse_qs, unquote
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+TOKEN_EXPIRED_MSG = "The access token being passed has expired or is invalid."
+
+ACCOUNT_ID = "123456789"
+
+
+def now_ms():
+    return int(time.time() * 1000)
+
+
+class State:
+    """ server-wide settings, counters and issued tokens """
+
+    def __init__(self, args):
+        self.args = args
+        self.lock = threading.Lock()
+        self.requests = 0
+        self.tokens = {}      # token issued here -> expiration (sec)
+        self.expired = set()  # tokens explicitly expired
+        self.next_token = 0
+        self.next_order = 1000
+        self.payloads = {}
+        if args.payloads:
+            for f in os.listdir(args.payloads):
+                name, ext = os.path.splitext(f)
+                if ext == '.json':
+                    with open(os.path.join(args.payloads, f), 'rb') as fp:
+                        self.payloads[name] = fp.read()
+
+    def issue_token(self):
+        with self.lock:
+            self.next_token += 1
+            tok = "mock-access-token-%i" % self.next_token
+            self.tokens[tok] = time.time() + self.args.token_ttl
+            return tok
+
+    def count_request(self):
+        with self.lock:
+            self.requests += 1
+            return self.requests
+
+    def token_is_valid(self, tok):
+        with self.lock:
+            if tok in self.expired:
+                return False
+            exp = self.tokens.get(tok)
+            return exp is None or exp > time.time()
+
+    def expire_token(self, tok):
+        with self.lock:
+            self.expired.add(tok)
+
+    def new_order_id(self):
+        with self.lock:
+            self.next_order += 1
+            return self.next_order
+
+
+def quote(symbol):
+    p = round(random.uniform(10, 500), 2)
+    return {
+        "assetType": "EQUITY", "symbol": symbol, "description": symbol,
+        "bidPrice": round(p - .01, 2), "bidSize": 100,
+        "askPrice": round(p + .01, 2), "askSize": 200,
+        "lastPrice": p, "lastSize": 100, "openPrice": p, "highPrice": p,
+        "lowPrice": p, "closePrice": p, "netChange": 0.0,
+        "totalVolume": random.randint(0, 10**7),
+        "quoteTimeInLong": now_ms(), "tradeTimeInLong": now_ms(),
+        "mark": p, "exchange": "q", "exchangeName": "NASD",
+        "marginable": True, "shortable": True, "volatility": 0.01,
+        "digits": 4, "52WkHigh": p, "52WkLow": p, "peRatio": 0.0,
+        "divAmount": 0.0, "divYield": 0.0, "divDate": "",
+        "securityStatus": "Normal", "regularMarketLastPrice": p,
+        "regularMarketLastSize": 1, "regularMarketNetChange": 0.0,
+        "regularMarketTradeTimeInLong": now_ms(), "delayed": False
+    }
+
+
+def option_chain(symbol, strikes=10):
+    under = 100.0
+    exp = time.strftime("%Y-%m-%d", time.gmtime(time.time() + 86400 * 30))
+    exp_key = exp + ":30"
+
+    def side(put):
+        m = {}
+        for i in range(strikes):
+            k = under - strikes / 2 + i
+            sym = "%s_%s%s%i" % (symbol, time.strftime(
+                "%m%d%y", time.gmtime(time.time() + 86400 * 30)),
+                "P" if put else "C", k)
+            m["%.1f" % k] = [{
+                "putCall": "PUT" if put else "CALL", "symbol": sym,
+                "description": sym, "exchangeName": "OPR",
+                "bid": 1.0, "ask": 1.1, "last": 1.05, "mark": 1.05,
+                "bidSize": 10, "askSize": 10, "lastSize": 1,
+                "highPrice": 1.1, "lowPrice": 1.0, "openPrice": 0.0,
+                "closePrice": 1.0, "totalVolume": 100,
+                "quoteTimeInLong": now_ms(), "tradeTimeInLong": now_ms(),
+                "netChange": 0.05, "volatility": 20.0, "delta": 0.5,
+                "gamma": 0.05, "theta": -0.01, "vega": 0.1, "rho": 0.01,
+                "openInterest": 1000, "timeValue": 1.0,
+                "theoreticalOptionValue": 1.05,
+                "theoreticalVolatility": 29.0, "strikePrice": k,
+                "expirationDate": now_ms() + 86400000 * 30,
+                "daysToExpiration": 30, "expirationType": "R",
+                "multiplier": 100.0, "inTheMoney": (k < under) != put,
+                "nonStandard": False
+            }]
+        return {exp_key: m}
+
+    return {
+        "symbol": symbol, "status": "SUCCESS", "underlying": None,
+        "strategy": "SINGLE", "interval": 0.0, "isDelayed": False,
+        "isIndex": False, "interestRate": 0.02, "underlyingPrice": under,
+        "volatility": 29.0, "daysToExpiration": 0.0,
+        "numberOfContracts": strikes * 2,
+        "callExpDateMap": side(False), "putExpDateMap": side(True)
+    }
+
+
+def price_history(symbol, n=390, start=None, end=None):
+    """minute candles; w/ start and end(msec) one on each minute in range"""
+    if start is not None and end is not None:
+        t = -(-start // 60000) * 60000
+        n = max(0, min((end - t) // 60000 + 1, 100000))
+    else:
+        t = now_ms() - n * 60000
+    p = 100.0
+    candles = []
+    for i in range(n):
+        o = p
+        p = max(1.0, p + random.uniform(-.5, .5))
+        candles.append({
+            "open": round(o, 2), "high": round(max(o, p) + .1, 2),
+            "low": round(min(o, p) - .1, 2), "close": round(p, 2),
+            "volume": random.randint(100, 10000), "datetime": t + i * 60000
+        })
+    return {"candles": candles, "symbol": symbol, "empty": False}
+
+
+def account(account_id, with_positions=False):
+    a = {"securitiesAccount": {
+        "type": "MARGIN", "accountId": account_id, "roundTrips": 0,
+        "isDayTrader": False, "isClosingOnlyRestricted": False,
+        "currentBalances": {"cashBalance": 10000.0,
+                            "liquidationValue": 10000.0}
+    }}
+    if with_positions:
+        a["securitiesAccount"]["positions"] = [{
+            "shortQuantity": 0.0, "longQuantity": 10.0,
+            "averagePrice": 100.0, "marketValue": 1000.0,
+            "instrument": {"assetType": "EQUITY", "symbol": "SPY"}
+        }]
+    return a
+
+
+def order(account_id, order_id):
+    return {
+        "session": "NORMAL", "duration": "DAY", "orderType": "LIMIT",
+        "price": 1.0, "quantity": 1.0, "filledQuantity": 0.0,
+        "remainingQuantity": 1.0, "orderStrategyType": "SINGLE",
+        "orderId": int(order_id), "cancelable": True, "editable": True,
+        "status": "WORKING", "enteredTime": time.strftime(
+            "%Y-%m-%dT%H:%M:%S+0000", time.gmtime()),
+        "accountId": int(account_id),
+        "orderLegCollection": [{
+            "orderLegType": "EQUITY", "legId": 1, "instruction": "BUY",
+            "positionEffect": "OPENING", "quantity": 1.0,
+            "instrument": {"assetType": "EQUITY", "symbol": "SPY"}
+        }]
+    }
+
+
+def user_principals(host, port):
+    return {
+        "userId": "mockuser", "primaryAccountId": ACCOUNT_ID,
+        "accountCdDomainId": "A000000000000000", "userCdDomainId": "X",
+        "streamerInfo": {
+            "streamerBinaryUrl": "%s:%i" % (host, port),
+            "streamerSocketUrl": "%s:%i" % (host, port),
+            "token": "mock-streamer-token",
+            "tokenTimestamp": time.strftime("%Y-%m-%dT%H:%M:%S+0000",
+                                            time.gmtime()),
+            "userGroup": "ACCT", "accessLevel": "ACCT", "acl": "AKBR",
+            "appId": "MOCK"
+        },
+        "streamerSubscriptionKeys": {"keys": [{"key": "mock-key"}]},
+        "accounts": [{
+            "accountId": ACCOUNT_ID, "description": "", "displayName": "",
+            "accountCdDomainId": "A000000000000000", "company": "AMER",
+            "segment": "AMER", "acl": "AKBR",
+            "authorizations": {"apex": False, "levelTwoQuotes": True,
+                               "stockTrading": True,
+                               "optionTradingLevel": "NONE"}
+        }]
+    }
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "TDMAMock/1.0"
+
+    def log_message(self, fmt, *args):
+        if self.server.state.args.verbose:
+            sys.stderr.write("%s\n" % (fmt % args))
+
+    # -- helpers --
+
+    def _send(self, code, body=b"", headers=None, ctype="application/json"):
+        if isinstance(body, (dict, list)):
+            body = json.dumps(body).encode()
+        elif isinstance(body, str):
+            body = body.encode()
+        self.send_response(code)
+        self.send_header("Content-Type", ctype)
+        self.send_header("Content-Length", str(len(body)))
+        for k, v in (headers or {}).items():
+            self.send_header(k, v)
+        self.end_headers()
+        if body and self.command != "HEAD":
+            self.wfile.write(body)
+
+    def _payload(self, name, build):
+        p = self.server.state.payloads.get(name)
+        return p if p is not None else build()
+
+    def _read_body(self):
+        n = int(self.headers.get("Content-Length", 0) or 0)
+        return self.rfile.read(n) if n else b""
+
+    def _delay(self):
+        a = self.server.state.args
+        d = a.latency + (random.uniform(0, a.jitter) if a.jitter else 0)
+        if d > 0:
+            time.sleep(d / 1000.0)
+
+    def _check_request(self):
+        """ returns False if an error was sent """
+        state = self.server.state
+        a = state.args
+        n = state.count_request()
+        self._delay()
+
+        if a.error_rate and random.random() < a.error_rate:
+            self._send(503, {"error": "Service Unavailable (mock)"})
+            return False
+
+        auth = self.headers.get("Authorization", "")
+        tok = auth[7:] if auth.startswith("Bearer ") else ""
+        if not tok:
+            self._send(401, {"error": "Missing Authorization header"})
+            return False
+        if a.expire_every and n % a.expire_every == 0:
+            state.expire_token(tok)
+        if not state.token_is_valid(tok):
+            self._send(401, {"error": TOKEN_EXPIRED_MSG})
+            return False
+        return True
+
+    # -- routes --
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        if url.path == "/ws":
+            return self._websocket()
+        if not self._check_request():
+            return
+        q = {k: v[0] for k, v in parse_qs(url.query).items()}
+        parts = [unquote(p) for p in url.path.split('/') if p]
+        if parts[:1] == ["v1"]:
+            parts = parts[1:]
+        try:
+            body = self._route_get(parts, q)
+        except (IndexError, KeyError) as e:
+            return self._send(400, {"error": "bad request: %s" % e})
+        if body is None:
+            return self._send(404, {"error": "not found: " + url.path})
+        self._send(200, body)
+
+    def _route_get(self, parts, q):
+        n = len(parts)
+        if parts[0] == "marketdata":
+            if n == 2 and parts[1] == "quotes":
+                return self._payload("quotes", lambda: {
+                    s: quote(s) for s in q["symbol"].split(',')})
+            if n == 2 and parts[1] == "chains":
+                return self._payload("chains", lambda: option_chain(
+                    q["symbol"], int(q.get("strikeCount", 10))))
+            if n == 3 and parts[2] == "quotes":
+                return self._payload("quote", lambda: {
+                    parts[1]: quote(parts[1])})
+            if n == 3 and parts[2] == "pricehistory":
+                return self._payload("pricehistory", lambda: price_history(
+                    parts[1], start=int(q["startDate"]) if "startDate" in q
+                    else None, end=int(q["endDate"]) if "endDate" in q
+                    else None))
+            if n == 3 and parts[2] == "movers":
+                return self._payload("movers", lambda: [])
+            if n == 3 and parts[2] == "hours":
+                return self._payload("hours", lambda: {})
+        elif parts[0] == "instruments":
+            return self._payload("instruments", lambda: {})
+        elif parts[0] == "accounts":
+            if n == 1:
+                return self._payload("accounts", lambda: [
+                    account(ACCOUNT_ID, "positions" in q.get("fields", ""))])
+            if n == 2:
+                return self._payload("account", lambda: account(
+                    parts[1], "positions" in q.get("fields", "")))
+            if n == 3 and parts[2] in ("orders", "savedorders",
+                                       "transactions"):
+                return self._payload("orders", lambda: [
+                    order(parts[1], 1000)])
+            if n == 4 and parts[2] in ("orders", "savedorders",
+                                       "transactions"):
+                return self._payload("order",
+                                     lambda: order(parts[1], parts[3]))
+        elif parts[0] == "userprincipals":
+            if n == 1:
+                host, port = self.server.server_address[:2]
+                return self._payload("userprincipals",
+                                     lambda: user_principals(host, port))
+            if parts[1] == "streamersubscriptionkeys":
+                return self._payload("streamersubscriptionkeys", lambda: {
+                    "keys": [{"key": "mock-key"}]})
+        return None
+
+    def do_POST(self):
+        url = urlparse(self.path)
+        parts = [p for p in url.path.split('/') if p]
+        if parts[:1] == ["v1"]:
+            parts = parts[1:]
+        body = self._read_body()
+
+        if parts == ["oauth2", "token"]:
+            self._delay()
+            fields = {k: v[0] for k, v in parse_qs(body.decode()).items()}
+            grant = fields.get("grant_type", "")
+            if grant not in ("authorization_code", "refresh_token"):
+                return self._send(400, {"error": "invalid_grant"})
+            def build():
+                r = {"access_token": self.server.state.issue_token(),
+                     "scope": "PlaceTrades AccountAccess MoveMoney",
+                     "expires_in": int(self.server.state.args.token_ttl),
+                     "token_type": "Bearer"}
+                if grant == "authorization_code":
+                    r["refresh_token"] = "mock-refresh-token"
+                    r["refresh_token_expires_in"] = 7776000
+                return r
+            return self._send(200, self._payload("token", build))
+
+        if not self._check_request():
+            return
+        if len(parts) == 3 and parts[0] == "accounts" and parts[2] == "orders":
+            try:
+                json.loads(body.decode())
+            except ValueError:
+                return self._send(400, {"error": "invalid order json"})
+            oid = self.server.state.new_order_id()
+            host, port = self.server.server_address[:2]
+            loc = "http://%s:%i/v1/accounts/%s/orders/%i" % (
+                host, port, parts[1], oid)
+            return self._send(201, headers={"Location": loc})
+        self._send(404, {"error": "not found: " + url.path})
+
+    def do_DELETE(self):
+        url = urlparse(self.path)
+        parts = [p for p in url.path.split('/') if p]
+        if parts[:1] == ["v1"]:
+            parts = parts[1:]
+        if not self._check_request():
+            return
+        if len(parts) == 4 and parts[0] == "accounts" and parts[2] == "orders":
+            return self._send(200)
+        self._send(404, {"error": "not found: " + url.path})
+
+    # -- streamer --
+
+    def _websocket(self):
+        key = self.headers.get("Sec-WebSocket-Key")
+        if not key or "websocket" not in self.headers.get("Upgrade", "").lower():
+            return self._send(400, {"error": "expected websocket upgrade"})
+        accept = base64.b64encode(
+            hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        self.send_response(101)
+        self.send_header("Upgrade", "websocket")
+        self.send_header("Connection", "Upgrade")
+        self.send_header("Sec-WebSocket-Accept", accept)
+        self.end_headers()
+        self.wfile.flush()
+        StreamerSession(self.connection, self.server.state).run()
+        self.close_connection = True
+
+
+class StreamerSession:
+    """ one websocket client; frames are read on the handler's thread,
+        heartbeats and data floods are written from a second thread """
+
+    def __init__(self, sock, state):
+        self.sock = sock
+        self.state = state
+        self.args = state.args
+        self.send_lock = threading.Lock()
+        self.subs_lock = threading.Lock()
+        self.subs = {}  # service -> (keys, fields)
+        self.logged_in = False
+        self.closed = threading.Event()
+
+    # -- framing (RFC 6455, server side: unmasked out, masked in) --
+
+    def _recv_exact(self, n):
+        buf = b""
+        while len(buf) < n:
+            chunk = self.sock.recv(n - len(buf))
+            if not chunk:
+                raise ConnectionError("closed")
+            buf += chunk
+        return buf
+
+    def _recv_frame(self):
+        b0, b1 = self._recv_exact(2)
+        fin, opcode = b0 & 0x80, b0 & 0x0f
+        n = b1 & 0x7f
+        if n == 126:
+            n = struct.unpack("!H", self._recv_exact(2))[0]
+        elif n == 127:
+            n = struct.unpack("!Q", self._recv_exact(8))[0]
+        mask = self._recv_exact(4) if b1 & 0x80 else None
+        data = self._recv_exact(n)
+        if mask:
+            data = bytes(b ^ mask[i % 4] for i, b in enumerate(data))
+        return fin, opcode, data
+
+    def recv(self):
+        """ returns (opcode, payload) of the next whole message """
+        msg, msg_op = b"", None
+        while True:
+            fin, opcode, data = self._recv_frame()
+            if opcode == 0x9:
+                self.send_frame(0xA, data)
+                continue
+            if opcode == 0xA:
+                continue
+            if opcode == 0x8:
+                return opcode, data
+            if opcode != 0:
+                msg_op = opcode
+            msg += data
+            if fin:
+                return msg_op, msg
+
+    def send_frame(self, opcode, data):
+        n = len(data)
+        if n < 126:
+            head = struct.pack("!BB", 0x80 | opcode, n)
+        elif n < 65536:
+            head = struct.pack("!BBH", 0x80 | opcode, 126, n)
+        else:
+            head = struct.pack("!BBQ", 0x80 | opcode, 127, n)
+        with self.send_lock:
+            self.sock.sendall(head + data)
+
+    def send_json(self, obj):
+        self.send_frame(0x1, json.dumps(obj).encode())
+
+    # -- protocol --
+
+    def response(self, req, code=0, msg=""):
+        return {"service": req.get("service", ""),
+                "requestid": str(req.get("requestid", "")),
+                "command": req.get("command", ""),
+                "timestamp": now_ms(),
+                "content": {"code": code, "msg": msg}}
+
+    def handle(self, req):
+        service, cmd = req.get("service", ""), req.get("command", "")
+        params = req.get("parameters", {}) or {}
+        if service == "ADMIN":
+            if cmd == "LOGIN":
+                self.logged_in = True
+                return self.response(req, 0, "mock login")
+            if cmd == "LOGOUT":
+                self.logged_in = False
+                return self.response(req, 0, "SUCCESS")
+            if cmd == "QOS":
+                return self.response(req, 0, "QoS command succeeded")
+            return self.response(req, 22, "unknown command")
+        if not self.logged_in:
+            return self.response(req, 3, "not logged in")
+
+        keys = [k for k in params.get("keys", "").split(',') if k]
+        fields = [f for f in params.get("fields", "").split(',') if f]
+        with self.subs_lock:
+            if cmd == "SUBS":
+                self.subs[service] = (keys, fields)
+            elif cmd == "ADD":
+                old_keys, old_fields = self.subs.get(service, ([], fields))
+                self.subs[service] = (
+                    old_keys + [k for k in keys if k not in old_keys],
+                    old_fields)
+            elif cmd == "UNSUBS":
+                if service in self.subs:
+                    left = [k for k in self.subs[service][0] if k not in keys]
+                    if left:
+                        self.subs[service] = (left, self.subs[service][1])
+                    else:
+                        del self.subs[service]
+            elif cmd == "VIEW":
+                if service in self.subs:
+                    self.subs[service] = (self.subs[service][0], fields)
+            else:
+                return self.response(req, 22, "unknown command")
+        return self.response(req, 0, cmd + " command succeeded")
+
+    def data_frame(self, service, keys, fields):
+        content = []
+        for k in keys:
+            item = {"key": k}
+            for f in fields:
+                if f != "0":
+                    item[f] = round(random.uniform(1, 500), 2)
+            content.append(item)
+        return {"service": service, "timestamp": now_ms(),
+                "command": "SUBS", "content": content}
+
+    def writer(self):
+        """ heartbeats and data floods until closed """
+        rate = self.args.flood_rate
+        tick = 1.0 / rate if rate > 0 else None
+        next_hb = time.time() + self.args.heartbeat
+        next_data = time.time()
+        while not self.closed.is_set():
+            t = time.time()
+            try:
+                if t >= next_hb:
+                    self.send_json({"notify": [{"heartbeat": str(now_ms())}]})
+                    next_hb += self.args.heartbeat
+                if tick and t >= next_data and self.logged_in:
+                    with self.subs_lock:
+                        frames = [self.data_frame(s, k, f)
+                                  for s, (k, f) in self.subs.items() if k]
+                    if frames:
+                        self.send_json({"data": frames})
+                    next_data += tick
+                    if next_data < t - 1:  # can't keep up; don't burst
+                        next_data = t
+            except OSError:
+                break
+            wake = min([next_hb] + ([next_data] if tick else []))
+            self.closed.wait(max(0, wake - time.time()))
+
+    def run(self):
+        thrd = threading.Thread(target=self.writer, daemon=True)
+        thrd.start()
+        try:
+            while True:
+                opcode, data = self.recv()
+                if opcode == 0x8:
+                    self.send_frame(0x8, data[:2])
+                    break
+                try:
+                    msg = json.loads(data.decode())
+                except ValueError:
+                    continue
+                reqs = msg.get("requests", [msg])
+                resps = [self.handle(r) for r in reqs]
+                if resps:
+                    self.send_json({"response": resps})
+        except (ConnectionError, OSError):
+            pass
+        finally:
+            self.closed.set()
+            thrd.join()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="local stand-in for the TDAmeritrade REST/streamer APIs")
+    parser.add_argument("--host", default="127.0.0.1", type=str)
+    parser.add_argument("--port", default=8477, type=int)
+    parser.add_argument("--payloads", type=str,
+                        help="directory of canned responses (see above)")
+    parser.add_argument("--latency", default=0.0, type=float,
+                        help="added latency of REST responses (msec)")
+    parser.add_argument("--jitter", default=0.0, type=float,
+                        help="random extra latency, up to (msec)")
+    parser.add_argument("--error-rate", default=0.0, type=float,
+                        help="fraction of REST requests that get a 503")
+    parser.add_argument("--expire-every", default=0, type=int,
+                        help="expire the token of every Nth REST request")
+    parser.add_argument("--token-ttl", default=1800.0, type=float,
+                        help="lifetime of issued access tokens (sec)")
+    parser.add_argument("--flood-rate", default=1.0, type=float,
+                        help="streamer data frames per second (0 for none)")
+    parser.add_argument("--heartbeat", default=10.0, type=float,
+                        help="streamer heartbeat interval (sec)")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    server.daemon_threads = True
+    server.state = State(args)
+    print("mock server on http://%s:%i/v1/ and ws://%s:%i/ws"
+          % (args.host, args.port, args.host, args.port))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()